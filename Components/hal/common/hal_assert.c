@@ -47,6 +47,7 @@
 #include "hal_board.h"
 #include "hal_defs.h"
 #include "hal_mcu.h"
+#include "OSAL_Nv.h"
 
 #if (defined HAL_MCU_AVR) || (defined HAL_MCU_CC2430) || (defined HAL_MCU_CC2530) || \
     (defined HAL_MCU_CC2533) || (defined HAL_MCU_MSP430)
@@ -76,6 +77,14 @@ void halAssertHandler(void)
 {
   /* execute code that handles asserts */
 #ifdef ASSERT_RESET
+  static uint8 halAssertFlushing = FALSE;
+
+  /* Don't lose the NV writes still held in RAM, unless the flush itself asserted. */
+  if (!halAssertFlushing)
+  {
+    halAssertFlushing = TRUE;
+    (void)osal_nv_flush();
+  }
   HAL_SYSTEM_RESET();
 #elif !defined ASSERT_WHILE
   halAssertHazardLights();
@@ -60,6 +60,7 @@
 #include "hal_timer.h"
 #include "hal_uart.h"
 #include "hal_sleep.h"
+#include "hal_energy.h"
 #if (defined HAL_AES) && (HAL_AES == TRUE)
   #include "hal_aes.h"
 #endif
@@ -132,6 +133,11 @@ void Hal_Init( uint8 task_id )
  **************************************************************************************************/
 void HalDriverInit (void)
 {
+  /* Energy accounting, before any driver reports activity */
+#if (defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+  HalEnergyInit();
+#endif
+
   /* TIMER */
 #if (defined HAL_TIMER) && (HAL_TIMER == TRUE)
   #error "The hal timer driver module is removed."
@@ -324,6 +330,11 @@ void Hal_ProcessPoll ()
 #if (defined HAL_HID) && (HAL_HID == TRUE)
   usbHidProcessEvents();
 #endif
+
+  /* Energy accounting, the sleep timer wraps every 512s */
+#if (defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+  HalEnergyUpdate();
+#endif
   
 #if defined( POWER_SAVING )
   /* Allow sleep before the next OSAL event loop */
@@ -118,6 +118,16 @@ extern float AD7793_AIN3_fetch_one(void);
  */
 extern bool AD7793_IsReadyToFetch(void);
 
+/*
+ * Arm the DOUT/RDY falling edge interrupt to wake up and post an event.
+ */
+extern void HalAD7793RdyIntEnable(uint8 task_id, uint16 event);
+
+/*
+ * Disarm the DOUT/RDY interrupt.
+ */
+extern void HalAD7793RdyIntDisable(void);
+
 #ifdef __cplusplus
 }
 #endif  
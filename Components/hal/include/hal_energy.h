@@ -0,0 +1,145 @@
+/**************************************************************************************************
+  Filename:       hal_energy.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    This file contains the interface to the energy accounting
+                  service.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef HAL_ENERGY_H
+#define HAL_ENERGY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+  
+/**************************************************************************************************
+ *                                             INCLUDES
+ **************************************************************************************************/
+#include "hal_board.h"
+
+/**************************************************************************************************
+ *                                            CONSTANTS
+ **************************************************************************************************/
+/* CPU power states, exclusive. The PM values match the CC2530 SLEEPCMD mode bits. */
+#define HAL_ENERGY_CPU_ACTIVE     0
+#define HAL_ENERGY_CPU_PM1        1
+#define HAL_ENERGY_CPU_PM2        2
+#define HAL_ENERGY_CPU_PM3        3
+
+/* Peripheral activities, may overlap with each other and with the CPU state. */
+#define HAL_ENERGY_RADIO_TX       4
+#define HAL_ENERGY_RADIO_RX       5
+#define HAL_ENERGY_AD7793         6
+#define HAL_ENERGY_OLED           7
+#define HAL_ENERGY_EXT_FLASH      8
+
+#define HAL_ENERGY_STATE_NUM      9
+
+/* Serialized counter: seconds(4) + microseconds(4), LSB first */
+#define HAL_ENERGY_COUNTER_LEN    8
+#define HAL_ENERGY_REPORT_LEN     (HAL_ENERGY_STATE_NUM * HAL_ENERGY_COUNTER_LEN)
+
+/**************************************************************************************************
+ *                                              MACROS
+ **************************************************************************************************/
+#if (defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+#define HAL_ENERGY_CPU(state)     HalEnergyCpuState(state)
+#define HAL_ENERGY_START(state)   HalEnergyStart(state)
+#define HAL_ENERGY_STOP(state)    HalEnergyStop(state)
+#else
+#define HAL_ENERGY_CPU(state)
+#define HAL_ENERGY_START(state)
+#define HAL_ENERGY_STOP(state)
+#endif
+
+/***************************************************************************************************
+ *                                              TYPEDEFS
+ ***************************************************************************************************/
+typedef struct
+{
+  uint32 sec;    // whole seconds
+  uint16 ticks;  // remainder in 32 kHz sleep timer ticks, < 32768
+} halEnergyCounter_t;
+
+/**************************************************************************************************
+ *                                             FUNCTIONS - API
+ **************************************************************************************************/
+
+/*
+ * Initialize the energy accounting, the CPU starts as active.
+ */
+extern void HalEnergyInit(void);
+
+/*
+ * Switch the CPU power state.
+ */
+extern void HalEnergyCpuState(uint8 state);
+
+/*
+ * Mark a peripheral activity as started.
+ */
+extern void HalEnergyStart(uint8 state);
+
+/*
+ * Mark a peripheral activity as finished.
+ */
+extern void HalEnergyStop(uint8 state);
+
+/*
+ * Account the open intervals up to now, shall be called at least every 512s.
+ */
+extern void HalEnergyUpdate(void);
+
+/*
+ * Clear all counters.
+ */
+extern void HalEnergyReset(void);
+
+/*
+ * Serialize all counters into pBuf (HAL_ENERGY_REPORT_LEN bytes).
+ */
+extern uint8 *HalEnergySerialize(uint8 *pBuf);
+
+/*
+ * Accounting core, to add elapsed sleep timer ticks to a counter.
+ */
+extern void HalEnergyAccumulate(halEnergyCounter_t *pCounter, uint32 ticks);
+
+#ifdef __cplusplus
+}
+#endif  
+#endif
@@ -43,6 +43,9 @@
  ***************************************************************************************************/
 #include "hal_AD7793.h"
 #include "hal_spi_user.h"
+#include "hal_mcu.h"
+#include "hal_energy.h"
+#include "OSAL.h"
 
 #if (defined HAL_AD7793) && (HAL_AD7793 == TRUE)
 /***************************************************************************************************
@@ -179,6 +182,15 @@
 /* Dummy Byte */
 #define DUMMY_BYTE     0xFF
 
+/* DOUT/RDY shares the SPI MISO pin P0.2; it is driven low by the AD7793
+ * when a conversion is ready, as long as its CS stays asserted. */
+#define HAL_AD7793_RDY_BIT         BV(2)
+#define HAL_AD7793_RDY_PXIFG       P0IFG  /* Interrupt flag at source */
+#define HAL_AD7793_RDY_ICTL        P0IEN  /* Port Interrupt Control register */
+#define HAL_AD7793_RDY_EDGEBIT     BV(0)  /* PICTL - P0 falling edge */
+#define HAL_AD7793_RDY_IEN         IEN1   /* CPU interrupt mask register */
+#define HAL_AD7793_RDY_IENBIT      BV(5)  /* IEN1 - P0IE */
+
 /***************************************************************************************************
  *                                              MACROS
  ***************************************************************************************************/
@@ -190,6 +202,10 @@
 /**************************************************************************************************
  *                                        INNER GLOBAL VARIABLES
  **************************************************************************************************/
+/* Task and event posted when DOUT/RDY goes low */
+static uint8  halAD7793RdyTaskID = 0xFF;
+static uint16 halAD7793RdyEvent  = 0;
+
 void AD7793_Init_AIN1(void);
 void AD7793_Init_AIN2(void);
 void AD7793_Init_AIN3(void);
@@ -232,6 +248,7 @@ void HalAD7793Init(void)
 void AD7793_AIN1_config_one(AD7793Rate_t OutUpdateRate)
 {
   HalSpiAD7793Enable();       // AD7793 enable
+  HAL_ENERGY_START(HAL_ENERGY_AD7793);
   AD7793_Init_AIN1();
      
   //setup mode register
@@ -313,6 +330,7 @@ float AD7793_AIN1_fetch_one(void)
           
   
   HalSpiAD7793Disable();       // AD7793 disable
+  HAL_ENERGY_STOP(HAL_ENERGY_AD7793);
           
   fSample = (((float)reg_num)/8388608.0 - 1.0) * 1.17/128;
   
@@ -333,6 +351,7 @@ float AD7793_AIN1_fetch_one(void)
 void AD7793_AIN2_config_one(AD7793Rate_t OutUpdateRate)
 {
   HalSpiAD7793Enable();       // AD7793 enable
+  HAL_ENERGY_START(HAL_ENERGY_AD7793);
   AD7793_Init_AIN2();
   
   //setup mode register
@@ -413,6 +432,7 @@ float AD7793_AIN2_fetch_one(void)
           
   
   HalSpiAD7793Disable();       // AD7793 disable
+  HAL_ENERGY_STOP(HAL_ENERGY_AD7793);
           
   fSample = (((float)reg_num) * 1.17/16777215.0)/4;
   
@@ -433,6 +453,7 @@ float AD7793_AIN2_fetch_one(void)
 void AD7793_AIN3_config_one(AD7793Rate_t OutUpdateRate)
 {
   HalSpiAD7793Enable();       // AD7793 enable
+  HAL_ENERGY_START(HAL_ENERGY_AD7793);
   AD7793_Init_AIN3();
   
   //setup mode register
@@ -513,6 +534,7 @@ float AD7793_AIN3_fetch_one(void)
           
   
   HalSpiAD7793Disable();       // AD7793 disable
+  HAL_ENERGY_STOP(HAL_ENERGY_AD7793);
           
   fSample = (((float)reg_num) * 1.17/16777215.0)/1;
   
@@ -591,7 +613,108 @@ bool AD7793_IsReadyToFetch(void)
   statusData = HalSpiWriteReadByte(DUMMY_BYTE);
   return (( (statusData&AD7793_STAT_RDY) == AD7793_STAT_RDY)?FALSE:TRUE);
 }
+
+
+/*********************************************************************
+ * @fn      HalAD7793RdyIntEnable()
+ *
+ * @brief   Arm the DOUT/RDY falling edge interrupt after a conversion
+ *          has been started, so the MCU can sleep (PM2) and be woken up
+ *          as soon as the result is available instead of polling.
+ *
+ * @param   task_id - task to be notified.
+ *          event   - event to be posted to task_id.
+ *
+ * @return  none
+ *
+ * @note    Any SPI traffic toggles MISO, so the interrupt must be
+ *          disarmed by HalAD7793RdyIntDisable() before touching the bus.
+ */
+void HalAD7793RdyIntEnable(uint8 task_id, uint16 event)
+{
+  halIntState_t intState;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  halAD7793RdyTaskID = task_id;
+  halAD7793RdyEvent  = event;
+
+  PICTL |= HAL_AD7793_RDY_EDGEBIT;              /* Falling edge */
+  HAL_AD7793_RDY_PXIFG = ~(HAL_AD7793_RDY_BIT); /* Clear stale edges from SPI traffic */
+  P0IF = 0;
+  HAL_AD7793_RDY_ICTL |= HAL_AD7793_RDY_BIT;
+  HAL_AD7793_RDY_IEN  |= HAL_AD7793_RDY_IENBIT;
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/*********************************************************************
+ * @fn      HalAD7793RdyIntDisable()
+ *
+ * @brief   Disarm the DOUT/RDY interrupt.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void HalAD7793RdyIntDisable(void)
+{
+  halIntState_t intState;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  HAL_AD7793_RDY_ICTL &= ~(HAL_AD7793_RDY_BIT);
+  HAL_AD7793_RDY_PXIFG = ~(HAL_AD7793_RDY_BIT);
+  halAD7793RdyEvent = 0;
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/***************************************************************************************************
+ *                                    INTERRUPT SERVICE ROUTINE
+ ***************************************************************************************************/
+
+/**************************************************************************************************
+ * @fn      halAD7793Port0Isr
+ *
+ * @brief   Port0 ISR, DOUT/RDY of AD7793 went low. It is one-shot: the
+ *          interrupt is disarmed and the registered event is posted.
+ *
+ * @param
+ *
+ * @return
+ **************************************************************************************************/
+HAL_ISR_FUNCTION( halAD7793Port0Isr, P0INT_VECTOR )
+{
+  HAL_ENTER_ISR();
+
+  if (HAL_AD7793_RDY_PXIFG & HAL_AD7793_RDY_BIT)
+  {
+    HAL_AD7793_RDY_ICTL &= ~(HAL_AD7793_RDY_BIT);
+
+    if (halAD7793RdyEvent)
+    {
+      osal_set_event(halAD7793RdyTaskID, halAD7793RdyEvent);
+      halAD7793RdyEvent = 0;
+    }
+  }
+
+  /*
+    Clear the CPU interrupt flag for Port_0
+    PxIFG has to be cleared before PxIF
+    Only the RDY bit, the other P0 sources keep their edges
+  */
+  HAL_AD7793_RDY_PXIFG = ~(HAL_AD7793_RDY_BIT);
+  P0IF = 0;
+
+  CLEAR_SLEEP_MODE();
+  HAL_EXIT_ISR();
+}
 #else
 void HalAD7793Init(void);
+void HalAD7793RdyIntEnable(uint8 task_id, uint16 event);
+void HalAD7793RdyIntDisable(void);
 
 #endif /* HAL_AD7793 */
\ No newline at end of file
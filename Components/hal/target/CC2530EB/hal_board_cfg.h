@@ -505,6 +505,11 @@ st( \
 #define HAL_AD7793 TRUE
 #endif
 
+/* Set to TRUE enable energy accounting usage, FALSE disable it */
+#ifndef HAL_ENERGY
+#define HAL_ENERGY TRUE
+#endif
+
 /* Set to TRUE enable UART usage, FALSE disable it */
 #ifndef HAL_UART
 #if (defined ZAPP_P1) || (defined ZAPP_P2) || (defined ZTOOL_P1) || (defined ZTOOL_P2)
@@ -0,0 +1,348 @@
+/**************************************************************************************************
+  Filename:       hal_energy.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    This file contains the energy accounting service. The time
+                  spent in each CPU power state and in each peripheral activity
+                  is measured with the 32 kHz sleep timer and accumulated in RAM.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/***************************************************************************************************
+ *                                             INCLUDES
+ ***************************************************************************************************/
+#include "hal_energy.h"
+#include "hal_mcu.h"
+#include "OSAL.h"
+
+#if (defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+/***************************************************************************************************
+ *                                             CONSTANTS
+ ***************************************************************************************************/
+/* The sleep timer is a 24-bit counter clocked at 32.768 kHz, it wraps every 512s. It keeps
+ * running in PM1 and PM2 but is stopped in PM3, so PM3 time can not be measured. */
+#define HAL_ENERGY_ST_MASK         0x00FFFFFFUL
+
+/* 32768 ticks per second */
+#define HAL_ENERGY_TICKS_SHIFT     15
+#define HAL_ENERGY_TICKS_MASK      0x7FFF
+
+/***************************************************************************************************
+ *                                              MACROS
+ ***************************************************************************************************/
+/* 1000000/32768 = 15625/512, ticks must be < 32768 */
+#define HAL_ENERGY_TICKS_TO_US(t)  ((((uint32) (t)) * 15625UL) >> 9)
+
+/**************************************************************************************************
+ *                                        INNER GLOBAL VARIABLES
+ **************************************************************************************************/
+static halEnergyCounter_t halEnergyCounter[HAL_ENERGY_STATE_NUM];
+static uint32 halEnergyStamp[HAL_ENERGY_STATE_NUM];  // start of the open interval
+static uint16 halEnergyOpen;                         // bit map of open peripheral intervals
+static uint8  halEnergyCpu;                          // current CPU power state
+
+/**************************************************************************************************
+ *                                        FUNCTIONS - Local
+ **************************************************************************************************/
+static uint32 halEnergyReadST(void);
+static void halEnergyClose(uint8 state, uint32 now);
+
+/**************************************************************************************************
+ *                                        FUNCTIONS - API
+ **************************************************************************************************/
+
+/**************************************************************************************************
+ * @fn      HalEnergyInit
+ *
+ * @brief   Initialize the energy accounting, the CPU starts as active.
+ *
+ * @param   none
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyInit(void)
+{
+  uint8 idx;
+
+  halEnergyOpen = 0;
+  halEnergyCpu  = HAL_ENERGY_CPU_ACTIVE;
+
+  for (idx = 0; idx < HAL_ENERGY_STATE_NUM; idx++)
+  {
+    halEnergyCounter[idx].sec   = 0;
+    halEnergyCounter[idx].ticks = 0;
+  }
+
+  halEnergyStamp[HAL_ENERGY_CPU_ACTIVE] = halEnergyReadST();
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergyCpuState
+ *
+ * @brief   Switch the CPU power state, the time spent in the previous state is accounted.
+ *
+ * @param   state - HAL_ENERGY_CPU_ACTIVE or HAL_ENERGY_CPU_PMx
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyCpuState(uint8 state)
+{
+  halIntState_t intState;
+  uint32 now;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  now = halEnergyReadST();
+  halEnergyClose(halEnergyCpu, now);
+  halEnergyCpu = state;
+  halEnergyStamp[state] = now;
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergyStart
+ *
+ * @brief   Mark a peripheral activity as started. Nested starts are ignored.
+ *
+ * @param   state - HAL_ENERGY_RADIO_TX ... HAL_ENERGY_EXT_FLASH
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyStart(uint8 state)
+{
+  halIntState_t intState;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  if (!(halEnergyOpen & BV(state)))
+  {
+    halEnergyOpen |= BV(state);
+    halEnergyStamp[state] = halEnergyReadST();
+  }
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergyStop
+ *
+ * @brief   Mark a peripheral activity as finished. Stopping an idle activity is ignored.
+ *
+ * @param   state - HAL_ENERGY_RADIO_TX ... HAL_ENERGY_EXT_FLASH
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyStop(uint8 state)
+{
+  halIntState_t intState;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  if (halEnergyOpen & BV(state))
+  {
+    halEnergyOpen &= ~BV(state);
+    halEnergyClose(state, halEnergyReadST());
+  }
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergyUpdate
+ *
+ * @brief   Account all open intervals up to now. The sleep timer wraps every 512s, so this
+ *          shall be called more often than that; it is done from Hal_ProcessPoll().
+ *
+ * @param   none
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyUpdate(void)
+{
+  halIntState_t intState;
+  uint32 now;
+  uint8 idx;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  now = halEnergyReadST();
+  halEnergyClose(halEnergyCpu, now);
+
+  for (idx = HAL_ENERGY_RADIO_TX; idx < HAL_ENERGY_STATE_NUM; idx++)
+  {
+    if (halEnergyOpen & BV(idx))
+    {
+      halEnergyClose(idx, now);
+    }
+  }
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergyReset
+ *
+ * @brief   Clear all counters, open intervals are restarted from now.
+ *
+ * @param   none
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyReset(void)
+{
+  halIntState_t intState;
+  uint32 now;
+  uint8 idx;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  now = halEnergyReadST();
+
+  for (idx = 0; idx < HAL_ENERGY_STATE_NUM; idx++)
+  {
+    halEnergyCounter[idx].sec   = 0;
+    halEnergyCounter[idx].ticks = 0;
+    halEnergyStamp[idx] = now;
+  }
+
+  HAL_EXIT_CRITICAL_SECTION(intState);
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergySerialize
+ *
+ * @brief   Serialize all counters, in the order of the state IDs, as seconds and microseconds.
+ *
+ * @param   pBuf - buffer of at least HAL_ENERGY_REPORT_LEN bytes
+ *
+ * @return  pointer to end of destination buffer
+ **************************************************************************************************/
+uint8 *HalEnergySerialize(uint8 *pBuf)
+{
+  halEnergyCounter_t counter;
+  halIntState_t intState;
+  uint8 idx;
+
+  HalEnergyUpdate();
+
+  for (idx = 0; idx < HAL_ENERGY_STATE_NUM; idx++)
+  {
+    HAL_ENTER_CRITICAL_SECTION(intState);
+    counter = halEnergyCounter[idx];
+    HAL_EXIT_CRITICAL_SECTION(intState);
+
+    pBuf = osal_buffer_uint32(pBuf, counter.sec);
+    pBuf = osal_buffer_uint32(pBuf, HAL_ENERGY_TICKS_TO_US(counter.ticks));
+  }
+
+  return pBuf;
+}
+
+
+/**************************************************************************************************
+ * @fn      HalEnergyAccumulate
+ *
+ * @brief   Accounting core, add elapsed sleep timer ticks to a counter. The remainder is kept
+ *          in ticks so no rounding error accumulates over many short intervals.
+ *
+ * @param   pCounter - counter to update
+ *          ticks - elapsed 32 kHz ticks
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalEnergyAccumulate(halEnergyCounter_t *pCounter, uint32 ticks)
+{
+  ticks += pCounter->ticks;
+
+  pCounter->sec  += ticks >> HAL_ENERGY_TICKS_SHIFT;
+  pCounter->ticks = (uint16)(ticks & HAL_ENERGY_TICKS_MASK);
+}
+
+
+/**************************************************************************************************
+ * @fn      halEnergyReadST
+ *
+ * @brief   Read the 24-bit sleep timer, ST0 must be read first to latch ST1 and ST2.
+ *
+ * @param   none
+ *
+ * @return  sleep timer ticks
+ **************************************************************************************************/
+static uint32 halEnergyReadST(void)
+{
+  uint32 ticks;
+
+  ticks  = ST0;
+  ticks |= ((uint32) ST1) << 8;
+  ticks |= ((uint32) ST2) << 16;
+
+  return ticks;
+}
+
+
+/**************************************************************************************************
+ * @fn      halEnergyClose
+ *
+ * @brief   Account the interval of a state up to now and restart it from now.
+ *
+ * @param   state - state to account
+ *          now - current sleep timer ticks
+ *
+ * @return  None
+ **************************************************************************************************/
+static void halEnergyClose(uint8 state, uint32 now)
+{
+  HalEnergyAccumulate(&halEnergyCounter[state], (now - halEnergyStamp[state]) & HAL_ENERGY_ST_MASK);
+  halEnergyStamp[state] = now;
+}
+
+#else
+
+void HalEnergyInit(void);
+void HalEnergyCpuState(uint8 state);
+void HalEnergyStart(uint8 state);
+void HalEnergyStop(uint8 state);
+void HalEnergyUpdate(void);
+void HalEnergyReset(void);
+uint8 *HalEnergySerialize(uint8 *pBuf);
+void HalEnergyAccumulate(halEnergyCounter_t *pCounter, uint32 ticks);
+
+#endif /* HAL_ENERGY */
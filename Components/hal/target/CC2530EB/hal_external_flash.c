@@ -43,6 +43,7 @@
  ***************************************************************************************************/
 #include "hal_external_flash.h"
 #include "hal_spi_user.h"
+#include "hal_energy.h"
 
 #if (defined HAL_EXTERNAL_FLASH) && (HAL_EXTERNAL_FLASH == TRUE)
 /***************************************************************************************************
@@ -738,6 +739,8 @@ void HalExtFlashChipErase(void)
 void HalExtFlashWaitWriteEnd(void)
 {
   while((HalExtFlashReadStatusRegister() & 0x01) == 0x01);
+
+  HAL_ENERGY_STOP(HAL_ENERGY_EXT_FLASH);
 }
 
 
@@ -752,6 +755,9 @@ void HalExtFlashWaitWriteEnd(void)
  **************************************************************************************************/
 void HalExtFlashWriteEnable(void)
 {
+  /* program/erase cycle starts here and ends in HalExtFlashWaitWriteEnd() */
+  HAL_ENERGY_START(HAL_ENERGY_EXT_FLASH);
+
   HalSpiFlashEnable(); // ѡоƬ
   
   HalSpiWriteReadByte(F_WREN_COMMAND);  // Write enable 
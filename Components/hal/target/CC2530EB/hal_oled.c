@@ -43,6 +43,7 @@
 #include "OLED_FRONT.h"
 #include "hal_board.h"
 #include "hal_oled.h"
+#include "hal_energy.h"
 
 #if (defined HAL_OLED) && (HAL_OLED == TRUE)
 /***************************************************************************************************
@@ -425,6 +426,8 @@ void HalOledClear(void)
  **************************************************************************************************/
 void I2C_Start(void)
 {
+  HAL_ENERGY_START(HAL_ENERGY_OLED);
+
   SDA_L;
   OLED_OP_DELAY;
   SCL_H;
@@ -451,6 +454,8 @@ void I2C_Stop(void)
   OLED_OP_DELAY;
   SDA_H;
   OLED_OP_DELAY;  
+
+  HAL_ENERGY_STOP(HAL_ENERGY_OLED);
 }
 
 
@@ -55,6 +55,7 @@
 #include "OnBoard.h"
 #include "hal_drivers.h"
 #include "hal_assert.h"
+#include "hal_energy.h"
 #include "mac_mcu.h"
 
 #ifndef ZG_BUILD_ENDDEVICE_TYPE
@@ -344,6 +345,9 @@ void halSleep( uint16 osal_timeout )
       /* Prep CC2530 power mode */
       HAL_SLEEP_PREP_POWER_MODE(halPwrMgtMode);
 
+      /* account the time until now as active, from now on as PM2/PM3 */
+      HAL_ENERGY_CPU(halPwrMgtMode);
+
       /* save interrupt enable registers and disable all interrupts */
       HAL_SLEEP_IE_BACKUP_AND_DISABLE(ien0, ien1, ien2);
       HAL_ENABLE_INTERRUPTS();
@@ -361,6 +365,9 @@ void halSleep( uint16 osal_timeout )
       /* restore interrupt enable registers */
       HAL_SLEEP_IE_RESTORE(ien0, ien1, ien2);
 
+      /* the sleep timer is stopped in PM3, so only PM2 time is really accounted */
+      HAL_ENERGY_CPU(HAL_ENERGY_CPU_ACTIVE);
+
       /* disable sleep timer interrupt */
       HAL_SLEEP_TIMER_DISABLE_INT();
 
@@ -0,0 +1,176 @@
+/**************************************************************************************************
+  Filename:       hal_board_cfg.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Board configuration for the Linux host port. Only the simulated
+                  internal flash is present, the other drivers are off.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef HAL_BOARD_CFG_H
+#define HAL_BOARD_CFG_H
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#include "hal_mcu.h"
+#include "hal_defs.h"
+#include "hal_types.h"
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Clock Speed
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#define HAL_CPU_CLOCK_MHZ     32
+
+/* ------------------------------------------------------------------------------------------------
+ *                                         Flash Geometry
+ *
+ *                        Same layout as the banked CC2530 build, see hal_flash.c
+ * ------------------------------------------------------------------------------------------------
+ */
+#define HAL_FLASH_PAGE_PER_BANK    16
+#define HAL_FLASH_PAGE_SIZE        2048
+#define HAL_FLASH_WORD_SIZE        4
+#define HAL_FLASH_PAGE_CNT         128
+
+#define HAL_FLASH_LOCK_BITS        16
+#define HAL_NV_PAGE_END            126
+#define HAL_NV_PAGE_CNT            6
+
+#define HAL_FLASH_IEEE_SIZE        8
+#define HAL_FLASH_IEEE_PAGE       (HAL_NV_PAGE_END+1)
+#define HAL_FLASH_IEEE_OSET       (HAL_FLASH_PAGE_SIZE - HAL_FLASH_LOCK_BITS - HAL_FLASH_IEEE_SIZE)
+
+#define HAL_NV_PAGE_BEG           (HAL_NV_PAGE_END-HAL_NV_PAGE_CNT+1)
+
+/* ------------------------------------------------------------------------------------------------
+ *                                         Board Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+#define HAL_BOARD_INIT()
+#define HAL_CLOCK_STABLE()
+
+#define HAL_NUM_LEDS            0
+#define HAL_LED_BLINK_DELAY()
+
+/* ----------- Minimum safe bus voltage ---------- */
+#define VDD_2_0  74
+#define VDD_2_7  100
+
+#define VDD_MIN_RUN   VDD_2_0
+#define VDD_MIN_NV   (VDD_2_0+4)
+#define VDD_MIN_XNV  (VDD_2_7+5)
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Driver Configuration
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* Set to TRUE enable Flash access, FALSE disable it */
+#ifndef HAL_FLASH
+#define HAL_FLASH TRUE
+#endif
+
+#ifndef HAL_TIMER
+#define HAL_TIMER FALSE
+#endif
+
+#ifndef HAL_ADC
+#define HAL_ADC FALSE
+#endif
+
+#ifndef HAL_DMA
+#define HAL_DMA FALSE
+#endif
+
+#ifndef HAL_AES
+#define HAL_AES FALSE
+#endif
+
+#ifndef HAL_LCD
+#define HAL_LCD FALSE
+#endif
+
+#ifndef HAL_OLED
+#define HAL_OLED FALSE
+#endif
+
+#ifndef HAL_BATTERY_MONITOR
+#define HAL_BATTERY_MONITOR FALSE
+#endif
+
+#ifndef HAL_RTC_DS1302
+#define HAL_RTC_DS1302 FALSE
+#endif
+
+#ifndef HAL_LED
+#define HAL_LED FALSE
+#endif
+
+#ifndef HAL_KEY
+#define HAL_KEY FALSE
+#endif
+
+#ifndef HAL_SPI_USER
+#define HAL_SPI_USER FALSE
+#endif
+
+#ifndef HAL_EXTERNAL_FLASH
+#define HAL_EXTERNAL_FLASH FALSE
+#endif
+
+#ifndef HAL_AD7793
+#define HAL_AD7793 FALSE
+#endif
+
+#ifndef HAL_ENERGY
+#define HAL_ENERGY FALSE
+#endif
+
+#ifndef HAL_UART
+#define HAL_UART FALSE
+#endif
+
+#define HAL_UART_DMA  0
+#define HAL_UART_ISR  0
+#define HAL_UART_USB  0
+
+#endif
+/*******************************************************************************************************
+*/
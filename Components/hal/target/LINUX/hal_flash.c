@@ -0,0 +1,334 @@
+/**************************************************************************************************
+  Filename:       hal_flash.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Simulated internal flash for the Linux host port. Programming
+                  can only clear bits, like the CC2530 flash.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include <string.h>
+
+#include "hal_assert.h"
+#include "hal_board_cfg.h"
+#include "hal_flash.h"
+#include "hal_host.h"
+#include "hal_mcu.h"
+#include "hal_types.h"
+
+/* ------------------------------------------------------------------------------------------------
+ *                                         Global Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+halHostFlashStat_t halHostFlashStat;
+
+/* ------------------------------------------------------------------------------------------------
+ *                                          Local Variables
+ * ------------------------------------------------------------------------------------------------
+ */
+static uint8 halHostFlash[HAL_FLASH_PAGE_CNT][HAL_FLASH_PAGE_SIZE];
+static uint8 halHostFlashInit = FALSE;
+
+/* Words left to write before power is lost, zero when disarmed */
+static uint32 halHostFlashBudget = 0;
+static uint8 halHostFlashDead = FALSE;
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Local Prototypes
+ * ------------------------------------------------------------------------------------------------
+ */
+static void halHostFlashCheckInit(void);
+static uint8 halHostFlashSpend(uint32 words);
+
+/**************************************************************************************************
+ * @fn          HalFlashRead
+ *
+ * @brief       This function reads 'cnt' bytes from the internal flash.
+ *
+ * input parameters
+ *
+ * @param       pg - A valid flash page number.
+ * @param       offset - A valid offset into the page.
+ * @param       buf - A valid buffer space at least as big as the 'cnt' parameter.
+ * @param       cnt - A valid number of bytes to read.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashRead(uint8 pg, uint16 offset, uint8 *buf, uint16 cnt)
+{
+  halHostFlashCheckInit();
+  HAL_ASSERT((pg < HAL_FLASH_PAGE_CNT) && ((uint32)offset + cnt <= HAL_FLASH_PAGE_SIZE));
+
+  memcpy(buf, &halHostFlash[pg][offset], cnt);
+
+  halHostFlashStat.reads++;
+  halHostFlashStat.readBytes += cnt;
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashWrite
+ *
+ * @brief       This function writes 'cnt' bytes to the internal flash.
+ *
+ * input parameters
+ *
+ * @param       addr - Valid HAL flash write address: actual addr / 4 and quad-aligned.
+ * @param       buf - Valid buffer space at least as big as 'cnt' X 4.
+ * @param       cnt - Number of 4-byte blocks to write.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashWrite(uint16 addr, uint8 *buf, uint16 cnt)
+{
+  uint8 *dst;
+  uint16 len;
+  uint16 idx;
+
+  halHostFlashCheckInit();
+  HAL_ASSERT(((uint32)addr + cnt) <=
+             ((uint32)HAL_FLASH_PAGE_CNT * (HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE)));
+
+  dst = &halHostFlash[0][0] + ((uint32)addr * HAL_FLASH_WORD_SIZE);
+  len = cnt * HAL_FLASH_WORD_SIZE;
+
+  halHostFlashStat.writes++;
+  halHostFlashStat.writeBytes += len;
+
+  if (halHostFlashDead)
+  {
+    return;
+  }
+
+  for (idx = 0; idx < len; idx++)
+  {
+    if (((idx % HAL_FLASH_WORD_SIZE) == 0) && !halHostFlashSpend(1))
+    {
+      // Power was lost while programming this word, half of it made it
+      dst[idx] &= buf[idx];
+      dst[idx+1] &= buf[idx+1];
+      break;
+    }
+
+    // Programming can only clear bits
+    dst[idx] &= buf[idx];
+  }
+}
+
+/**************************************************************************************************
+ * @fn          HalFlashErase
+ *
+ * @brief       This function erases the specified page of the internal flash.
+ *
+ * input parameters
+ *
+ * @param       pg - A valid flash page number to erase.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ **************************************************************************************************
+ */
+void HalFlashErase(uint8 pg)
+{
+  halHostFlashCheckInit();
+  HAL_ASSERT(pg < HAL_FLASH_PAGE_CNT);
+
+  halHostFlashStat.erases++;
+
+  if (halHostFlashDead)
+  {
+    return;
+  }
+
+  if (halHostFlashSpend(HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE))
+  {
+    memset(halHostFlash[pg], 0xFF, HAL_FLASH_PAGE_SIZE);
+  }
+  else
+  {
+    // Power was lost during the erase, the page is left neither old nor erased
+    memset(halHostFlash[pg], 0xFF, HAL_FLASH_PAGE_SIZE / 2);
+  }
+}
+
+/**************************************************************************************************
+ * @fn          HalHostFlashReset
+ *
+ * @brief       Erase the whole simulated flash and clear the statistics and any fault.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void HalHostFlashReset(void)
+{
+  memset(halHostFlash, 0xFF, sizeof(halHostFlash));
+  memset(&halHostFlashStat, 0, sizeof(halHostFlashStat));
+  halHostFlashBudget = 0;
+  halHostFlashDead = FALSE;
+  halHostFlashInit = TRUE;
+}
+
+/**************************************************************************************************
+ * @fn          HalHostFlashPowerFail
+ *
+ * @brief       Lose power after 'words' more flash words are written. Zero disarms.
+ *
+ * @param       words - number of words that still make it to the flash
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+void HalHostFlashPowerFail(uint32 words)
+{
+  halHostFlashBudget = words;
+}
+
+/**************************************************************************************************
+ * @fn          HalHostFlashPowerOn
+ *
+ * @brief       Restore power to the simulated flash.
+ *
+ * @param       none
+ *
+ * @return      TRUE if power had been lost
+ **************************************************************************************************
+ */
+uint8 HalHostFlashPowerOn(void)
+{
+  uint8 dead = halHostFlashDead;
+
+  halHostFlashBudget = 0;
+  halHostFlashDead = FALSE;
+
+  return dead;
+}
+
+/**************************************************************************************************
+ * @fn          HalHostFlashPowerLost
+ *
+ * @brief       Check if power to the simulated flash has been lost, without restoring it.
+ *
+ * @param       none
+ *
+ * @return      TRUE if power has been lost
+ **************************************************************************************************
+ */
+uint8 HalHostFlashPowerLost(void)
+{
+  return halHostFlashDead;
+}
+
+/**************************************************************************************************
+ * @fn          HalHostFlashPage
+ *
+ * @brief       Direct access to a simulated flash page.
+ *
+ * @param       pg - flash page number
+ *
+ * @return      pointer to the page
+ **************************************************************************************************
+ */
+uint8 *HalHostFlashPage(uint8 pg)
+{
+  halHostFlashCheckInit();
+  HAL_ASSERT(pg < HAL_FLASH_PAGE_CNT);
+
+  return halHostFlash[pg];
+}
+
+/**************************************************************************************************
+ * @fn          halHostFlashCheckInit
+ *
+ * @brief       The flash comes up erased.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************
+ */
+static void halHostFlashCheckInit(void)
+{
+  if (!halHostFlashInit)
+  {
+    HalHostFlashReset();
+  }
+}
+
+/**************************************************************************************************
+ * @fn          halHostFlashSpend
+ *
+ * @brief       Account flash words about to be programmed against the power fail budget.
+ *
+ * @param       words - number of words
+ *
+ * @return      TRUE if the words can be programmed
+ **************************************************************************************************
+ */
+static uint8 halHostFlashSpend(uint32 words)
+{
+  if (halHostFlashBudget != 0)
+  {
+    if (halHostFlashBudget <= words)
+    {
+      halHostFlashBudget = 0;
+      halHostFlashDead = TRUE;
+      return FALSE;
+    }
+
+    halHostFlashBudget -= words;
+  }
+
+  return TRUE;
+}
+
+/**************************************************************************************************
+*/
@@ -0,0 +1,175 @@
+/**************************************************************************************************
+  Filename:       hal_host.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    HAL services of the Linux host port: interrupt flag, software
+                  reset, asserts, supply voltage and the driver poll.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/**************************************************************************************************
+ *                                            INCLUDES
+ **************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal_adc.h"
+#include "hal_assert.h"
+#include "hal_drivers.h"
+#include "hal_host.h"
+#include "hal_mcu.h"
+#include "hal_types.h"
+
+/**************************************************************************************************
+ *                                         GLOBAL VARIABLES
+ **************************************************************************************************/
+volatile uint8 halHostIntEnabled = 1;
+volatile uint32 halHostSleepTimer = 0;
+
+/**************************************************************************************************
+ *                                          LOCAL VARIABLES
+ **************************************************************************************************/
+static halHostResetCB_t halHostResetCB = NULL;
+static uint8 halHostVddGood = TRUE;
+
+/**************************************************************************************************
+ * @fn          halHostSystemReset
+ *
+ * @brief       HAL_SYSTEM_RESET() on the host: call the registered handler, which normally
+ *              restarts the simulated device, or end the program.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************/
+void halHostSystemReset(void)
+{
+  if (halHostResetCB != NULL)
+  {
+    halHostResetCB();
+  }
+  else
+  {
+    exit(0);
+  }
+}
+
+/**************************************************************************************************
+ * @fn          HalHostResetRegister
+ *
+ * @brief       Install the handler of HAL_SYSTEM_RESET().
+ *
+ * @param       cb - handler, NULL to end the program on reset
+ *
+ * @return      none
+ **************************************************************************************************/
+void HalHostResetRegister(halHostResetCB_t cb)
+{
+  halHostResetCB = cb;
+}
+
+/**************************************************************************************************
+ * @fn          HalHostSleepTimerAdvance
+ *
+ * @brief       Move the simulated sleep timer on, it is 24 bits wide like the CC2530 one.
+ *
+ * @param       ticks - 32 kHz ticks
+ *
+ * @return      none
+ **************************************************************************************************/
+void HalHostSleepTimerAdvance(uint32 ticks)
+{
+  halHostSleepTimer = (halHostSleepTimer + ticks) & 0x00FFFFFFUL;
+}
+
+/**************************************************************************************************
+ * @fn          HalHostVddSet
+ *
+ * @brief       Set the supply voltage reported to HalAdcCheckVdd().
+ *
+ * @param       good - TRUE if the supply is good enough for any check
+ *
+ * @return      none
+ **************************************************************************************************/
+void HalHostVddSet(uint8 good)
+{
+  halHostVddGood = good;
+}
+
+/**************************************************************************************************
+ * @fn          HalAdcCheckVdd
+ *
+ * @brief       Check for minimum Vdd specified.
+ *
+ * @param       vdd - The board-specific Vdd reading to check for.
+ *
+ * @return      TRUE if reading is greater than or equal to the parameter, FALSE otherwise.
+ **************************************************************************************************/
+bool HalAdcCheckVdd(uint8 vdd)
+{
+  (void)vdd;
+
+  return halHostVddGood;
+}
+
+/**************************************************************************************************
+ * @fn          Hal_ProcessPoll
+ *
+ * @brief       There are no drivers to poll on the host.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************/
+void Hal_ProcessPoll(void)
+{
+}
+
+/**************************************************************************************************
+ * @fn          halAssertHandler
+ *
+ * @brief       Logic to handle an assert: stop the simulation.
+ *
+ * @param       none
+ *
+ * @return      none
+ **************************************************************************************************/
+void halAssertHandler(void)
+{
+  fprintf(stderr, "HAL assert\n");
+  abort();
+}
+
+/**************************************************************************************************
+*/
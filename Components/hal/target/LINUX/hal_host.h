@@ -0,0 +1,128 @@
+/**************************************************************************************************
+  Filename:       hal_host.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Hooks of the Linux host port: simulated flash statistics and
+                  fault injection, software reset and supply voltage.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**************************************************************************************************
+ *                                             INCLUDES
+ **************************************************************************************************/
+#include "hal_board.h"
+
+/**************************************************************************************************
+ *                                             TYPEDEFS
+ **************************************************************************************************/
+/* Simulated flash activity since the last HalHostFlashReset() */
+typedef struct
+{
+  uint32 reads;            /* HalFlashRead calls */
+  uint32 readBytes;
+  uint32 writes;           /* HalFlashWrite calls */
+  uint32 writeBytes;
+  uint32 erases;
+} halHostFlashStat_t;
+
+/* Called by HAL_SYSTEM_RESET(), the default ends the program */
+typedef void (*halHostResetCB_t)(void);
+
+/**************************************************************************************************
+ *                                             GLOBALS
+ **************************************************************************************************/
+extern halHostFlashStat_t halHostFlashStat;
+
+/**************************************************************************************************
+ *                                        FUNCTIONS - API
+ **************************************************************************************************/
+
+/*
+ * Erase the whole simulated flash and clear the statistics and any fault.
+ */
+extern void HalHostFlashReset(void);
+
+/*
+ * Lose power after 'words' more flash words are written, an erase counting as one page of
+ * words. The word being written when power is lost is written half way. Later writes and
+ * erases are dropped until HalHostFlashPowerOn(). Zero disarms.
+ */
+extern void HalHostFlashPowerFail(uint32 words);
+
+/*
+ * Restore power to the simulated flash, returns TRUE if power had been lost.
+ */
+extern uint8 HalHostFlashPowerOn(void);
+
+/*
+ * Check if power to the simulated flash has been lost, without restoring it.
+ */
+extern uint8 HalHostFlashPowerLost(void);
+
+/*
+ * Direct access to a simulated flash page, e.g. to corrupt or inspect it.
+ */
+extern uint8 *HalHostFlashPage(uint8 pg);
+
+/*
+ * Set the supply voltage reported to HalAdcCheckVdd(), TRUE (the default) for good.
+ */
+extern void HalHostVddSet(uint8 good);
+
+/*
+ * Install the handler of HAL_SYSTEM_RESET(), NULL for the default.
+ */
+extern void HalHostResetRegister(halHostResetCB_t cb);
+
+/*
+ * Move the 24-bit sleep timer (ST2:ST1:ST0) on by 'ticks' of 32 kHz, wrapping as the real one.
+ */
+extern void HalHostSleepTimerAdvance(uint32 ticks);
+
+/**************************************************************************************************
+**************************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/**************************************************************************************************
+  Filename:       hal_mcu.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    MCU abstraction for the Linux host port. Interrupts are a flag,
+                  the simulator is single threaded.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef _HAL_MCU_H
+#define _HAL_MCU_H
+
+/*
+ *  Target : Linux host, single threaded simulation
+ *
+ */
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                           Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include "hal_defs.h"
+#include "hal_types.h"
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Target Defines
+ * ------------------------------------------------------------------------------------------------
+ */
+#define HAL_MCU_HOST
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                     Compiler Abstraction
+ * ------------------------------------------------------------------------------------------------
+ */
+#define HAL_COMPILER_GCC
+#define HAL_MCU_LITTLE_ENDIAN()   1
+#define HAL_ISR_FUNC_DECLARATION(f,v)   void f(void)
+#define HAL_ISR_FUNC_PROTOTYPE(f,v)     void f(void)
+#define HAL_ISR_FUNCTION(f,v)           HAL_ISR_FUNC_PROTOTYPE(f,v); HAL_ISR_FUNC_DECLARATION(f,v)
+
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Interrupt Macros
+ * ------------------------------------------------------------------------------------------------
+ */
+/* There are no interrupts on the host, the flag stands in for EA so that
+ * code checking HAL_INTERRUPTS_ARE_ENABLED() behaves as on the target.
+ */
+extern volatile uint8 halHostIntEnabled;
+
+#define HAL_ENABLE_INTERRUPTS()         st( halHostIntEnabled = 1; )
+#define HAL_DISABLE_INTERRUPTS()        st( halHostIntEnabled = 0; )
+#define HAL_INTERRUPTS_ARE_ENABLED()    (halHostIntEnabled)
+
+typedef unsigned char halIntState_t;
+#define HAL_ENTER_CRITICAL_SECTION(x)   st( x = halHostIntEnabled;  HAL_DISABLE_INTERRUPTS(); )
+#define HAL_EXIT_CRITICAL_SECTION(x)    st( halHostIntEnabled = x; )
+#define HAL_CRITICAL_STATEMENT(x)       st( halIntState_t _s; HAL_ENTER_CRITICAL_SECTION(_s); x; HAL_EXIT_CRITICAL_SECTION(_s); )
+
+#define HAL_ENTER_ISR()
+#define HAL_EXIT_ISR()
+
+/* ------------------------------------------------------------------------------------------------
+ *                                         Sleep Timer
+ * ------------------------------------------------------------------------------------------------
+ */
+/* The 24-bit 32 kHz sleep timer, moved on by HalHostSleepTimerAdvance(). */
+extern volatile uint32 halHostSleepTimer;
+
+#define ST0   ((uint8)(halHostSleepTimer))
+#define ST1   ((uint8)(halHostSleepTimer >> 8))
+#define ST2   ((uint8)(halHostSleepTimer >> 16))
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Reset Macro
+ * ------------------------------------------------------------------------------------------------
+ */
+extern void halHostSystemReset(void);
+
+#define WD_KICK()
+#define HAL_SYSTEM_RESET()  halHostSystemReset()
+
+#define CLEAR_SLEEP_MODE()
+#define ALLOW_SLEEP_MODE()
+
+/**************************************************************************************************
+ */
+#endif
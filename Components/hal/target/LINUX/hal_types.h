@@ -0,0 +1,106 @@
+/**************************************************************************************************
+  Filename:       hal_types.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Basic types for the Linux host port of OSAL and the HAL.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef _HAL_TYPES_H
+#define _HAL_TYPES_H
+
+/* Linux host */
+
+/* ------------------------------------------------------------------------------------------------
+ *                                             Includes
+ * ------------------------------------------------------------------------------------------------
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+/* ------------------------------------------------------------------------------------------------
+ *                                               Types
+ * ------------------------------------------------------------------------------------------------
+ */
+/* The widths must match the CC2530 build, where long is 32 bits. */
+typedef int8_t          int8;
+typedef uint8_t         uint8;
+
+typedef int16_t         int16;
+typedef uint16_t        uint16;
+
+typedef int32_t         int32;
+typedef uint32_t        uint32;
+
+typedef unsigned char   bool;
+
+typedef uint8           halDataAlign_t;
+
+typedef float           real32;
+
+/* ------------------------------------------------------------------------------------------------
+ *                                       Memory Attributes
+ * ------------------------------------------------------------------------------------------------
+ */
+#define  CODE
+#define  XDATA
+
+/* IAR keywords used directly by the sources */
+#define  __code
+#define  __xdata
+#define  __data
+#define  __no_init
+#define  __near_func
+#define  __root
+
+/* ------------------------------------------------------------------------------------------------
+ *                                        Standard Defines
+ * ------------------------------------------------------------------------------------------------
+ */
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+
+/**************************************************************************************************
+ */
+#endif
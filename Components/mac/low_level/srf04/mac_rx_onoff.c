@@ -45,6 +45,7 @@
 /* hal */
 #include "hal_defs.h"
 #include "hal_types.h"
+#include "hal_energy.h"
 
 /* exported low-level */
 #include "mac_low_level.h"
@@ -260,6 +261,7 @@ MAC_INTERNAL_API void macRxOn(void)
     macRxOnFlag = 1;
     MAC_RADIO_RX_ON();
     MAC_DEBUG_TURN_ON_RX_LED();
+    HAL_ENERGY_START(HAL_ENERGY_RADIO_RX);
   }
   HAL_EXIT_CRITICAL_SECTION(s);
 }
@@ -285,6 +287,7 @@ MAC_INTERNAL_API void macRxOff(void)
     macRxOnFlag = 0;
     MAC_RADIO_RXTX_OFF();
     MAC_DEBUG_TURN_OFF_RX_LED();
+    HAL_ENERGY_STOP(HAL_ENERGY_RADIO_RX);
     
     /* just in case a receive was about to start, flush the receive FIFO */
     MAC_RADIO_FLUSH_RX_FIFO();
@@ -47,6 +47,7 @@
 #include "hal_defs.h"
 #include "hal_mcu.h"
 #include "hal_mac_cfg.h"
+#include "hal_energy.h"
 
 /* high-level */
 #include "mac_spec.h"
@@ -194,6 +195,9 @@ MAC_INTERNAL_API void macTxFrame(uint8 txType)
     return;
   }
 
+  /* transmit time, including CSMA backoffs and ack wait, is accounted as radio TX */
+  HAL_ENERGY_START(HAL_ENERGY_RADIO_TX);
+
   /* save transmit type */
   macTxType = txType;
 
@@ -618,6 +622,7 @@ static void txComplete(uint8 status)
 
   /* update tx state; turn off receiver if nothing is keeping it on */
   macTxActive = MAC_TX_ACTIVE_NO_ACTIVITY;
+  HAL_ENERGY_STOP(HAL_ENERGY_RADIO_TX);
 
   /* turn off receive if allowed */
   macRxOffRequest();
@@ -792,6 +792,42 @@ uint32 macMcuPrecisionCount(void)
 }
 
 
+/**************************************************************************************************
+ * @fn          macMcuPrecisionCountFine
+ *
+ * @brief       Same as macMcuPrecisionCount() but also returns the hardware timer count within
+ *              the current backoff, latched together with the overflow count.
+ *
+ * @param       pTimerCount - receives the timer count, 0 to MAC_RADIO_TIMER_TICKS_PER_BACKOFF()-1
+ *
+ * @return      overflowCount
+ **************************************************************************************************
+ */
+uint32 macMcuPrecisionCountFine(uint16 *pTimerCount)
+{
+  uint32         overflowCount = 0;
+  uint8          timerLow;
+  halIntState_t  s;
+
+  HAL_ENTER_CRITICAL_SECTION(s);
+
+  /* This T2 access macro allows accessing both T2MOVFx and T2Mx */
+  MAC_MCU_T2_ACCESS_OVF_COUNT_VALUE();
+
+  /* Reading T2M0 latches T2M1 and the entire T2MOVFx */
+  timerLow = T2M0;
+  *pTimerCount = ((uint16)T2M1 << 8) | timerLow;
+  ((uint8 *)&overflowCount)[UINT32_NDX0] = T2MOVF0;
+  ((uint8 *)&overflowCount)[UINT32_NDX1] = T2MOVF1;
+  ((uint8 *)&overflowCount)[UINT32_NDX2] = T2MOVF2;
+
+  overflowCount += accumulatedOverflowCount;
+  HAL_EXIT_CRITICAL_SECTION(s);
+
+  return(overflowCount);
+}
+
+
 /**************************************************************************************************
  * @fn          macMcuRfIsr
  *
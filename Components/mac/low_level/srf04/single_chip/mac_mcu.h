@@ -211,6 +211,7 @@ MAC_INTERNAL_API void macMcuRecordMaxRssiStart(void);
 MAC_INTERNAL_API int8 macMcuRecordMaxRssiStop(void);
 MAC_INTERNAL_API void macMcuRecordMaxRssiIsr(void);
 uint32 macMcuPrecisionCount(void);
+uint32 macMcuPrecisionCountFine(uint16 *pTimerCount);
 void macMcuTimer2OverflowWorkaround(void);
 
 
@@ -93,6 +93,8 @@ extern "C"
 #define MT_SYS_GET_TIME                      0x11
 #define MT_SYS_OSAL_NV_DELETE                0x12
 #define MT_SYS_OSAL_NV_LENGTH                0x13
+#define MT_SYS_ENERGY_READ                   0x14
+#define MT_SYS_TASK_STATS                    0x15
 
 /* AREQ to host */
 #define MT_SYS_RESET_IND                     0x80
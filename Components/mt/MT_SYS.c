@@ -51,6 +51,7 @@
 #include "hal_adc.h"
 #include "ZGlobals.h"
 #include "OSAL_Clock.h"
+#include "hal_energy.h"
 
 /***************************************************************************************************
  * MACROS
@@ -121,6 +122,8 @@ void MT_SysStackTune(uint8 *pBuf);
 void MT_SysGetDeviceInfo(uint8 *pBuf);
 void MT_SysSetUtcTime(uint8 *pBuf);
 void MT_SysGetUtcTime(void);
+void MT_SysEnergyRead(uint8 *pBuf);
+void MT_SysTaskStats(uint8 *pBuf);
 #endif /* MT_SYS_FUNC */
 
 #if defined (MT_SYS_FUNC)
@@ -217,6 +220,14 @@ uint8 MT_SysCommandProcessing(uint8 *pBuf)
       MT_SysGetUtcTime();
       break;
 
+    case MT_SYS_ENERGY_READ:
+      MT_SysEnergyRead(pBuf);
+      break;
+
+    case MT_SYS_TASK_STATS:
+      MT_SysTaskStats(pBuf);
+      break;
+
     default:
       status = MT_RPC_ERR_COMMAND_ID;
       break;
@@ -235,6 +246,7 @@ uint8 MT_SysCommandProcessing(uint8 *pBuf)
  *************************************************************************************************/
 void MT_SysReset(uint8 *pBuf)
 {
+  // SystemReset() and SystemResetSoft() flush the NV writes still held in RAM.
   if (pBuf[MT_RPC_POS_DAT0] == 0)
   {
     SystemReset();
@@ -983,6 +995,116 @@ void MT_SysGetUtcTime(void)
     osal_mem_free( buf );
   }
 }
+
+/***************************************************************************************************
+ * @fn      MT_SysEnergyRead
+ *
+ * @brief   Read the energy accounting counters, optionally clearing them afterwards
+ *
+ * @param   pBuf - pointer to the data, data byte 0 (optional): 0=read, nonzero=read and reset
+ *
+ * @return  status, followed by seconds(4) and microseconds(4) for each HAL_ENERGY_xxx state
+ ***************************************************************************************************/
+void MT_SysEnergyRead(uint8 *pBuf)
+{
+#if (defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+  uint8 *buf;
+  uint8 reset;
+
+  reset = (pBuf[MT_RPC_POS_LEN] > 0) ? pBuf[MT_RPC_POS_DAT0] : 0;
+
+  buf = osal_mem_alloc( 1 + HAL_ENERGY_REPORT_LEN );
+  if ( buf )
+  {
+    buf[0] = ZSuccess;
+    HalEnergySerialize( buf + 1 );
+
+    if ( reset )
+    {
+      HalEnergyReset();
+    }
+
+    /* Build and send back the response */
+    MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS),
+                                   MT_SYS_ENERGY_READ, 1 + HAL_ENERGY_REPORT_LEN, buf);
+
+    osal_mem_free( buf );
+  }
+#else
+  uint8 retValue = ZUnsupportedMode;
+
+  (void)pBuf;
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS),
+                                 MT_SYS_ENERGY_READ, 1, &retValue);
+#endif
+}
+
+/***************************************************************************************************
+ * @fn      MT_SysTaskStats
+ *
+ * @brief   Read the dispatch statistics of an OSAL task, optionally clearing them afterwards
+ *
+ * @param   pBuf - pointer to the data, byte 0: task ID, byte 1: 0=read, 1=read and reset
+ *
+ * @return  status, bucket count(1), dispatches(4), total run time(4), max run time(2),
+ *          max latency(2), run time histogram(2 per bucket), latency histogram(2 per bucket),
+ *          all times in microseconds
+ ***************************************************************************************************/
+void MT_SysTaskStats(uint8 *pBuf)
+{
+#if OSAL_TASK_STATS
+  osal_task_stats_t stats;
+  uint8 *retBuf;
+  uint8 *pRet;
+  uint8 idx;
+
+  if ( osal_task_stats( pBuf[MT_RPC_POS_DAT0], &stats, pBuf[MT_RPC_POS_DAT0 + 1] ) != SUCCESS )
+  {
+    idx = ZInvalidParameter;
+    MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS),
+                                   MT_SYS_TASK_STATS, 1, &idx);
+    return;
+  }
+
+  retBuf = osal_mem_alloc( 1 + 1 + 4 + 4 + 2 + 2 + (4 * OSAL_TASK_STATS_BUCKETS) );
+  if ( retBuf == NULL )
+  {
+    return;
+  }
+
+  pRet = retBuf;
+  *pRet++ = ZSuccess;
+  *pRet++ = OSAL_TASK_STATS_BUCKETS;
+  pRet = osal_buffer_uint32( pRet, stats.dispatches );
+  pRet = osal_buffer_uint32( pRet, stats.runTotal );
+  *pRet++ = LO_UINT16( stats.runMax );
+  *pRet++ = HI_UINT16( stats.runMax );
+  *pRet++ = LO_UINT16( stats.latencyMax );
+  *pRet++ = HI_UINT16( stats.latencyMax );
+  for ( idx = 0; idx < OSAL_TASK_STATS_BUCKETS; idx++ )
+  {
+    *pRet++ = LO_UINT16( stats.runHist[idx] );
+    *pRet++ = HI_UINT16( stats.runHist[idx] );
+  }
+  for ( idx = 0; idx < OSAL_TASK_STATS_BUCKETS; idx++ )
+  {
+    *pRet++ = LO_UINT16( stats.latencyHist[idx] );
+    *pRet++ = HI_UINT16( stats.latencyHist[idx] );
+  }
+
+  /* Build and send back the response */
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS),
+                                 MT_SYS_TASK_STATS, (uint8)(pRet - retBuf), retBuf);
+
+  osal_mem_free( retBuf );
+#else
+  uint8 retValue = ZUnsupportedMode;
+
+  (void)pBuf;
+  MT_BuildAndSendZToolResponse(((uint8)MT_RPC_CMD_SRSP | (uint8)MT_RPC_SYS_SYS),
+                                 MT_SYS_TASK_STATS, 1, &retValue);
+#endif
+}
 #endif /* MT_SYS_FUNC */
 
 /***************************************************************************************************
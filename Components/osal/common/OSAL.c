@@ -58,6 +58,7 @@
 
 /* HAL */
 #include "hal_drivers.h"
+#include "hal_assert.h"
 
 #ifdef IAR_ARMCM3_LM
   #include "FreeRTOSConfig.h"
@@ -68,21 +69,41 @@
  * MACROS
  */
 
+// Bit of a task in the ready-task bit map
+#define OSAL_TASK_READY_BIT( task_id )  ((uint16)1 << (task_id))
+
 /*********************************************************************
  * CONSTANTS
  */
 
+// Number of tasks the ready-task bit map can hold
+#define OSAL_READY_TASKS_MAX    16
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+// Message queue of one task
+typedef struct
+{
+  osal_msg_q_t head;        // First message, NULL if empty
+  void *tail;               // Last message, valid while head is not NULL
+  osal_msg_qstat_t stat;
+} osalTaskQ_t;
+
+#if OSAL_TASK_STATS
+// Dispatch statistics of one task
+typedef struct
+{
+  uint32 readyAt;           // osal_time_us() when the task last became ready
+  osal_task_stats_t stats;
+} osalTaskStat_t;
+#endif
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
 
-// Message Pool Definitions
-osal_msg_q_t osal_qHead;
-
 /*********************************************************************
  * EXTERNAL VARIABLES
  */
@@ -99,9 +120,32 @@ TemprLowPower_t TemprLowPower;
 // Index of active task
 static uint8 activeTaskID = TASK_NO_TASK;
 
+// Ready-task bit map, bit n is set while tasksEvents[n] is not zero
+static uint16 osalTasksReady;
+
+// Message queues, one per task
+static osalTaskQ_t *osalTaskQ;
+
+#if OSAL_TASK_STATS
+// Dispatch statistics, one per task
+static osalTaskStat_t *osalTaskStat;
+#endif
+
+// Index of the lowest set bit of a nibble
+static CONST uint8 osalNibbleFirstBit[16] =
+{
+  0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
 /*********************************************************************
  * LOCAL FUNCTION PROTOTYPES
  */
+static uint8 osalFirstReadyTask( void );
+static uint8 osalMsgSend( uint8 destination_task, uint8 *msg_ptr, uint8 urgent );
+#if OSAL_TASK_STATS
+static uint8 osalStatsBucket( uint32 us );
+static void osalStatsRecord( uint8 idx, uint32 start, uint32 end );
+#endif
 
 /*********************************************************************
  * HELPER FUNCTIONS
@@ -321,9 +365,9 @@ uint32 osal_build_uint32( uint8 *swapped, uint8 len )
  *
  * @return  pointer to buffer
  */
-unsigned char * _ltoa(unsigned long l, unsigned char *buf, unsigned char radix)
+uint8 * _ltoa(uint32 l, uint8 *buf, uint8 radix)
 {
-#if defined( __GNUC__ )
+#if defined( __GNUC__ ) && !defined( HAL_MCU_HOST )
   return ( (char*)ltoa( l, buf, radix ) );
 #else
   unsigned char tmp1[10] = "", tmp2[10] = "", tmp3[10] = "";
@@ -491,10 +535,53 @@ uint8 osal_msg_deallocate( uint8 *msg_ptr )
  * @param   uint8 *msg_ptr - pointer to new message buffer
  * @param   uint8 len - length of data in message
  *
- * @return  SUCCESS, INVALID_TASK, INVALID_MSG_POINTER
+ * @return  SUCCESS, INVALID_TASK, INVALID_MSG_POINTER,
+ *          MSG_BUFFER_NOT_AVAIL if the task's queue is full
  */
 uint8 osal_msg_send( uint8 destination_task, uint8 *msg_ptr )
 {
+  return ( osalMsgSend( destination_task, msg_ptr, FALSE ) );
+}
+
+/*********************************************************************
+ * @fn      osal_msg_send_urgent
+ *
+ * @brief
+ *
+ *    This function sends a command message to a task ahead of the
+ *    messages already queued for it, whatever the depth cap of the
+ *    queue. It is meant for state changes the task must see first.
+ *
+ * @param   uint8 destination task - Send msg to?  Task ID
+ * @param   uint8 *msg_ptr - pointer to new message buffer
+ *
+ * @return  SUCCESS, INVALID_TASK, INVALID_MSG_POINTER
+ */
+uint8 osal_msg_send_urgent( uint8 destination_task, uint8 *msg_ptr )
+{
+  return ( osalMsgSend( destination_task, msg_ptr, TRUE ) );
+}
+
+/*********************************************************************
+ * @fn      osalMsgSend
+ *
+ * @brief
+ *
+ *    Queue a message on the destination task's own queue, at the tail
+ *    or, when urgent, at the head. A message over the depth cap is
+ *    counted and deallocated.
+ *
+ * @param   uint8 destination task - Send msg to?  Task ID
+ * @param   uint8 *msg_ptr - pointer to new message buffer
+ * @param   uint8 urgent - TRUE to queue at the head and ignore the cap
+ *
+ * @return  SUCCESS, INVALID_TASK, INVALID_MSG_POINTER, MSG_BUFFER_NOT_AVAIL
+ */
+static uint8 osalMsgSend( uint8 destination_task, uint8 *msg_ptr, uint8 urgent )
+{
+  osalTaskQ_t *q;
+  halIntState_t intState;
+
   if ( msg_ptr == NULL )
     return ( INVALID_MSG_POINTER );
 
@@ -512,10 +599,50 @@ uint8 osal_msg_send( uint8 destination_task, uint8 *msg_ptr )
     return ( INVALID_MSG_POINTER );
   }
 
+  q = osalTaskQ + destination_task;
+
+  // Hold off interrupts
+  HAL_ENTER_CRITICAL_SECTION(intState);
+
+  if ( !urgent && (q->stat.max != 0) && (q->stat.count >= q->stat.max) )
+  {
+    if ( q->stat.drops != 0xFFFF )
+    {
+      q->stat.drops++;
+    }
+    HAL_EXIT_CRITICAL_SECTION(intState);
+
+    // Back pressure: the sender learns the task is not keeping up
+    osal_msg_deallocate( msg_ptr );
+    return ( MSG_BUFFER_NOT_AVAIL );
+  }
+
   OSAL_MSG_ID( msg_ptr ) = destination_task;
 
   // queue message
-  osal_msg_enqueue( &osal_qHead, msg_ptr );
+  if ( q->head == NULL )
+  {
+    q->head = msg_ptr;
+    q->tail = msg_ptr;
+  }
+  else if ( urgent )
+  {
+    OSAL_MSG_NEXT( msg_ptr ) = q->head;
+    q->head = msg_ptr;
+  }
+  else
+  {
+    OSAL_MSG_NEXT( q->tail ) = msg_ptr;
+    q->tail = msg_ptr;
+  }
+
+  if ( ++q->stat.count > q->stat.peak )
+  {
+    q->stat.peak = q->stat.count;
+  }
+
+  // Release interrupts
+  HAL_EXIT_CRITICAL_SECTION(intState);
 
   // Signal the task that a message is waiting
   osal_set_event( destination_task, SYS_EVENT_MSG );
@@ -538,42 +665,30 @@ uint8 osal_msg_send( uint8 destination_task, uint8 *msg_ptr )
  */
 uint8 *osal_msg_receive( uint8 task_id )
 {
-  osal_msg_hdr_t *listHdr;
-  osal_msg_hdr_t *prevHdr = NULL;
-  osal_msg_hdr_t *foundHdr = NULL;
+  osalTaskQ_t *q;
+  osal_msg_hdr_t *foundHdr;
   halIntState_t   intState;
 
+  if ( task_id >= tasksCnt )
+    return ( NULL );
+
+  q = osalTaskQ + task_id;
+
   // Hold off interrupts
   HAL_ENTER_CRITICAL_SECTION(intState);
 
-  // Point to the top of the queue
-  listHdr = osal_qHead;
-
-  // Look through the queue for a message that belongs to the asking task
-  while ( listHdr != NULL )
+  // Take the first message off the task's queue
+  foundHdr = q->head;
+  if ( foundHdr != NULL )
   {
-    if ( (listHdr - 1)->dest_id == task_id )
-    {
-      if ( foundHdr == NULL )
-      {
-        // Save the first one
-        foundHdr = listHdr;
-      }
-      else
-      {
-        // Second msg found, stop looking
-        break;
-      }
-    }
-    if ( foundHdr == NULL )
-    {
-      prevHdr = listHdr;
-    }
-    listHdr = OSAL_MSG_NEXT( listHdr );
+    q->head = OSAL_MSG_NEXT( foundHdr );
+    q->stat.count--;
+    OSAL_MSG_NEXT( foundHdr ) = NULL;
+    OSAL_MSG_ID( foundHdr ) = TASK_NO_TASK;
   }
 
-  // Is there more than one?
-  if ( listHdr != NULL )
+  // Is there more?
+  if ( q->head != NULL )
   {
     // Yes, Signal the task that a message is waiting
     osal_set_event( task_id, SYS_EVENT_MSG );
@@ -584,13 +699,6 @@ uint8 *osal_msg_receive( uint8 task_id )
     osal_clear_event( task_id, SYS_EVENT_MSG );
   }
 
-  // Did we find a message?
-  if ( foundHdr != NULL )
-  {
-    // Take out of the link list
-    osal_msg_extract( &osal_qHead, foundHdr, prevHdr );
-  }
-
   // Release interrupts
   HAL_EXIT_CRITICAL_SECTION(intState);
 
@@ -620,14 +728,19 @@ osal_event_hdr_t *osal_msg_find(uint8 task_id, uint8 event)
   osal_msg_hdr_t *pHdr;
   halIntState_t intState;
 
+  if (task_id >= tasksCnt)
+  {
+    return NULL;
+  }
+
   HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
 
-  pHdr = osal_qHead;  // Point to the top of the queue.
+  pHdr = osalTaskQ[task_id].head;  // Point to the top of the task's queue.
 
-  // Look through the queue for a message that matches the task_id and event parameters.
+  // Look through the queue for a message that matches the event parameter.
   while (pHdr != NULL)
   {
-    if (((pHdr-1)->dest_id == task_id) && (((osal_event_hdr_t *)pHdr)->event == event))
+    if (((osal_event_hdr_t *)pHdr)->event == event)
     {
       break;
     }
@@ -640,6 +753,55 @@ osal_event_hdr_t *osal_msg_find(uint8 task_id, uint8 event)
   return (osal_event_hdr_t *)pHdr;
 }
 
+/*********************************************************************
+ * @fn      osal_msg_set_depth
+ *
+ * @brief
+ *
+ *    Set the depth cap of a task's message queue. Messages sent with
+ *    osal_msg_send() while the queue holds max messages are dropped.
+ *
+ * @param   uint8 task_id - task whose queue is capped
+ * @param   uint8 max - maximum number of queued messages, 0 for no cap
+ *
+ * @return  SUCCESS, INVALID_TASK
+ */
+uint8 osal_msg_set_depth( uint8 task_id, uint8 max )
+{
+  if ( task_id >= tasksCnt )
+    return ( INVALID_TASK );
+
+  osalTaskQ[task_id].stat.max = max;
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      osal_msg_q_stats
+ *
+ * @brief
+ *
+ *    Get the message queue statistics of a task.
+ *
+ * @param   uint8 task_id - task to look up
+ * @param   osal_msg_qstat_t *stat - receives the statistics
+ *
+ * @return  SUCCESS, INVALID_TASK
+ */
+uint8 osal_msg_q_stats( uint8 task_id, osal_msg_qstat_t *stat )
+{
+  halIntState_t intState;
+
+  if ( task_id >= tasksCnt )
+    return ( INVALID_TASK );
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+  *stat = osalTaskQ[task_id].stat;
+  HAL_EXIT_CRITICAL_SECTION(intState);
+
+  return ( SUCCESS );
+}
+
 /*********************************************************************
  * @fn      osal_msg_enqueue
  *
@@ -853,6 +1015,16 @@ uint8 osal_set_event( uint8 task_id, uint16 event_flag )
     halIntState_t   intState;
     HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
     tasksEvents[task_id] |= event_flag;  // Stuff the event bit(s)
+    if ( tasksEvents[task_id] )
+    {
+#if OSAL_TASK_STATS
+      if ( !(osalTasksReady & OSAL_TASK_READY_BIT( task_id )) )
+      {
+        osalTaskStat[task_id].readyAt = osal_time_us( NULL );
+      }
+#endif
+      osalTasksReady |= OSAL_TASK_READY_BIT( task_id );
+    }
     HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
     return ( SUCCESS );
   }
@@ -882,6 +1054,10 @@ uint8 osal_clear_event( uint8 task_id, uint16 event_flag )
     halIntState_t   intState;
     HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
     tasksEvents[task_id] &= ~(event_flag);   // Clear the event bit(s)
+    if ( tasksEvents[task_id] == 0 )
+    {
+      osalTasksReady &= ~OSAL_TASK_READY_BIT( task_id );
+    }
     HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
     return ( SUCCESS );
   }
@@ -891,6 +1067,40 @@ uint8 osal_clear_event( uint8 task_id, uint16 event_flag )
   }
 }
 
+/*********************************************************************
+ * @fn      osal_take_events
+ *
+ * @brief
+ *
+ *    This function is called by a task's event processor to pick up the
+ *    events set for it while it runs, so that they can be handled in the
+ *    same call. The returned events are cleared.
+ *
+ * @param   uint8 task_id - task whose events are taken
+ * @param   uint16 event_mask - events to take
+ *
+ * @return  the pending events within event_mask, 0 for an invalid task
+ */
+uint16 osal_take_events( uint8 task_id, uint16 event_mask )
+{
+  uint16 events = 0;
+
+  if ( task_id < tasksCnt )
+  {
+    halIntState_t   intState;
+    HAL_ENTER_CRITICAL_SECTION(intState);    // Hold off interrupts
+    events = tasksEvents[task_id] & event_mask;
+    tasksEvents[task_id] &= ~events;         // Clear the taken event bit(s)
+    if ( tasksEvents[task_id] == 0 )
+    {
+      osalTasksReady &= ~OSAL_TASK_READY_BIT( task_id );
+    }
+    HAL_EXIT_CRITICAL_SECTION(intState);     // Release interrupts
+  }
+
+  return ( events );
+}
+
 /*********************************************************************
  * @fn      osal_isr_register
  *
@@ -987,11 +1197,26 @@ uint8 osal_int_disable( uint8 interrupt_id )
  */
 uint8 osal_init_system( void )
 {
+  uint8 idx;
+
   // Initialize the Memory Allocation System
   osal_mem_init();
 
-  // Initialize the message queue
-  osal_qHead = NULL;
+  // Initialize the message queues, one per task with the default depth cap
+  osalTaskQ = (osalTaskQ_t *)osal_mem_alloc( sizeof( osalTaskQ_t ) * tasksCnt );
+  HAL_ASSERT( osalTaskQ != NULL );
+  osal_memset( osalTaskQ, 0, sizeof( osalTaskQ_t ) * tasksCnt );
+  for ( idx = 0; idx < tasksCnt; idx++ )
+  {
+    osalTaskQ[idx].stat.max = OSAL_MSG_Q_DEPTH;
+  }
+
+#if OSAL_TASK_STATS
+  // Initialize the task statistics
+  osalTaskStat = (osalTaskStat_t *)osal_mem_alloc( sizeof( osalTaskStat_t ) * tasksCnt );
+  HAL_ASSERT( osalTaskStat != NULL );
+  osal_memset( osalTaskStat, 0, sizeof( osalTaskStat_t ) * tasksCnt );
+#endif
 
   // Initialize the timers
   osalTimerInit();
@@ -1000,8 +1225,12 @@ uint8 osal_init_system( void )
   osal_pwrmgr_init();
 
   // Initialize the system tasks.
+  osalTasksReady = 0;
   osalInitTasks();
 
+  // Every task must fit into the ready-task bit map.
+  HAL_ASSERT( tasksCnt <= OSAL_READY_TASKS_MAX );
+
   // Setup efficient search for the first free block of heap.
   osal_mem_kick();
 
@@ -1035,9 +1264,9 @@ void osal_start_system( void )
  *
  * @brief
  *
- *   This function will make one pass through the OSAL taskEvents table
- *   and call the task_event_processor() function for the first task that
- *   is found with at least one event pending. If there are no pending
+ *   This function will look up the ready-task bit map and call the
+ *   task_event_processor() function for the highest priority (lowest
+ *   index) task with at least one event pending. If there are no pending
  *   events (all tasks), this function puts the processor into Sleep.
  *
  * @param   void
@@ -1053,39 +1282,61 @@ void osal_run_system( void )
   osalTimeUpdate();
   Hal_ProcessPoll();
 
-  do {
-    if (tasksEvents[idx])  // Task is highest priority that is ready.
-    {
-      break;
-    }
-  } while (++idx < tasksCnt);
-
-  if (idx < tasksCnt)
+  if (osalTasksReady)
   {
     uint16 events;
     halIntState_t intState;
+#if OSAL_TASK_STATS
+    uint32 start;
+#endif
 
     time_for1 = 0;
     time_for2 = 0;
     
     HAL_ENTER_CRITICAL_SECTION(intState);
+    idx = osalFirstReadyTask();  // Task is highest priority that is ready.
     events = tasksEvents[idx];
     tasksEvents[idx] = 0;  // Clear the Events for this task.
+    osalTasksReady &= ~OSAL_TASK_READY_BIT( idx );
     HAL_EXIT_CRITICAL_SECTION(intState);
 
+#if OSAL_TASK_STATS
+    start = osal_time_us( NULL );
+#endif
+
     activeTaskID = idx;
     events = (tasksArr[idx])( idx, events );
     activeTaskID = TASK_NO_TASK;
 
-    HAL_ENTER_CRITICAL_SECTION(intState);
-    tasksEvents[idx] |= events;  // Add back unprocessed events to the current task.
-    HAL_EXIT_CRITICAL_SECTION(intState);
+#if OSAL_TASK_STATS
+    osalStatsRecord( idx, start, osal_time_us( NULL ) );
+#endif
+
+    if (events)
+    {
+      HAL_ENTER_CRITICAL_SECTION(intState);
+      tasksEvents[idx] |= events;  // Add back unprocessed events to the current task.
+#if OSAL_TASK_STATS
+      if ( !(osalTasksReady & OSAL_TASK_READY_BIT( idx )) )
+      {
+        osalTaskStat[idx].readyAt = osal_time_us( NULL );
+      }
+#endif
+      osalTasksReady |= OSAL_TASK_READY_BIT( idx );
+      HAL_EXIT_CRITICAL_SECTION(intState);
+    }
   }
 #if defined( POWER_SAVING )
-  else  // Complete pass through all task events with no activity?
+  else  // No task with events pending?
   {
-    
-    if(time_for1<500)
+    if ( (TemprSystemStatus == TEMPR_ONLINE_MEASURE) ||
+         (TemprSystemStatus == TEMPR_OFFLINE_MEASURE) )
+    {
+      // Sleep through the AD7793 conversions, woken up by DOUT/RDY or
+      // the fallback timer. The OLED stays on during measurement.
+      osal_pwrmgr_powerconserve();
+    }
+    else if(time_for1<500)
     {
       if(time_for2 < 600)
         time_for2++;
@@ -1115,6 +1366,200 @@ void osal_run_system( void )
 #endif
 }
 
+#if defined ( OSAL_VIRTUAL_CLOCK )
+/*********************************************************************
+ * @fn      osal_run_virtual
+ *
+ * @brief
+ *
+ *   Run the task system in virtual time. Whenever no task has an
+ *   event pending, the virtual clock jumps straight to the next timer
+ *   expiration instead of sleeping, so the tasks run faster than real
+ *   time. If no timer is running the clock jumps to the end of the run.
+ *
+ * @param   runMSec - virtual milliseconds to run for
+ *
+ * @return  none
+ */
+void osal_run_virtual( uint32 runMSec )
+{
+  uint32 start;
+  uint32 elapsed;
+  uint32 left;
+  uint16 step;
+
+  start = osal_GetSystemClock();
+
+  for (;;)
+  {
+    osal_run_system();
+
+    if ( osalTasksReady )
+    {
+      continue;
+    }
+
+    elapsed = osal_GetSystemClock() - start;
+    if ( elapsed >= runMSec )
+    {
+      break;
+    }
+    left = runMSec - elapsed;
+
+    step = osal_next_timeout();
+    if ( (step == 0) || (step > left) )
+    {
+      step = (left > 0xFFFF) ? 0xFFFF : (uint16)left;
+    }
+
+    osal_virtual_clock_advance( step );
+  }
+}
+#endif // OSAL_VIRTUAL_CLOCK
+
+/*********************************************************************
+ * @fn      osalFirstReadyTask
+ *
+ * @brief
+ *
+ *   Find the highest priority ready task, i.e. the lowest set bit of
+ *   the ready-task bit map, in constant time. Must be called with
+ *   interrupts held off and at least one task ready.
+ *
+ * @param   void
+ *
+ * @return  task ID
+ */
+static uint8 osalFirstReadyTask( void )
+{
+  uint8 ready;
+  uint8 idx = 0;
+
+  ready = LO_UINT16( osalTasksReady );
+  if ( ready == 0 )
+  {
+    ready = HI_UINT16( osalTasksReady );
+    idx = 8;
+  }
+
+  if ( (ready & 0x0F) == 0 )
+  {
+    ready >>= 4;
+    idx += 4;
+  }
+
+  return ( idx + osalNibbleFirstBit[ready & 0x0F] );
+}
+
+#if OSAL_TASK_STATS
+/*********************************************************************
+ * @fn      osalStatsBucket
+ *
+ * @brief
+ *
+ *   Find the log2 histogram bucket of a time: 0 for 0 us, n for
+ *   2^(n-1) to 2^n - 1 us, the last bucket for anything longer.
+ *
+ * @param   us - time in microseconds
+ *
+ * @return  bucket index
+ */
+static uint8 osalStatsBucket( uint32 us )
+{
+  uint8 bucket = 0;
+
+  while ( (us != 0) && (bucket < (OSAL_TASK_STATS_BUCKETS - 1)) )
+  {
+    us >>= 1;
+    bucket++;
+  }
+
+  return ( bucket );
+}
+
+/*********************************************************************
+ * @fn      osalStatsRecord
+ *
+ * @brief
+ *
+ *   Account one call of a task's event handler. Counters saturate
+ *   rather than wrap, except the dispatch count and total run time.
+ *
+ * @param   idx - task ID
+ * @param   start - osal_time_us() when the event handler was called
+ * @param   end - osal_time_us() when the event handler returned
+ *
+ * @return  none
+ */
+static void osalStatsRecord( uint8 idx, uint32 start, uint32 end )
+{
+  osal_task_stats_t *pStats = &osalTaskStat[idx].stats;
+  uint32 latency = start - osalTaskStat[idx].readyAt;
+  uint32 run = end - start;
+  uint8 bucket;
+
+  pStats->dispatches++;
+  pStats->runTotal += run;
+
+  if ( run > pStats->runMax )
+  {
+    pStats->runMax = ( run > 0xFFFF ) ? 0xFFFF : (uint16)run;
+  }
+  if ( latency > pStats->latencyMax )
+  {
+    pStats->latencyMax = ( latency > 0xFFFF ) ? 0xFFFF : (uint16)latency;
+  }
+
+  bucket = osalStatsBucket( run );
+  if ( pStats->runHist[bucket] != 0xFFFF )
+  {
+    pStats->runHist[bucket]++;
+  }
+
+  bucket = osalStatsBucket( latency );
+  if ( pStats->latencyHist[bucket] != 0xFFFF )
+  {
+    pStats->latencyHist[bucket]++;
+  }
+}
+
+/*********************************************************************
+ * @fn      osal_task_stats
+ *
+ * @brief
+ *
+ *   Get the dispatch statistics of a task, and/or clear them.
+ *
+ * @param   task_id - task to look up
+ * @param   stats - receives the statistics, may be NULL
+ * @param   reset - TRUE to clear the statistics after reading them
+ *
+ * @return  SUCCESS, INVALID_TASK
+ */
+uint8 osal_task_stats( uint8 task_id, osal_task_stats_t *stats, uint8 reset )
+{
+  halIntState_t intState;
+
+  if ( task_id >= tasksCnt )
+  {
+    return ( INVALID_TASK );
+  }
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+  if ( stats != NULL )
+  {
+    *stats = osalTaskStat[task_id].stats;
+  }
+  if ( reset )
+  {
+    osal_memset( &osalTaskStat[task_id].stats, 0, sizeof( osal_task_stats_t ) );
+  }
+  HAL_EXIT_CRITICAL_SECTION(intState);
+
+  return ( SUCCESS );
+}
+#endif /* OSAL_TASK_STATS */
+
 /*********************************************************************
  * @fn      osal_buffer_uint32
  *
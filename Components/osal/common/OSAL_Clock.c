@@ -59,6 +59,9 @@
 
 #define	DAY      86400UL  // 24 hours * 60 minutes * 60 seconds
 
+// The MAC timer counts at the 32 MHz CPU clock, 10240 counts per 320us tick
+#define OSAL_CLOCK_COUNTS_PER_US  32
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -75,6 +78,15 @@
  * EXTERNAL FUNCTIONS
  */
 extern uint32 macMcuPrecisionCount(void);
+extern uint32 macMcuPrecisionCountFine(uint16 *pTimerCount);
+
+/* The free running count of 320us ticks is read from the MAC backoff
+ * timer. When OSAL is driven in virtual time (OSAL_VIRTUAL_CLOCK) there
+ * is no MAC, the two reads are served from a virtual counter advanced by
+ * the caller instead, see below.
+ */
+#define OSAL_CLOCK_TICKS_320US()  macMcuPrecisionCount()
+#define OSAL_CLOCK_TICKS_FINE( pCount )  macMcuPrecisionCountFine( pCount )
 
 #if (defined HAL_MCU_CC2430) || (defined HAL_MCU_CC2530) || (defined HAL_MCU_CC2533)
 
@@ -121,10 +133,23 @@ static uint32 previousMacTimerTick = 0;
 static uint16 remUsTicks = 0;
 static uint16 timeMSec = 0;
 
+// 320us tick count at the last read and the number of times the 32-bit
+// tick count wrapped, the top of the 64-bit time
+static uint32 usPrevTicks = 0;
+static uint32 usTicksWraps = 0;
+
 // number of seconds since 0 hrs, 0 minutes, 0 seconds, on the
 // 1st of January 2000 UTC
 UTCTime OSAL_timeSeconds = 0;
 
+#if defined ( OSAL_VIRTUAL_CLOCK )
+// Virtual count of 320us ticks, the microseconds within the tick and how
+// far, in 1/8 ticks, it is ahead of the virtual milliseconds
+static uint32 osalVirtualTicks = 0;
+static uint16 osalVirtualUs = 0;
+static uint8 osalVirtualAhead = 0;
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTION PROTOTYPES
  */
@@ -132,6 +157,8 @@ static uint8 monthLength( uint8 lpyr, uint8 mon );
 
 static void osalClockUpdate( uint16 elapsedMSec );
 
+static void osalTicksWrapCheck( uint32 ticks );
+
 /*********************************************************************
  * FUNCTIONS
  *********************************************************************/
@@ -159,7 +186,8 @@ void osalTimeUpdate( void )
 
   HAL_ENTER_CRITICAL_SECTION(intState);
   // Get the free-running count of 320us timer ticks
-  tmp = macMcuPrecisionCount();
+  tmp = OSAL_CLOCK_TICKS_320US();
+  osalTicksWrapCheck( tmp );
   HAL_EXIT_CRITICAL_SECTION(intState);
   
   if ( tmp != previousMacTimerTick )
@@ -186,6 +214,87 @@ void osalTimeUpdate( void )
   }
 }
 
+/*********************************************************************
+ * @fn      osal_time_us
+ *
+ * @brief   Read the monotonic microsecond clock. The count of 320 usec
+ *          ticks and the MAC timer count within the tick are latched
+ *          together and combined into a 64-bit count of microseconds,
+ *          computed in two 32-bit halves. Sleep is covered the same way
+ *          as for osalTimeUpdate(): the MAC restores the tick count from
+ *          the sleep timer on wake up. The wraps of the tick count are
+ *          also counted by osalTimeUpdate(), so the clock needs no
+ *          other caller. May be called from interrupts.
+ *
+ * @param   pTime - receives the 64-bit time, may be NULL
+ *
+ * @return  the low 32 bits of the time
+ */
+uint32 osal_time_us( osalTimeUs_t *pTime )
+{
+  halIntState_t intState;
+  uint32 ticks;
+  uint32 wraps;
+  uint32 part;
+  uint32 lo;
+  uint32 hi;
+  uint16 count;
+
+  HAL_ENTER_CRITICAL_SECTION(intState);
+  ticks = OSAL_CLOCK_TICKS_FINE( &count );
+  osalTicksWrapCheck( ticks );
+  wraps = usTicksWraps;
+  HAL_EXIT_CRITICAL_SECTION(intState);
+
+  // (wraps:ticks) * 320, the tick count taken 16 bits at a time
+  lo = (ticks & 0xFFFF) * 320;
+  part = (ticks >> 16) * 320;
+  hi = (part >> 16) + (wraps * 320);
+  part <<= 16;
+  lo += part;
+  if ( lo < part )
+  {
+    hi++;
+  }
+
+  // Add the microseconds within the current tick
+  part = count / OSAL_CLOCK_COUNTS_PER_US;
+  lo += part;
+  if ( lo < part )
+  {
+    hi++;
+  }
+
+  if ( pTime != NULL )
+  {
+    pTime->hi = hi;
+    pTime->lo = lo;
+  }
+
+  return ( lo );
+}
+
+/*********************************************************************
+ * @fn      osalTicksWrapCheck
+ *
+ * @brief   Count the wraps of the 32-bit 320 usec tick count, once
+ *          every 15.9 days. Every read of the tick count goes through
+ *          here with interrupts held off, osalTimeUpdate() included,
+ *          so a wrap is seen while the OSAL loop runs.
+ *
+ * @param   ticks - tick count just read
+ *
+ * @return  none
+ */
+static void osalTicksWrapCheck( uint32 ticks )
+{
+  if ( ticks < usPrevTicks )
+  {
+    usTicksWraps++;
+  }
+  usPrevTicks = ticks;
+}
+
 /*********************************************************************
  * @fn      osalClockUpdate
  *
@@ -208,6 +317,125 @@ static void osalClockUpdate( uint16 elapsedMSec )
   }
 }
 
+#if defined ( OSAL_VIRTUAL_CLOCK )
+/*********************************************************************
+ * @fn      osal_virtual_clock_advance
+ *
+ * @brief   Advance the virtual clock and update the OSAL Clock and
+ *          Timers right away. 1 msec is 25/8 of a 320us tick. The tick
+ *          count is rounded up and the excess carried over to the next
+ *          call, so osalTimeUpdate(), which rounds down, moves the OSAL
+ *          Clock by exactly elapsedMSec and timers expire on time.
+ *
+ * @param   elapsedMSec - milliseconds to advance
+ *
+ * @return  none
+ */
+void osal_virtual_clock_advance( uint16 elapsedMSec )
+{
+  uint32 tmp;
+
+  if ( elapsedMSec == 0 )
+  {
+    return;
+  }
+
+  tmp = ((uint32)elapsedMSec * 25) - osalVirtualAhead;
+  osalVirtualTicks += (tmp + 7) / 8;
+  osalVirtualAhead = (uint8)(((tmp + 7) & ~7UL) - tmp);
+
+  osalTimeUpdate();
+}
+
+/*********************************************************************
+ * @fn      osal_virtual_clock_ticks
+ *
+ * @brief   Advance the virtual MAC timer by whole 320us ticks, as time
+ *          spent in an event handler would. The OSAL Clock catches up
+ *          at the next osalTimeUpdate().
+ *
+ * @param   ticks - 320us ticks to advance
+ *
+ * @return  none
+ */
+void osal_virtual_clock_ticks( uint32 ticks )
+{
+  osalVirtualTicks += ticks;
+}
+
+/*********************************************************************
+ * @fn      osal_virtual_clock_us
+ *
+ * @brief   Advance the virtual MAC timer by microseconds, the count
+ *          within the 320us tick included. The OSAL Clock catches up
+ *          at the next osalTimeUpdate().
+ *
+ * @param   us - microseconds to advance
+ *
+ * @return  none
+ */
+void osal_virtual_clock_us( uint32 us )
+{
+  us += osalVirtualUs;
+  osalVirtualTicks += us / 320;
+  osalVirtualUs = (uint16)(us % 320);
+}
+
+/*********************************************************************
+ * @fn      macMcuPrecisionCount
+ *
+ * @brief   The MAC backoff timer read in virtual time.
+ *
+ * @param   none
+ *
+ * @return  virtual count of 320us ticks
+ */
+uint32 macMcuPrecisionCount( void )
+{
+  return ( osalVirtualTicks );
+}
+
+/*********************************************************************
+ * @fn      macMcuPrecisionCountFine
+ *
+ * @brief   The MAC backoff timer read in virtual time, with the timer
+ *          count within the tick.
+ *
+ * @param   pTimerCount - receives the count within the tick
+ *
+ * @return  virtual count of 320us ticks
+ */
+uint32 macMcuPrecisionCountFine( uint16 *pTimerCount )
+{
+  *pTimerCount = osalVirtualUs * OSAL_CLOCK_COUNTS_PER_US;
+
+  return ( osalVirtualTicks );
+}
+
+/*********************************************************************
+ * @fn      osal_virtual_clock_skip
+ *
+ * @brief   Jump the virtual clock straight to the next timer
+ *          expiration instead of waiting for it.
+ *
+ * @param   none
+ *
+ * @return  milliseconds skipped, zero if no timer is running
+ */
+uint16 osal_virtual_clock_skip( void )
+{
+  uint16 nextTimeout;
+
+  nextTimeout = osal_next_timeout();
+  if ( nextTimeout )
+  {
+    osal_virtual_clock_advance( nextTimeout );
+  }
+
+  return ( nextTimeout );
+}
+#endif // OSAL_VIRTUAL_CLOCK
+
 /*********************************************************************
  * @fn      osal_setClock
  *
@@ -112,6 +112,32 @@
 #define OSALMEM_SMALL_BLKCNT       8
 #endif
 
+/* Fixed-size block pools for the hottest allocations once the LL block is filled. A request is
+ * served in O(1) by the first pool with a large enough block size, or by the heap when that pool
+ * is empty. The default pool 0 fits osalTimerRec_t and small OSAL messages, pool 1 fits
+ * zdoIncomingMsg_t and AF incoming packets with a short payload. The pools are a lifetime
+ * allocation at the front of the wilderness, so they do not add to MAXMEMHEAP.
+ */
+#if !defined OSALMEM_POOL0_BLKSZ
+#define OSALMEM_POOL0_BLKSZ       (OSALMEM_ROUND(16))
+#endif
+#if !defined OSALMEM_POOL0_BLKCNT
+#define OSALMEM_POOL0_BLKCNT       8
+#endif
+#if !defined OSALMEM_POOL1_BLKSZ
+#define OSALMEM_POOL1_BLKSZ       (OSALMEM_ROUND(64))
+#endif
+#if !defined OSALMEM_POOL1_BLKCNT
+#define OSALMEM_POOL1_BLKCNT       4
+#endif
+
+#if OSALMEM_POOLS
+#define OSALMEM_POOL_BUCKET       ((OSALMEM_POOL0_BLKSZ * OSALMEM_POOL0_BLKCNT) + \
+                                   (OSALMEM_POOL1_BLKSZ * OSALMEM_POOL1_BLKCNT))
+#else
+#define OSALMEM_POOL_BUCKET        0
+#endif
+
 /*
  * These numbers setup the size of the small-block bucket which is reserved at the front of the
  * heap for allocations of OSALMEM_SMALL_BLKSZ or smaller.
@@ -128,6 +154,14 @@
 // The size of the wilderness after losing the small-block heap, the wasted header to block the
 // small-block heap from being coalesced, and the wasted header to mark the end of the heap.
 #define OSALMEM_BIGBLK_SZ         (MAXMEMHEAP - OSALMEM_SMALLBLK_BUCKET - OSALMEM_HDRSZ*2)
+#if OSALMEM_POOLS
+// Index of the wilderness after the in-use block holding the pools at the front of the big-block.
+#define OSALMEM_WILDBLK_IDX       (OSALMEM_BIGBLK_IDX + (OSALMEM_POOL_BUCKET / OSALMEM_HDRSZ) + 1)
+#define OSALMEM_WILDBLK_SZ        (OSALMEM_BIGBLK_SZ - OSALMEM_POOL_BUCKET - OSALMEM_HDRSZ)
+#else
+#define OSALMEM_WILDBLK_IDX        OSALMEM_BIGBLK_IDX
+#define OSALMEM_WILDBLK_SZ         OSALMEM_BIGBLK_SZ
+#endif
 // Index of the last available osalMemHdr_t at the end of the heap which will be set to zero for
 // fast comparisons with zero to determine the end of the heap.
 #define OSALMEM_LASTBLK_IDX      ((MAXMEMHEAP / OSALMEM_HDRSZ) - 1)
@@ -167,6 +201,16 @@ typedef union {
   osalMemHdrHdr_t hdr;
 } osalMemHdr_t;
 
+#if OSALMEM_POOLS
+typedef struct {
+  void  *freeList;  // First free block, each free block holds the pointer to the next one.
+  uint8 *base;      // First block of the pool.
+  uint8  used;      // Current cnt of blocks allocated.
+  uint8  max;       // Max cnt of blocks ever allocated at once.
+  uint16 miss;      // Cnt of allocations which found the pool empty.
+} osalMemPool_t;
+#endif
+
 /* ------------------------------------------------------------------------------------------------
  *                                           Local Variables
  * ------------------------------------------------------------------------------------------------
@@ -177,6 +221,14 @@ static __no_init osalMemHdr_t *ff1;  // First free block in the small-block buck
 
 static uint8 osalMemStat;            // Discrete status flags: 0x01 = kicked.
 
+#if OSALMEM_POOLS
+static osalMemPool_t osalMemPool[OSALMEM_POOL_NUM];
+static CONST uint16 osalMemPoolBlkSz[OSALMEM_POOL_NUM] = {
+OSALMEM_POOL0_BLKSZ, OSALMEM_POOL1_BLKSZ };
+static CONST uint8 osalMemPoolBlkCnt[OSALMEM_POOL_NUM] = {
+OSALMEM_POOL0_BLKCNT, OSALMEM_POOL1_BLKCNT };
+#endif
+
 #if OSALMEM_METRICS
 static uint16 blkMax;  // Max cnt of all blocks ever seen at once.
 static uint16 blkCnt;  // Current cnt of all blocks.
@@ -208,6 +260,17 @@ static uint16 proSmallBlkMiss;
 extern int dprintf(const char *fmt, ...);
 #endif /* DPRINTF_HEAPTRACE */
 
+/* ------------------------------------------------------------------------------------------------
+ *                                           Local Functions
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#if OSALMEM_POOLS
+static void osalMemPoolInit(uint8 *base);
+static void *osalMemPoolAlloc(uint16 size);
+static uint8 osalMemPoolFree(void *ptr);
+#endif
+
 /**************************************************************************************************
  * @fn          osal_mem_init
  *
@@ -243,17 +306,159 @@ void osal_mem_init(void)
   // small-block bucket from ever being coalesced with the wilderness.
   theHeap[OSALMEM_SMALLBLK_HDRCNT].val = (OSALMEM_HDRSZ | OSALMEM_IN_USE);
 
+#if OSALMEM_POOLS
+  // Setup the pools as a lifetime allocation at the front of the big-block.
+  theHeap[OSALMEM_BIGBLK_IDX].val = ((OSALMEM_POOL_BUCKET + OSALMEM_HDRSZ) | OSALMEM_IN_USE);
+  osalMemPoolInit((uint8 *)(theHeap + OSALMEM_BIGBLK_IDX + 1));
+#endif
+
   // Setup the wilderness.
-  theHeap[OSALMEM_BIGBLK_IDX].val = OSALMEM_BIGBLK_SZ;  // Set 'len' & clear 'inUse' field.
+  theHeap[OSALMEM_WILDBLK_IDX].val = OSALMEM_WILDBLK_SZ;  // Set 'len' & clear 'inUse' field.
 
 #if ( OSALMEM_METRICS )
   /* Start with the small-block bucket and the wilderness - don't count the
    * end-of-heap NULL block nor the end-of-small-block NULL block.
    */
   blkCnt = blkFree = 2;
+#if OSALMEM_POOLS
+  blkCnt++;  // The pools block.
+#endif
 #endif
 }
 
+#if OSALMEM_POOLS
+/**************************************************************************************************
+ * @fn          osalMemPoolInit
+ *
+ * @brief       Chain the blocks of each pool into its free list.
+ *
+ * input parameters
+ *
+ * @param base - the memory reserved for all pools.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      None.
+ */
+static void osalMemPoolInit(uint8 *base)
+{
+  uint8 idx, cnt;
+
+  for (idx = 0; idx < OSALMEM_POOL_NUM; idx++)
+  {
+    osalMemPool_t *pool = osalMemPool + idx;
+
+    pool->base = base;
+    pool->freeList = NULL;
+    pool->used = pool->max = 0;
+    pool->miss = 0;
+
+    // Push the blocks from the last one so that the list starts with the lowest address.
+    base += osalMemPoolBlkSz[idx] * osalMemPoolBlkCnt[idx];
+    for (cnt = 0; cnt < osalMemPoolBlkCnt[idx]; cnt++)
+    {
+      base -= osalMemPoolBlkSz[idx];
+      *(void **)base = pool->freeList;
+      pool->freeList = base;
+    }
+    base += osalMemPoolBlkSz[idx] * osalMemPoolBlkCnt[idx];
+  }
+}
+
+/**************************************************************************************************
+ * @fn          osalMemPoolAlloc
+ *
+ * @brief       Take a block from the first pool with a large enough block size.
+ *
+ * input parameters
+ *
+ * @param size - the number of bytes requested.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      Pointer to the block, NULL if the size fits no pool or the pool is empty.
+ */
+static void *osalMemPoolAlloc(uint16 size)
+{
+  halIntState_t intState;
+  void *blk = NULL;
+  uint8 idx;
+
+  for (idx = 0; idx < OSALMEM_POOL_NUM; idx++)
+  {
+    if (size <= osalMemPoolBlkSz[idx])
+    {
+      osalMemPool_t *pool = osalMemPool + idx;
+
+      HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
+
+      blk = pool->freeList;
+      if (blk != NULL)
+      {
+        pool->freeList = *(void **)blk;
+        if (pool->max < ++pool->used)
+        {
+          pool->max = pool->used;
+        }
+      }
+      else
+      {
+        pool->miss++;
+      }
+
+      HAL_EXIT_CRITICAL_SECTION(intState);  // Re-enable interrupts.
+      break;
+    }
+  }
+
+  return blk;
+}
+
+/**************************************************************************************************
+ * @fn          osalMemPoolFree
+ *
+ * @brief       Return a block to its pool if it belongs to one.
+ *
+ * input parameters
+ *
+ * @param ptr - the memory to free.
+ *
+ * output parameters
+ *
+ * None.
+ *
+ * @return      TRUE if the block was a pool block, FALSE if it belongs to the heap.
+ */
+static uint8 osalMemPoolFree(void *ptr)
+{
+  halIntState_t intState;
+  uint8 idx = OSALMEM_POOL_NUM;
+
+  if (((uint8 *)ptr < osalMemPool[0].base) ||
+      ((uint8 *)ptr >= osalMemPool[0].base + OSALMEM_POOL_BUCKET))
+  {
+    return FALSE;
+  }
+
+  // The pools are laid out in order, find the last one starting at or below the block.
+  while ((uint8 *)ptr < osalMemPool[--idx].base);
+
+  HAL_ENTER_CRITICAL_SECTION(intState);  // Hold off interrupts.
+
+  *(void **)ptr = osalMemPool[idx].freeList;
+  osalMemPool[idx].freeList = ptr;
+  osalMemPool[idx].used--;
+
+  HAL_EXIT_CRITICAL_SECTION(intState);  // Re-enable interrupts.
+
+  return TRUE;
+}
+#endif
+
 /**************************************************************************************************
  * @fn          osal_mem_kick
  *
@@ -317,6 +522,21 @@ void *osal_mem_alloc( uint16 size )
   halIntState_t intState;
   uint8 coal = 0;
 
+#if OSALMEM_POOLS
+  // Long-lived allocations are kept out of the pools.
+  if (osalMemStat != 0)
+  {
+    hdr = osalMemPoolAlloc(size);
+    if (hdr != NULL)
+    {
+#ifdef DPRINTF_OSALHEAPTRACE
+      dprintf("osal_mem_alloc(%u)->%lx:%s:%u\n", size, (unsigned) hdr, fname, lnum);
+#endif /* DPRINTF_OSALHEAPTRACE */
+      return (void *)hdr;
+    }
+  }
+#endif
+
   size += OSALMEM_HDRSZ;
 
   // Calculate required bytes to add to 'size' to align to halDataAlign_t.
@@ -344,7 +564,7 @@ void *osal_mem_alloc( uint16 size )
   }
   else
   {
-    hdr = (theHeap + OSALMEM_BIGBLK_IDX);
+    hdr = (theHeap + OSALMEM_WILDBLK_IDX);
   }
 
   do
@@ -514,6 +734,13 @@ void osal_mem_free(void *ptr)
   dprintf("osal_mem_free(%lx):%s:%u\n", (unsigned) ptr, fname, lnum);
 #endif /* DPRINTF_OSALHEAPTRACE */
 
+#if OSALMEM_POOLS
+  if (osalMemPoolFree(ptr))
+  {
+    return;
+  }
+#endif
+
   HAL_ASSERT(((uint8 *)ptr >= (uint8 *)theHeap) && ((uint8 *)ptr < (uint8 *)theHeap+MAXMEMHEAP));
   HAL_ASSERT(hdr->hdr.inUse);
 
@@ -611,6 +838,38 @@ uint16 osal_heap_mem_used( void )
 }
 #endif
 
+#if OSALMEM_POOLS
+/*********************************************************************
+ * @fn      osal_mem_pool_stat
+ *
+ * @brief   Return the usage and high-water mark of a fixed-size block pool.
+ *
+ * @param   pool - pool index, 0 to OSALMEM_POOL_NUM-1
+ * @param   pStat - where to copy the statistics
+ *
+ * @return  SUCCESS, or INVALIDPARAMETER
+ */
+uint8 osal_mem_pool_stat( uint8 pool, osalMemPoolStat_t *pStat )
+{
+  halIntState_t intState;
+
+  if ( pool >= OSALMEM_POOL_NUM )
+  {
+    return INVALIDPARAMETER;
+  }
+
+  HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+  pStat->blkSz = osalMemPoolBlkSz[pool];
+  pStat->blkCnt = osalMemPoolBlkCnt[pool];
+  pStat->used = osalMemPool[pool].used;
+  pStat->max = osalMemPool[pool].max;
+  pStat->miss = osalMemPool[pool].miss;
+  HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+
+  return SUCCESS;
+}
+#endif
+
 #if defined (ZTOOL_P1) || defined (ZTOOL_P2)
 /*********************************************************************
  * @fn      osal_heap_high_water
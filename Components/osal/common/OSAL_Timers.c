@@ -62,7 +62,7 @@
 typedef struct
 {
   void   *next;
-  uint16 timeout;
+  uint16 timeout;       // ticks after the previous timer in the list expires
   uint16 event_flag;
   uint8  task_id;
   uint16 reloadTimeout;
@@ -72,6 +72,8 @@ typedef struct
  * GLOBAL VARIABLES
  */
 
+// Timer delta list, sorted by expiration. The head's timeout is the time
+// left until it expires, every other timeout is relative to its predecessor.
 osalTimerRec_t *timerHead;
 
 /*********************************************************************
@@ -94,6 +96,8 @@ static uint32 osal_systemClock;
 osalTimerRec_t  *osalAddTimer( uint8 task_id, uint16 event_flag, uint16 timeout );
 osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag );
 void osalDeleteTimer( osalTimerRec_t *rmTimer );
+static void osalInsertTimer( osalTimerRec_t *newTimer, uint16 timeout );
+static void osalUnlinkTimer( osalTimerRec_t *rmTimer );
 
 /*********************************************************************
  * FUNCTIONS
@@ -113,6 +117,87 @@ void osalTimerInit( void )
   osal_systemClock = 0;
 }
 
+/*********************************************************************
+ * @fn      osalInsertTimer
+ *
+ * @brief   Insert a timer into the delta list, behind any timer that
+ *          expires at the same time.
+ *          Ints must be disabled.
+ *
+ * @param   newTimer - timer not in the list
+ * @param   timeout - ticks from now
+ *
+ * @return  none
+ */
+static void osalInsertTimer( osalTimerRec_t *newTimer, uint16 timeout )
+{
+  osalTimerRec_t *srchTimer;
+  osalTimerRec_t *prevTimer;
+
+  srchTimer = timerHead;
+  prevTimer = (void *)NULL;
+
+  // Walk past the timers expiring before or with the new one
+  while ( srchTimer && (srchTimer->timeout <= timeout) )
+  {
+    timeout -= srchTimer->timeout;
+    prevTimer = srchTimer;
+    srchTimer = srchTimer->next;
+  }
+
+  newTimer->timeout = timeout;
+  newTimer->next = srchTimer;
+
+  // The following timer is now relative to the new one
+  if ( srchTimer )
+  {
+    srchTimer->timeout -= timeout;
+  }
+
+  if ( prevTimer == NULL )
+    timerHead = newTimer;
+  else
+    prevTimer->next = newTimer;
+}
+
+/*********************************************************************
+ * @fn      osalUnlinkTimer
+ *
+ * @brief   Take a timer out of the delta list, its remaining delta is
+ *          handed on to the following timer.
+ *          Ints must be disabled.
+ *
+ * @param   rmTimer - timer in the list
+ *
+ * @return  none
+ */
+static void osalUnlinkTimer( osalTimerRec_t *rmTimer )
+{
+  osalTimerRec_t *srchTimer;
+
+  if ( rmTimer->next )
+  {
+    ((osalTimerRec_t *)rmTimer->next)->timeout += rmTimer->timeout;
+  }
+
+  if ( timerHead == rmTimer )
+  {
+    timerHead = rmTimer->next;
+  }
+  else
+  {
+    srchTimer = timerHead;
+
+    // Stop at the previous record
+    while ( srchTimer->next != rmTimer )
+      srchTimer = srchTimer->next;
+
+    srchTimer->next = rmTimer->next;
+  }
+
+  rmTimer->next = (void *)NULL;
+}
+
 /*********************************************************************
  * @fn      osalAddTimer
  *
@@ -128,14 +213,14 @@ void osalTimerInit( void )
 osalTimerRec_t * osalAddTimer( uint8 task_id, uint16 event_flag, uint16 timeout )
 {
   osalTimerRec_t *newTimer;
-  osalTimerRec_t *srchTimer;
 
   // Look for an existing timer first
   newTimer = osalFindTimer( task_id, event_flag );
   if ( newTimer )
   {
-    // Timer is found - update it.
-    newTimer->timeout = timeout;
+    // Timer is found - move it to its new position.
+    osalUnlinkTimer( newTimer );
+    osalInsertTimer( newTimer, timeout );
 
     return ( newTimer );
   }
@@ -149,28 +234,10 @@ osalTimerRec_t * osalAddTimer( uint8 task_id, uint16 event_flag, uint16 timeout
       // Fill in new timer
       newTimer->task_id = task_id;
       newTimer->event_flag = event_flag;
-      newTimer->timeout = timeout;
-      newTimer->next = (void *)NULL;
       newTimer->reloadTimeout = 0;
 
-      // Does the timer list already exist
-      if ( timerHead == NULL )
-      {
-        // Start task list
-        timerHead = newTimer;
-      }
-      else
-      {
-        // Add it to the end of the timer list
-        srchTimer = timerHead;
-
-        // Stop at the last record
-        while ( srchTimer->next )
-          srchTimer = srchTimer->next;
-
-        // Add to the list
-        srchTimer->next = newTimer;
-      }
+      // Add it in order of expiration
+      osalInsertTimer( newTimer, timeout );
 
       return ( newTimer );
     }
@@ -215,6 +282,7 @@ osalTimerRec_t *osalFindTimer( uint8 task_id, uint16 event_flag )
  * @fn      osalDeleteTimer
  *
  * @brief   Delete a timer from a timer list.
+ *          Ints must be disabled.
  *
  * @param   table
  * @param   rmTimer
@@ -226,9 +294,10 @@ void osalDeleteTimer( osalTimerRec_t *rmTimer )
   // Does the timer list really exist
   if ( rmTimer )
   {
-    // Clear the event flag and osalTimerUpdate() will delete 
-    // the timer from the list.
-    rmTimer->event_flag = 0;
+    // Take it out right away so that it no longer counts for the
+    // next timeout.
+    osalUnlinkTimer( rmTimer );
+    osal_mem_free( rmTimer );
   }
 }
 
@@ -347,11 +416,22 @@ uint16 osal_get_timeoutEx( uint8 task_id, uint16 event_id )
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
 
-  tmr = osalFindTimer( task_id, event_id );
+  // Sum up the deltas up to the timer
+  tmr = timerHead;
+  while ( tmr )
+  {
+    rtrn += tmr->timeout;
+
+    if ( tmr->event_flag == event_id &&
+         tmr->task_id == task_id )
+      break;
+
+    tmr = tmr->next;
+  }
 
-  if ( tmr )
+  if ( tmr == NULL )
   {
-    rtrn = tmr->timeout;
+    rtrn = 0;
   }
 
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
@@ -394,7 +474,9 @@ uint8 osal_timer_num_active( void )
 /*********************************************************************
  * @fn      osalTimerUpdate
  *
- * @brief   Update the timer structures for a timer tick.
+ * @brief   Update the timer structures for a timer tick. Only the
+ *          head of the delta list is counted down, expired timers
+ *          are taken off the head.
  *
  * @param   none
  *
@@ -403,79 +485,77 @@ uint8 osal_timer_num_active( void )
 void osalTimerUpdate( uint16 updateTime )
 {
   halIntState_t intState;
-  osalTimerRec_t *srchTimer;
-  osalTimerRec_t *prevTimer;
+  osalTimerRec_t *expTimer;
+  osalTimerRec_t *expHead = NULL;
+  osalTimerRec_t *expTail = NULL;
 
   HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
   // Update the system time
   osal_systemClock += updateTime;
   HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
 
-  // Look for open timer slot
-  if ( timerHead != NULL )
+  // Take the expired timers off the head of the list
+  for ( ;; )
   {
-    // Add it to the end of the timer list
-    srchTimer = timerHead;
-    prevTimer = (void *)NULL;
+    HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
 
-    // Look for open timer slot
-    while ( srchTimer )
+    expTimer = timerHead;
+
+    if ( expTimer == NULL )
     {
-      osalTimerRec_t *freeTimer = NULL;
-     
-      HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
-      
-      if (srchTimer->timeout <= updateTime)
-      {
-        srchTimer->timeout = 0;
-      }
-      else
-      {
-        srchTimer->timeout = srchTimer->timeout - updateTime;
-      }
-      
-      // Check for reloading
-      if ( (srchTimer->timeout == 0) && (srchTimer->reloadTimeout) && (srchTimer->event_flag) )
-      {
-        // Notify the task of a timeout
-        osal_set_event( srchTimer->task_id, srchTimer->event_flag );
-        
-        // Reload the timer timeout value
-        srchTimer->timeout = srchTimer->reloadTimeout;
-      }
-      
-      // When timeout or delete (event_flag == 0)
-      if ( srchTimer->timeout == 0 || srchTimer->event_flag == 0 )
-      {
-        // Take out of list
-        if ( prevTimer == NULL )
-          timerHead = srchTimer->next;
-        else
-          prevTimer->next = srchTimer->next;
+      HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+      break;
+    }
 
-        // Setup to free memory
-        freeTimer = srchTimer;
+    if ( expTimer->timeout > updateTime )
+    {
+      // Not expired, and so are all following timers
+      expTimer->timeout -= updateTime;
+      HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+      break;
+    }
 
-        // Next
-        srchTimer = srchTimer->next;
-      }
-      else
+    // Expired, the following timer is relative to this one
+    updateTime -= expTimer->timeout;
+    expTimer->timeout = 0;
+    timerHead = expTimer->next;
+    expTimer->next = (void *)NULL;
+
+    HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
+
+    // Keep them in order of expiration
+    if ( expTail == NULL )
+      expHead = expTimer;
+    else
+      expTail->next = expTimer;
+    expTail = expTimer;
+  }
+
+  // Notify the tasks, reload or free the expired timers
+  while ( expHead )
+  {
+    expTimer = expHead;
+    expHead = expTimer->next;
+
+    osal_set_event( expTimer->task_id, expTimer->event_flag );
+
+    if ( expTimer->reloadTimeout )
+    {
+      HAL_ENTER_CRITICAL_SECTION( intState );  // Hold off interrupts.
+
+      // The timer may have been restarted by an interrupt meanwhile
+      if ( osalFindTimer( expTimer->task_id, expTimer->event_flag ) == NULL )
       {
-        // Get next
-        prevTimer = srchTimer;
-        srchTimer = srchTimer->next;
+        osalInsertTimer( expTimer, expTimer->reloadTimeout );
+        expTimer = NULL;
       }
-      
+
       HAL_EXIT_CRITICAL_SECTION( intState );   // Re-enable interrupts.
-      
-      if ( freeTimer )
-      {
-        if ( freeTimer->timeout == 0 )
-        {
-          osal_set_event( freeTimer->task_id, freeTimer->event_flag );
-        }
-        osal_mem_free( freeTimer );
-      }
+    }
+
+    if ( expTimer )
+    {
+      osal_mem_free( expTimer );
     }
   }
 }
@@ -503,14 +583,17 @@ void osal_adjust_timers( void )
       osalTimerUpdate( eTime );
   }
 }
+#endif // POWER_SAVING
 
+#if defined ( POWER_SAVING ) || defined ( OSAL_VIRTUAL_CLOCK )
 /*********************************************************************
  * @fn      osal_next_timeout
  *
  * @brief
  *
- *   Search timer table to return the lowest timeout value. If the
- *   timer list is empty, then the returned timeout will be zero.
+ *   Return the lowest timeout value, which is the head of the delta
+ *   list. If the timer list is empty, then the returned timeout will
+ *   be zero.
  *
  * @param   none
  *
@@ -519,24 +602,11 @@ void osal_adjust_timers( void )
 uint16 osal_next_timeout( void )
 {
   uint16 nextTimeout;
-  osalTimerRec_t *srchTimer;
 
   if ( timerHead != NULL )
   {
-    // Head of the timer list
-    srchTimer = timerHead;
-    nextTimeout = OSAL_TIMERS_MAX_TIMEOUT;
-
-    // Look for the next timeout timer
-    while ( srchTimer != NULL )
-    {
-      if (srchTimer->timeout < nextTimeout)
-      {
-        nextTimeout = srchTimer->timeout;
-      }
-      // Check next timer
-      srchTimer = srchTimer->next;
-    }
+    // The head expires first
+    nextTimeout = timerHead->timeout;
   }
   else
   {
@@ -546,7 +616,7 @@ uint16 osal_next_timeout( void )
 
   return ( nextTimeout );
 }
-#endif // POWER_SAVING
+#endif // POWER_SAVING || OSAL_VIRTUAL_CLOCK
 
 /*********************************************************************
  * @fn      osal_GetSystemClock()
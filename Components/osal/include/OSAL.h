@@ -83,6 +83,27 @@ extern "C"
 /*** Interrupts ***/
 #define INTS_ALL    0xFF
 
+/*** Task Message Queues ***/
+// Default depth cap of every task message queue, 0 for no cap.
+// osal_msg_set_depth() overrides it per task.
+#if !defined ( OSAL_MSG_Q_DEPTH )
+  #define OSAL_MSG_Q_DEPTH  0
+#endif
+
+/*** Task Statistics ***/
+// Per-task dispatch count, run time and event-to-dispatch latency,
+// timed in microseconds by osal_time_us()
+#if !defined ( OSAL_TASK_STATS )
+  #define OSAL_TASK_STATS  FALSE
+#endif
+
+// Number of log2 histogram buckets: bucket 0 counts 0 us, bucket n
+// counts 2^(n-1) to 2^n - 1 us and the last bucket everything above,
+// from 16.4 ms with the default 16 buckets
+#if !defined ( OSAL_TASK_STATS_BUCKETS )
+  #define OSAL_TASK_STATS_BUCKETS  16
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -101,6 +122,28 @@ typedef struct
 
 typedef void * osal_msg_q_t;
 
+// Message queue statistics of a task
+typedef struct
+{
+  uint16 count;   // Messages queued now
+  uint16 peak;    // Most messages queued at once
+  uint16 drops;   // Messages dropped at the depth cap, saturates at 0xFFFF
+  uint8  max;     // Depth cap, 0 for none
+} osal_msg_qstat_t;
+
+#if OSAL_TASK_STATS
+// Dispatch statistics of a task, times in microseconds
+typedef struct
+{
+  uint32 dispatches;                         // Calls of the task's event handler
+  uint32 runTotal;                           // Time spent in the event handler, wraps
+  uint16 runMax;                             // Longest event handler call, saturates
+  uint16 latencyMax;                         // Longest wait from ready to dispatch, saturates
+  uint16 runHist[OSAL_TASK_STATS_BUCKETS];      // Event handler call times
+  uint16 latencyHist[OSAL_TASK_STATS_BUCKETS];  // Waits from ready to dispatch
+} osal_task_stats_t;
+#endif
+
 
 typedef enum
 {
@@ -134,6 +177,11 @@ extern TemprLowPower_t TemprLowPower;
    */
   extern uint8 osal_msg_send( uint8 destination_task, uint8 *msg_ptr );
 
+  /*
+   * Send a Task Message ahead of the queued ones, ignoring the depth cap
+   */
+  extern uint8 osal_msg_send_urgent( uint8 destination_task, uint8 *msg_ptr );
+
   /*
    * Receive a Task Message
    */
@@ -144,6 +192,23 @@ extern TemprLowPower_t TemprLowPower;
    */
   extern osal_event_hdr_t *osal_msg_find(uint8 task_id, uint8 event);
 
+  /*
+   * Set the depth cap of a Task's message queue, 0 for no cap
+   */
+  extern uint8 osal_msg_set_depth( uint8 task_id, uint8 max );
+
+  /*
+   * Get the message queue statistics of a Task
+   */
+  extern uint8 osal_msg_q_stats( uint8 task_id, osal_msg_qstat_t *stat );
+
+#if OSAL_TASK_STATS
+  /*
+   * Get and/or reset the dispatch statistics of a Task
+   */
+  extern uint8 osal_task_stats( uint8 task_id, osal_task_stats_t *stats, uint8 reset );
+#endif
+
   /*
    * Enqueue a Task Message
    */
@@ -183,6 +248,11 @@ extern TemprLowPower_t TemprLowPower;
    */
   extern uint8 osal_clear_event( uint8 task_id, uint16 event_flag );
 
+  /*
+   * Take (read and clear) the pending events of a Task
+   */
+  extern uint16 osal_take_events( uint8 task_id, uint16 event_mask );
+
 
 /*** Interrupt Management  ***/
 
@@ -223,6 +293,14 @@ extern TemprLowPower_t TemprLowPower;
    */
   extern void osal_run_system( void );
 
+#if defined ( OSAL_VIRTUAL_CLOCK )
+  /*
+   * Run the task system for runMSec of virtual time, skipping the idle
+   * time between timer expirations.
+   */
+  extern void osal_run_virtual( uint32 runMSec );
+#endif
+
   /*
    * Get the active task ID
    */
@@ -78,6 +78,13 @@ typedef struct
   uint16 year;    // 2000+
 } UTCTimeStruct;
 
+// Monotonic count of microseconds since start up, 64 bits as two halves
+typedef struct
+{
+  uint32 hi;
+  uint32 lo;
+} osalTimeUs_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -91,6 +98,40 @@ typedef struct
    */
   extern void osalTimeUpdate( void );
 
+  /*
+   * Read the monotonic microsecond clock, driven by the MAC timer.
+   *     pTime - receives the 64-bit time, may be NULL
+   *     returns: the low 32 bits, enough for intervals below 71 minutes
+   */
+  extern uint32 osal_time_us( osalTimeUs_t *pTime );
+
+#if defined ( OSAL_VIRTUAL_CLOCK )
+  /*
+   * Advance the virtual clock by elapsedMSec and update the OSAL
+   * clock and Timers.
+   */
+  extern void osal_virtual_clock_advance( uint16 elapsedMSec );
+
+  /*
+   * Advance the virtual MAC timer by whole 320us ticks, as time spent
+   * in an event handler would. The OSAL clock catches up at the next
+   * osalTimeUpdate().
+   */
+  extern void osal_virtual_clock_ticks( uint32 ticks );
+
+  /*
+   * Advance the virtual MAC timer by microseconds, the count within the
+   * 320us tick included.
+   */
+  extern void osal_virtual_clock_us( uint32 us );
+
+  /*
+   * Jump the virtual clock to the next timer expiration.
+   *     returns: milliseconds skipped, zero if no timer is running
+   */
+  extern uint16 osal_virtual_clock_skip( void );
+#endif
+
   /*
    * Set the new time.  This will only set the seconds portion
    * of time and doesn't change the factional second counter.
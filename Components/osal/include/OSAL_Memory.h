@@ -58,6 +58,13 @@ extern "C"
   #define OSALMEM_METRICS  FALSE
 #endif
 
+#if !defined ( OSALMEM_POOLS )
+  #define OSALMEM_POOLS  TRUE
+#endif
+
+// Number of fixed-size block pools
+#define OSALMEM_POOL_NUM  2
+
 /*********************************************************************
  * MACROS
  */
@@ -68,6 +75,15 @@ extern "C"
  * TYPEDEFS
  */
 
+typedef struct
+{
+  uint16 blkSz;   // Block size in bytes.
+  uint8  blkCnt;  // Number of blocks in the pool.
+  uint8  used;    // Blocks now allocated.
+  uint8  max;     // Max blocks ever allocated at once.
+  uint16 miss;    // Allocations that fell back to the heap because the pool was empty.
+} osalMemPoolStat_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -128,6 +144,13 @@ extern "C"
   uint16 osal_heap_mem_used( void );
 #endif
 
+#if ( OSALMEM_POOLS )
+ /*
+  * Return the usage and high-water mark of a fixed-size block pool.
+  */
+  uint8 osal_mem_pool_stat( uint8 pool, osalMemPoolStat_t *pStat );
+#endif
+
 #if defined (ZTOOL_P1) || defined (ZTOOL_P2)
  /*
   * Return the highest number of bytes ever used in the heap.
@@ -55,10 +55,25 @@ extern "C"
  * CONSTANTS
  */
 
+// Compact NV pages in steps driven by an OSAL event, see osal_nv_register().
+#if !defined OSAL_NV_BG_COMPACT
+#define OSAL_NV_BG_COMPACT  TRUE
+#endif
+
+// Coalesce the writes of osal_nv_write_back() in RAM until osal_nv_flush() or a short delay.
+#if !defined OSAL_NV_WRITE_BACK
+#define OSAL_NV_WRITE_BACK  TRUE
+#endif
+
 /*********************************************************************
  * MACROS
  */
 
+#if !OSAL_NV_WRITE_BACK
+#define osal_nv_write_back  osal_nv_write
+#define osal_nv_flush()     ( SUCCESS )
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -101,6 +116,30 @@ extern uint16 osal_nv_item_len( uint16 id );
  */
 extern uint8 osal_nv_delete( uint16 id, uint16 len );
 
+#if OSAL_NV_BG_COMPACT || OSAL_NV_WRITE_BACK
+/*
+ * Register the task event for the NV work done in the background.
+ */
+extern void osal_nv_register( uint8 taskId, uint16 event );
+
+/*
+ * Do the NV work pending for the registered event.
+ */
+extern void osal_nv_process( void );
+#endif
+
+#if OSAL_NV_WRITE_BACK
+/*
+ * Write an NV attribute, coalesced with the following writes in RAM.
+ */
+extern uint8 osal_nv_write_back( uint16 id, uint16 offset, uint16 len, void *buf );
+
+/*
+ * Write all the NV attributes held in RAM.
+ */
+extern uint8 osal_nv_flush( void );
+#endif
+
 /*********************************************************************
 *********************************************************************/
 
@@ -0,0 +1,149 @@
+/**************************************************************************************************
+  Filename:       OSAL_Pt.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Stackless coroutines (protothreads) resumed by an OSAL
+                  event, for long multi-step sequences.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef OSAL_PT_H
+#define OSAL_PT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "OSAL.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*
+ * A coroutine is a function returning uint8 whose body is enclosed in
+ * OSAL_PT_BEGIN() / OSAL_PT_END(). It is resumed by calling it again,
+ * normally from the event processor of its task when its event is set.
+ * A wait returns from the function and the next call continues right
+ * after the wait. Once ended, calls return OSAL_PT_ENDED until it is
+ * started again with OSAL_PT_INIT() or OSAL_PT_RESTART(), so a stray
+ * event cannot rerun it. Local variables are lost across waits, keep
+ * state in static variables. switch statements must not span a wait,
+ * and there can be only one wait per source line.
+ *
+ *   static osalPt_t myPt;
+ *
+ *   static uint8 mySequence( void )
+ *   {
+ *     OSAL_PT_BEGIN( &myPt );
+ *     startSomething();
+ *     OSAL_PT_WAIT_MS( &myPt, 10 );
+ *     OSAL_PT_WAIT_UNTIL( &myPt, somethingDone() );
+ *     OSAL_PT_END( &myPt );
+ *   }
+ */
+
+// Set up a coroutine to be resumed by event of task taskId
+#define OSAL_PT_INIT( pt, taskId, evt )  st( (pt)->lc = 0;             \
+                                             (pt)->task = (taskId);    \
+                                             (pt)->event = (evt); )
+
+// Restart a coroutine from the top on its next call
+#define OSAL_PT_RESTART( pt )  st( (pt)->lc = 0; )
+
+// Coroutine body
+#define OSAL_PT_BEGIN( pt )  switch ( (pt)->lc ) { case OSAL_PT_LC_END: \
+                                                   return ( OSAL_PT_ENDED ); \
+                                                 case 0:
+
+#define OSAL_PT_END( pt )    } (pt)->lc = OSAL_PT_LC_END; return ( OSAL_PT_ENDED )
+
+// Return until the next call, i.e. until the coroutine's event is set
+#define OSAL_PT_WAIT_EVENT( pt )  st( (pt)->lc = __LINE__;                \
+                                      return ( OSAL_PT_WAITING );          \
+                                      case __LINE__: ; )
+
+// Wait until cond is true, it is checked on every call. The label comes
+// first and the continuation is set only when waiting, so no statement
+// falls through into the label.
+#define OSAL_PT_WAIT_UNTIL( pt, cond )  st( case __LINE__:                 \
+                                            if ( !(cond) )                 \
+                                            {                              \
+                                              (pt)->lc = __LINE__;         \
+                                              return ( OSAL_PT_WAITING );  \
+                                            } )
+
+// Wait ms milliseconds on an OSAL timer of the coroutine's event
+#define OSAL_PT_WAIT_MS( pt, ms )  st( osal_start_timerEx( (pt)->task, (pt)->event, (ms) ); \
+                                       OSAL_PT_WAIT_EVENT( pt ); )
+
+// Give the other tasks a turn, the coroutine continues on the next pass
+#define OSAL_PT_YIELD( pt )  st( osal_set_event( (pt)->task, (pt)->event ); \
+                                 OSAL_PT_WAIT_EVENT( pt ); )
+
+// Leave the coroutine before its end
+#define OSAL_PT_EXIT( pt )  st( (pt)->lc = OSAL_PT_LC_END; return ( OSAL_PT_ENDED ); )
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Coroutine return values
+#define OSAL_PT_WAITING   0
+#define OSAL_PT_ENDED     1
+
+// Continuation of an ended coroutine
+#define OSAL_PT_LC_END    0xFFFF
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Coroutine state
+typedef struct
+{
+  uint16 lc;      // Source line to continue at, 0 for the top
+  uint8  task;    // Task and event resuming the coroutine
+  uint16 event;
+} osalPt_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_PT_H */
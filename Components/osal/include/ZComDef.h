@@ -202,6 +202,11 @@ extern "C"
 #define ZCD_NV_SAS_CURR_NWK_KEY           0x00D2
 #define ZCD_NV_SAS_CURR_PRECFG_LINK_KEY   0x00D3
 
+// NV Items Reserved for Binding Table blocks
+// 0x00E1 - 0x00EF
+#define ZCD_NV_BINDING_BLOCK_START        0x00E1
+#define ZCD_NV_BINDING_BLOCK_END          0x00EF
+
 // NV Items Reserved for Trust Center Link Key Table entries
 // 0x0101 - 0x01FF
 #define ZCD_NV_TCLK_TABLE_START           0x0101
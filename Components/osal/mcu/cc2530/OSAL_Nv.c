@@ -50,6 +50,7 @@
 #include "hal_adc.h"
 #include "hal_flash.h"
 #include "hal_types.h"
+#include "OSAL.h"
 #include "OSAL_Nv.h"
 #include "ZComDef.h"
 
@@ -86,6 +87,37 @@ static const uint16 hotIds[OSAL_NV_MAX_HOT] = {
   ZCD_NV_NWK_ALTERN_KEY_INFO,
 };
 
+/* Number of entries in the RAM index of item Id to page/offset, kept in most recently used order.
+ * It is filled at initNV(), kept up to date by item writes and page compaction, and the least
+ * recently used entry is replaced on a miss. Set to 0 to always search the NV pages.
+ */
+#if !defined OSAL_NV_CACHE_SIZE
+#define OSAL_NV_CACHE_SIZE      8
+#endif
+
+/* When the room left at the end of every page drops below OSAL_NV_COMPACT_MARGIN, the page with
+ * the most lost bytes is compacted onto the reserve page in the background, one item per event of
+ * the task registered with osal_nv_register(), instead of all at once by the next write.
+ */
+#if !defined OSAL_NV_COMPACT_MARGIN
+#define OSAL_NV_COMPACT_MARGIN (OSAL_NV_PAGE_SIZE / 4)
+#endif
+
+/* Number of items whose osal_nv_write_back() data can be held in RAM at once, and the delay in
+ * milliseconds from the first of those writes to the flush of all of them.
+ */
+#if !defined OSAL_NV_WB_CNT
+#define OSAL_NV_WB_CNT          4
+#endif
+#if !defined OSAL_NV_WB_DELAY
+#define OSAL_NV_WB_DELAY        100
+#endif
+
+// Return values of compactItem().
+#define OSAL_NV_XFER_FAIL       0
+#define OSAL_NV_XFER_NEXT       1
+#define OSAL_NV_XFER_END        2
+
 /*********************************************************************
  * MACROS
  */
@@ -157,6 +189,24 @@ typedef enum
   eNvZero
 } eNvHdrEnum;
 
+#if OSAL_NV_CACHE_SIZE
+typedef struct
+{
+  uint16 id;    // OSAL_NV_ITEM_NULL for an unused entry.
+  uint16 off;   // Offset of the item data.
+  uint8  pg;
+} osalNvCache_t;
+#endif
+
+#if OSAL_NV_WRITE_BACK
+typedef struct
+{
+  uint16 id;    // OSAL_NV_ITEM_NULL for an unused entry.
+  uint16 len;   // Item length.
+  uint8 *buf;   // Image of the whole item, as last written.
+} osalNvWb_t;
+#endif
+
 typedef enum
 {
   ePgActive,
@@ -196,6 +246,29 @@ static uint8 findPg;
 static uint8 hotPg[OSAL_NV_MAX_HOT];
 static uint16 hotOff[OSAL_NV_MAX_HOT];
 
+#if OSAL_NV_CACHE_SIZE
+// RAM index of item locations, most recently used first.
+static osalNvCache_t nvCache[OSAL_NV_CACHE_SIZE];
+#endif
+
+#if OSAL_NV_BG_COMPACT
+// Page being compacted in the background, or OSAL_NV_PAGE_NULL.
+static uint8 bgPg;
+// Offset of the next item to transfer: OSAL_NV_ITEM_NULL before the start, page size at the end.
+static uint16 bgOff;
+#endif
+
+#if OSAL_NV_WRITE_BACK
+// Items written with osal_nv_write_back() and not yet flushed to NV.
+static osalNvWb_t nvWb[OSAL_NV_WB_CNT];
+#endif
+
+#if OSAL_NV_BG_COMPACT || OSAL_NV_WRITE_BACK
+// Task and event registered for the NV work done in the background.
+static uint8 nvTaskId;
+static uint16 nvEvent;
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -205,7 +278,11 @@ static uint8  initNV( void );
 static void   setPageUse( uint8 pg, uint8 inUse );
 static uint16 initPage( uint8 pg, uint16 id, uint8 findDups );
 static void   erasePage( uint8 pg );
+static void   setPageXfer( uint8 pg );
+static uint8  checkRes( void );
 static uint8  compactPage( uint8 srcPg, uint16 skipId );
+static uint8  compactItem( uint8 srcPg, uint16 *srcOff, uint16 skipId );
+static uint8  newerItem( uint8 srcPg, uint16 id );
 
 static uint16 findItem( uint16 id );
 static uint8  initItem( uint8 flag, uint16 id, uint16 len, void *buf );
@@ -225,6 +302,24 @@ static uint8  writeItem( uint8 pg, uint16 id, uint16 len, void *buf, uint8 flag
 static uint8  hotItem(uint16 id);
 static void   hotItemUpdate(uint8 pg, uint16 off, uint16 id);
 
+#if OSAL_NV_CACHE_SIZE
+static uint8  cacheFind( uint16 id );
+static void   cacheUpdate( uint8 pg, uint16 off, uint16 id, uint8 evict );
+static void   cacheDrop( uint8 pg, uint16 off );
+#endif
+
+#if OSAL_NV_BG_COMPACT
+static void   compactCheck( void );
+static uint8  compactWait( uint16 sz );
+static uint8  pageRoom( uint16 sz );
+static uint8  compactStep( void );
+#endif
+
+#if OSAL_NV_WRITE_BACK
+static osalNvWb_t *wbFind( uint16 id );
+static uint8  wbFlush( osalNvWb_t *wb );
+#endif
+
 /*********************************************************************
  * @fn      initNV
  *
@@ -243,6 +338,15 @@ static uint8 initNV( void )
 
   pgRes = OSAL_NV_PAGE_NULL;
 
+#if OSAL_NV_BG_COMPACT
+  bgPg = OSAL_NV_PAGE_NULL;
+#endif
+
+#if OSAL_NV_CACHE_SIZE
+  // The index is refilled by initPage() below.
+  (void)osal_memset( nvCache, 0, sizeof( nvCache ) );
+#endif
+
   for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
     HalFlashRead(pg, OSAL_NV_PAGE_HDR_OFFSET, (uint8 *)(&pgHdr), OSAL_NV_HDR_SIZE);
@@ -461,6 +565,13 @@ static uint16 initPage( uint8 pg, uint16 id, uint8 findDups )
           {
             return OSAL_NV_ERASED_ID;
           }
+#if OSAL_NV_CACHE_SIZE
+          // Index the valid items while there is room, the rest are indexed on first use.
+          else if ( hotItem( hdr.id ) >= OSAL_NV_MAX_HOT )
+          {
+            cacheUpdate( pg, offset, hdr.id, FALSE );
+          }
+#endif
         }
         else
         {
@@ -496,10 +607,67 @@ static void erasePage( uint8 pg )
 {
   HalFlashErase(pg);
 
+#if OSAL_NV_CACHE_SIZE
+  // Forget all the items indexed on this page.
+  cacheDrop( pg, OSAL_NV_ITEM_NULL );
+#endif
+
   pgOff[pg - OSAL_NV_PAGE_BEG] = OSAL_NV_PAGE_HDR_SIZE;
   pgLost[pg - OSAL_NV_PAGE_BEG] = 0;
 }
 
+/*********************************************************************
+ * @fn      setPageXfer
+ *
+ * @brief   Mark a page as being in process of compaction.
+ *
+ * @param   pg - Valid NV page.
+ *
+ * @return  none
+ */
+static void setPageXfer( uint8 pg )
+{
+  osalNvPgHdr_t pgHdr;
+
+  /* Prevent excessive re-writes to page header caused by numerous, rapid, & successive
+   * OSAL_Nv interruptions caused by resets.
+   */
+  HalFlashRead(pg, OSAL_NV_PAGE_HDR_OFFSET, (uint8 *)(&pgHdr), OSAL_NV_PAGE_HDR_SIZE);
+  if ( pgHdr.xfer == OSAL_NV_ERASED_ID )
+  {
+    pgHdr.xfer = OSAL_NV_ZEROED_ID;
+    writeWordH( pg, OSAL_NV_PG_XFER, (uint8*)(&(pgHdr.xfer)) );
+  }
+}
+
+/*********************************************************************
+ * @fn      checkRes
+ *
+ * @brief   Verify that the 'pgRes' is clean before a compaction; erase it otherwise.
+ *
+ * @param   none
+ *
+ * @return  TRUE if the 'pgRes' is clean; FALSE if it had to be erased.
+ */
+static uint8 checkRes( void )
+{
+  uint16 off;
+  uint8 tmp;
+
+  // To minimize code size, only check for a clean page here where it's absolutely required.
+  for (off = 0; off < OSAL_NV_PAGE_SIZE; off++)
+  {
+    HalFlashRead(pgRes, off, &tmp, 1);
+    if (tmp != OSAL_NV_ERASED)
+    {
+      erasePage(pgRes);
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /*********************************************************************
  * @fn      compactPage
  *
@@ -529,108 +697,160 @@ static void erasePage( uint8 pg )
  */
 static uint8 compactPage( uint8 srcPg, uint16 skipId )
 {
-  uint16 srcOff;
+  uint16 srcOff = OSAL_NV_PAGE_HDR_SIZE;
   uint8 rtrn;
 
-  // To minimize code size, only check for a clean page here where it's absolutely required.
-  for (srcOff = 0; srcOff < OSAL_NV_PAGE_SIZE; srcOff++)
+  if ( !checkRes() )
   {
-    HalFlashRead(pgRes, srcOff, &rtrn, 1);
-    if (rtrn != OSAL_NV_ERASED)
-    {
-      erasePage(pgRes);
-      return FALSE;
-    }
+    return FALSE;
   }
 
-  srcOff = OSAL_NV_PAGE_HDR_SIZE;
-  rtrn = TRUE;
+  do {
+    rtrn = compactItem( srcPg, &srcOff, skipId );
+  } while ( rtrn == OSAL_NV_XFER_NEXT );
 
-  while ( srcOff < (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE ) )
+  if (rtrn == OSAL_NV_XFER_FAIL)
   {
-    osalNvHdr_t hdr;
-    uint16 sz, dstOff = pgOff[pgRes-OSAL_NV_PAGE_BEG];
+    erasePage(pgRes);
+    return FALSE;
+  }
+  else if (skipId == OSAL_NV_ITEM_NULL)
+  {
+    COMPACT_PAGE_CLEANUP(srcPg);
+  }
+  // else invoking function must cleanup.
 
-    HalFlashRead(srcPg, srcOff, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+  return TRUE;
+}
 
-    if ( hdr.id == OSAL_NV_ERASED_ID )
-    {
-      break;
-    }
+/*********************************************************************
+ * @fn      compactItem
+ *
+ * @brief   Transfers the item at the offset specified onto the 'pgRes'.
+ *
+ * @param   srcPg - Valid NV page being compacted.
+ * @param   srcOff - Pointer to the offset of the item header; advanced to the next item.
+ * @param   skipId - Item Id to not compact.
+ *
+ * @return  OSAL_NV_XFER_NEXT if the item was transferred or is not to be transferred;
+ *          OSAL_NV_XFER_END if there are no more items on 'srcPg';
+ *          OSAL_NV_XFER_FAIL if the item does not fit or the transfer failed.
+ */
+static uint8 compactItem( uint8 srcPg, uint16 *srcOff, uint16 skipId )
+{
+  osalNvHdr_t hdr;
+  uint16 sz, off = *srcOff, dstOff = pgOff[pgRes-OSAL_NV_PAGE_BEG];
 
-    // Get the actual size in bytes which is the ceiling(hdr.len)
-    sz = OSAL_NV_DATA_SIZE( hdr.len );
+  if ( off >= (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE) )
+  {
+    return OSAL_NV_XFER_END;
+  }
 
-    if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - srcOff) )
-    {
-      break;
-    }
+  HalFlashRead(srcPg, off, (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
 
-    if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - dstOff) )
-    {
-      rtrn = FALSE;
-      break;
-    }
+  if ( hdr.id == OSAL_NV_ERASED_ID )
+  {
+    return OSAL_NV_XFER_END;
+  }
+
+  // Get the actual size in bytes which is the ceiling(hdr.len)
+  sz = OSAL_NV_DATA_SIZE( hdr.len );
 
-    srcOff += OSAL_NV_HDR_SIZE;
+  if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - off) )
+  {
+    return OSAL_NV_XFER_END;
+  }
 
-    if ( (hdr.id != OSAL_NV_ZEROED_ID) && (hdr.id != skipId) )
+  if ( sz > (OSAL_NV_PAGE_SIZE - OSAL_NV_HDR_SIZE - dstOff) )
+  {
+    return OSAL_NV_XFER_FAIL;
+  }
+
+  off += OSAL_NV_HDR_SIZE;
+  *srcOff = off + sz;
+
+  if ( (hdr.id != OSAL_NV_ZEROED_ID) && (hdr.id != skipId) )
+  {
+    if ( hdr.chk == calcChkF( srcPg, off, hdr.len ) )
     {
-      if ( hdr.chk == calcChkF( srcPg, srcOff, hdr.len ) )
+      /* Prevent excessive re-writes to item header caused by numerous, rapid, & successive
+       * OSAL_Nv interruptions caused by resets.
+       */
+      if ( hdr.stat == OSAL_NV_ERASED_ID )
       {
-        /* Prevent excessive re-writes to item header caused by numerous, rapid, & successive
-         * OSAL_Nv interruptions caused by resets.
-         */
-        if ( hdr.stat == OSAL_NV_ERASED_ID )
-        {
-          setItem( srcPg, srcOff, eNvXfer );
-        }
+        setItem( srcPg, off, eNvXfer );
+      }
+      /* An item already marked 'Xfer' may be the old copy of an item re-written, or the source of
+       * an item deleted, while this page was compacted in the background; don't bring it back.
+       */
+      else if ( newerItem( srcPg, hdr.id ) )
+      {
+        return OSAL_NV_XFER_NEXT;
+      }
 
-        if ( writeItem( pgRes, hdr.id, hdr.len, NULL, FALSE ) )
+      if ( writeItem( pgRes, hdr.id, hdr.len, NULL, FALSE ) )
+      {
+        dstOff += OSAL_NV_HDR_SIZE;
+        xferBuf( srcPg, off, pgRes, dstOff, sz );
+        // Calculate and write the new checksum.
+        if (hdr.chk == calcChkF(pgRes, dstOff, hdr.len))
         {
-          dstOff += OSAL_NV_HDR_SIZE;
-          xferBuf( srcPg, srcOff, pgRes, dstOff, sz );
-          // Calculate and write the new checksum.
-          if (hdr.chk == calcChkF(pgRes, dstOff, hdr.len))
+          if ( hdr.chk != setChk( pgRes, dstOff, hdr.chk ) )
           {
-            if ( hdr.chk != setChk( pgRes, dstOff, hdr.chk ) )
-            {
-              rtrn = FALSE;
-              break;
-            }
-            else
-            {
-              hotItemUpdate(pgRes, dstOff, hdr.id);
-            }
+            return OSAL_NV_XFER_FAIL;
           }
           else
           {
-            rtrn = FALSE;
-            break;
+            hotItemUpdate(pgRes, dstOff, hdr.id);
           }
         }
         else
         {
-          rtrn = FALSE;
-          break;
+          return OSAL_NV_XFER_FAIL;
         }
       }
+      else
+      {
+        return OSAL_NV_XFER_FAIL;
+      }
     }
-
-    srcOff += sz;
   }
 
-  if (rtrn == FALSE)
-  {
-    erasePage(pgRes);
-  }
-  else if (skipId == OSAL_NV_ITEM_NULL)
+  return OSAL_NV_XFER_NEXT;
+}
+
+/*********************************************************************
+ * @fn      newerItem
+ *
+ * @brief   Look for a valid copy of an item on a page other than the one being compacted
+ *          and the 'pgRes'.
+ *
+ * @param   srcPg - Valid NV page being compacted.
+ * @param   id - Valid NV item Id.
+ *
+ * @return  TRUE if a copy with a good checksum is found; FALSE otherwise.
+ */
+static uint8 newerItem( uint8 srcPg, uint16 id )
+{
+  osalNvHdr_t hdr;
+  uint16 off;
+  uint8 pg;
+
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
-    COMPACT_PAGE_CLEANUP(srcPg);
+    if ( (pg != srcPg) && (pg != pgRes) &&
+         ((off = initPage( pg, id, FALSE )) != OSAL_NV_ITEM_NULL) )
+    {
+      HalFlashRead(pg, (off - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+
+      if ( hdr.chk == calcChkF( pg, off, hdr.len ) )
+      {
+        return TRUE;
+      }
+    }
   }
-  // else invoking function must cleanup.
 
-  return rtrn;
+  return FALSE;
 }
 
 /*********************************************************************
@@ -652,11 +872,31 @@ static uint16 findItem( uint16 id )
   uint16 off;
   uint8 pg;
 
+#if OSAL_NV_CACHE_SIZE
+  if ( (id & OSAL_NV_SOURCE_ID) == 0 )
+  {
+    uint8 idx = cacheFind( id );
+
+    if ( idx < OSAL_NV_CACHE_SIZE )
+    {
+      findPg = nvCache[0].pg;  // A hit is moved to the front.
+      return nvCache[0].off;
+    }
+  }
+#endif
+
   for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
   {
     if ( (off = initPage( pg, id, FALSE )) != OSAL_NV_ITEM_NULL )
     {
       findPg = pg;
+#if OSAL_NV_CACHE_SIZE
+      // Hot items keep their own location data.
+      if ( ((id & OSAL_NV_SOURCE_ID) == 0) && (hotItem( id ) >= OSAL_NV_MAX_HOT) )
+      {
+        cacheUpdate( pg, off, id, TRUE );
+      }
+#endif
       return off;
     }
   }
@@ -697,6 +937,12 @@ static uint8 initItem( uint8 flag, uint16 id, uint16 len, void *buf )
   uint8 rtrn = OSAL_NV_PAGE_NULL;
   uint8 cnt = OSAL_NV_PAGES_USED;
   uint8 pg = pgRes+1;  // Set to 1 after the reserve page to even wear across all available pages.
+#if OSAL_NV_BG_COMPACT
+  /* Use up the room left on the pages before compacting one, leaving it to the background; the
+   * 'pgRes' is taken while compacting in the background, so only the room left counts then.
+   */
+  uint8 roomOnly = (bgPg != OSAL_NV_PAGE_NULL) || ((nvEvent != 0) && pageRoom( sz ));
+#endif
 
   do {
     if (pg >= OSAL_NV_PAGE_BEG+OSAL_NV_PAGES_USED)
@@ -706,7 +952,14 @@ static uint8 initItem( uint8 flag, uint16 id, uint16 len, void *buf )
     if ( pg != pgRes )
     {
       uint8 idx = pg - OSAL_NV_PAGE_BEG;
-      if ( sz <= (OSAL_NV_PAGE_SIZE - pgOff[idx] + pgLost[idx]) )
+      uint16 lost = pgLost[idx];
+#if OSAL_NV_BG_COMPACT
+      if ( roomOnly )
+      {
+        lost = 0;
+      }
+#endif
+      if ( sz <= (OSAL_NV_PAGE_SIZE - pgOff[idx] + lost) )
       {
         break;
       }
@@ -719,18 +972,8 @@ static uint8 initItem( uint8 flag, uint16 id, uint16 len, void *buf )
     // Item fits if an old page is compacted.
     if ( sz > (OSAL_NV_PAGE_SIZE - pgOff[pg - OSAL_NV_PAGE_BEG]) )
     {
-      osalNvPgHdr_t pgHdr;
-
-      /* Prevent excessive re-writes to page header caused by numerous, rapid, & successive
-       * OSAL_Nv interruptions caused by resets.
-       */
-      HalFlashRead(pg, OSAL_NV_PAGE_HDR_OFFSET, (uint8 *)(&pgHdr), OSAL_NV_PAGE_HDR_SIZE);
-      if ( pgHdr.xfer == OSAL_NV_ERASED_ID )
-      {
-        // Mark the old page as being in process of compaction.
-        sz = OSAL_NV_ZEROED_ID;
-        writeWordH( pg, OSAL_NV_PG_XFER, (uint8*)(&sz) );
-      }
+      // Mark the old page as being in process of compaction.
+      setPageXfer( pg );
 
       /* First the old page is compacted, then the new item will be the last one written to what
        * had been the reserved page.
@@ -801,6 +1044,10 @@ static void setItem( uint8 pg, uint16 offset, eNvHdrEnum stat )
     hdr.id = 0;
     writeWord( pg, offset, (uint8 *)(&hdr) );
     pgLost[pg-OSAL_NV_PAGE_BEG] += sz;
+
+#if OSAL_NV_CACHE_SIZE
+    cacheDrop( pg, offset+OSAL_NV_HDR_SIZE );
+#endif
   }
 }
 
@@ -1161,6 +1408,7 @@ static uint8 hotItem(uint16 id)
  * @fn      hotItemUpdate
  *
  * @brief   If the parameter 'id' is a hot item, update the corresponding hot item data.
+ *          Any other item is updated in, or added to, the RAM index.
  *
  * @param   pg - The new NV page corresponding to the hot item.
  * @param   off - The new NV page offset corresponding to the hot item.
@@ -1179,8 +1427,337 @@ static void hotItemUpdate(uint8 pg, uint16 off, uint16 id)
       hotOff[hotIdx] = off;
     }
   }
+#if OSAL_NV_CACHE_SIZE
+  else
+  {
+    cacheUpdate(pg, off, id, TRUE);
+  }
+#endif
+}
+
+#if OSAL_NV_CACHE_SIZE
+/*********************************************************************
+ * @fn      cacheFind
+ *
+ * @brief   Look for the parameter 'id' in the RAM index and move a hit to the front.
+ *
+ * @param   id - A valid NV item Id.
+ *
+ * @return  OSAL_NV_CACHE_SIZE if not found; otherwise the former index of the entry,
+ *          which is now nvCache[0].
+ */
+static uint8 cacheFind( uint16 id )
+{
+  osalNvCache_t hit;
+  uint8 idx;
+
+  for ( idx = 0; idx < OSAL_NV_CACHE_SIZE; idx++ )
+  {
+    if ( nvCache[idx].id == id )
+    {
+      break;
+    }
+  }
+
+  if ( (idx < OSAL_NV_CACHE_SIZE) && (idx != 0) )
+  {
+    uint8 cnt = idx;
+
+    hit = nvCache[idx];
+    while ( cnt )
+    {
+      nvCache[cnt] = nvCache[cnt-1];
+      cnt--;
+    }
+    nvCache[0] = hit;
+  }
+
+  return idx;
+}
+
+/*********************************************************************
+ * @fn      cacheUpdate
+ *
+ * @brief   Set the location of an item in the RAM index, as the most recently used entry.
+ *
+ * @param   pg - The NV page of the item.
+ * @param   off - The NV page offset of the item data.
+ * @param   id - A valid NV item Id.
+ * @param   evict - TRUE to replace the least recently used entry if the index is full,
+ *                  FALSE to only use a free entry.
+ *
+ * @return  none
+ */
+static void cacheUpdate( uint8 pg, uint16 off, uint16 id, uint8 evict )
+{
+  uint8 idx;
+
+  if ( cacheFind( id ) >= OSAL_NV_CACHE_SIZE )
+  {
+    // Use the first free entry, else the least recently used one at the back.
+    for ( idx = 0; idx < OSAL_NV_CACHE_SIZE-1; idx++ )
+    {
+      if ( nvCache[idx].id == OSAL_NV_ITEM_NULL )
+      {
+        break;
+      }
+    }
+
+    if ( !evict && (nvCache[idx].id != OSAL_NV_ITEM_NULL) )
+    {
+      return;
+    }
+
+    for ( ; idx != 0; idx-- )
+    {
+      nvCache[idx] = nvCache[idx-1];
+    }
+    nvCache[0].id = id;
+  }
+
+  nvCache[0].pg = pg;
+  nvCache[0].off = off;
+}
+
+/*********************************************************************
+ * @fn      cacheDrop
+ *
+ * @brief   Remove the entries of an item location, or of a whole page, from the RAM index.
+ *
+ * @param   pg - The NV page.
+ * @param   off - The NV page offset of the item data; OSAL_NV_ITEM_NULL for the whole page.
+ *
+ * @return  none
+ */
+static void cacheDrop( uint8 pg, uint16 off )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < OSAL_NV_CACHE_SIZE; idx++ )
+  {
+    if ( (nvCache[idx].id != OSAL_NV_ITEM_NULL) && (nvCache[idx].pg == pg) &&
+         ((off == OSAL_NV_ITEM_NULL) || (nvCache[idx].off == off)) )
+    {
+      nvCache[idx].id = OSAL_NV_ITEM_NULL;
+    }
+  }
+}
+#endif
+
+#if OSAL_NV_BG_COMPACT
+/*********************************************************************
+ * @fn      compactCheck
+ *
+ * @brief   Start a compaction in the background when the room left at the end of the pages
+ *          runs low and a page has enough lost bytes to be worth compacting.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void compactCheck( void )
+{
+  uint16 room = 0;
+  uint8 lostPg = OSAL_NV_PAGE_NULL;
+  uint8 pg;
+
+  if ( (nvEvent == 0) || (bgPg != OSAL_NV_PAGE_NULL) )
+  {
+    return;
+  }
+
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
+  {
+    if ( pg != pgRes )
+    {
+      uint8 idx = pg - OSAL_NV_PAGE_BEG;
+
+      if ( room < (OSAL_NV_PAGE_SIZE - pgOff[idx]) )
+      {
+        room = OSAL_NV_PAGE_SIZE - pgOff[idx];
+      }
+
+      if ( (pgLost[idx] >= OSAL_NV_COMPACT_MARGIN) && ((lostPg == OSAL_NV_PAGE_NULL) ||
+           (pgLost[idx] > pgLost[lostPg - OSAL_NV_PAGE_BEG])) )
+      {
+        lostPg = pg;
+      }
+    }
+  }
+
+  if ( (room < OSAL_NV_COMPACT_MARGIN) && (lostPg != OSAL_NV_PAGE_NULL) )
+  {
+    bgPg = lostPg;
+    bgOff = OSAL_NV_ITEM_NULL;
+    (void)osal_set_event( nvTaskId, nvEvent );
+  }
+}
+
+/*********************************************************************
+ * @fn      compactWait
+ *
+ * @brief   Finish the compaction in the background if no page other than the 'pgRes' has
+ *          room for an item of the size specified.
+ *
+ * @param   sz - Size of the item including its header.
+ *
+ * @return  TRUE if the compaction was finished, and items may have moved; FALSE otherwise.
+ */
+static uint8 compactWait( uint16 sz )
+{
+  if ( (bgPg == OSAL_NV_PAGE_NULL) || pageRoom( sz ) )
+  {
+    return FALSE;
+  }
+
+  while ( compactStep() );
+
+  return TRUE;
+}
+
+/*********************************************************************
+ * @fn      pageRoom
+ *
+ * @brief   Check for a page other than the 'pgRes' with room left for an item of the size
+ *          specified.
+ *
+ * @param   sz - Size of the item including its header.
+ *
+ * @return  TRUE if an item of size 'sz' fits without a compaction; FALSE otherwise.
+ */
+static uint8 pageRoom( uint16 sz )
+{
+  uint8 pg;
+
+  for ( pg = OSAL_NV_PAGE_BEG; pg <= OSAL_NV_PAGE_END; pg++ )
+  {
+    if ( (pg != pgRes) && (sz <= (OSAL_NV_PAGE_SIZE - pgOff[pg - OSAL_NV_PAGE_BEG])) )
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
 }
 
+/*********************************************************************
+ * @fn      compactStep
+ *
+ * @brief   Perform one bounded step of the compaction in the background: verify the reserve page
+ *          and mark the page as being compacted, transfer one item, or finally put the reserve
+ *          page in use and erase the compacted page.
+ *          A reset at any step is recovered by initNV() from the page 'Xfer' header, as for a
+ *          compaction on demand. Reads and writes keep working in between steps.
+ *
+ * @param   none
+ *
+ * @return  TRUE if more steps are pending (the registered event is set again); FALSE otherwise.
+ */
+static uint8 compactStep( void )
+{
+  if ( bgPg == OSAL_NV_PAGE_NULL )
+  {
+    return FALSE;
+  }
+
+  if ( bgOff == OSAL_NV_ITEM_NULL )
+  {
+    if ( checkRes() )
+    {
+      setPageXfer( bgPg );
+      bgOff = OSAL_NV_PAGE_HDR_SIZE;
+    }
+    else
+    {
+      bgPg = OSAL_NV_PAGE_NULL;  // The reserve page had to be erased; retry on a later write.
+    }
+  }
+  else if ( bgOff < OSAL_NV_PAGE_SIZE )
+  {
+    uint8 rtrn = compactItem( bgPg, &bgOff, OSAL_NV_ITEM_NULL );
+
+    if ( rtrn == OSAL_NV_XFER_END )
+    {
+      bgOff = OSAL_NV_PAGE_SIZE;
+    }
+    else if ( rtrn == OSAL_NV_XFER_FAIL )
+    {
+      erasePage( pgRes );
+      bgPg = OSAL_NV_PAGE_NULL;
+    }
+  }
+  else
+  {
+    COMPACT_PAGE_CLEANUP( bgPg );
+    bgPg = OSAL_NV_PAGE_NULL;
+  }
+
+  if ( bgPg != OSAL_NV_PAGE_NULL )
+  {
+    (void)osal_set_event( nvTaskId, nvEvent );
+    return TRUE;
+  }
+
+  return FALSE;
+}
+#endif
+
+#if OSAL_NV_WRITE_BACK
+/*********************************************************************
+ * @fn      wbFind
+ *
+ * @brief   Find the RAM image of an item written with osal_nv_write_back().
+ *
+ * @param   id - Valid NV item Id; OSAL_NV_ITEM_NULL to find an unused entry.
+ *
+ * @return  Pointer to the entry if found; NULL otherwise.
+ */
+static osalNvWb_t *wbFind( uint16 id )
+{
+  uint8 idx;
+
+  for ( idx = 0; idx < OSAL_NV_WB_CNT; idx++ )
+  {
+    if ( nvWb[idx].id == id )
+    {
+      return &nvWb[idx];
+    }
+  }
+
+  return NULL;
+}
+
+/*********************************************************************
+ * @fn      wbFlush
+ *
+ * @brief   Write the RAM image of an item to NV and release it. osal_nv_write() leaves NV
+ *          untouched if the item did not actually change.
+ *
+ * @param   wb - Valid entry.
+ *
+ * @return  The osal_nv_write() status; on a failure the image is kept for a retry.
+ */
+static uint8 wbFlush( osalNvWb_t *wb )
+{
+  uint16 id = wb->id;
+  uint8 rtrn;
+
+  wb->id = OSAL_NV_ITEM_NULL;  // So that osal_nv_write() goes to NV.
+  rtrn = osal_nv_write( id, 0, wb->len, wb->buf );
+
+  if ( rtrn == SUCCESS )
+  {
+    osal_mem_free( wb->buf );
+  }
+  else
+  {
+    wb->id = id;
+  }
+
+  return rtrn;
+}
+#endif
+
 /*********************************************************************
  * @fn      osal_nv_init
  *
@@ -1227,13 +1804,24 @@ uint8 osal_nv_item_init( uint16 id, uint16 len, void *buf )
 
     return SUCCESS;
   }
-  else if ( initItem( TRUE, id, len, buf ) != OSAL_NV_PAGE_NULL )
-  {
-    return NV_ITEM_UNINIT;
-  }
   else
   {
-    return NV_OPER_FAILED;
+#if OSAL_NV_BG_COMPACT
+    // Finish a compaction in the background first if it holds the only room for the new item.
+    (void)compactWait( OSAL_NV_ITEM_SIZE( len ) );
+#endif
+
+    if ( initItem( TRUE, id, len, buf ) != OSAL_NV_PAGE_NULL )
+    {
+#if OSAL_NV_BG_COMPACT
+      compactCheck();
+#endif
+      return NV_ITEM_UNINIT;
+    }
+    else
+    {
+      return NV_OPER_FAILED;
+    }
   }
 }
 
@@ -1283,6 +1871,25 @@ uint16 osal_nv_item_len( uint16 id )
 uint8 osal_nv_write( uint16 id, uint16 ndx, uint16 len, void *buf )
 {
   uint8 rtrn = SUCCESS;
+#if OSAL_NV_WRITE_BACK
+  osalNvWb_t *wb = wbFind( id );
+
+  if ( wb != NULL )
+  {
+    // An item held in RAM is written to NV together with this write, so the last write wins.
+    if ( (ndx + len) <= wb->len )
+    {
+      osal_memcpy( wb->buf + ndx, buf, len );
+      return wbFlush( wb );
+    }
+
+    // Otherwise write the held data first, so that it can not overwrite this write later.
+    if ( wbFlush( wb ) != SUCCESS )
+    {
+      return NV_OPER_FAILED;
+    }
+  }
+#endif
 
   if ( !OSAL_NV_CHECK_BUS_VOLTAGE )
   {
@@ -1308,6 +1915,16 @@ uint8 osal_nv_write( uint16 id, uint16 ndx, uint16 len, void *buf )
       return NV_OPER_FAILED;
     }
 
+#if OSAL_NV_BG_COMPACT
+    // A compaction in the background that has to be finished first may move the item.
+    if ( compactWait( OSAL_NV_ITEM_SIZE( hdr.len ) ) )
+    {
+      origOff = srcOff = findItem( id );
+      srcPg = findPg;
+      HalFlashRead(srcPg, (srcOff - OSAL_NV_HDR_SIZE), (uint8 *)(&hdr), OSAL_NV_HDR_SIZE);
+    }
+#endif
+
     srcOff += ndx;
     ptr = buf;
     cnt = len;
@@ -1402,6 +2019,10 @@ uint8 osal_nv_write( uint16 id, uint16 ndx, uint16 len, void *buf )
       {
         setItem( srcPg, origOff, eNvZero );
       }
+
+#if OSAL_NV_BG_COMPACT
+      compactCheck();
+#endif
     }
   }
 
@@ -1427,6 +2048,20 @@ uint8 osal_nv_read( uint16 id, uint16 ndx, uint16 len, void *buf )
 {
   uint16 offset;
   uint8 hotIdx;
+#if OSAL_NV_WRITE_BACK
+  osalNvWb_t *wb;
+
+  if ( (wb = wbFind( id )) != NULL )
+  {
+    if ( (ndx + len) > wb->len )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    osal_memcpy( buf, wb->buf + ndx, len );
+    return SUCCESS;
+  }
+#endif
 
   if ((hotIdx = hotItem(id)) < OSAL_NV_MAX_HOT)
   {
@@ -1478,6 +2113,34 @@ uint8 osal_nv_delete( uint16 id, uint16 len )
     return NV_BAD_ITEM_LEN;
   }
 
+#if OSAL_NV_WRITE_BACK
+  {
+    osalNvWb_t *wb = wbFind( id );
+
+    // Drop any data not yet flushed.
+    if ( wb != NULL )
+    {
+      osal_mem_free( wb->buf );
+      wb->id = OSAL_NV_ITEM_NULL;
+    }
+  }
+#endif
+
+#if OSAL_NV_BG_COMPACT
+  /* An item already transferred by a compaction in the background still has its source on the
+   * page being compacted, which initNV() would transfer again after a reset; so zero it first.
+   */
+  if ( (bgPg != OSAL_NV_PAGE_NULL) && (findPg == pgRes) )
+  {
+    uint16 srcOff = initPage( bgPg, (id | OSAL_NV_SOURCE_ID), FALSE );
+
+    if ( srcOff != OSAL_NV_ITEM_NULL )
+    {
+      setItem( bgPg, srcOff, eNvZero );
+    }
+  }
+#endif
+
   // Set item header ID to zero to 'delete' the item
   setItem( findPg, offset, eNvZero );
 
@@ -1495,5 +2158,162 @@ uint8 osal_nv_delete( uint16 id, uint16 len )
   }
 }
 
+#if OSAL_NV_BG_COMPACT || OSAL_NV_WRITE_BACK
+/*********************************************************************
+ * @fn      osal_nv_register
+ *
+ * @brief   Register the task and event for the NV work done in the background: the steps of
+ *          a page compaction and the delayed flush of osal_nv_write_back() data. The event is
+ *          set, or its timer started, when there is work; the task is expected to call
+ *          osal_nv_process() on it.
+ *
+ * @param   taskId - OSAL task Id.
+ * @param   event - Event to set for the task; 0 to do all NV work on demand.
+ *
+ * @return  none
+ */
+void osal_nv_register( uint8 taskId, uint16 event )
+{
+#if OSAL_NV_WRITE_BACK
+  if ( event == 0 )
+  {
+    (void)osal_nv_flush();
+  }
+#endif
+
+  nvTaskId = taskId;
+  nvEvent = event;
+
+#if OSAL_NV_BG_COMPACT
+  compactCheck();
+#endif
+}
+
+/*********************************************************************
+ * @fn      osal_nv_process
+ *
+ * @brief   Do the NV work pending for the registered event: flush the osal_nv_write_back()
+ *          data once its delay has expired, and perform one bounded compaction step.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osal_nv_process( void )
+{
+#if OSAL_NV_WRITE_BACK
+  // The event is also set by the compaction steps, so only flush once the timer has expired.
+  if ( osal_get_timeoutEx( nvTaskId, nvEvent ) == 0 )
+  {
+    (void)osal_nv_flush();
+  }
+#endif
+
+#if OSAL_NV_BG_COMPACT
+  (void)compactStep();
+#endif
+}
+#endif
+
+#if OSAL_NV_WRITE_BACK
+/*********************************************************************
+ * @fn      osal_nv_write_back
+ *
+ * @brief   Write a data item, or an element of it, like osal_nv_write() but hold the item in
+ *          RAM so that the writes within OSAL_NV_WB_DELAY of the first one are coalesced into
+ *          a single NV write. Reads return the data held; a plain osal_nv_write() of the item
+ *          or osal_nv_flush() writes it to NV at once.
+ *          Writes through to NV if no event is registered, or no entry or heap is available.
+ *
+ * @param   id  - Valid NV item Id.
+ * @param   ndx - Index offset into item
+ * @param   len - Length of data to write.
+ * @param  *buf - Data to write.
+ *
+ * @return  SUCCESS if successful, NV_ITEM_UNINIT if item did not
+ *          exist in NV, NV_OPER_FAILED if failure.
+ */
+uint8 osal_nv_write_back( uint16 id, uint16 ndx, uint16 len, void *buf )
+{
+  osalNvWb_t *wb = wbFind( id );
+
+  if ( wb == NULL )
+  {
+    uint16 itemLen = osal_nv_item_len( id );
+
+    if ( itemLen == 0 )
+    {
+      return NV_ITEM_UNINIT;
+    }
+    else if ( itemLen < (ndx + len) )
+    {
+      return NV_OPER_FAILED;
+    }
+
+    if ( (nvEvent == 0) || ((wb = wbFind( OSAL_NV_ITEM_NULL )) == NULL) ||
+         ((wb->buf = osal_mem_alloc( itemLen )) == NULL) )
+    {
+      return osal_nv_write( id, ndx, len, buf );
+    }
+
+    (void)osal_nv_read( id, 0, itemLen, wb->buf );
+    wb->id = id;
+    wb->len = itemLen;
+
+    // The delay runs from the first write held.
+    if ( osal_get_timeoutEx( nvTaskId, nvEvent ) == 0 )
+    {
+      (void)osal_start_timerEx( nvTaskId, nvEvent, OSAL_NV_WB_DELAY );
+    }
+  }
+  else if ( wb->len < (ndx + len) )
+  {
+    return NV_OPER_FAILED;
+  }
+
+  osal_memcpy( wb->buf + ndx, buf, len );
+
+  return SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      osal_nv_flush
+ *
+ * @brief   Write all the items held in RAM by osal_nv_write_back() to NV. To be called before
+ *          a reset or power down.
+ *
+ * @param   none
+ *
+ * @return  SUCCESS if all items were written; NV_OPER_FAILED otherwise, in which case the
+ *          failed items are kept in RAM and retried after OSAL_NV_WB_DELAY.
+ */
+uint8 osal_nv_flush( void )
+{
+  uint8 idx, rtrn = SUCCESS;
+
+  for ( idx = 0; idx < OSAL_NV_WB_CNT; idx++ )
+  {
+    if ( (nvWb[idx].id != OSAL_NV_ITEM_NULL) && (wbFlush( &nvWb[idx] ) != SUCCESS) )
+    {
+      rtrn = NV_OPER_FAILED;
+    }
+  }
+
+  if ( nvEvent != 0 )
+  {
+    if ( rtrn == SUCCESS )
+    {
+      (void)osal_stop_timerEx( nvTaskId, nvEvent );
+    }
+    else
+    {
+      (void)osal_start_timerEx( nvTaskId, nvEvent, OSAL_NV_WB_DELAY );
+    }
+  }
+
+  return rtrn;
+}
+#endif
+
 /*********************************************************************
  */
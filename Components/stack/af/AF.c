@@ -94,13 +94,30 @@
 
 epList_t *epList;
 
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint8 afEpSlotEP[AF_MAX_EP_SLOTS];       // Endpoint number of each slot
+static epList_t *afEpSlotList[AF_MAX_EP_SLOTS]; // Its latest epList entry
+static uint8 afEpSlotCnt;                       // Slots in use
+static uint8 afEpSlotOverflow;                  // An endpoint got no slot
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
 
 static void afBuildMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
                 zAddrType_t *SrcAddress, uint16 SrcPanId, NLDE_Signal_t *sig,
-                uint8 nwkSeqNum, uint8 SecurityUse, uint32 timestamp );
+                uint8 nwkSeqNum, uint8 SecurityUse, uint32 timestamp,
+                uint8 **shared );
+
+static void afDeliverMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
+                zAddrType_t *SrcAddress, uint16 SrcPanId, NLDE_Signal_t *sig,
+                uint8 nwkSeqNum, uint8 SecurityUse, uint32 timestamp,
+                uint8 **shared );
+
+static void afRxRelease( uint8 *shared );
 
 static epList_t *afFindEndPointDescList( uint8 EndPoint );
 
@@ -138,6 +155,7 @@ void afInit( void )
 epList_t *afRegisterExtended( endPointDesc_t *epDesc, pDescCB descFn )
 {
   epList_t *ep = osal_mem_alloc(sizeof(epList_t));
+  uint8 slot;
 
   if (ep != NULL)
   {
@@ -148,6 +166,23 @@ epList_t *afRegisterExtended( endPointDesc_t *epDesc, pDescCB descFn )
     ep->apsfCfg.frameDelay = APSF_DEFAULT_INTERFRAME_DELAY;
     ep->apsfCfg.windowSize = APSF_DEFAULT_WINDOW_SIZE;
     ep->flags = eEP_AllowMatch;  // Default to allow Match Descriptor.
+
+    // The newest entry of an endpoint is found first, as in epList.
+    slot = afEndPointSlot(epDesc->endPoint);
+    if ((slot == AF_EP_SLOT_NONE) && (afEpSlotCnt < AF_MAX_EP_SLOTS))
+    {
+      slot = afEpSlotCnt++;
+      afEpSlotEP[slot] = epDesc->endPoint;
+    }
+
+    if (slot != AF_EP_SLOT_NONE)
+    {
+      afEpSlotList[slot] = ep;
+    }
+    else
+    {
+      afEpSlotOverflow = TRUE;
+    }
   }
 
   return ep;
@@ -246,6 +281,8 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16 Src
 {
   endPointDesc_t *epDesc = NULL;
   epList_t *pList = epList;
+  uint8 *shared = NULL;
+  endPointDesc_t *pendDesc = NULL;  // Sharing endpoint whose message is not built yet
 #if !defined ( APS_NO_GROUPS )
   uint8 grpEp = APS_GROUPS_EP_NOT_FOUND;
 #endif
@@ -302,18 +339,21 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16 Src
     if ( (aff->ProfileID == epProfileID) ||
          ((epDesc->endPoint == ZDO_EP) && (aff->ProfileID == ZDO_PROFILE_ID)) )
     {
+      if ( !(pList->flags & eEP_RxShared) )
       {
-        // Save original endpoint
-        uint8 endpoint = aff->DstEndPoint;
-
-        // overwrite with descriptor's endpoint
-        aff->DstEndPoint = epDesc->endPoint;
-
-        afBuildMSGIncoming( aff, epDesc, SrcAddress, SrcPanId, sig,
-                           nwkSeqNum, SecurityUse, timestamp );
-
-        // Restore with original endpoint
-        aff->DstEndPoint = endpoint;
+        afDeliverMSGIncoming( aff, epDesc, SrcAddress, SrcPanId, sig,
+                              nwkSeqNum, SecurityUse, timestamp, NULL );
+      }
+      else
+      {
+        // A sharing endpoint is built once the next one is found: the shared
+        // payload only pays off when two or more of them get the frame.
+        if ( pendDesc != NULL )
+        {
+          afDeliverMSGIncoming( aff, pendDesc, SrcAddress, SrcPanId, sig,
+                                nwkSeqNum, SecurityUse, timestamp, &shared );
+        }
+        pendDesc = epDesc;
       }
     }
 
@@ -322,16 +362,17 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16 Src
 #if !defined ( APS_NO_GROUPS )
       // Find the next endpoint for this group
       grpEp = aps_FindGroupForEndpoint( aff->GroupID, grpEp );
-      if ( grpEp == APS_GROUPS_EP_NOT_FOUND )
-        return;   // No endpoint found
-
-      epDesc = afFindEndPointDesc( grpEp );
-      if ( epDesc == NULL )
-        return;   // Endpoint descriptor not found
-
-      pList = afFindEndPointDescList( epDesc->endPoint );
+      epDesc = NULL;
+      if ( grpEp != APS_GROUPS_EP_NOT_FOUND )
+      {
+        epDesc = afFindEndPointDesc( grpEp );
+        if ( epDesc != NULL )
+        {
+          pList = afFindEndPointDescList( epDesc->endPoint );
+        }
+      }
 #else
-      return;
+      epDesc = NULL;
 #endif
     }
     else if ( aff->DstEndPoint == AF_BROADCAST_ENDPOINT )
@@ -345,6 +386,96 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16 Src
     else
       epDesc = NULL;
   }
+
+  // The last sharing endpoint gets a private copy if it is the only one
+  if ( pendDesc != NULL )
+  {
+    afDeliverMSGIncoming( aff, pendDesc, SrcAddress, SrcPanId, sig,
+                          nwkSeqNum, SecurityUse, timestamp,
+                          (shared != NULL) ? &shared : NULL );
+  }
+
+  // Drop the reference held while building the messages
+  afRxRelease( shared );
+}
+
+/*********************************************************************
+ * @fn          afDeliverMSGIncoming
+ *
+ * @brief       Build the message of one matching endpoint, with the
+ *              frame's destination endpoint set to that endpoint.
+ *
+ * @param       shared - see afBuildMSGIncoming()
+ *
+ * @return      none
+ */
+static void afDeliverMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
+                 zAddrType_t *SrcAddress, uint16 SrcPanId, NLDE_Signal_t *sig,
+                 uint8 nwkSeqNum, uint8 SecurityUse, uint32 timestamp,
+                 uint8 **shared )
+{
+  // Save original endpoint
+  uint8 endpoint = aff->DstEndPoint;
+
+  // overwrite with descriptor's endpoint
+  aff->DstEndPoint = epDesc->endPoint;
+
+  afBuildMSGIncoming( aff, epDesc, SrcAddress, SrcPanId, sig,
+                      nwkSeqNum, SecurityUse, timestamp, shared );
+
+  // Restore with original endpoint
+  aff->DstEndPoint = endpoint;
+}
+
+/*********************************************************************
+ * @fn          afRxRelease
+ *
+ * @brief       Drop one reference to a shared incoming payload. The
+ *              reference count is kept in the byte before the data.
+ *
+ * @param       shared - pointer to the reference count, may be NULL
+ *
+ * @return      none
+ */
+static void afRxRelease( uint8 *shared )
+{
+  if ( shared != NULL )
+  {
+    if ( --(*shared) == 0 )
+    {
+      osal_mem_free( shared );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn          afIncomingMSGFree
+ *
+ * @brief       Release an OSAL message received by an endpoint task.
+ *              Tasks that enabled afSetRxShared() must use this in place
+ *              of osal_msg_deallocate(), any other message is simply
+ *              deallocated.
+ *
+ * @param       msg - message from osal_msg_receive()
+ *
+ * @return      none
+ */
+void afIncomingMSGFree( uint8 *msg )
+{
+  afIncomingMSGPacket_t *pkt = (afIncomingMSGPacket_t *)msg;
+
+  if ( pkt == NULL )
+  {
+    return;
+  }
+
+  if ( (pkt->hdr.event == AF_INCOMING_MSG_CMD) && (pkt->cmd.Data != NULL) &&
+       (pkt->cmd.Data != (uint8 *)(pkt + 1)) )
+  {
+    afRxRelease( pkt->cmd.Data - 1 );
+  }
+
+  osal_msg_deallocate( msg );
 }
 
 /*********************************************************************
@@ -352,17 +483,48 @@ void afIncomingData( aps_FrameFormat_t *aff, zAddrType_t *SrcAddress, uint16 Src
  *
  * @brief       Build the message for the app
  *
- * @param
+ * @param       shared - NULL to copy the payload into the message, else
+ *                       the payload shared by the endpoints of this frame.
+ *                       It is allocated and copied on first use and holds
+ *                       one reference for the caller.
  *
  * @return      pointer to next in data buffer
  */
 static void afBuildMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
                  zAddrType_t *SrcAddress, uint16 SrcPanId, NLDE_Signal_t *sig,
-                 uint8 nwkSeqNum, uint8 SecurityUse, uint32 timestamp )
+                 uint8 nwkSeqNum, uint8 SecurityUse, uint32 timestamp,
+                 uint8 **shared )
 {
   afIncomingMSGPacket_t *MSGpkt;
-  const uint8 len = sizeof( afIncomingMSGPacket_t ) + aff->asduLength;
+  uint8 len = sizeof( afIncomingMSGPacket_t ) + aff->asduLength;
   uint8 *asdu = aff->asdu;
+
+  if ( (shared != NULL) && aff->asduLength )
+  {
+    if ( *shared == NULL )
+    {
+      *shared = osal_mem_alloc( aff->asduLength + 1 );
+      if ( *shared != NULL )
+      {
+        **shared = 1;
+        osal_memcpy( *shared + 1, asdu, aff->asduLength );
+      }
+    }
+
+    if ( *shared != NULL )
+    {
+      len = sizeof( afIncomingMSGPacket_t );
+    }
+    else
+    {
+      shared = NULL;  // Fall back to a private copy
+    }
+  }
+  else
+  {
+    shared = NULL;
+  }
+
   MSGpkt = (afIncomingMSGPacket_t *)osal_msg_allocate( len );
 
   if ( MSGpkt == NULL )
@@ -388,7 +550,12 @@ static void afBuildMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
   MSGpkt->cmd.TransSeqNumber = 0;
   MSGpkt->cmd.DataLength = aff->asduLength;
 
-  if ( MSGpkt->cmd.DataLength )
+  if ( shared != NULL )
+  {
+    (**shared)++;
+    MSGpkt->cmd.Data = *shared + 1;
+  }
+  else if ( MSGpkt->cmd.DataLength )
   {
     MSGpkt->cmd.Data = (uint8 *)(MSGpkt + 1);
     osal_memcpy( MSGpkt->cmd.Data, asdu, MSGpkt->cmd.DataLength );
@@ -404,13 +571,18 @@ static void afBuildMSGIncoming( aps_FrameFormat_t *aff, endPointDesc_t *epDesc,
   {
     MT_AfIncomingMsg( (void *)MSGpkt );
     // Release the memory.
-    osal_msg_deallocate( (void *)MSGpkt );
+    afIncomingMSGFree( (uint8 *)MSGpkt );
   }
   else
 #endif
   {
     // Send message through task message.
-    osal_msg_send( *(epDesc->task_id), (uint8 *)MSGpkt );
+    if ( (osal_msg_send( *(epDesc->task_id), (uint8 *)MSGpkt ) != SUCCESS) &&
+         (shared != NULL) )
+    {
+      // The message was dropped, and its reference with it
+      (**shared)--;
+    }
   }
 }
 
@@ -695,6 +867,16 @@ afStatus_t AF_DataRequestSrcRtg( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
 static epList_t *afFindEndPointDescList( uint8 EndPoint )
 {
   epList_t *epSearch;
+  uint8 slot = afEndPointSlot( EndPoint );
+
+  if ( slot != AF_EP_SLOT_NONE )
+  {
+    return ( afEpSlotList[slot] );
+  }
+  else if ( !afEpSlotOverflow )
+  {
+    return ( (epList_t *)NULL );  // Every registered endpoint has a slot
+  }
 
   for (epSearch = epList; epSearch != NULL; epSearch = epSearch->nextDesc)
   {
@@ -730,6 +912,33 @@ endPointDesc_t *afFindEndPointDesc( uint8 EndPoint )
     return ( (endPointDesc_t *)NULL );
 }
 
+/*********************************************************************
+ * @fn      afEndPointSlot
+ *
+ * @brief   Find the slot of a registered endpoint. Slots are given in
+ *          registration order to the first AF_MAX_EP_SLOTS endpoints
+ *          and never change, so other layers may keep per-endpoint
+ *          data in arrays indexed by them.
+ *
+ * @param   endPoint - Application Endpoint to look for
+ *
+ * @return  slot number, AF_EP_SLOT_NONE if the endpoint has none
+ */
+uint8 afEndPointSlot( uint8 endPoint )
+{
+  uint8 slot;
+
+  for ( slot = 0; slot < afEpSlotCnt; slot++ )
+  {
+    if ( afEpSlotEP[slot] == endPoint )
+    {
+      return ( slot );
+    }
+  }
+
+  return ( AF_EP_SLOT_NONE );
+}
+
 /*********************************************************************
  * @fn      afFindSimpleDesc
  *
@@ -777,6 +986,13 @@ static pDescCB afGetDescCB( endPointDesc_t *epDesc )
 {
   epList_t *epSearch;
 
+  // Usually the latest entry of its endpoint
+  epSearch = afFindEndPointDescList( epDesc->endPoint );
+  if ( ( epSearch != NULL ) && ( epSearch->epDesc == epDesc ) )
+  {
+    return ( epSearch->pfnDescCB );
+  }
+
   // Start at the beginning
   epSearch = epList;
 
@@ -884,6 +1100,43 @@ uint8 afSetMatch( uint8 ep, uint8 action )
     return ( FALSE );
 }
 
+/*********************************************************************
+ * @fn      afSetRxShared
+ *
+ * @brief   Set how incoming group and broadcast data is handed to the
+ *          endpoint task. A frame that reaches two or more sharing
+ *          endpoints is copied once for all of them, the payload is
+ *          only valid until the message is released with
+ *          afIncomingMSGFree().
+ *
+ * @param   ep - Application Endpoint to look for
+ * @param   action - true - share the payload, false - private copy
+ *
+ * @return  TRUE if success, FALSE if endpoint not found
+ */
+uint8 afSetRxShared( uint8 ep, uint8 action )
+{
+  epList_t *epSearch;
+
+  // Look for the endpoint
+  epSearch = afFindEndPointDescList( ep );
+
+  if ( epSearch )
+  {
+    if ( action )
+    {
+      epSearch->flags |= eEP_RxShared;
+    }
+    else
+    {
+      epSearch->flags &= (eEP_RxShared ^ 0xFFFF);
+    }
+    return ( TRUE );
+  }
+  else
+    return ( FALSE );
+}
+
 /*********************************************************************
  * @fn      afNumEndPoints
  *
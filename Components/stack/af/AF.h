@@ -72,6 +72,14 @@ extern "C"
 // Default Radius Count value
 #define AF_DEFAULT_RADIUS                  DEF_NWK_RADIUS
 
+// Number of endpoint slots. Registered endpoints take a slot in
+// registration order so other layers can index per-endpoint data by it.
+// Endpoints beyond this are only found by walking epList.
+#if !defined ( AF_MAX_EP_SLOTS )
+  #define AF_MAX_EP_SLOTS                  8
+#endif
+#define AF_EP_SLOT_NONE                    0xFF
+
 /*********************************************************************
  * Node Descriptor
  */
@@ -296,6 +304,7 @@ typedef void *(*pDescCB)( uint8 type, uint8 endpoint );
 typedef enum
 {
   eEP_AllowMatch = 1,
+  eEP_RxShared = 2,
   eEP_NotUsed
 } eEP_Flags;
 
@@ -419,6 +428,12 @@ afStatus_t AF_DataRequestSrcRtg( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
   */
   extern endPointDesc_t *afFindEndPointDesc( uint8 endPoint );
 
+ /*
+  *	afEndPointSlot - Find the slot of a registered endpoint.
+  *   Returns AF_EP_SLOT_NONE if the endpoint has no slot. Slots never change.
+  */
+  extern uint8 afEndPointSlot( uint8 endPoint );
+
  /*
   *	afFindSimpleDesc - Find the Simple Descriptor from the endpoint number.
   *   	  If return value is not zero, the descriptor memory must be freed.
@@ -442,6 +457,19 @@ afStatus_t AF_DataRequestSrcRtg( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
   */
   extern uint8 afSetMatch( uint8 ep, uint8 action );
 
+ /*
+  *	afSetRxShared - Set how incoming data is delivered to the endpoint
+  *             TRUE payload shared between endpoints, must be freed
+  *             with afIncomingMSGFree()
+  */
+  extern uint8 afSetRxShared( uint8 ep, uint8 action );
+
+ /*
+  *	afIncomingMSGFree - Release an OSAL message received by an endpoint task,
+  *             including a shared AF_INCOMING_MSG_CMD payload.
+  */
+  extern void afIncomingMSGFree( uint8 *msg );
+
  /*
   *	afNumEndPoints - returns the number of endpoints defined.
   */
@@ -58,6 +58,33 @@
 #define NV_BIND_REC_SIZE (gBIND_REC_SIZE)
 #define NV_BIND_ITEM_SIZE  (gBIND_REC_SIZE * gNWK_MAX_BINDING_ENTRIES)
 
+// Binding records per NV block. Only the blocks holding changed records
+// are written; the size grows if the table needs more blocks than the
+// ZCD_NV_BINDING_BLOCK_START..END range has.
+#if !defined ( BIND_NV_BLOCK_ENTRIES )
+  #define BIND_NV_BLOCK_ENTRIES  4
+#endif
+
+#define NV_BIND_MAX_BLKS  (ZCD_NV_BINDING_BLOCK_END - ZCD_NV_BINDING_BLOCK_START + 1)
+
+// A block record is: slot in block, srcEP, dstGroupMode, dstIdx (LSB first),
+// dstEP, numClusterIds, then only the cluster IDs in use.
+#define NV_BIND_BLK_HDR_LEN  7
+#define NV_BIND_BLK_REC_LEN( numIds )  (NV_BIND_BLK_HDR_LEN + ((numIds) * sizeof( uint16 )))
+
+// Every block item has room for full records and is padded with NV_BIND_EMPTY
+// after the last one, so it keeps its size and is rewritten in place.
+#define NV_BIND_BLK_LEN  ((uint16)(bindNvBlkEntries * NV_BIND_BLK_REC_LEN( gMAX_BINDING_CLUSTER_IDS )))
+
+#define NV_BIND_BLK_BIT( blk )  ((uint16)1 << (blk))
+#define NV_BIND_ALL_BLKS        ((uint16)(NV_BIND_BLK_BIT( bindNvBlks ) - 1))
+
+// Position of a binding record in BindingTable[]
+#define BIND_ENTRY_IDX( pBind )  ((uint16)((pBind) - BindingTable))
+
+// Mark the NV block of a binding record as changed
+#define BIND_NV_DIRTY( pBind )  bindNvSetDirty( BIND_ENTRY_IDX( pBind ) )
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -86,11 +113,24 @@ uint16 bindingAddrMgsHelperFind( zAddrType_t *addr );
 uint8 bindingAddrMgsHelperConvert( uint16 idx, zAddrType_t *addr );
 void bindAddrMgrLocalLoad( void );
 uint16 bindAddrIndexGet( zAddrType_t* addr );
+static void bindNvSetDirty( uint16 bindIdx );
+static uint16 bindRestoreLegacyNV( void );
+#if ( BIND_INDEX == TRUE )
+static uint16 bindIndexLowerBound( uint8 srcEP, uint16 clusterID, uint16 bindIdx );
+static void bindIndexAdd( BindingEntry_t *pBind, uint16 clusterID );
+static void bindIndexRemove( BindingEntry_t *pBind, uint16 clusterID );
+#endif
 
 /*********************************************************************
  * LOCAL VARIABLES
  */
 static uint8 bindAddrMgrLocalLoaded = FALSE;
+#if ( BIND_INDEX == TRUE )
+static uint16 bindIndexCnt = 0;   // Number of used BindingIndex[] records
+#endif
+static uint8 bindNvBlkEntries;    // Binding records per NV block
+static uint8 bindNvBlks;          // NV blocks used by the table
+static uint16 bindNvDirty = 0;    // Blocks changed since the last BindWriteNV()
 
 /*********************************************************************
  * Function Pointers
@@ -149,6 +189,20 @@ void InitBindingTable( void )
 
   bindAddrMgrLocalLoaded = FALSE;
 
+#if ( BIND_INDEX == TRUE )
+  bindIndexCnt = 0;
+#endif
+
+  bindNvBlkEntries = BIND_NV_BLOCK_ENTRIES;
+  if ( gNWK_MAX_BINDING_ENTRIES > (uint16)bindNvBlkEntries * NV_BIND_MAX_BLKS )
+  {
+    bindNvBlkEntries = (gNWK_MAX_BINDING_ENTRIES + NV_BIND_MAX_BLKS - 1) / NV_BIND_MAX_BLKS;
+  }
+  bindNvBlks = (gNWK_MAX_BINDING_ENTRIES + bindNvBlkEntries - 1) / bindNvBlkEntries;
+
+  // Until restored, the empty table replaces what NV holds
+  bindNvDirty = NV_BIND_ALL_BLKS;
+
 #if ( ADDRMGR_CALLBACK_ENABLED == 1 )
   // Register with the address manager
   AddrMgrRegister( ADDRMGR_REG_BINDING, BindAddrMgrCB );
@@ -338,6 +392,15 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
         osal_memcpy( entry->clusterIdList,
                      clusterIds,
                      numClusterIds * sizeof(uint16) );
+
+        BIND_NV_DIRTY( entry );
+
+#if ( BIND_INDEX == TRUE )
+        for ( index = 0; index < numClusterIds; index++ )
+        {
+          bindIndexAdd( entry, entry->clusterIdList[index] );
+        }
+#endif
       }
     }
   }
@@ -356,6 +419,21 @@ BindingEntry_t *bindAddEntry( byte srcEpInt,
  */
 byte bindRemoveEntry( BindingEntry_t *pBind )
 {
+#if ( BIND_INDEX == TRUE )
+  uint8 x;
+#endif
+
+  if ( pBind->srcEP != NV_BIND_EMPTY )
+  {
+#if ( BIND_INDEX == TRUE )
+    for ( x = 0; x < pBind->numClusterIds; x++ )
+    {
+      bindIndexRemove( pBind, pBind->clusterIdList[x] );
+    }
+#endif
+    BIND_NV_DIRTY( pBind );
+  }
+
   osal_memset( pBind, 0xFF, gBIND_REC_SIZE );
   return ( TRUE );
 }
@@ -406,6 +484,15 @@ byte bindRemoveClusterIdFromList( BindingEntry_t *entry, uint16 clusterId )
 
   if ( entry )
   {
+    // Nothing changes, in RAM or in NV, if the cluster isn't bound
+    if ( bindIsClusterIDinList( entry, clusterId ) )
+    {
+#if ( BIND_INDEX == TRUE )
+      bindIndexRemove( entry, clusterId );
+#endif
+      BIND_NV_DIRTY( entry );
+    }
+
     if ( entry->numClusterIds > 0 )
     {
       listPtr = entry->clusterIdList;
@@ -457,6 +544,10 @@ byte bindAddClusterIdToList( BindingEntry_t *entry, uint16 clusterId )
     // Add the new one
     entry->clusterIdList[entry->numClusterIds] = clusterId;
     entry->numClusterIds++;
+#if ( BIND_INDEX == TRUE )
+    bindIndexAdd( entry, clusterId );
+#endif
+    BIND_NV_DIRTY( entry );
     return ( TRUE );
   }
   return ( FALSE );
@@ -657,10 +748,23 @@ byte bindNumBoundTo( zAddrType_t *devAddr, byte devEpInt, byte srcMode )
 uint16 bindNumReflections( uint8 ep, uint16 clusterID )
 {
   uint16 x;
-  BindingEntry_t *pBind;
   uint16 cnt = 0;
+#if ( BIND_INDEX != TRUE )
+  BindingEntry_t *pBind;
   uint8 bindEP;
+#endif
 
+#if ( BIND_INDEX == TRUE )
+  // Matches are adjacent in the index, one record per binding entry
+  for ( x = bindIndexLowerBound( ep, clusterID, 0 ); x < bindIndexCnt; x++ )
+  {
+    if ( (BindingIndex[x].srcEP != ep) || (BindingIndex[x].clusterID != clusterID) )
+    {
+      break;
+    }
+    cnt++;
+  }
+#else
   for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
   {
     pBind = &BindingTable[x];
@@ -671,6 +775,7 @@ uint16 bindNumReflections( uint8 ep, uint16 clusterID )
       cnt++;
     }
   }
+#endif
 
   return ( cnt );
 }
@@ -689,10 +794,21 @@ uint16 bindNumReflections( uint8 ep, uint16 clusterID )
  */
 BindingEntry_t *bindFind( uint8 ep, uint16 clusterID, uint8 skipping )
 {
+  uint16 x;
+#if ( BIND_INDEX != TRUE )
   BindingEntry_t *pBind;
   byte skipped = 0;
-  uint16 x;
+#endif
 
+#if ( BIND_INDEX == TRUE )
+  // Matches sit together in table order, so skip straight to the one wanted
+  x = bindIndexLowerBound( ep, clusterID, 0 ) + skipping;
+  if ( (x < bindIndexCnt) && (BindingIndex[x].srcEP == ep)
+      && (BindingIndex[x].clusterID == clusterID) )
+  {
+    return ( &BindingTable[BindingIndex[x].bindIdx] );
+  }
+#else
   for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
   {
     pBind = &BindingTable[x];
@@ -709,6 +825,7 @@ BindingEntry_t *bindFind( uint8 ep, uint16 clusterID, uint8 skipping )
       }
     }
   }
+#endif
 
   return ( (BindingEntry_t *)NULL );
 }
@@ -716,20 +833,31 @@ BindingEntry_t *bindFind( uint8 ep, uint16 clusterID, uint8 skipping )
 /*********************************************************************
  * @fn          BindInitNV
  *
- * @brief       Initialize the Binding NV Item
+ * @brief       Initialize the Binding NV Items. The blocks are created
+ *              when BindWriteNV() first has records for them.
  *
  * @param       none
  *
- * @return      ZSUCCESS if successful, NV_ITEM_UNINIT if item did not
- *              exist in NV, NV_OPER_FAILED if failure.
+ * @return      ZSUCCESS if a stored table exists, NV_ITEM_UNINIT if
+ *              none was found.
  */
 byte BindInitNV( void )
 {
-  byte ret;
+  byte ret = NV_ITEM_UNINIT;
+  uint16 id;
 
-  // Initialize the device list
-  ret = osal_nv_item_init( ZCD_NV_BINDING_TABLE,
-                  (uint16)(gBIND_REC_SIZE + NV_BIND_ITEM_SIZE), NULL );
+  if ( osal_nv_item_len( ZCD_NV_BINDING_TABLE ) != 0 )
+  {
+    ret = ZSUCCESS;
+  }
+
+  for ( id = ZCD_NV_BINDING_BLOCK_START; id <= ZCD_NV_BINDING_BLOCK_END; id++ )
+  {
+    if ( osal_nv_item_len( id ) != 0 )
+    {
+      ret = ZSUCCESS;
+    }
+  }
 
   if ( ret != ZSUCCESS )
   {
@@ -750,27 +878,137 @@ byte BindInitNV( void )
  */
 void BindSetDefaultNV( void )
 {
-  nvBindingHdr_t hdr;
+  uint16 id;
+  uint16 len;
+
+  // An empty table has no blocks at all
+  for ( id = ZCD_NV_BINDING_BLOCK_START; id <= ZCD_NV_BINDING_BLOCK_END; id++ )
+  {
+    if ( (len = osal_nv_item_len( id )) != 0 )
+    {
+      osal_nv_delete( id, len );
+    }
+  }
 
-  // Initialize the header
-  hdr.numRecs = 0;
+  if ( (len = osal_nv_item_len( ZCD_NV_BINDING_TABLE )) != 0 )
+  {
+    osal_nv_delete( ZCD_NV_BINDING_TABLE, len );
+  }
 
-  // Save off the header
-  osal_nv_write( ZCD_NV_BINDING_TABLE, 0, sizeof( nvBindingHdr_t ), &hdr );
+  // Whatever is in RAM now has to be written again
+  bindNvDirty = NV_BIND_ALL_BLKS;
 }
 
 /*********************************************************************
  * @fn          BindRestoreFromNV
  *
- * @brief       Restore the binding table from NV
+ * @brief       Restore the binding table from NV. Every record goes
+ *              back to the slot it was saved from, so the table and the
+ *              blocks start out clean.
  *
  * @param       none
  *
  * @return      Number of entries restored
  */
 uint16 BindRestoreFromNV( void )
+{
+  BindingEntry_t *pBind;
+  zAddrType_t dstAddr;
+  uint8 hdr[NV_BIND_BLK_HDR_LEN];
+  uint16 numAdded = 0;
+  uint16 id;
+  uint16 len;
+  uint16 pos;
+  uint16 idx;
+  uint8 blk;
+
+  if ( osal_nv_item_len( ZCD_NV_BINDING_TABLE ) != 0 )
+  {
+    // Saved as one item by an older image
+    numAdded = bindRestoreLegacyNV();
+  }
+  else
+  {
+    // make sure local addresses have been loaded
+    bindAddrMgrLocalLoad();
+
+    bindNvDirty = 0;
+
+    for ( blk = 0; blk < bindNvBlks; blk++ )
+    {
+      id = ZCD_NV_BINDING_BLOCK_START + blk;
+      len = osal_nv_item_len( id );
+
+      // Saved with another block size by an older image
+      if ( (len != 0) && (len != NV_BIND_BLK_LEN) )
+      {
+        bindNvDirty |= NV_BIND_BLK_BIT( blk );
+      }
+
+      for ( pos = 0; (pos + NV_BIND_BLK_HDR_LEN) <= len; pos += NV_BIND_BLK_REC_LEN( hdr[6] ) )
+      {
+        // Stop at the padding after the last record
+        if ( (osal_nv_read( id, pos, NV_BIND_BLK_HDR_LEN, hdr ) != ZSUCCESS)
+            || (hdr[0] == NV_BIND_EMPTY) )
+        {
+          break;
+        }
+
+        idx = (uint16)blk * bindNvBlkEntries + hdr[0];
+
+        // Stop at anything that doesn't decode
+        if ( (hdr[0] >= bindNvBlkEntries) || (idx >= gNWK_MAX_BINDING_ENTRIES)
+            || (hdr[6] > gMAX_BINDING_CLUSTER_IDS)
+            || ((pos + NV_BIND_BLK_REC_LEN( hdr[6] )) > len) )
+        {
+          bindNvDirty |= NV_BIND_BLK_BIT( blk );
+          break;
+        }
+
+        pBind = &BindingTable[idx];
+        pBind->srcEP = hdr[1];
+        pBind->dstGroupMode = hdr[2];
+        pBind->dstIdx = BUILD_UINT16( hdr[3], hdr[4] );
+        pBind->dstEP = hdr[5];
+        pBind->numClusterIds = hdr[6];
+
+        if ( (osal_nv_read( id, (uint16)(pos + NV_BIND_BLK_HDR_LEN),
+                            (uint16)(hdr[6] * sizeof( uint16 )), pBind->clusterIdList ) != ZSUCCESS)
+            || ((pBind->dstGroupMode == DSTGROUPMODE_ADDR)
+                && (bindingAddrMgsHelperConvert( pBind->dstIdx, &dstAddr ) == FALSE)) )
+        {
+          // Drop it here and from NV on the next write
+          osal_memset( pBind, 0xFF, gBIND_REC_SIZE );
+          bindNvDirty |= NV_BIND_BLK_BIT( blk );
+        }
+        else
+        {
+          numAdded++;
+        }
+      }
+    }
+  }
+
+  // Start the index over from what actually made it into the table
+  bindIndexRebuild();
+
+  return ( numAdded );
+}
+
+/*********************************************************************
+ * @fn          bindRestoreLegacyNV
+ *
+ * @brief       Restore a binding table saved as one NV item of whole
+ *              records, then move it to the blocks.
+ *
+ * @param       none
+ *
+ * @return      Number of entries restored
+ */
+static uint16 bindRestoreLegacyNV( void )
 {
   uint16 x;
+  uint16 len;
   nvBindingHdr_t hdr;
   BindingEntry_t bind;
   zAddrType_t dstAddr;
@@ -809,13 +1047,28 @@ uint16 BindRestoreFromNV( void )
       }
     }
   }
+
+  // Only give up the old item once the blocks hold the table
+  bindNvDirty = NV_BIND_ALL_BLKS;
+  BindWriteNV();
+
+  if ( bindNvDirty == 0 )
+  {
+    len = osal_nv_item_len( ZCD_NV_BINDING_TABLE );
+    osal_nv_delete( ZCD_NV_BINDING_TABLE, len );
+  }
+
   return ( numAdded );
 }
 
 /*********************************************************************
  * @fn          BindWriteNV
  *
- * @brief       Save the Binding Table in NV
+ * @brief       Save the changed parts of the Binding Table in NV. Only
+ *              the blocks holding a record added, changed or removed
+ *              since the last save are written. A block item keeps its
+ *              size, so it is rewritten in place and NV holds the old
+ *              block until the new one is complete.
  *
  * @param       none
  *
@@ -824,30 +1077,98 @@ uint16 BindRestoreFromNV( void )
 void BindWriteNV( void )
 {
   BindingEntry_t *pBind;
-  BindingEntry_t bind;
-  nvBindingHdr_t hdr;
-  uint16 x;
+  uint8 *buf;
+  uint8 *pBuf;
+  uint16 idx;
+  uint16 id;
+  uint16 len;
+  uint16 oldLen;
+  uint8 status;
+  uint8 blk;
+  uint8 slot;
+
+  if ( bindNvDirty == 0 )
+  {
+    return;
+  }
 
-  hdr.numRecs = 0;
+  buf = osal_mem_alloc( NV_BIND_BLK_LEN );
+  if ( buf == NULL )
+  {
+    return;  // The blocks stay dirty for the next save
+  }
 
-  for ( x = 0; x < gNWK_MAX_BINDING_ENTRIES; x++ )
+  for ( blk = 0; blk < bindNvBlks; blk++ )
   {
-    pBind = &BindingTable[x];
+    if ( (bindNvDirty & NV_BIND_BLK_BIT( blk )) == 0 )
+    {
+      continue;
+    }
 
-    if ( pBind->srcEP != NV_BIND_EMPTY )
+    // Pack the block's records, leaving out empty slots and unused cluster IDs
+    pBuf = buf;
+    for ( slot = 0; slot < bindNvBlkEntries; slot++ )
     {
-      osal_memcpy( &bind, pBind, gBIND_REC_SIZE );
+      idx = (uint16)blk * bindNvBlkEntries + slot;
+      if ( idx >= gNWK_MAX_BINDING_ENTRIES )
+      {
+        break;
+      }
 
-      // Save the record to NV
-      osal_nv_write( ZCD_NV_BINDING_TABLE,
-              (uint16)((sizeof(nvBindingHdr_t)) + (hdr.numRecs * NV_BIND_REC_SIZE)),
-                      NV_BIND_REC_SIZE, &bind );
-      hdr.numRecs++;
+      pBind = &BindingTable[idx];
+      if ( pBind->srcEP != NV_BIND_EMPTY )
+      {
+        *pBuf++ = slot;
+        *pBuf++ = pBind->srcEP;
+        *pBuf++ = pBind->dstGroupMode;
+        *pBuf++ = LO_UINT16( pBind->dstIdx );
+        *pBuf++ = HI_UINT16( pBind->dstIdx );
+        *pBuf++ = pBind->dstEP;
+        *pBuf++ = pBind->numClusterIds;
+        pBuf = osal_memcpy( pBuf, pBind->clusterIdList,
+                            pBind->numClusterIds * sizeof( uint16 ) );
+      }
+    }
+
+    len = (uint16)(pBuf - buf);
+    osal_memset( pBuf, NV_BIND_EMPTY, NV_BIND_BLK_LEN - len );
+
+    id = ZCD_NV_BINDING_BLOCK_START + blk;
+    oldLen = osal_nv_item_len( id );
+
+    if ( oldLen == NV_BIND_BLK_LEN )
+    {
+      status = osal_nv_write_back( id, 0, NV_BIND_BLK_LEN, buf );
+    }
+    else if ( oldLen == 0 )
+    {
+      // A block item is created once it has a record to hold
+      status = ZSUCCESS;
+      if ( (len != 0) && (osal_nv_item_init( id, NV_BIND_BLK_LEN, buf ) != NV_ITEM_UNINIT) )
+      {
+        status = NV_OPER_FAILED;
+      }
+    }
+    else
+    {
+      // Only after an image with another table or block geometry: the
+      // old item can't be written at the new size and is replaced
+      osal_nv_delete( id, oldLen );
+
+      status = ZSUCCESS;
+      if ( (len != 0) && (osal_nv_item_init( id, NV_BIND_BLK_LEN, buf ) != NV_ITEM_UNINIT) )
+      {
+        status = NV_OPER_FAILED;
+      }
+    }
+
+    if ( status == ZSUCCESS )
+    {
+      bindNvDirty &= ~NV_BIND_BLK_BIT( blk );
     }
   }
 
-  // Save off the header
-  osal_nv_write( ZCD_NV_BINDING_TABLE, 0, sizeof(nvBindingHdr_t), &hdr );
+  osal_mem_free( buf );
 }
 
 /*********************************************************************
@@ -881,6 +1202,7 @@ void bindUpdateAddr( uint16 oldAddr, uint16 newAddr )
     if ( pBind->dstIdx == oldIdx )
     {
       pBind->dstIdx = newIdx;
+      BIND_NV_DIRTY( pBind );
     }
   }
 }
@@ -1091,5 +1413,167 @@ BindingEntry_t *GetBindingTableEntry( uint16 Nth )
   return rtrn;
 }
 
+/*********************************************************************
+ * @fn      bindIndexRebuild
+ *
+ * @brief   Rebuild the (srcEP, clusterID) index from the binding
+ *          table. Call after writing BindingTable[] directly.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void bindIndexRebuild( void )
+{
+#if ( BIND_INDEX == TRUE )
+  uint16 idx;
+  uint8 x;
+
+  bindIndexCnt = 0;
+
+  for ( idx = 0; idx < gNWK_MAX_BINDING_ENTRIES; idx++ )
+  {
+    if ( BindingTable[idx].srcEP != NV_BIND_EMPTY )
+    {
+      for ( x = 0; x < BindingTable[idx].numClusterIds; x++ )
+      {
+        bindIndexAdd( &BindingTable[idx], BindingTable[idx].clusterIdList[x] );
+      }
+    }
+  }
+#endif
+}
+
+/*********************************************************************
+ * @fn      bindNvSetDirty
+ *
+ * @brief   Mark the NV block holding a binding record as changed.
+ *
+ * @param   bindIdx - binding table index
+ *
+ * @return  none
+ */
+static void bindNvSetDirty( uint16 bindIdx )
+{
+  if ( bindIdx < gNWK_MAX_BINDING_ENTRIES )
+  {
+    bindNvDirty |= NV_BIND_BLK_BIT( bindIdx / bindNvBlkEntries );
+  }
+}
+
+#if ( BIND_INDEX == TRUE )
+/*********************************************************************
+ * @fn      bindIndexLowerBound
+ *
+ * @brief   Binary search the index for the first record not below
+ *          (srcEP, clusterID, bindIdx).
+ *
+ * @param   srcEP - source endpoint
+ * @param   clusterID - cluster ID
+ * @param   bindIdx - binding table index
+ *
+ * @return  position in BindingIndex[], bindIndexCnt if past the end
+ */
+static uint16 bindIndexLowerBound( uint8 srcEP, uint16 clusterID, uint16 bindIdx )
+{
+  bindIndexRec_t *pRec;
+  uint16 lo = 0;
+  uint16 hi = bindIndexCnt;
+  uint16 mid;
+
+  while ( lo < hi )
+  {
+    mid = lo + ((hi - lo) >> 1);
+    pRec = &BindingIndex[mid];
+
+    if ( (pRec->srcEP < srcEP)
+        || ((pRec->srcEP == srcEP) && ((pRec->clusterID < clusterID)
+            || ((pRec->clusterID == clusterID) && (pRec->bindIdx < bindIdx)))) )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return ( lo );
+}
+
+/*********************************************************************
+ * @fn      bindIndexAdd
+ *
+ * @brief   Insert the (srcEP, clusterID) record of a binding entry,
+ *          unless it is already there.
+ *
+ * @param   pBind - binding table entry
+ * @param   clusterID - cluster ID
+ *
+ * @return  none
+ */
+static void bindIndexAdd( BindingEntry_t *pBind, uint16 clusterID )
+{
+  uint16 bindIdx = BIND_ENTRY_IDX( pBind );
+  uint16 pos;
+  uint16 x;
+
+  if ( (bindIdx >= gNWK_MAX_BINDING_ENTRIES) || (bindIndexCnt >= gBIND_INDEX_SIZE) )
+  {
+    return;
+  }
+
+  pos = bindIndexLowerBound( pBind->srcEP, clusterID, bindIdx );
+
+  if ( (pos < bindIndexCnt) && (BindingIndex[pos].srcEP == pBind->srcEP)
+      && (BindingIndex[pos].clusterID == clusterID) && (BindingIndex[pos].bindIdx == bindIdx) )
+  {
+    return;  // Duplicate cluster ID in the entry's list
+  }
+
+  // Open a gap, from the top down since osal_memcpy() copies forwards
+  for ( x = bindIndexCnt; x > pos; x-- )
+  {
+    BindingIndex[x] = BindingIndex[x - 1];
+  }
+
+  BindingIndex[pos].srcEP = pBind->srcEP;
+  BindingIndex[pos].clusterID = clusterID;
+  BindingIndex[pos].bindIdx = bindIdx;
+  bindIndexCnt++;
+}
+
+/*********************************************************************
+ * @fn      bindIndexRemove
+ *
+ * @brief   Remove the (srcEP, clusterID) record of a binding entry.
+ *
+ * @param   pBind - binding table entry
+ * @param   clusterID - cluster ID
+ *
+ * @return  none
+ */
+static void bindIndexRemove( BindingEntry_t *pBind, uint16 clusterID )
+{
+  uint16 bindIdx = BIND_ENTRY_IDX( pBind );
+  uint16 pos;
+
+  if ( bindIdx >= gNWK_MAX_BINDING_ENTRIES )
+  {
+    return;
+  }
+
+  pos = bindIndexLowerBound( pBind->srcEP, clusterID, bindIdx );
+
+  if ( (pos < bindIndexCnt) && (BindingIndex[pos].srcEP == pBind->srcEP)
+      && (BindingIndex[pos].clusterID == clusterID) && (BindingIndex[pos].bindIdx == bindIdx) )
+  {
+    bindIndexCnt--;
+    osal_memcpy( &BindingIndex[pos], &BindingIndex[pos + 1],
+                 (bindIndexCnt - pos) * sizeof( bindIndexRec_t ) );
+  }
+}
+#endif // ( BIND_INDEX == TRUE )
+
 /*********************************************************************
 *********************************************************************/
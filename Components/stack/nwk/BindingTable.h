@@ -65,6 +65,12 @@ extern "C" {
 #define DSTGROUPMODE_ADDR     0
 #define DSTGROUPMODE_GROUP    1
 
+// Keep a sorted (srcEP, clusterID) index over the binding table so
+// bindFind() and bindNumReflections() don't walk every cluster list.
+#if !defined ( BIND_INDEX )
+  #define BIND_INDEX  TRUE
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -92,6 +98,15 @@ typedef struct
                       // gMAX_BINDING_CLUSTER_IDS
 } BindingEntry_t;
 
+// One record per (binding entry, cluster ID) pair, kept in ascending
+// srcEP, clusterID, bindIdx order.
+typedef struct
+{
+  uint8  srcEP;
+  uint16 clusterID;
+  uint16 bindIdx;       // Index into BindingTable[]
+} bindIndexRec_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -101,6 +116,12 @@ typedef struct
 // number of records - use gNWK_MAX_BINDING_ENTRIES.
 extern BindingEntry_t BindingTable[];
 
+#if ( BIND_INDEX == TRUE )
+// BindingIndex is defined in nwk_globals.c with room for every cluster
+// of every binding record - use gBIND_INDEX_SIZE as the number of records.
+extern bindIndexRec_t BindingIndex[];
+#endif
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -272,6 +293,11 @@ extern uint16 bindingAddrMgsHelperConvertShort( uint16 idx );
  */
 extern BindingEntry_t *GetBindingTableEntry( uint16 Nth );
 
+/*
+ * Rebuild the (srcEP, clusterID) index from the binding table
+ */
+extern void bindIndexRebuild( void );
+
 /*********************************************************************
 *********************************************************************/
 #ifdef __cplusplus
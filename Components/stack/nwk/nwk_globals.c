@@ -241,6 +241,13 @@ CONST uint16 gNWK_MAX_BINDING_ENTRIES = NWK_MAX_BINDING_ENTRIES;
 
   // Binding Table
   BindingEntry_t BindingTable[NWK_MAX_BINDING_ENTRIES];
+
+#if ( BIND_INDEX == TRUE )
+  // Binding Table (srcEP, clusterID) index
+  CONST uint16 gBIND_INDEX_SIZE = NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS;
+
+  bindIndexRec_t BindingIndex[NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS];
+#endif
 #endif
 
 // Maximum number allowed in the groups table.
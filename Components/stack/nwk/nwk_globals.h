@@ -440,6 +440,7 @@ extern CONST uint16 gLINK_STATUS_JITTER_MASK;
 extern CONST uint16 gNWK_MAX_BINDING_ENTRIES;
 extern CONST uint8 gMAX_BINDING_CLUSTER_IDS;
 extern CONST uint16 gBIND_REC_SIZE;
+extern CONST uint16 gBIND_INDEX_SIZE;
 
 extern CONST uint8 gAPS_MAX_GROUPS;
 
@@ -49,6 +49,10 @@
 #include "zcl.h"
 #include "zcl_general.h"
 
+#if defined ( ZCL_REPORT_ENGINE )
+  #include "zcl_report.h"
+#endif
+
 #if defined ( INTER_PAN )
   #include "stub_aps.h"
 #endif
@@ -69,6 +73,9 @@
 #define zcl_AccessCtrlAuthRead( a )   ( (a) & ACCESS_CONTROL_AUTH_READ )
 #define zcl_AccessCtrlAuthWrite( a )  ( (a) & ACCESS_CONTROL_AUTH_WRITE )
 
+// Length of an outgoing ZCL header
+#define zcl_HdrLen( manuCode )        ( (manuCode) != 0 ? 5 : 3 )
+
 #define zclParseCmd( a, b )           zclCmdTable[(a)].pfnParseInProfile( (b) )
 #define zclProcessCmd( a, b )         zclCmdTable[(a)].pfnProcessInProfile( (b) )
 
@@ -85,9 +92,22 @@
                                         (cmd) == ZCL_CMD_DISCOVER        || \
                                         (cmd) == ZCL_CMD_DEFAULT_RSP ) // exception
 
+/*** Attribute Index ***/
+#define zcl_AttrRecLess( a, b )       ( ( (a)->clusterID < (b)->clusterID ) || \
+                                        ( ( (a)->clusterID == (b)->clusterID ) && \
+                                          ( (a)->attr.attrId < (b)->attr.attrId ) ) )
+
 /*********************************************************************
  * CONSTANTS
  */
+// Keep a sorted index of every registered attribute list for binary
+// search lookups. Costs one byte per attribute and four per cluster.
+#if !defined ( ZCL_ATTR_INDEX )
+  #define ZCL_ATTR_INDEX  TRUE
+#endif
+
+// No attribute record position, start a search from scratch
+#define ZCL_ATTR_POS_NONE  0xFF
 
 /*********************************************************************
  * TYPEDEFS
@@ -100,6 +120,16 @@ typedef struct zclLibPlugin
   zclInHdlr_t         pfnIncomingHdlr;    // function to handle incoming message
 } zclLibPlugin_t;
 
+#if ( ZCL_ATTR_INDEX == TRUE )
+// Attribute index cluster item
+typedef struct
+{
+  uint16 clusterID; // cluster ID
+  uint8  first;     // position of the first cluster attribute in the sorted index
+  uint8  count;     // number of attributes in the cluster
+} zclAttrCluster_t;
+#endif
+
 // Attribute record list item
 typedef struct zclAttrRecsList
 {
@@ -109,6 +139,11 @@ typedef struct zclAttrRecsList
   zclAuthorizeCB_t       pfnAuthorizeCB;// Authorize Read or Write operation
   uint8                  numAttributes; // Number of the following records
   CONST zclAttrRec_t     *attrs;        // attribute records
+#if ( ZCL_ATTR_INDEX == TRUE )
+  uint8                  *sorted;       // record positions by cluster ID and attribute ID, NULL if no index
+  zclAttrCluster_t       *clusters;     // clusters in ascending order
+  uint8                  numClusters;   // Number of clusters
+#endif
 } zclAttrRecsList;
 
 // Cluster option list item
@@ -120,6 +155,13 @@ typedef struct zclClusterOptionList
   zclOptionRec_t              *options;   // option records
 } zclClusterOptionList;
 
+// Per-endpoint lists, indexed by AF endpoint slot
+typedef struct
+{
+  zclAttrRecsList      *attrList;   // First attribute list of the endpoint
+  zclClusterOptionList *optionList; // First cluster option list of the endpoint
+} zclEpSlot_t;
+
 typedef void *(*zclParseInProfileCmd_t)( zclParseCmd_t *pCmd );
 typedef uint8 (*zclProcessInProfileCmd_t)( zclIncoming_t *pInMsg );
 
@@ -159,6 +201,12 @@ uint8 zcl_SeqNum = 0x00;
 static zclLibPlugin_t *plugins;
 static zclAttrRecsList *attrList;
 static zclClusterOptionList *clusterOptionList;
+
+// Lists are only appended to, so the first list of an endpoint is cached
+// in its slot once found and stays valid.
+static zclEpSlot_t zclEpSlots[AF_MAX_EP_SLOTS];
+static uint8 zclLastEP = AF_BROADCAST_ENDPOINT;   // Endpoint of the last slot lookup
+static zclEpSlot_t *zclLastEpSlot = NULL;
 static uint8 zcl_TransID = 0;  // This is the unique message ID (counter)
 
 static afIncomingMSGPacket_t *rawAFMsg = NULL;
@@ -169,8 +217,17 @@ static afIncomingMSGPacket_t *rawAFMsg = NULL;
 void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );  // Not static for ZNP build.
 static uint8 *zclBuildHdr( zclFrameHdr_t *hdr, uint8 *pData );
 static uint8 zclCalcHdrSize( zclFrameHdr_t *hdr );
+static ZStatus_t zclSendFrame( uint8 srcEP, afAddrType_t *destAddr,
+                               uint16 clusterID, uint8 cmd, uint8 specific, uint8 direction,
+                               uint8 disableDefaultRsp, uint16 manuCode, uint8 seqNum,
+                               uint16 cmdFormatLen, uint8 *msgBuf );
 static zclLibPlugin_t *zclFindPlugin( uint16 clusterID, uint16 profileID );
+static zclEpSlot_t *zclFindEpSlot( uint8 endpoint );
 static zclAttrRecsList *zclFindAttrRecsList( uint8 endpoint );
+#if ( ZCL_ATTR_INDEX == TRUE )
+static void zclBuildAttrIndex( zclAttrRecsList *pRec );
+static uint8 zclFindAttrIndex( zclAttrRecsList *pRec, uint16 clusterID, uint16 attrId );
+#endif
 static zclOptionRec_t *zclFindClusterOption( uint8 endpoint, uint16 clusterID );
 static uint8 zclGetClusterOption( uint8 endpoint, uint16 clusterID );
 static void zclSetSecurityOption( uint8 endpoint, uint16 clusterID, uint8 enable );
@@ -210,7 +267,7 @@ static void *zclParseInReadReportCfgRspCmd( zclParseCmd_t *pCmd );
 static void *zclParseInDefaultRspCmd( zclParseCmd_t *pCmd );
 
 #ifdef ZCL_DISCOVER
-static uint8 zclFindNextAttrRec( uint8 endpoint, uint16 clusterID, uint16 *attrId, zclAttrRec_t *pAttr );
+static uint8 zclFindNextAttrRec( uint8 endpoint, uint16 clusterID, uint16 *attrId, zclAttrRec_t *pAttr, uint8 *pPos );
 static void *zclParseInDiscRspCmd( zclParseCmd_t *pCmd );
 static uint8 zclProcessInDiscCmd( zclIncoming_t *pInMsg );
 #endif // ZCL_DISCOVER
@@ -243,9 +300,15 @@ static CONST zclCmdItems_t zclCmdTable[] =
 #endif // ZCL_WRITE
 
 #ifdef ZCL_REPORT
+#ifdef ZCL_REPORT_ENGINE
+  /* ZCL_CMD_CONFIG_REPORT */       { zclParseInConfigReportCmd,     zclReport_ProcessInConfigReportCmd  },
+  /* ZCL_CMD_CONFIG_REPORT_RSP */   { zclParseInConfigReportRspCmd,  zclSendMsg                      },
+  /* ZCL_CMD_READ_REPORT_CFG */     { zclParseInReadReportCfgCmd,    zclReport_ProcessInReadReportCfgCmd },
+#else
   /* ZCL_CMD_CONFIG_REPORT */       { zclParseInConfigReportCmd,     zclSendMsg                      },
   /* ZCL_CMD_CONFIG_REPORT_RSP */   { zclParseInConfigReportRspCmd,  zclSendMsg                      },
   /* ZCL_CMD_READ_REPORT_CFG */     { zclParseInReadReportCfgCmd,    zclSendMsg                      },
+#endif // ZCL_REPORT_ENGINE
   /* ZCL_CMD_READ_REPORT_CFG_RSP */ { zclParseInReadReportCfgRspCmd, zclSendMsg                      },
   /* ZCL_CMD_REPORT */              { zclParseInReportCmd,           zclSendMsg                      },
 #else
@@ -287,6 +350,9 @@ void zcl_Init( uint8 task_id )
   plugins = (zclLibPlugin_t  *)NULL;
   attrList = (zclAttrRecsList *)NULL;
   clusterOptionList = (zclClusterOptionList *)NULL;
+
+  osal_memset( zclEpSlots, 0, sizeof( zclEpSlots ) );
+  zclLastEpSlot = (zclEpSlot_t *)NULL;
 }
 
 /*********************************************************************
@@ -444,6 +510,9 @@ ZStatus_t zcl_registerAttrList( uint8 endpoint, uint8 numAttr, CONST zclAttrRec_
   pNewItem->pfnReadWriteCB = NULL;
   pNewItem->numAttributes = numAttr;
   pNewItem->attrs = newAttrList;
+#if ( ZCL_ATTR_INDEX == TRUE )
+  zclBuildAttrIndex( pNewItem );
+#endif
 
   // Find spot in list
   if ( attrList == NULL )
@@ -672,14 +741,58 @@ ZStatus_t zcl_SendCommand( uint8 srcEP, afAddrType_t *destAddr,
                            uint16 clusterID, uint8 cmd, uint8 specific, uint8 direction,
                            uint8 disableDefaultRsp, uint16 manuCode, uint8 seqNum,
                            uint16 cmdFormatLen, uint8 *cmdFormat )
+{
+  uint8 *msgBuf;
+  ZStatus_t status;
+
+  // Allocate the buffer needed
+  msgBuf = osal_mem_alloc( zcl_HdrLen( manuCode ) + cmdFormatLen );
+  if ( msgBuf != NULL )
+  {
+    // Fill in the command frame
+    osal_memcpy( msgBuf + zcl_HdrLen( manuCode ), cmdFormat, cmdFormatLen );
+
+    status = zclSendFrame( srcEP, destAddr, clusterID, cmd, specific, direction,
+                           disableDefaultRsp, manuCode, seqNum, cmdFormatLen, msgBuf );
+    osal_mem_free ( msgBuf );
+  }
+  else
+  {
+    status = ZMemError;
+  }
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      zclSendFrame
+ *
+ * @brief   Fill in the ZCL header of a frame whose command was built in
+ *          place after zcl_HdrLen( manuCode ) reserved bytes, and send it.
+ *
+ * @param   srcEp - source endpoint
+ * @param   destAddr - destination address
+ * @param   clusterID - cluster ID
+ * @param   cmd - command ID
+ * @param   specific - whether the command is Cluster Specific
+ * @param   direction - client/server direction of the command
+ * @param   disableDefaultRsp - disable Default Response command
+ * @param   manuCode - manufacturer code for proprietary extensions to a profile
+ * @param   seqNumber - identification number for the transaction
+ * @param   cmdFormatLen - length of the command after the header
+ * @param   msgBuf - frame buffer
+ *
+ * @return  ZSuccess if OK
+ */
+static ZStatus_t zclSendFrame( uint8 srcEP, afAddrType_t *destAddr,
+                               uint16 clusterID, uint8 cmd, uint8 specific, uint8 direction,
+                               uint8 disableDefaultRsp, uint16 manuCode, uint8 seqNum,
+                               uint16 cmdFormatLen, uint8 *msgBuf )
 {
   endPointDesc_t *epDesc;
   zclFrameHdr_t hdr;
-  uint8 *msgBuf;
   uint16 msgLen;
-  uint8 *pBuf;
   uint8 options;
-  ZStatus_t status;
 
   epDesc = afFindEndPointDesc( srcEP );
   if ( epDesc == NULL )
@@ -750,30 +863,12 @@ ZStatus_t zcl_SendCommand( uint8 srcEP, afAddrType_t *destAddr,
   // Fill in the command
   hdr.commandID = cmd;
 
-  // calculate the needed buffer size
-  msgLen = zclCalcHdrSize( &hdr );
-  msgLen += cmdFormatLen;
-
-  // Allocate the buffer needed
-  msgBuf = osal_mem_alloc( msgLen );
-  if ( msgBuf != NULL )
-  {
-    // Fill in the ZCL Header
-    pBuf = zclBuildHdr( &hdr, msgBuf );
-
-    // Fill in the command frame
-    osal_memcpy( pBuf, cmdFormat, cmdFormatLen );
-
-    status = AF_DataRequest( destAddr, epDesc, clusterID, msgLen, msgBuf,
-                             &zcl_TransID, options, AF_DEFAULT_RADIUS );
-    osal_mem_free ( msgBuf );
-  }
-  else
-  {
-    status = ZMemError;
-  }
+  // Fill in the ZCL Header, zclCalcHdrSize() equals zcl_HdrLen( manuCode )
+  msgLen = zclCalcHdrSize( &hdr ) + cmdFormatLen;
+  zclBuildHdr( &hdr, msgBuf );
 
-  return ( status );
+  return ( AF_DataRequest( destAddr, epDesc, clusterID, msgLen, msgBuf,
+                           &zcl_TransID, options, AF_DEFAULT_RADIUS ) );
 }
 
 #ifdef ZCL_READ
@@ -872,11 +967,12 @@ ZStatus_t zcl_SendReadRsp( uint8 srcEP, afAddrType_t *dstAddr,
     }
   }
 
-  buf = osal_mem_alloc( len );
+  // Serialize straight into the frame, after the ZCL header
+  buf = osal_mem_alloc( zcl_HdrLen( 0 ) + len );
   if ( buf != NULL )
   {
     // Load the buffer - serially
-    uint8 *pBuf = buf;
+    uint8 *pBuf = buf + zcl_HdrLen( 0 );
     for ( uint8 i = 0; i < readRspCmd->numAttr; i++ )
     {
       zclReadRspStatus_t *statusRec = &(readRspCmd->attrList[i]);
@@ -905,8 +1001,8 @@ ZStatus_t zcl_SendReadRsp( uint8 srcEP, afAddrType_t *dstAddr,
       }
     } // for loop
 
-    status = zcl_SendCommand( srcEP, dstAddr, clusterID, ZCL_CMD_READ_RSP, FALSE,
-                              direction, disableDefaultRsp, 0, seqNum, len, buf );
+    status = zclSendFrame( srcEP, dstAddr, clusterID, ZCL_CMD_READ_RSP, FALSE,
+                           direction, disableDefaultRsp, 0, seqNum, len, buf );
     osal_mem_free( buf );
   }
   else
@@ -1002,11 +1098,12 @@ ZStatus_t zcl_SendWriteRsp( uint8 srcEP, afAddrType_t *dstAddr,
 
   dataLen = writeRspCmd->numAttr * ( 1 + 2 ); // status + attribute id
 
-  buf = osal_mem_alloc( dataLen );
+  // Serialize straight into the frame, after the ZCL header
+  buf = osal_mem_alloc( zcl_HdrLen( 0 ) + dataLen );
   if ( buf != NULL )
   {
     // Load the buffer - serially
-    uint8 *pBuf = buf;
+    uint8 *pBuf = buf + zcl_HdrLen( 0 );
     for ( uint8 i = 0; i < writeRspCmd->numAttr; i++ )
     {
       *pBuf++ = writeRspCmd->attrList[i].status;
@@ -1021,8 +1118,8 @@ ZStatus_t zcl_SendWriteRsp( uint8 srcEP, afAddrType_t *dstAddr,
       dataLen = 1;
     }
 
-    status = zcl_SendCommand( srcEP, dstAddr, clusterID, ZCL_CMD_WRITE_RSP, FALSE,
-                              direction, disableDefaultRsp, 0, seqNum, dataLen, buf );
+    status = zclSendFrame( srcEP, dstAddr, clusterID, ZCL_CMD_WRITE_RSP, FALSE,
+                           direction, disableDefaultRsp, 0, seqNum, dataLen, buf );
     osal_mem_free( buf );
   }
   else
@@ -1848,6 +1945,38 @@ static zclLibPlugin_t *zclFindPlugin( uint16 clusterID, uint16 profileID )
   return ( (zclLibPlugin_t *)NULL );
 }
 
+/*********************************************************************
+ * @fn      zclFindEpSlot
+ *
+ * @brief   Find the per-endpoint list cache of an endpoint. The last
+ *          endpoint is remembered, as one incoming frame looks up the
+ *          same endpoint several times.
+ *
+ * @param   endpoint - endpoint to look for
+ *
+ * @return  pointer to the slot, NULL if the endpoint has no AF slot
+ */
+static zclEpSlot_t *zclFindEpSlot( uint8 endpoint )
+{
+  uint8 slot;
+
+  if ( ( zclLastEpSlot != NULL ) && ( zclLastEP == endpoint ) )
+  {
+    return ( zclLastEpSlot );
+  }
+
+  slot = afEndPointSlot( endpoint );
+  if ( slot == AF_EP_SLOT_NONE )
+  {
+    return ( NULL );
+  }
+
+  zclLastEP = endpoint;
+  zclLastEpSlot = &(zclEpSlots[slot]);
+
+  return ( zclLastEpSlot );
+}
+
 /*********************************************************************
  * @fn      zclFindAttrRecsList
  *
@@ -1859,12 +1988,23 @@ static zclLibPlugin_t *zclFindPlugin( uint16 clusterID, uint16 profileID )
  */
 static zclAttrRecsList *zclFindAttrRecsList( uint8 endpoint )
 {
+  zclEpSlot_t *pSlot = zclFindEpSlot( endpoint );
   zclAttrRecsList *pLoop = attrList;
 
+  if ( ( pSlot != NULL ) && ( pSlot->attrList != NULL ) )
+  {
+    return ( pSlot->attrList );
+  }
+
   while ( pLoop != NULL )
   {
     if ( pLoop->endpoint == endpoint )
     {
+      if ( pSlot != NULL )
+      {
+        pSlot->attrList = pLoop;
+      }
+
       return ( pLoop );
     }
 
@@ -1874,6 +2014,147 @@ static zclAttrRecsList *zclFindAttrRecsList( uint8 endpoint )
   return ( NULL );
 }
 
+#if ( ZCL_ATTR_INDEX == TRUE )
+/*********************************************************************
+ * @fn      zclBuildAttrIndex
+ *
+ * @brief   Sort the positions of an attribute list by cluster ID and
+ *          attribute ID, and build the cluster table over them. The
+ *          list is left without an index if memory runs out.
+ *
+ * @param   pRec - attribute record list
+ *
+ * @return  none
+ */
+static void zclBuildAttrIndex( zclAttrRecsList *pRec )
+{
+  CONST zclAttrRec_t *attrs = pRec->attrs;
+  zclAttrCluster_t *clusters;
+  uint8 *sorted;
+  uint8 numClusters = 0;
+  uint8 i, j;
+
+  pRec->sorted = NULL;
+  pRec->clusters = NULL;
+  pRec->numClusters = 0;
+
+  if ( pRec->numAttributes == 0 )
+  {
+    return;
+  }
+
+  sorted = osal_mem_alloc( pRec->numAttributes );
+  if ( sorted == NULL )
+  {
+    return;
+  }
+
+  // Insertion sort, the tables are normally in order already. Equal
+  // keys keep their table order, as the linear search would find them.
+  for ( i = 0; i < pRec->numAttributes; i++ )
+  {
+    for ( j = i; ( j > 0 ) && zcl_AttrRecLess( &attrs[i], &attrs[sorted[j-1]] ); j-- )
+    {
+      sorted[j] = sorted[j-1];
+    }
+    sorted[j] = i;
+  }
+
+  for ( i = 0; i < pRec->numAttributes; i++ )
+  {
+    if ( ( i == 0 ) || ( attrs[sorted[i]].clusterID != attrs[sorted[i-1]].clusterID ) )
+    {
+      numClusters++;
+    }
+  }
+
+  clusters = osal_mem_alloc( numClusters * sizeof( zclAttrCluster_t ) );
+  if ( clusters == NULL )
+  {
+    osal_mem_free( sorted );
+    return;
+  }
+
+  for ( i = 0, j = 0; i < pRec->numAttributes; i++ )
+  {
+    if ( ( i == 0 ) || ( attrs[sorted[i]].clusterID != attrs[sorted[i-1]].clusterID ) )
+    {
+      clusters[j].clusterID = attrs[sorted[i]].clusterID;
+      clusters[j].first = i;
+      clusters[j].count = 0;
+      j++;
+    }
+    clusters[j-1].count++;
+  }
+
+  pRec->sorted = sorted;
+  pRec->clusters = clusters;
+  pRec->numClusters = numClusters;
+}
+
+/*********************************************************************
+ * @fn      zclFindAttrIndex
+ *
+ * @brief   Binary search the index of an attribute list for the first
+ *          attribute of a cluster whose ID is not below attrId.
+ *
+ * @param   pRec - attribute record list with an index
+ * @param   clusterID - cluster ID
+ * @param   attrId - lowest attribute ID looked for
+ *
+ * @return  position in the sorted index, ZCL_ATTR_POS_NONE if not found
+ */
+static uint8 zclFindAttrIndex( zclAttrRecsList *pRec, uint16 clusterID, uint16 attrId )
+{
+  zclAttrCluster_t *pCluster;
+  uint8 lo = 0;
+  uint8 hi = pRec->numClusters;
+  uint8 mid;
+
+  while ( lo < hi )
+  {
+    mid = lo + ( ( hi - lo ) >> 1 );
+    if ( pRec->clusters[mid].clusterID < clusterID )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  if ( ( lo == pRec->numClusters ) || ( pRec->clusters[lo].clusterID != clusterID ) )
+  {
+    return ( ZCL_ATTR_POS_NONE );
+  }
+
+  pCluster = &(pRec->clusters[lo]);
+  lo = pCluster->first;
+  hi = pCluster->first + pCluster->count;
+
+  while ( lo < hi )
+  {
+    mid = lo + ( ( hi - lo ) >> 1 );
+    if ( pRec->attrs[pRec->sorted[mid]].attr.attrId < attrId )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  if ( lo == pCluster->first + pCluster->count )
+  {
+    return ( ZCL_ATTR_POS_NONE );
+  }
+
+  return ( lo );
+}
+#endif // ZCL_ATTR_INDEX
+
 /*********************************************************************
  * @fn      zclFindAttrRec
  *
@@ -1891,6 +2172,22 @@ uint8 zclFindAttrRec( uint8 endpoint, uint16 clusterID, uint16 attrId, zclAttrRe
   uint8 x;
   zclAttrRecsList *pRec = zclFindAttrRecsList( endpoint );
 
+#if ( ZCL_ATTR_INDEX == TRUE )
+  if ( ( pRec != NULL ) && ( pRec->sorted != NULL ) )
+  {
+    x = zclFindAttrIndex( pRec, clusterID, attrId );
+
+    if ( ( x != ZCL_ATTR_POS_NONE ) && ( pRec->attrs[pRec->sorted[x]].attr.attrId == attrId ) )
+    {
+      *pAttr = pRec->attrs[pRec->sorted[x]];
+
+      return ( TRUE ); // EMBEDDED RETURN
+    }
+
+    return ( FALSE ); // EMBEDDED RETURN
+  }
+#endif
+
   if ( pRec != NULL )
   {
     for ( x = 0; x < pRec->numAttributes; x++ )
@@ -1964,13 +2261,28 @@ static zclAuthorizeCB_t zclGetAuthorizeCB( uint8 endpoint )
  */
 static zclOptionRec_t *zclFindClusterOption( uint8 endpoint, uint16 clusterID )
 {
+  zclEpSlot_t *pSlot = zclFindEpSlot( endpoint );
   zclClusterOptionList *pLoop;
 
-  pLoop = clusterOptionList;
+  // An endpoint may have more than one list, start from its first one
+  if ( ( pSlot != NULL ) && ( pSlot->optionList != NULL ) )
+  {
+    pLoop = pSlot->optionList;
+  }
+  else
+  {
+    pLoop = clusterOptionList;
+  }
+
   while ( pLoop != NULL )
   {
     if ( pLoop->endpoint == endpoint )
     {
+      if ( ( pSlot != NULL ) && ( pSlot->optionList == NULL ) )
+      {
+        pSlot->optionList = pLoop;
+      }
+
       for ( uint8 x = 0; x < pLoop->numOptions; x++ )
       {
         if ( pLoop->options[x].clusterID == clusterID )
@@ -2054,29 +2366,90 @@ static void zclSetSecurityOption( uint8 endpoint, uint16 clusterID, uint8 enable
  * @param   endpoint - Application's endpoint
  * @param   clusterID - cluster ID
  * @param   attr - attribute looking for
+ * @param   pAttr - attribute record to be returned
+ * @param   pPos - position of the record found by the previous call of
+ *                 a discovery, ZCL_ATTR_POS_NONE on the first call.
+ *                 Returns the position of the record found.
  *
- * @return  pointer to attribute record, NULL if not found
+ * @return  TRUE if record found. FALSE, otherwise.
  */
 static uint8 zclFindNextAttrRec( uint8 endpoint, uint16 clusterID,
-                                 uint16 *attrId, zclAttrRec_t *pAttr )
+                                 uint16 *attrId, zclAttrRec_t *pAttr, uint8 *pPos )
 {
   zclAttrRecsList *pRec = zclFindAttrRecsList( endpoint );
+  uint16 x;
 
-  if ( pRec != NULL )
+  if ( pRec == NULL )
+  {
+    return ( FALSE ); // EMBEDDED RETURN
+  }
+
+#if ( ZCL_ATTR_INDEX == TRUE )
+  if ( pRec->sorted != NULL )
   {
-    for ( uint16 x = 0; x < pRec->numAttributes; x++ )
+    x = *pPos;
+
+    // Step on from the previous record while it is below the one looked
+    // for, the next attribute is then the following position
+    if ( ( x < pRec->numAttributes ) &&
+         ( pRec->attrs[pRec->sorted[x]].clusterID == clusterID ) &&
+         ( pRec->attrs[pRec->sorted[x]].attr.attrId < *attrId ) )
     {
-      if ( ( pRec->attrs[x].clusterID == clusterID ) && 
-           ( pRec->attrs[x].attr.attrId >= *attrId ) )
+      while ( ( x < pRec->numAttributes ) &&
+              ( pRec->attrs[pRec->sorted[x]].clusterID == clusterID ) &&
+              ( pRec->attrs[pRec->sorted[x]].attr.attrId < *attrId ) )
       {
-        *pAttr = pRec->attrs[x];
-
-        // Update attribute ID
-        *attrId = pAttr->attr.attrId;
+        x++;
+      }
 
-        return ( TRUE ); // EMBEDDED RETURN
+      if ( ( x == pRec->numAttributes ) || ( pRec->attrs[pRec->sorted[x]].clusterID != clusterID ) )
+      {
+        x = ZCL_ATTR_POS_NONE;
       }
     }
+    else
+    {
+      x = zclFindAttrIndex( pRec, clusterID, *attrId );
+    }
+
+    if ( x != ZCL_ATTR_POS_NONE )
+    {
+      *pAttr = pRec->attrs[pRec->sorted[x]];
+      *pPos = (uint8)x;
+
+      // Update attribute ID
+      *attrId = pAttr->attr.attrId;
+
+      return ( TRUE ); // EMBEDDED RETURN
+    }
+
+    return ( FALSE ); // EMBEDDED RETURN
+  }
+#endif
+
+  // Without an index the table is in ascending order, go on from the
+  // previous record if it is below the one looked for
+  x = *pPos;
+  if ( ( x >= pRec->numAttributes ) ||
+       ( pRec->attrs[x].clusterID != clusterID ) ||
+       ( pRec->attrs[x].attr.attrId >= *attrId ) )
+  {
+    x = 0;
+  }
+
+  for ( ; x < pRec->numAttributes; x++ )
+  {
+    if ( ( pRec->attrs[x].clusterID == clusterID ) &&
+         ( pRec->attrs[x].attr.attrId >= *attrId ) )
+    {
+      *pAttr = pRec->attrs[x];
+      *pPos = (uint8)x;
+
+      // Update attribute ID
+      *attrId = pAttr->attr.attrId;
+
+      return ( TRUE ); // EMBEDDED RETURN
+    }
   }
 
   return ( FALSE );
@@ -2560,6 +2933,10 @@ static ZStatus_t zclWriteAttrData( uint8 endpoint, afAddrType_t *srcAddr,
         uint16 len = zclGetAttrDataLength( pAttr->attr.dataType, pWriteRec->attrData );
         osal_memcpy( pAttr->attr.dataPtr, pWriteRec->attrData, len );
 
+#if defined ( ZCL_REPORT_ENGINE )
+        zclReport_AttrChanged( endpoint, pAttr->clusterID, pAttr->attr.attrId );
+#endif
+
         status = ZCL_STATUS_SUCCESS;
       }
       else
@@ -3385,7 +3762,9 @@ static void *zclParseInDiscRspCmd( zclParseCmd_t *pCmd )
 /*********************************************************************
  * @fn      zclProcessInReadCmd
  *
- * @brief   Process the "Profile" Read Command
+ * @brief   Process the "Profile" Read Command. The response is
+ *          serialized straight into one frame buffer, and sent in as
+ *          many Read Response frames as the MTU requires.
  *
  * @param   pInMsg - incoming message to process
  *
@@ -3394,57 +3773,130 @@ static void *zclParseInDiscRspCmd( zclParseCmd_t *pCmd )
 static uint8 zclProcessInReadCmd( zclIncoming_t *pInMsg )
 {
   zclReadCmd_t *readCmd;
-  zclReadRspCmd_t *readRspCmd;
   zclAttrRec_t attrRec;
-  uint16 len;
-  
+  afDataReqMTU_t mtu;
+  uint8 endpoint = pInMsg->msg->endPoint;
+  uint16 clusterID = pInMsg->msg->clusterId;
+  uint8 *msgBuf;
+  uint8 *pBuf;
+  uint16 maxLen;  // largest command in one frame
+  uint16 bufLen;  // room for the command in msgBuf
+  uint16 len = 0; // command length built so far
+  uint16 recLen;
+  uint16 dataLen;
+  uint8 status;
+
   readCmd = (zclReadCmd_t *)pInMsg->attrCmd;
 
-  // calculate the length of the response status record
-  len = sizeof( zclReadRspCmd_t ) + (readCmd->numAttr * sizeof( zclReadRspStatus_t ));
+#if defined ( INTER_PAN )
+  if ( StubAPS_InterPan( pInMsg->msg->srcAddr.panId, pInMsg->msg->srcAddr.endPoint ) )
+  {
+    maxLen = INTERP_DataReqMTU();
+  }
+  else
+#endif
+  {
+    mtu.kvp = FALSE;
+    mtu.aps.secure = ( zclGetClusterOption( endpoint, clusterID ) & AF_EN_SECURITY ) ? TRUE : FALSE;
+    maxLen = afDataReqMTU( &mtu );
+  }
+  maxLen -= zcl_HdrLen( 0 );
 
-  readRspCmd = osal_mem_alloc( len );
-  if ( readRspCmd == NULL )
+  bufLen = maxLen;
+  msgBuf = osal_mem_alloc( zcl_HdrLen( 0 ) + bufLen );
+  if ( msgBuf == NULL )
   {
     return FALSE; // EMBEDDED RETURN
   }
 
-  readRspCmd->numAttr = readCmd->numAttr;
   for ( uint8 i = 0; i < readCmd->numAttr; i++ )
   {
-    zclReadRspStatus_t *statusRec = &(readRspCmd->attrList[i]);
-
-    statusRec->attrID = readCmd->attrID[i];
-
-    if ( zclFindAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId,
-                         readCmd->attrID[i], &attrRec ) )
+    if ( zclFindAttrRec( endpoint, clusterID, readCmd->attrID[i], &attrRec ) )
     {
       if ( zcl_AccessCtrlRead( attrRec.attr.accessControl ) )
       {
-        statusRec->status = zclAuthorizeRead( pInMsg->msg->endPoint, 
-                                              &(pInMsg->msg->srcAddr), &attrRec );
-        if ( statusRec->status == ZCL_STATUS_SUCCESS )
-        {
-          statusRec->data = attrRec.attr.dataPtr;
-          statusRec->dataType = attrRec.attr.dataType;
-        }
+        status = zclAuthorizeRead( endpoint, &(pInMsg->msg->srcAddr), &attrRec );
       }
       else
       {
-        statusRec->status = ZCL_STATUS_WRITE_ONLY;
+        status = ZCL_STATUS_WRITE_ONLY;
       }
     }
     else
     {
-      statusRec->status = ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+      status = ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+    }
+
+    recLen = 2 + 1; // Attribute ID + Status
+    if ( status == ZCL_STATUS_SUCCESS )
+    {
+      if ( attrRec.attr.dataPtr != NULL )
+      {
+        dataLen = zclGetAttrDataLength( attrRec.attr.dataType, attrRec.attr.dataPtr );
+      }
+      else
+      {
+        dataLen = zclGetAttrDataLengthUsingCB( endpoint, clusterID, readCmd->attrID[i] );
+      }
+
+      recLen += 1 + dataLen; // Attribute Data Type + Data
+    }
+
+    // Send the records built so far if this one does not fit with them
+    if ( ( len != 0 ) && ( ( len + recLen ) > maxLen ) )
+    {
+      zclSendFrame( endpoint, &(pInMsg->msg->srcAddr), clusterID, ZCL_CMD_READ_RSP, FALSE,
+                    ZCL_FRAME_SERVER_CLIENT_DIR, true, 0, pInMsg->hdr.transSeqNum,
+                    len, msgBuf );
+      len = 0;
+    }
+
+    // A record longer than the MTU is left to APS fragmentation, alone
+    if ( recLen > bufLen )
+    {
+      osal_mem_free( msgBuf );
+
+      bufLen = recLen;
+      msgBuf = osal_mem_alloc( zcl_HdrLen( 0 ) + bufLen );
+      if ( msgBuf == NULL )
+      {
+        return FALSE; // EMBEDDED RETURN
+      }
+    }
+
+    pBuf = msgBuf + zcl_HdrLen( 0 ) + len;
+    *pBuf++ = LO_UINT16( readCmd->attrID[i] );
+    *pBuf++ = HI_UINT16( readCmd->attrID[i] );
+    *pBuf++ = status;
+
+    if ( status == ZCL_STATUS_SUCCESS )
+    {
+      *pBuf++ = attrRec.attr.dataType;
+
+      if ( attrRec.attr.dataPtr != NULL )
+      {
+        // Copy attribute data to the buffer to be sent out
+        zclSerializeData( attrRec.attr.dataType, attrRec.attr.dataPtr, pBuf );
+      }
+      else
+      {
+        // Read attribute data directly into the buffer to be sent out
+        zclReadAttrDataUsingCB( endpoint, clusterID, readCmd->attrID[i], pBuf, &dataLen );
+      }
     }
+
+    len += recLen;
+  }
+
+  // Send the last frame, or the empty response to an empty request
+  if ( ( len != 0 ) || ( readCmd->numAttr == 0 ) )
+  {
+    zclSendFrame( endpoint, &(pInMsg->msg->srcAddr), clusterID, ZCL_CMD_READ_RSP, FALSE,
+                  ZCL_FRAME_SERVER_CLIENT_DIR, true, 0, pInMsg->hdr.transSeqNum,
+                  len, msgBuf );
   }
 
-  // Build and send Read Response command
-  zcl_SendReadRsp( pInMsg->msg->endPoint, &(pInMsg->msg->srcAddr), pInMsg->msg->clusterId,
-                   readRspCmd, ZCL_FRAME_SERVER_CLIENT_DIR,
-                   true, pInMsg->hdr.transSeqNum );
-  osal_mem_free( readRspCmd );
+  osal_mem_free( msgBuf );
 
   return TRUE;
 }
@@ -3796,14 +4248,16 @@ static uint8 zclProcessInDiscCmd( zclIncoming_t *pInMsg )
   uint8 discComplete = TRUE;
   zclAttrRec_t attrRec;
   uint16 attrID;
+  uint8 pos;
   uint8 i;
 
   discoverCmd = (zclDiscoverCmd_t *)pInMsg->attrCmd;
 
   // Find out the number of attributes supported within the specified range
+  pos = ZCL_ATTR_POS_NONE;
   for ( i = 0, attrID = discoverCmd->startAttr; i < discoverCmd->maxAttrIDs; i++, attrID++ )
   {
-    if ( !zclFindNextAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, &attrID, &attrRec ) )
+    if ( !zclFindNextAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, &attrID, &attrRec, &pos ) )
     {
       break;
     }
@@ -3820,9 +4274,10 @@ static uint8 zclProcessInDiscCmd( zclIncoming_t *pInMsg )
   discoverRspCmd->numAttr = i;
   if ( discoverRspCmd->numAttr != 0 )
   {
+    pos = ZCL_ATTR_POS_NONE;
     for ( i = 0, attrID = discoverCmd->startAttr; i < discoverRspCmd->numAttr; i++, attrID++ )
     {
-      if ( !zclFindNextAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, &attrID, &attrRec ) )
+      if ( !zclFindNextAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, &attrID, &attrRec, &pos ) )
       {
         break; // Attribute not supported
       }
@@ -3832,7 +4287,7 @@ static uint8 zclProcessInDiscCmd( zclIncoming_t *pInMsg )
     }
 
     // Are there more attributes to be discovered?
-    if ( zclFindNextAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, &attrID, &attrRec ) )
+    if ( zclFindNextAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, &attrID, &attrRec, &pos ) )
     {
       discComplete = FALSE;
     }
@@ -129,6 +129,23 @@ static uint16 zclOTA_ElementTag;
 static uint32 zclOTA_ElementLen;
 static uint32 zclOTA_ElementPos;
 
+// Image Block Request window. Window block k is at file offset
+// zclOTA_FileOffset + k * zclOTA_BlockSize; block 0 is parsed on arrival,
+// later blocks are held until the ones before them are in.
+static uint8 zclOTA_BlockSize;
+static uint32 zclOTA_ReqOffset;            // Blocks below this are requested
+#if ( OTA_BLOCK_WINDOW > 1 )
+static uint8 zclOTA_BlockLen[OTA_BLOCK_WINDOW - 1];
+static uint8 zclOTA_BlockBuf[OTA_BLOCK_WINDOW - 1][OTA_BLOCK_DATA_SIZE];
+#endif
+
+#if ( OTA_PAGE_REQ == TRUE )
+// Image Page Requests cover the window; holes are asked for by block
+static uint8 zclOTA_PageReq;               // Server streams pages
+static uint8 zclOTA_PageSeen;              // A page block has come in
+static uint32 zclOTA_PageEnd;              // End of the page streaming in
+#endif
+
 // Retry counters
 static uint8 zclOTA_BlockRetry;
 static uint8 zclOTA_UpgradeEndRetry;
@@ -139,6 +156,17 @@ static uint8 zclOTA_ClientPdState;
 static const uint8 zclOTA_HdrMagic[] = {0x1E, 0xF1, 0xEE, 0x0B};
 #endif // OTA_CLIENT
 
+#if (defined OTA_SERVER) && (OTA_SERVER == TRUE)
+// Image Page Request being streamed, one client at a time
+static afAddrType_t zclOTA_SrvPageAddr;
+static zclOTA_FileID_t zclOTA_SrvPageFileId;
+static uint32 zclOTA_SrvPageOffset;        // Next block to read
+static uint32 zclOTA_SrvPageEnd;
+static uint16 zclOTA_SrvPageSpacing;
+static uint8 zclOTA_SrvPageLen;            // Data per block
+static uint8 zclOTA_SrvPageRetry;
+#endif // OTA_SERVER
+
 /******************************************************************************
  * LOCAL FUNCTIONS
  */
@@ -147,6 +175,13 @@ static ZStatus_t zclOTA_HdlIncoming( zclIncoming_t *pInMsg );
 #if (defined OTA_CLIENT) && (OTA_CLIENT == TRUE)
 static void zclOTA_StartTimer(uint16 eventId, uint32 minutes);
 static ZStatus_t sendImageBlockReq(afAddrType_t *dstAddr);
+#if ( OTA_PAGE_REQ == TRUE )
+static ZStatus_t sendImagePageReq(afAddrType_t *dstAddr);
+#endif
+static ZStatus_t zclOTA_SendNextReq(afAddrType_t *dstAddr);
+static void zclOTA_BlockWindowReset(void);
+static uint8 zclOTA_BlockIndex(uint32 offset, uint8 len);
+static uint8 zclOTA_ProcessImageBlock(uint8 *pData, uint8 len);
 static void zclOTA_ProcessZDOMsgs( zdoIncomingMsg_t *pMsg );
 static void zclOTA_ImageBlockWaitExpired(void);
 static void zclOTA_UpgradeComplete(uint8 status);
@@ -155,6 +190,9 @@ static uint8 zclOTA_ProcessImageData(uint8 *pData, uint8 len);
 
 static ZStatus_t zclOTA_SendQueryNextImageReq( afAddrType_t *dstAddr, zclOTA_QueryNextImageReqParams_t *pParams );
 static ZStatus_t zclOTA_SendImageBlockReq( afAddrType_t *dstAddr, zclOTA_ImageBlockReqParams_t *pParams );
+#if ( OTA_PAGE_REQ == TRUE )
+static ZStatus_t zclOTA_SendImagePageReq( afAddrType_t *dstAddr, zclOTA_ImagePageReqParams_t *pParams );
+#endif
 static ZStatus_t zclOTA_SendUpgradeEndReq( afAddrType_t *dstAddr, zclOTA_UpgradeEndReqParams_t *pParams );
 
 static ZStatus_t zclOTA_ClientHdlIncoming( zclIncoming_t *pInMsg );
@@ -175,6 +213,8 @@ static ZStatus_t zclOTA_Srv_QuerySpecificFileReq(afAddrType_t *pSrcAddr, zclOTA_
 static void zclOTA_ProcessNextImgRsp(uint8* pMSGpkt, zclOTA_FileID_t *pFileId, afAddrType_t *pAddr);
 static void zclOTA_ProcessFileReadRsp(uint8* pMSGpkt, zclOTA_FileID_t *pFileId, afAddrType_t *pAddr);
 static void zclOTA_ServerHandleFileSysCb(OTA_MtMsg_t* pMSGpkt);
+static void zclOTA_ServerPageNext(void);
+static uint8 zclOTA_ServerPageFrom(afAddrType_t *pSrcAddr);
 
 static ZStatus_t zclOTA_ServerHdlIncoming( zclIncoming_t *pInMsg );
 #endif // OTA_SERVER
@@ -557,7 +597,17 @@ uint16 zclOTA_event_loop( uint8 task_id, uint16 events )
     }
     else
     {
-      // Send another block request
+#if ( OTA_PAGE_REQ == TRUE )
+      // Nothing came of the first page, the server does not stream pages
+      if ((zclOTA_PageEnd > zclOTA_FileOffset) && (zclOTA_PageSeen == FALSE))
+      {
+        zclOTA_PageReq = FALSE;
+        zclOTA_PageEnd = zclOTA_FileOffset;
+      }
+#endif
+
+      // Send the block requests of the window again
+      zclOTA_ReqOffset = zclOTA_FileOffset;
       sendImageBlockReq(&zclOTA_serverAddr);
     }
 
@@ -582,6 +632,15 @@ uint16 zclOTA_event_loop( uint8 task_id, uint16 events )
   }
 #endif // OTA_CLIENT
 
+#if (defined OTA_SERVER) && (OTA_SERVER == TRUE)
+  if ( events & ZCL_OTA_IMAGE_PAGE_EVT )
+  {
+    zclOTA_ServerPageNext();
+
+    return ( events ^ ZCL_OTA_IMAGE_PAGE_EVT );
+  }
+#endif // OTA_SERVER
+
   // Discard unknown events
   return 0;
 }
@@ -933,6 +992,51 @@ ZStatus_t zclOTA_SendImageBlockReq( afAddrType_t *dstAddr,
   return status;
 }
 
+#if ( OTA_PAGE_REQ == TRUE )
+/******************************************************************************
+ * @fn      zclOTA_SendImagePageReq
+ *
+ * @brief   Send an OTA Image Page Request mesage.
+ *
+ * @param   dstAddr - where you want the message to go
+ * @param   pParams - message parameters
+ *
+ * @return  ZStatus_t
+ */
+ZStatus_t zclOTA_SendImagePageReq( afAddrType_t *dstAddr,
+                                   zclOTA_ImagePageReqParams_t *pParams )
+{
+  ZStatus_t status;
+  uint8 buf[PAYLOAD_MAX_LEN_IMAGE_PAGE_REQ];
+  uint8 *pBuf = buf;
+
+  *pBuf++ = pParams->fieldControl;
+  *pBuf++ = LO_UINT16(pParams->fileId.manufacturer);
+  *pBuf++ = HI_UINT16(pParams->fileId.manufacturer);
+  *pBuf++ = LO_UINT16(pParams->fileId.type);
+  *pBuf++ = HI_UINT16(pParams->fileId.type);
+  pBuf = osal_buffer_uint32(pBuf, pParams->fileId.version);
+  pBuf = osal_buffer_uint32(pBuf, pParams->fileOffset);
+  *pBuf++ = pParams->maxDataSize;
+  *pBuf++ = LO_UINT16(pParams->pageSize);
+  *pBuf++ = HI_UINT16(pParams->pageSize);
+  *pBuf++ = LO_UINT16(pParams->responseSpacing);
+  *pBuf++ = HI_UINT16(pParams->responseSpacing);
+  if (pParams->fieldControl == 1)
+  {
+    osal_cpyExtAddr(pBuf, pParams->nodeAddr);
+    pBuf += Z_EXTADDR_LEN;
+  }
+
+  status = zcl_SendCommand( ZCL_OTA_ENDPOINT, dstAddr, ZCL_CLUSTER_ID_OTA,
+                            COMMAND_IMAGE_PAGE_REQ, TRUE,
+                            ZCL_FRAME_CLIENT_SERVER_DIR, FALSE, 0,
+                            zclOTA_SeqNo++, (uint16) (pBuf - buf), buf );
+
+  return status;
+}
+#endif // OTA_PAGE_REQ
+
 /******************************************************************************
  * @fn      zclOTA_SendUpgradeEndReq
  *
@@ -987,7 +1091,8 @@ static void zclOTA_StartTimer(uint16 eventId, uint32 seconds)
 /******************************************************************************
  * @fn      sendImageBlockReq
  *
- * @brief   Send an Image Block Request.
+ * @brief   Send an Image Block Request for each block of the window that
+ *          has not been requested yet.
  *
  * @param   dstAddr - where you want the message to go
  *
@@ -996,26 +1101,273 @@ static void zclOTA_StartTimer(uint16 eventId, uint32 seconds)
 static ZStatus_t sendImageBlockReq(afAddrType_t *dstAddr)
 {
   zclOTA_ImageBlockReqParams_t req;
+  ZStatus_t status = ZSuccess;
+  uint32 offset = zclOTA_FileOffset;
+  uint32 end = zclOTA_DownloadedImageSize;
+  uint8 k;
+
+#if ( OTA_PAGE_REQ == TRUE )
+  // While a page streams in, only its holes are asked for
+  if (zclOTA_PageEnd > zclOTA_FileOffset)
+  {
+    end = zclOTA_PageEnd;
+  }
+#endif
 
   req.fieldControl = 0;
   req.fileId.manufacturer = zclOTA_ManufacturerId;
   req.fileId.type = zclOTA_ImageType;
   req.fileId.version = zclOTA_DownloadedFileVersion;
-  req.fileOffset = zclOTA_FileOffset;
 
-  if (zclOTA_DownloadedImageSize - zclOTA_FileOffset < OTA_MAX_MTU)
+  for (k = 0; (k < OTA_BLOCK_WINDOW) && (offset < end); k++)
   {
-    req.maxDataSize = zclOTA_DownloadedImageSize - zclOTA_FileOffset;
+#if ( OTA_BLOCK_WINDOW > 1 )
+    // Skip blocks already held
+    if ((offset >= zclOTA_ReqOffset) && ((k == 0) || (zclOTA_BlockLen[k-1] == 0)))
+#else
+    if (offset >= zclOTA_ReqOffset)
+#endif
+    {
+      req.fileOffset = offset;
+
+      if (zclOTA_DownloadedImageSize - offset < zclOTA_BlockSize)
+      {
+        req.maxDataSize = zclOTA_DownloadedImageSize - offset;
+      }
+      else
+      {
+        req.maxDataSize = zclOTA_BlockSize;
+      }
+
+      // Out of buffers, the rest is asked for on the next block or timeout
+      status = zclOTA_SendImageBlockReq( dstAddr, &req);
+      if (status != ZSuccess)
+      {
+        break;
+      }
+    }
+
+    offset += zclOTA_BlockSize;
   }
-  else
+
+  if (offset > zclOTA_ReqOffset)
   {
-    req.maxDataSize = OTA_MAX_MTU;
+    zclOTA_ReqOffset = offset;
   }
 
   // Start a timer waiting for a response
   osal_start_timerEx(zclOTA_TaskID, ZCL_OTA_BLOCK_RSP_TO_EVT, OTA_MAX_BLOCK_RSP_WAIT_TIME);
 
-  return zclOTA_SendImageBlockReq( dstAddr, &req);
+  return status;
+}
+
+#if ( OTA_PAGE_REQ == TRUE )
+/******************************************************************************
+ * @fn      sendImagePageReq
+ *
+ * @brief   Send an Image Page Request for the window. A page never spans
+ *          more than the window, so none of its blocks are dropped.
+ *
+ * @param   dstAddr - where you want the message to go
+ *
+ * @return  ZStatus_t
+ */
+static ZStatus_t sendImagePageReq(afAddrType_t *dstAddr)
+{
+  zclOTA_ImagePageReqParams_t req;
+  ZStatus_t status;
+  uint32 size = (uint32)zclOTA_BlockSize * OTA_BLOCK_WINDOW;
+
+  if (zclOTA_DownloadedImageSize - zclOTA_FileOffset < size)
+  {
+    size = zclOTA_DownloadedImageSize - zclOTA_FileOffset;
+  }
+
+  req.fieldControl = 0;
+  req.fileId.manufacturer = zclOTA_ManufacturerId;
+  req.fileId.type = zclOTA_ImageType;
+  req.fileId.version = zclOTA_DownloadedFileVersion;
+  req.fileOffset = zclOTA_FileOffset;
+  req.maxDataSize = zclOTA_BlockSize;
+  req.pageSize = (uint16)size;
+  req.responseSpacing = OTA_PAGE_SPACING;
+
+  status = zclOTA_SendImagePageReq(dstAddr, &req);
+
+  // The whole window is requested, unless the page could not be sent
+  if (status == ZSuccess)
+  {
+    zclOTA_PageEnd = zclOTA_FileOffset + size;
+    zclOTA_ReqOffset = zclOTA_PageEnd;
+  }
+
+  // Start a timer waiting for the page
+  osal_start_timerEx(zclOTA_TaskID, ZCL_OTA_BLOCK_RSP_TO_EVT, OTA_PAGE_RSP_WAIT_TIME);
+
+  return status;
+}
+#endif // OTA_PAGE_REQ
+
+/******************************************************************************
+ * @fn      zclOTA_SendNextReq
+ *
+ * @brief   Ask for more image data once a block is in: the next page when
+ *          the page is done, its holes when the end of the page is in,
+ *          else the next blocks of the window.
+ *
+ * @param   dstAddr - where you want the message to go
+ *
+ * @return  ZStatus_t
+ */
+static ZStatus_t zclOTA_SendNextReq(afAddrType_t *dstAddr)
+{
+#if ( OTA_PAGE_REQ == TRUE )
+  if (zclOTA_PageReq == TRUE)
+  {
+    if (zclOTA_FileOffset >= zclOTA_PageEnd)
+    {
+      return sendImagePageReq(dstAddr);
+    }
+
+    if (zclOTA_ReqOffset >= zclOTA_PageEnd)
+    {
+      // The rest of the page is still streaming in
+      osal_start_timerEx(zclOTA_TaskID, ZCL_OTA_BLOCK_RSP_TO_EVT, OTA_PAGE_RSP_WAIT_TIME);
+      return ZSuccess;
+    }
+  }
+#endif
+
+  return sendImageBlockReq(dstAddr);
+}
+
+/******************************************************************************
+ * @fn      zclOTA_BlockWindowReset
+ *
+ * @brief   Empty the Image Block Request window at the current file offset.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void zclOTA_BlockWindowReset(void)
+{
+  zclOTA_ReqOffset = zclOTA_FileOffset;
+
+#if ( OTA_BLOCK_WINDOW > 1 )
+  osal_memset(zclOTA_BlockLen, 0, sizeof(zclOTA_BlockLen));
+#endif
+}
+
+/******************************************************************************
+ * @fn      zclOTA_BlockIndex
+ *
+ * @brief   Find the window block an Image Block Response fills. A block
+ *          is never longer than asked for, else it would overflow its
+ *          buffer or misalign the blocks after it.
+ *
+ * @param   offset - file offset of the response data
+ * @param   len - length of the response data
+ *
+ * @return  window block, OTA_BLOCK_WINDOW to drop the response
+ */
+static uint8 zclOTA_BlockIndex(uint32 offset, uint8 len)
+{
+  uint32 k;
+
+  if ((offset < zclOTA_FileOffset) || (offset >= zclOTA_DownloadedImageSize) ||
+      (len == 0) || (len > zclOTA_BlockSize) ||
+      (len > zclOTA_DownloadedImageSize - offset))
+  {
+    return OTA_BLOCK_WINDOW;
+  }
+
+  k = offset - zclOTA_FileOffset;
+
+  if ((k % zclOTA_BlockSize) != 0)
+  {
+    return OTA_BLOCK_WINDOW;
+  }
+
+  k /= zclOTA_BlockSize;
+
+  if (k >= OTA_BLOCK_WINDOW)
+  {
+    return OTA_BLOCK_WINDOW;
+  }
+
+#if ( OTA_BLOCK_WINDOW > 1 )
+  if (k != 0)
+  {
+    // Drop duplicates, and short blocks that would leave a gap
+    if ((zclOTA_BlockLen[k-1] != 0) ||
+        ((len != zclOTA_BlockSize) && (len != zclOTA_DownloadedImageSize - offset)))
+    {
+      return OTA_BLOCK_WINDOW;
+    }
+  }
+#endif
+
+  return (uint8)k;
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ProcessImageBlock
+ *
+ * @brief   Process the block at the head of the window, then the held
+ *          blocks that follow it. A short block before the end of the
+ *          image means the server serves smaller blocks; the window is
+ *          emptied and requested again at that size.
+ *
+ * @param   pData - pointer to the data
+ * @param   len - length of the data
+ *
+ * @return  status of the operation
+ */
+static uint8 zclOTA_ProcessImageBlock(uint8 *pData, uint8 len)
+{
+  uint8 status;
+#if ( OTA_BLOCK_WINDOW > 1 )
+  uint8 k;
+#endif
+
+  status = zclOTA_ProcessImageData(pData, len);
+
+  while ((status == ZSuccess) && (zclOTA_ImageUpgradeStatus == OTA_STATUS_IN_PROGRESS))
+  {
+    if (len < zclOTA_BlockSize)
+    {
+      zclOTA_BlockSize = len;
+      zclOTA_BlockWindowReset();
+      break;
+    }
+
+#if ( OTA_BLOCK_WINDOW > 1 )
+    // The window moved up a block, the first held block is now its head
+    len = zclOTA_BlockLen[0];
+
+    if (len != 0)
+    {
+      status = zclOTA_ProcessImageData(zclOTA_BlockBuf[0], len);
+    }
+
+    for (k = 1; k < OTA_BLOCK_WINDOW - 1; k++)
+    {
+      zclOTA_BlockLen[k-1] = zclOTA_BlockLen[k];
+      osal_memcpy(zclOTA_BlockBuf[k-1], zclOTA_BlockBuf[k], zclOTA_BlockLen[k]);
+    }
+    zclOTA_BlockLen[OTA_BLOCK_WINDOW - 2] = 0;
+
+    if (len == 0)
+    {
+      break;
+    }
+#else
+    break;
+#endif
+  }
+
+  return status;
 }
 
 /******************************************************************************
@@ -1426,6 +1778,13 @@ static ZStatus_t zclOTA_ProcessQueryNextImageRsp( zclIncoming_t *pInMsg )
       // initialize other variables
       zclOTA_FileOffset = 0;
       zclOTA_ClientPdState = ZCL_OTA_PD_MAGIC_0_STATE;
+      zclOTA_BlockSize = OTA_BLOCK_DATA_SIZE;
+      zclOTA_BlockWindowReset();
+#if ( OTA_PAGE_REQ == TRUE )
+      zclOTA_PageReq = TRUE;
+      zclOTA_PageSeen = FALSE;
+      zclOTA_PageEnd = 0;
+#endif
 
       // set state to 'in progress'
       zclOTA_ImageUpgradeStatus = OTA_STATUS_IN_PROGRESS;
@@ -1436,8 +1795,8 @@ static ZStatus_t zclOTA_ProcessQueryNextImageRsp( zclIncoming_t *pInMsg )
       // Store the file ID
       osal_memcpy(&zclOTA_CurrentDlFileId, &param.fileId, sizeof(zclOTA_FileID_t));
 
-      // send image block request
-      sendImageBlockReq(&(pInMsg->msg->srcAddr));
+      // send image page or block request
+      zclOTA_SendNextReq(&(pInMsg->msg->srcAddr));
       status = ZCL_STATUS_CMD_HAS_RSP;
 
       // Request the IEEE address of the server to put into the
@@ -1483,6 +1842,7 @@ static ZStatus_t zclOTA_ProcessImageBlockRsp( zclIncoming_t *pInMsg )
   zclOTA_UpgradeEndReqParams_t  req;
   uint8 *pData;
   uint8 status = ZSuccess;
+  uint8 k;
 
   // verify in 'in progress' state
   if (zclOTA_ImageUpgradeStatus != OTA_STATUS_IN_PROGRESS)
@@ -1516,6 +1876,12 @@ static ZStatus_t zclOTA_ProcessImageBlockRsp( zclIncoming_t *pInMsg )
     param.rsp.success.dataSize = *pData++;
     param.rsp.success.pData = pData;
 
+    // verify the data is all in the message
+    if (pInMsg->pDataLen - PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP < param.rsp.success.dataSize)
+    {
+      return ZCL_STATUS_MALFORMED_COMMAND;
+    }
+
     // verify manufacturer, image type, file version, file offset
     if ((param.rsp.success.fileId.type != zclOTA_ImageType) ||
         (param.rsp.success.fileId.manufacturer != zclOTA_ManufacturerId) ||
@@ -1525,18 +1891,53 @@ static ZStatus_t zclOTA_ProcessImageBlockRsp( zclIncoming_t *pInMsg )
     }
     else
     {
-      // Drop duplicate packets (retries)
-      if (param.rsp.success.fileOffset != zclOTA_FileOffset)
+      // Drop duplicate packets (retries) and blocks outside the window
+      k = zclOTA_BlockIndex(param.rsp.success.fileOffset, param.rsp.success.dataSize);
+      if (k == OTA_BLOCK_WINDOW)
       {
         return ZSuccess;
       }
 
-      status = zclOTA_ProcessImageData(param.rsp.success.pData, param.rsp.success.dataSize);
+#if ( OTA_BLOCK_WINDOW > 1 )
+      if (k != 0)
+      {
+        // Hold the block until the ones before it are in
+        zclOTA_BlockLen[k-1] = param.rsp.success.dataSize;
+        osal_memcpy(zclOTA_BlockBuf[k-1], param.rsp.success.pData, param.rsp.success.dataSize);
+
+        // With the rest of the window in, ask for the head block again
+        // rather than wait for the response timeout
+        for (k = 0; (k < OTA_BLOCK_WINDOW - 1) && (zclOTA_BlockLen[k] != 0); k++);
+        if (k == OTA_BLOCK_WINDOW - 1)
+        {
+          zclOTA_ReqOffset = zclOTA_FileOffset;
+        }
+
+#if ( OTA_PAGE_REQ == TRUE )
+        // The end of the page is in, so are all the blocks it will bring
+        if (param.rsp.success.fileOffset + param.rsp.success.dataSize == zclOTA_PageEnd)
+        {
+          zclOTA_ReqOffset = zclOTA_FileOffset;
+        }
+#endif
+      }
+      else
+#endif
+      {
+        status = zclOTA_ProcessImageBlock(param.rsp.success.pData, param.rsp.success.dataSize);
+      }
 
       // Stop the timer and clear the retry count
       zclOTA_BlockRetry = 0;
       osal_stop_timerEx(zclOTA_TaskID, ZCL_OTA_BLOCK_RSP_TO_EVT);
 
+#if ( OTA_PAGE_REQ == TRUE )
+      if (zclOTA_PageReq == TRUE)
+      {
+        zclOTA_PageSeen = TRUE;
+      }
+#endif
+
       if (status == ZSuccess)
       {
         if (zclOTA_ImageUpgradeStatus == OTA_STATUS_COMPLETE)
@@ -1548,7 +1949,7 @@ static ZStatus_t zclOTA_ProcessImageBlockRsp( zclIncoming_t *pInMsg )
         }
         else
         {
-          sendImageBlockReq(&(pInMsg->msg->srcAddr));
+          zclOTA_SendNextReq(&(pInMsg->msg->srcAddr));
         }
       }
     }
@@ -1572,6 +1973,11 @@ static ZStatus_t zclOTA_ProcessImageBlockRsp( zclIncoming_t *pInMsg )
     zclOTA_BlockRetry = 0;
     osal_stop_timerEx(zclOTA_TaskID, ZCL_OTA_BLOCK_RSP_TO_EVT);
 
+#if ( OTA_PAGE_REQ == TRUE )
+    // The page is asked for again after the wait
+    zclOTA_PageEnd = zclOTA_FileOffset;
+#endif
+
     // set timer for next image block req
     zclOTA_StartTimer(ZCL_OTA_IMAGE_BLOCK_WAIT_EVT,
                       (param.rsp.wait.requestTime - param.rsp.wait.currentTime));
@@ -1824,8 +2230,9 @@ static void zclOTA_ImageBlockWaitExpired(void)
   // verify in 'in progress' state
   if (zclOTA_ImageUpgradeStatus == OTA_STATUS_IN_PROGRESS)
   {
-    // request next block
-    sendImageBlockReq(&zclOTA_serverAddr);
+    // request the blocks of the window again
+    zclOTA_ReqOffset = zclOTA_FileOffset;
+    zclOTA_SendNextReq(&zclOTA_serverAddr);
   }
 }
 
@@ -2099,9 +2506,9 @@ ZStatus_t zclOTA_Srv_ImageBlockReq(afAddrType_t *pSrcAddr, zclOTA_ImageBlockReqP
     {
       uint8 len = pParam->maxDataSize;
 
-      if (len > OTA_MAX_MTU)
+      if (len > OTA_BLOCK_DATA_SIZE)
       {
-        len = OTA_MAX_MTU;
+        len = OTA_BLOCK_DATA_SIZE;
       }
 
       // Read the data from the OTA Console
@@ -2133,7 +2540,9 @@ ZStatus_t zclOTA_Srv_ImageBlockReq(afAddrType_t *pSrcAddr, zclOTA_ImageBlockReqP
 /******************************************************************************
  * @fn      zclOTA_Srv_ImagePageReq
  *
- * @brief   Handle an Image Page Request.  Note: Not currently supported.
+ * @brief   Handle an Image Page Request. The page is read from the OTA
+ *          Console a block at a time, at least OTA_PAGE_SPACING apart.
+ *          A page from another client waits for the current one.
  *
  * @param   pSrcAddr - The source of the message
  *          pParam - message parameters
@@ -2142,8 +2551,128 @@ ZStatus_t zclOTA_Srv_ImageBlockReq(afAddrType_t *pSrcAddr, zclOTA_ImageBlockReqP
  */
 ZStatus_t zclOTA_Srv_ImagePageReq(afAddrType_t *pSrcAddr, zclOTA_ImagePageReqParams_t *pParam)
 {
-  // Send not supported resposne
-  return ZUnsupClusterCmd;
+  uint8 status = ZFailure;
+
+  if (pParam->fileId.version != queryResponse.fileId.version)
+  {
+    status = ZCL_STATUS_NO_IMAGE_AVAILABLE;
+  }
+  else if ((pParam->maxDataSize == 0) || (pParam->pageSize == 0))
+  {
+    status = ZCL_STATUS_INVALID_FIELD;
+  }
+  else if (zclOTA_Permit)
+  {
+    if ((zclOTA_SrvPageOffset < zclOTA_SrvPageEnd) &&
+        (zclOTA_ServerPageFrom(pSrcAddr) == FALSE))
+    {
+      zclOTA_ImageBlockRspParams_t blockRsp;
+
+      // Fill in the response parameters
+      blockRsp.status = ZOtaWaitForData;
+      osal_memcpy(&blockRsp.rsp.success.fileId, &pParam->fileId, sizeof(zclOTA_FileID_t));
+      blockRsp.rsp.wait.currentTime = 0;
+      blockRsp.rsp.wait.requestTime = OTA_SEND_BLOCK_WAIT;
+
+      // Send the block to the peer
+      zclOTA_SendImageBlockRsp(pSrcAddr, &blockRsp);
+    }
+    else
+    {
+      zclOTA_SrvPageAddr = *pSrcAddr;
+      osal_memcpy(&zclOTA_SrvPageFileId, &pParam->fileId, sizeof(zclOTA_FileID_t));
+      zclOTA_SrvPageOffset = pParam->fileOffset;
+      zclOTA_SrvPageEnd = pParam->fileOffset + pParam->pageSize;
+      zclOTA_SrvPageRetry = 0;
+
+      zclOTA_SrvPageLen = pParam->maxDataSize;
+      if (zclOTA_SrvPageLen > OTA_BLOCK_DATA_SIZE)
+      {
+        zclOTA_SrvPageLen = OTA_BLOCK_DATA_SIZE;
+      }
+
+      zclOTA_SrvPageSpacing = pParam->responseSpacing;
+      if (zclOTA_SrvPageSpacing < OTA_PAGE_SPACING)
+      {
+        zclOTA_SrvPageSpacing = OTA_PAGE_SPACING;
+      }
+
+      osal_set_event(zclOTA_TaskID, ZCL_OTA_IMAGE_PAGE_EVT);
+    }
+
+    status = ZCL_STATUS_CMD_HAS_RSP;
+  }
+
+  return status;
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ServerPageNext
+ *
+ * @brief   Read the next block of the page being streamed. A read the OTA
+ *          Console cannot take is tried again on the next tick.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void zclOTA_ServerPageNext(void)
+{
+  uint8 len = zclOTA_SrvPageLen;
+
+  if (zclOTA_SrvPageOffset >= zclOTA_SrvPageEnd)
+  {
+    return;
+  }
+
+  if (zclOTA_SrvPageEnd - zclOTA_SrvPageOffset < len)
+  {
+    len = zclOTA_SrvPageEnd - zclOTA_SrvPageOffset;
+  }
+
+  // Read the data from the OTA Console
+  if (MT_OtaFileReadReq(&zclOTA_SrvPageAddr, &zclOTA_SrvPageFileId, len,
+                        zclOTA_SrvPageOffset) == ZSuccess)
+  {
+    zclOTA_SrvPageOffset += len;
+    zclOTA_SrvPageRetry = 0;
+  }
+  else if (++zclOTA_SrvPageRetry > OTA_MAX_BLOCK_RETRIES)
+  {
+    // Drop the page, the client asks for what it misses by block
+    zclOTA_SrvPageOffset = zclOTA_SrvPageEnd;
+  }
+
+  if (zclOTA_SrvPageOffset < zclOTA_SrvPageEnd)
+  {
+    osal_start_timerEx(zclOTA_TaskID, ZCL_OTA_IMAGE_PAGE_EVT, zclOTA_SrvPageSpacing);
+  }
+}
+
+/******************************************************************************
+ * @fn      zclOTA_ServerPageFrom
+ *
+ * @brief   Check whether a request comes from the client of the page being
+ *          streamed. A 64-bit address is compared in full, not by the
+ *          bytes it shares with a short address.
+ *
+ * @param   pSrcAddr - The source of the message
+ *
+ * @return  TRUE if it is the same client
+ */
+static uint8 zclOTA_ServerPageFrom(afAddrType_t *pSrcAddr)
+{
+  if (zclOTA_SrvPageAddr.addrMode != pSrcAddr->addrMode)
+  {
+    return FALSE;
+  }
+
+  if (pSrcAddr->addrMode == afAddr64Bit)
+  {
+    return osal_memcmp(zclOTA_SrvPageAddr.addr.extAddr, pSrcAddr->addr.extAddr, Z_EXTADDR_LEN);
+  }
+
+  return (zclOTA_SrvPageAddr.addr.shortAddr == pSrcAddr->addr.shortAddr);
 }
 
 /******************************************************************************
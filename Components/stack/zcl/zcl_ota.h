@@ -63,6 +63,46 @@ extern "C"
 #define OTA_MAX_END_REQ_RETRIES                       2
 #define OTA_MAX_BLOCK_RSP_WAIT_TIME                   ((uint16)5000)
 
+// Image Block Requests the client keeps outstanding
+#if !defined ( OTA_BLOCK_WINDOW )
+#define OTA_BLOCK_WINDOW                              4
+#endif
+
+// Image data asked for per Image Block Request, the server may return less
+#if !defined ( OTA_BLOCK_DATA_SIZE )
+#if defined ( ZIGBEE_FRAGMENTATION )
+#define OTA_BLOCK_DATA_SIZE                           64
+#else
+#define OTA_BLOCK_DATA_SIZE                           OTA_MAX_MTU
+#endif
+#endif
+
+// Client asks for the window with one Image Page Request, for about a
+// quarter of the requests and a third fewer frames on the air. The block
+// spacing of the page makes a download slower than with the block
+// request window; set it to FALSE where download time matters more.
+#if !defined ( OTA_PAGE_REQ )
+#define OTA_PAGE_REQ                                  TRUE
+#endif
+
+// Minimum spacing between the blocks of a page (ms)
+#if !defined ( OTA_PAGE_SPACING )
+#define OTA_PAGE_SPACING                              20
+#endif
+
+// Time without a page block before the client asks for holes by block (ms)
+#if !defined ( OTA_PAGE_RSP_WAIT_TIME )
+#define OTA_PAGE_RSP_WAIT_TIME                        ((uint16)1000)
+#endif
+
+#if ( OTA_BLOCK_WINDOW < 1 ) || ( OTA_BLOCK_WINDOW > 16 )
+#error "OTA_BLOCK_WINDOW shall be between 1 and 16 !"
+#endif
+
+#if ( OTA_BLOCK_DATA_SIZE < 1 ) || ( OTA_BLOCK_DATA_SIZE > 255 )
+#error "OTA_BLOCK_DATA_SIZE shall be between 1 and 255 !"
+#endif
+
 // Simple descriptor values
 #define ZCL_OTA_ENDPOINT                              14
 #ifdef OTA_HA
@@ -178,6 +218,9 @@ extern "C"
 #define ZCL_OTA_BLOCK_RSP_TO_EVT                      0x0008
 #define ZCL_OTA_IMAGE_QUERY_TO_EVT                    0x0010
 
+// Server Task Events
+#define ZCL_OTA_IMAGE_PAGE_EVT                        0x0020
+
 // The OTA Upgrade delay is the number of seconds before the client
 // should wait before switching to the upgrade image
 #define OTA_UPGRADE_DELAY                             60
@@ -0,0 +1,801 @@
+/**************************************************************************************************
+  Filename:       zcl_report.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    ZCL attribute reporting engine: configure reporting state
+                  per attribute, min/max interval and reportable change
+                  evaluation on one shared timer.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "AF.h"
+#include "zcl.h"
+#include "zcl_report.h"
+
+#if !defined ( ZCL_REPORT )
+  #error "The reporting engine needs ZCL_REPORT"
+#endif
+
+/*********************************************************************
+ * MACROS
+ */
+// Reporting interval in seconds to milliseconds
+#define ZCL_REPORT_MS( sec )      ( (uint32)(sec) * 1000 )
+
+/*********************************************************************
+ * CONSTANTS
+ */
+// Record flags
+#define ZCL_REPORT_CHANGED        0x01  // value changed since the last report
+#define ZCL_REPORT_DUE            0x02  // goes into the next Report Attributes frame
+
+// Retry delay of due reports that found no memory
+#define ZCL_REPORT_RETRY_DELAY    100
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+// Reporting state of one attribute
+typedef struct
+{
+  uint8  endpoint;                          // 0 if the record is free
+  uint16 clusterID;
+  uint16 attrID;
+  uint8  dataType;
+  uint8  flags;                             // ZCL_REPORT_CHANGED, ZCL_REPORT_DUE
+  uint16 minReportInt;                      // seconds
+  uint16 maxReportInt;                      // seconds, ZCL_REPORT_NO_PERIODIC for none
+  uint32 lastTime;                          // osal_GetSystemClock() of the last report
+  uint8  change[ZCL_REPORT_VALUE_LEN];      // reportable change, analog types only
+  uint8  lastValue[ZCL_REPORT_VALUE_LEN];   // value last reported
+} zclReportRec_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static zclReportRec_t zclReportRecs[ZCL_REPORT_MAX_ATTRS];
+static uint8 zclReportTaskID;
+static uint16 zclReportEvent;
+static uint8 zclReportSeqNum;
+static afAddrType_t zclReportDstAddr;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static zclReportRec_t *zclReportFindRec( uint8 endpoint, uint16 clusterID, uint16 attrID );
+static uint8 zclReportValueLen( uint8 dataType );
+static uint32 zclReportGetValue( uint8 dataType, uint8 *pValue );
+static uint8 zclReportChanged( zclReportRec_t *pRec, uint8 *pValue );
+static void zclReportSend( uint32 now );
+static void zclReportSchedule( uint32 now );
+
+/*********************************************************************
+ * @fn      zclReport_Init
+ *
+ * @brief   Initialize the reporting engine. Reports are evaluated on
+ *          one timer, the event of which the task passes on to
+ *          zclReport_ProcessEvent().
+ *
+ * @param   taskId - task owning the timer
+ * @param   event - timer event
+ *
+ * @return  none
+ */
+void zclReport_Init( uint8 taskId, uint16 event )
+{
+  zclReportTaskID = taskId;
+  zclReportEvent = event;
+  zclReportSeqNum = 0;
+
+  osal_memset( zclReportRecs, 0, sizeof( zclReportRecs ) );
+
+  osal_memset( &zclReportDstAddr, 0, sizeof( afAddrType_t ) );
+  zclReportDstAddr.addrMode = afAddrNotPresent; // Sent through the binding table
+}
+
+/*********************************************************************
+ * @fn      zclReport_SetDstAddr
+ *
+ * @brief   Send the reports to one device instead of the devices bound
+ *          to the reported cluster.
+ *
+ * @param   pDstAddr - destination, NULL to go back to the binding table
+ *
+ * @return  none
+ */
+void zclReport_SetDstAddr( afAddrType_t *pDstAddr )
+{
+  if ( pDstAddr != NULL )
+  {
+    zclReportDstAddr = *pDstAddr;
+  }
+  else
+  {
+    osal_memset( &zclReportDstAddr, 0, sizeof( afAddrType_t ) );
+    zclReportDstAddr.addrMode = afAddrNotPresent;
+  }
+}
+
+/*********************************************************************
+ * @fn      zclReport_Configure
+ *
+ * @brief   Configure the reports of an attribute. A maximum reporting
+ *          interval of ZCL_REPORT_STOP stops them. The attribute is
+ *          reported once right after it is configured.
+ *
+ * @param   endpoint - application's endpoint
+ * @param   clusterID - cluster of the attribute
+ * @param   pCfg - reporting configuration
+ *
+ * @return  ZCL_STATUS_SUCCESS or the ZCL status of the failure
+ */
+uint8 zclReport_Configure( uint8 endpoint, uint16 clusterID, zclCfgReportRec_t *pCfg )
+{
+  zclReportRec_t *pRec;
+  zclAttrRec_t attrRec;
+  uint8 len;
+
+  if ( pCfg->direction != ZCL_SEND_ATTR_REPORTS )
+  {
+    return ( ZCL_STATUS_UNSUP_GENERAL_COMMAND );
+  }
+
+  if ( !zclFindAttrRec( endpoint, clusterID, pCfg->attrID, &attrRec ) )
+  {
+    return ( ZCL_STATUS_UNSUPPORTED_ATTRIBUTE );
+  }
+
+  if ( attrRec.attr.dataType != pCfg->dataType )
+  {
+    return ( ZCL_STATUS_INVALID_DATA_TYPE );
+  }
+
+  len = zclReportValueLen( pCfg->dataType );
+  if ( ( len == 0 ) || ( attrRec.attr.dataPtr == NULL ) ||
+       !( attrRec.attr.accessControl & ACCESS_CONTROL_READ ) )
+  {
+    return ( ZCL_STATUS_UNREPORTABLE_ATTRIBUTE );
+  }
+
+  pRec = zclReportFindRec( endpoint, clusterID, pCfg->attrID );
+
+  if ( pCfg->maxReportInt == ZCL_REPORT_STOP )
+  {
+    if ( pRec != NULL )
+    {
+      pRec->endpoint = 0;
+    }
+
+    return ( ZCL_STATUS_SUCCESS );
+  }
+
+  if ( ( pCfg->maxReportInt != ZCL_REPORT_NO_PERIODIC ) &&
+       ( pCfg->maxReportInt < pCfg->minReportInt ) )
+  {
+    return ( ZCL_STATUS_INVALID_VALUE );
+  }
+
+  if ( pRec == NULL )
+  {
+    pRec = zclReportFindRec( 0, 0, 0 );
+    if ( pRec == NULL )
+    {
+      return ( ZCL_STATUS_INSUFFICIENT_SPACE );
+    }
+  }
+
+  pRec->endpoint = endpoint;
+  pRec->clusterID = clusterID;
+  pRec->attrID = pCfg->attrID;
+  pRec->dataType = pCfg->dataType;
+  pRec->minReportInt = pCfg->minReportInt;
+  pRec->maxReportInt = pCfg->maxReportInt;
+  pRec->lastTime = osal_GetSystemClock();
+
+  osal_memset( pRec->change, 0, ZCL_REPORT_VALUE_LEN );
+  if ( zclAnalogDataType( pCfg->dataType ) && ( pCfg->reportableChange != NULL ) )
+  {
+    osal_memcpy( pRec->change, pCfg->reportableChange, len );
+  }
+
+  // Report the current value as the base for the reportable change
+  pRec->flags = ZCL_REPORT_DUE;
+  osal_set_event( zclReportTaskID, zclReportEvent );
+
+  return ( ZCL_STATUS_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      zclReport_AttrChanged
+ *
+ * @brief   Tell the engine the value of an attribute changed. It is
+ *          compared with the last reported value when the event runs,
+ *          so changes of several attributes in one go share a frame.
+ *
+ * @param   endpoint - application's endpoint
+ * @param   clusterID - cluster of the attribute
+ * @param   attrID - attribute ID
+ *
+ * @return  none
+ */
+void zclReport_AttrChanged( uint8 endpoint, uint16 clusterID, uint16 attrID )
+{
+  zclReportRec_t *pRec = zclReportFindRec( endpoint, clusterID, attrID );
+
+  if ( pRec != NULL )
+  {
+    pRec->flags |= ZCL_REPORT_CHANGED;
+    osal_set_event( zclReportTaskID, zclReportEvent );
+  }
+}
+
+/*********************************************************************
+ * @fn      zclReport_ProcessEvent
+ *
+ * @brief   Find the attributes due for a report, send them and restart
+ *          the timer for the next deadline. An attribute is due when
+ *          its value moved by the reportable change and the minimum
+ *          interval has passed, or when the maximum interval has passed.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void zclReport_ProcessEvent( void )
+{
+  zclReportRec_t *pRec;
+  zclAttrRec_t attrRec;
+  uint32 now = osal_GetSystemClock();
+  uint32 elapsed;
+  uint8 i;
+
+  for ( i = 0; i < ZCL_REPORT_MAX_ATTRS; i++ )
+  {
+    pRec = &(zclReportRecs[i]);
+    if ( pRec->endpoint == 0 )
+    {
+      continue;
+    }
+
+    elapsed = now - pRec->lastTime;
+
+    if ( pRec->flags & ZCL_REPORT_CHANGED )
+    {
+      if ( !zclFindAttrRec( pRec->endpoint, pRec->clusterID, pRec->attrID, &attrRec ) ||
+           !zclReportChanged( pRec, (uint8 *)attrRec.attr.dataPtr ) )
+      {
+        // Not enough to report
+        pRec->flags &= ~ZCL_REPORT_CHANGED;
+      }
+      else if ( elapsed >= ZCL_REPORT_MS( pRec->minReportInt ) )
+      {
+        pRec->flags |= ZCL_REPORT_DUE;
+      }
+    }
+
+    if ( ( pRec->maxReportInt != ZCL_REPORT_NO_PERIODIC ) &&
+         ( elapsed >= ZCL_REPORT_MS( pRec->maxReportInt ) ) )
+    {
+      pRec->flags |= ZCL_REPORT_DUE;
+    }
+  }
+
+  zclReportSend( now );
+  zclReportSchedule( now );
+}
+
+/*********************************************************************
+ * @fn      zclReport_ProcessInConfigReportCmd
+ *
+ * @brief   Process the "Profile" Configure Reporting Command
+ *
+ * @param   pInMsg - incoming message to process
+ *
+ * @return  TRUE if command processed. FALSE, otherwise.
+ */
+uint8 zclReport_ProcessInConfigReportCmd( zclIncoming_t *pInMsg )
+{
+  zclCfgReportCmd_t *cfgReportCmd;
+  zclCfgReportRspCmd_t *cfgReportRspCmd;
+  uint8 status;
+  uint8 i, j = 0;
+
+  cfgReportCmd = (zclCfgReportCmd_t *)pInMsg->attrCmd;
+
+  // Allocate space for the response command
+  cfgReportRspCmd = (zclCfgReportRspCmd_t *)osal_mem_alloc( sizeof ( zclCfgReportRspCmd_t )
+                        + sizeof ( zclCfgReportStatus_t ) * ( cfgReportCmd->numAttr + 1 ) );
+  if ( cfgReportRspCmd == NULL )
+  {
+    return FALSE; // EMBEDDED RETURN
+  }
+
+  // Only the failed records are listed in the response
+  for ( i = 0; i < cfgReportCmd->numAttr; i++ )
+  {
+    zclCfgReportRec_t *reportRec = &(cfgReportCmd->attrList[i]);
+
+    status = zclReport_Configure( pInMsg->msg->endPoint, pInMsg->msg->clusterId, reportRec );
+    if ( status != ZCL_STATUS_SUCCESS )
+    {
+      cfgReportRspCmd->attrList[j].status = status;
+      cfgReportRspCmd->attrList[j].direction = reportRec->direction;
+      cfgReportRspCmd->attrList[j].attrID = reportRec->attrID;
+      j++;
+    }
+  }
+
+  if ( j == 0 )
+  {
+    // A single success status tells all records were accepted
+    cfgReportRspCmd->attrList[0].status = ZCL_STATUS_SUCCESS;
+    cfgReportRspCmd->attrList[0].direction = ZCL_SEND_ATTR_REPORTS;
+    cfgReportRspCmd->attrList[0].attrID = 0;
+    j = 1;
+  }
+
+  cfgReportRspCmd->numAttr = j;
+  zcl_SendConfigReportRspCmd( pInMsg->msg->endPoint, &pInMsg->msg->srcAddr,
+                              pInMsg->msg->clusterId, cfgReportRspCmd, ZCL_FRAME_SERVER_CLIENT_DIR,
+                              true, pInMsg->hdr.transSeqNum );
+  osal_mem_free( cfgReportRspCmd );
+
+  return TRUE;
+}
+
+/*********************************************************************
+ * @fn      zclReport_ProcessInReadReportCfgCmd
+ *
+ * @brief   Process the "Profile" Read Reporting Configuration Command
+ *
+ * @param   pInMsg - incoming message to process
+ *
+ * @return  TRUE if command processed. FALSE, otherwise.
+ */
+uint8 zclReport_ProcessInReadReportCfgCmd( zclIncoming_t *pInMsg )
+{
+  zclReadReportCfgCmd_t *readReportCfgCmd;
+  zclReadReportCfgRspCmd_t *readReportCfgRspCmd;
+  zclReportRec_t *pRec;
+  zclAttrRec_t attrRec;
+  uint8 i;
+
+  readReportCfgCmd = (zclReadReportCfgCmd_t *)pInMsg->attrCmd;
+
+  // Allocate space for the response command
+  readReportCfgRspCmd = (zclReadReportCfgRspCmd_t *)osal_mem_alloc( sizeof ( zclReadReportCfgRspCmd_t )
+                            + sizeof ( zclReportCfgRspRec_t ) * readReportCfgCmd->numAttr );
+  if ( readReportCfgRspCmd == NULL )
+  {
+    return FALSE; // EMBEDDED RETURN
+  }
+
+  readReportCfgRspCmd->numAttr = readReportCfgCmd->numAttr;
+  for ( i = 0; i < readReportCfgCmd->numAttr; i++ )
+  {
+    zclReportCfgRspRec_t *reportRspRec = &(readReportCfgRspCmd->attrList[i]);
+
+    osal_memset( reportRspRec, 0, sizeof( zclReportCfgRspRec_t ) );
+    reportRspRec->direction = readReportCfgCmd->attrList[i].direction;
+    reportRspRec->attrID = readReportCfgCmd->attrList[i].attrID;
+
+    pRec = zclReportFindRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId, reportRspRec->attrID );
+
+    if ( reportRspRec->direction != ZCL_SEND_ATTR_REPORTS )
+    {
+      reportRspRec->status = ZCL_STATUS_UNSUP_GENERAL_COMMAND;
+    }
+    else if ( !zclFindAttrRec( pInMsg->msg->endPoint, pInMsg->msg->clusterId,
+                               reportRspRec->attrID, &attrRec ) )
+    {
+      reportRspRec->status = ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+    }
+    else if ( pRec == NULL )
+    {
+      reportRspRec->status = ZCL_STATUS_NOT_FOUND;
+    }
+    else
+    {
+      reportRspRec->status = ZCL_STATUS_SUCCESS;
+      reportRspRec->dataType = pRec->dataType;
+      reportRspRec->minReportInt = pRec->minReportInt;
+      reportRspRec->maxReportInt = pRec->maxReportInt;
+      reportRspRec->reportableChange = pRec->change;
+    }
+  }
+
+  zcl_SendReadReportCfgRspCmd( pInMsg->msg->endPoint, &pInMsg->msg->srcAddr,
+                               pInMsg->msg->clusterId, readReportCfgRspCmd, ZCL_FRAME_SERVER_CLIENT_DIR,
+                               true, pInMsg->hdr.transSeqNum );
+  osal_mem_free( readReportCfgRspCmd );
+
+  return TRUE;
+}
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      zclReportFindRec
+ *
+ * @brief   Find the reporting record of an attribute. Endpoint 0 finds
+ *          a free record.
+ *
+ * @param   endpoint - application's endpoint
+ * @param   clusterID - cluster of the attribute
+ * @param   attrID - attribute ID
+ *
+ * @return  pointer to the record, NULL if not found
+ */
+static zclReportRec_t *zclReportFindRec( uint8 endpoint, uint16 clusterID, uint16 attrID )
+{
+  zclReportRec_t *pRec;
+  uint8 i;
+
+  for ( i = 0; i < ZCL_REPORT_MAX_ATTRS; i++ )
+  {
+    pRec = &(zclReportRecs[i]);
+    if ( ( pRec->endpoint == endpoint ) &&
+         ( ( endpoint == 0 ) || ( ( pRec->clusterID == clusterID ) && ( pRec->attrID == attrID ) ) ) )
+    {
+      return ( pRec );
+    }
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      zclReportValueLen
+ *
+ * @brief   Size of the value of a data type as kept in RAM, 24 bit
+ *          types are kept in a uint32.
+ *
+ * @param   dataType - data type
+ *
+ * @return  size in octets, 0 if the type cannot be reported
+ */
+static uint8 zclReportValueLen( uint8 dataType )
+{
+  uint8 len = zclGetDataTypeLength( dataType );
+
+  if ( len == 3 )
+  {
+    len = 4;
+  }
+
+  return ( ( len <= ZCL_REPORT_VALUE_LEN ) ? len : 0 );
+}
+
+/*********************************************************************
+ * @fn      zclReportGetValue
+ *
+ * @brief   Read an integer attribute value, signed types are sign
+ *          extended.
+ *
+ * @param   dataType - data type
+ * @param   pValue - value as kept in RAM
+ *
+ * @return  value
+ */
+static uint32 zclReportGetValue( uint8 dataType, uint8 *pValue )
+{
+  uint32 value;
+
+  switch ( dataType )
+  {
+    case ZCL_DATATYPE_INT8:
+      value = (uint32)(int32)*((int8 *)pValue);
+      break;
+
+    case ZCL_DATATYPE_UINT8:
+      value = *pValue;
+      break;
+
+    case ZCL_DATATYPE_INT16:
+      value = (uint32)(int32)*((int16 *)pValue);
+      break;
+
+    case ZCL_DATATYPE_UINT16:
+      value = *((uint16 *)pValue);
+      break;
+
+    case ZCL_DATATYPE_INT24:
+      value = *((uint32 *)pValue) & 0x00FFFFFF;
+      if ( value & 0x00800000 )
+      {
+        value |= 0xFF000000;
+      }
+      break;
+
+    case ZCL_DATATYPE_UINT24:
+      value = *((uint32 *)pValue) & 0x00FFFFFF;
+      break;
+
+    default:
+      value = *((uint32 *)pValue);
+      break;
+  }
+
+  return ( value );
+}
+
+/*********************************************************************
+ * @fn      zclReportChanged
+ *
+ * @brief   Check whether a value differs from the last reported one
+ *          by at least the reportable change. Discrete values and
+ *          analog values without an integer or float form report any
+ *          change.
+ *
+ * @param   pRec - reporting record
+ * @param   pValue - current value
+ *
+ * @return  TRUE if the value is to be reported
+ */
+static uint8 zclReportChanged( zclReportRec_t *pRec, uint8 *pValue )
+{
+  uint32 cur, last, change, delta;
+  uint8 isSigned = FALSE;
+
+  switch ( pRec->dataType )
+  {
+    case ZCL_DATATYPE_INT8:
+    case ZCL_DATATYPE_INT16:
+    case ZCL_DATATYPE_INT24:
+    case ZCL_DATATYPE_INT32:
+      isSigned = TRUE;
+      // Fall through
+
+    case ZCL_DATATYPE_UINT8:
+    case ZCL_DATATYPE_UINT16:
+    case ZCL_DATATYPE_UINT24:
+    case ZCL_DATATYPE_UINT32:
+    case ZCL_DATATYPE_UTC:
+      cur = zclReportGetValue( pRec->dataType, pValue );
+      last = zclReportGetValue( pRec->dataType, pRec->lastValue );
+      change = zclReportGetValue( pRec->dataType, pRec->change );
+
+      if ( isSigned && ( (int32)change < 0 ) )
+      {
+        change = (uint32)( -(int32)change );
+      }
+
+      if ( isSigned ? ( (int32)cur > (int32)last ) : ( cur > last ) )
+      {
+        delta = cur - last;
+      }
+      else
+      {
+        delta = last - cur;
+      }
+
+      return ( ( delta != 0 ) && ( delta >= change ) );
+
+    case ZCL_DATATYPE_SINGLE_PREC:
+      {
+        float fDelta = *((float *)pValue) - *((float *)pRec->lastValue);
+        float fChange = *((float *)pRec->change);
+
+        if ( fDelta < 0 )
+        {
+          fDelta = -fDelta;
+        }
+        if ( fChange < 0 )
+        {
+          fChange = -fChange;
+        }
+
+        return ( ( fDelta != 0 ) && ( fDelta >= fChange ) );
+      }
+
+    default:
+      return ( !osal_memcmp( pValue, pRec->lastValue, zclReportValueLen( pRec->dataType ) ) );
+  }
+}
+
+/*********************************************************************
+ * @fn      zclReportSend
+ *
+ * @brief   Send the due attributes, one Report Attributes frame per
+ *          endpoint and cluster, to the bound devices or the address
+ *          given to zclReport_SetDstAddr(). An attribute that is no
+ *          longer registered stops being reported.
+ *
+ * @param   now - current system clock
+ *
+ * @return  none
+ */
+static void zclReportSend( uint32 now )
+{
+  zclReportCmd_t *reportCmd;
+  zclReportRec_t *pRec;
+  zclReportRec_t *pFirst;
+  uint16 clusterID;
+  zclAttrRec_t attrRec;
+  afAddrType_t dstAddr;
+  uint8 endpoint;
+  uint8 i, j, n;
+
+  for ( i = 0; i < ZCL_REPORT_MAX_ATTRS; i++ )
+  {
+    pFirst = &(zclReportRecs[i]);
+    if ( ( pFirst->endpoint == 0 ) || !( pFirst->flags & ZCL_REPORT_DUE ) )
+    {
+      continue;
+    }
+
+    // The first record may be dropped below
+    endpoint = pFirst->endpoint;
+    clusterID = pFirst->clusterID;
+
+    // Count the due attributes of the same endpoint and cluster
+    for ( j = i, n = 0; j < ZCL_REPORT_MAX_ATTRS; j++ )
+    {
+      pRec = &(zclReportRecs[j]);
+      if ( ( pRec->flags & ZCL_REPORT_DUE ) && ( pRec->endpoint == endpoint ) &&
+           ( pRec->clusterID == clusterID ) )
+      {
+        n++;
+      }
+    }
+
+    reportCmd = (zclReportCmd_t *)osal_mem_alloc( sizeof( zclReportCmd_t ) + n * sizeof( zclReport_t ) );
+    if ( reportCmd == NULL )
+    {
+      return; // Retried by zclReportSchedule()
+    }
+
+    reportCmd->numAttr = 0;
+    for ( j = i; j < ZCL_REPORT_MAX_ATTRS; j++ )
+    {
+      pRec = &(zclReportRecs[j]);
+      if ( !( pRec->flags & ZCL_REPORT_DUE ) || ( pRec->endpoint != endpoint ) ||
+           ( pRec->clusterID != clusterID ) )
+      {
+        continue;
+      }
+
+      pRec->flags &= ~( ZCL_REPORT_DUE | ZCL_REPORT_CHANGED );
+
+      if ( !zclFindAttrRec( pRec->endpoint, pRec->clusterID, pRec->attrID, &attrRec ) )
+      {
+        pRec->endpoint = 0;
+      }
+      else
+      {
+        pRec->lastTime = now;
+        osal_memcpy( pRec->lastValue, attrRec.attr.dataPtr, zclReportValueLen( pRec->dataType ) );
+
+        reportCmd->attrList[reportCmd->numAttr].attrID = pRec->attrID;
+        reportCmd->attrList[reportCmd->numAttr].dataType = pRec->dataType;
+        reportCmd->attrList[reportCmd->numAttr].attrData = pRec->lastValue;
+        reportCmd->numAttr++;
+      }
+    }
+
+    if ( reportCmd->numAttr != 0 )
+    {
+      // AF_DataRequest() may change the address mode it is given
+      dstAddr = zclReportDstAddr;
+      zcl_SendReportCmd( endpoint, &dstAddr, clusterID, reportCmd,
+                         ZCL_FRAME_SERVER_CLIENT_DIR, TRUE, zclReportSeqNum++ );
+    }
+
+    osal_mem_free( reportCmd );
+  }
+}
+
+/*********************************************************************
+ * @fn      zclReportSchedule
+ *
+ * @brief   Start the shared timer for the earliest deadline: the end
+ *          of the minimum interval of a pending change, or the end of
+ *          a maximum interval. The timer is stopped if there is none.
+ *
+ * @param   now - current system clock
+ *
+ * @return  none
+ */
+static void zclReportSchedule( uint32 now )
+{
+  zclReportRec_t *pRec;
+  uint32 next = 0xFFFFFFFF;
+  uint32 elapsed;
+  uint32 wait;
+  uint8 i;
+
+  for ( i = 0; i < ZCL_REPORT_MAX_ATTRS; i++ )
+  {
+    pRec = &(zclReportRecs[i]);
+    if ( pRec->endpoint == 0 )
+    {
+      continue;
+    }
+
+    elapsed = now - pRec->lastTime;
+
+    if ( pRec->flags & ZCL_REPORT_DUE )
+    {
+      wait = ZCL_REPORT_RETRY_DELAY;
+      if ( wait < next )
+      {
+        next = wait;
+      }
+    }
+
+    if ( ( pRec->flags & ZCL_REPORT_CHANGED ) && ( elapsed < ZCL_REPORT_MS( pRec->minReportInt ) ) )
+    {
+      wait = ZCL_REPORT_MS( pRec->minReportInt ) - elapsed;
+      if ( wait < next )
+      {
+        next = wait;
+      }
+    }
+
+    if ( ( pRec->maxReportInt != ZCL_REPORT_NO_PERIODIC ) &&
+         ( elapsed < ZCL_REPORT_MS( pRec->maxReportInt ) ) )
+    {
+      wait = ZCL_REPORT_MS( pRec->maxReportInt ) - elapsed;
+      if ( wait < next )
+      {
+        next = wait;
+      }
+    }
+  }
+
+  if ( next == 0xFFFFFFFF )
+  {
+    osal_stop_timerEx( zclReportTaskID, zclReportEvent );
+  }
+  else
+  {
+    // Longer waits are cut into timer sized pieces
+    osal_start_timerEx( zclReportTaskID, zclReportEvent,
+                        (uint16)( ( next > 0xFFFF ) ? 0xFFFF : next ) );
+  }
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,132 @@
+/**************************************************************************************************
+  Filename:       zcl_report.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    ZCL attribute reporting engine: configure reporting state
+                  per attribute, min/max interval and reportable change
+                  evaluation on one shared timer.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef ZCL_REPORT_H
+#define ZCL_REPORT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "zcl.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Number of attributes that can be configured for reporting
+#if !defined ( ZCL_REPORT_MAX_ATTRS )
+  #define ZCL_REPORT_MAX_ATTRS      8
+#endif
+
+// Largest attribute value kept by the engine, in octets. Reportable
+// attributes must be of a fixed length type no longer than this.
+#define ZCL_REPORT_VALUE_LEN        4
+
+// Maximum reporting interval values
+#define ZCL_REPORT_NO_PERIODIC      0x0000  // report on change only
+#define ZCL_REPORT_STOP             0xFFFF  // stop reporting the attribute
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*********************************************************************
+ * VARIABLES
+ */
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Initialize the engine with the task and event of its shared timer
+ */
+extern void zclReport_Init( uint8 taskId, uint16 event );
+
+/*
+ * Send the reports to one device, NULL to send them through the binding table
+ */
+extern void zclReport_SetDstAddr( afAddrType_t *pDstAddr );
+
+/*
+ * Call when the event given to zclReport_Init() is set
+ */
+extern void zclReport_ProcessEvent( void );
+
+/*
+ * Configure, reconfigure or stop (maxReportInt of ZCL_REPORT_STOP) the
+ * reports of an attribute. Returns a ZCL status.
+ *
+ *   e.g. report the temperature each 5 min, or after 0.50 C of change
+ *        but not more often than each 10 s:
+ *        { ZCL_SEND_ATTR_REPORTS, ATTRID_MS_TEMPERATURE_MEASURED_VALUE,
+ *          ZCL_DATATYPE_INT16, 10, 300, 0, &change } with int16 change = 50
+ */
+extern uint8 zclReport_Configure( uint8 endpoint, uint16 clusterID, zclCfgReportRec_t *pCfg );
+
+/*
+ * Tell the engine the value of an attribute was changed by the application
+ */
+extern void zclReport_AttrChanged( uint8 endpoint, uint16 clusterID, uint16 attrID );
+
+/*
+ * Foundation command processors, used by zcl.c with ZCL_REPORT_ENGINE
+ */
+extern uint8 zclReport_ProcessInConfigReportCmd( zclIncoming_t *pInMsg );
+extern uint8 zclReport_ProcessInReadReportCfgCmd( zclIncoming_t *pInMsg );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZCL_REPORT_H */
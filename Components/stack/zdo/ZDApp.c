@@ -503,7 +503,7 @@ UINT16 ZDApp_ProcessSecEvent( uint8 task_id, UINT16 events )
       // process the new device event
       if ( ZDSecMgrNewDeviceEvent() == TRUE )
       {
-        osal_start_timerEx( ZDAppTaskID, ZDO_NEW_DEVICE, 1000 );
+        osal_start_timerEx( ZDAppTaskID, ZDO_NEW_DEVICE, ZDSECMGR_NEW_DEVICE_DELAY );
       }
 
       // Return unprocessed events
@@ -426,7 +426,8 @@ static void zdoSendStateChangeMsg(uint8 state, uint8 taskId)
       pMsg->event = ZDO_STATE_CHANGE;
       pMsg->status = state;
 
-      (void)osal_msg_send(taskId, (uint8 *)pMsg);
+      // Ahead of any queued data, so the task acts on the new state first.
+      (void)osal_msg_send_urgent(taskId, (uint8 *)pMsg);
     }
   }
   else
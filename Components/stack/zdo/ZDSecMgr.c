@@ -95,6 +95,45 @@ extern "C"
   #error "ZDSECMGR_TC_DEVICE_MAX shall be between 1 and 255 !"
 #endif
 
+// hash the entry table by address index and EXT address
+#if !defined ( ZDSECMGR_ENTRY_HASH )
+  #define ZDSECMGR_ENTRY_HASH TRUE
+#endif
+
+// number of hash buckets, a power of two
+#if !defined ( ZDSECMGR_HASH_SIZE )
+  #define ZDSECMGR_HASH_SIZE 8
+#endif
+
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  #if ( ZDSECMGR_ENTRY_MAX > 254 )
+    #error "ZDSECMGR_DEVICE_MAX shall be below 255 with ZDSECMGR_ENTRY_HASH !"
+  #endif
+  #if ( ZDSECMGR_HASH_SIZE < 1 ) || ( ZDSECMGR_HASH_SIZE > 128 ) || \
+      ( ( ZDSECMGR_HASH_SIZE & ( ZDSECMGR_HASH_SIZE - 1 ) ) != 0 )
+    #error "ZDSECMGR_HASH_SIZE shall be a power of 2 between 1 and 128 !"
+  #endif
+#endif
+
+#define ZDSECMGR_HASH_NONE       0xFF
+#define ZDSECMGR_AMI_HASH( ami ) ( (uint8)(ami) & ( ZDSECMGR_HASH_SIZE - 1 ) )
+
+// maximum number of joining devices waiting for key transport
+#if !defined ( ZDSECMGR_JOIN_QUEUE_MAX )
+  #define ZDSECMGR_JOIN_QUEUE_MAX 8
+#endif
+
+// key transport attempts to a queued device before it is dropped
+#if !defined ( ZDSECMGR_JOIN_RETRY_MAX )
+  #define ZDSECMGR_JOIN_RETRY_MAX 3
+#endif
+
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+  #if ( ZDSECMGR_JOIN_QUEUE_MAX < 1 ) || ( ZDSECMGR_JOIN_QUEUE_MAX > 255 )
+    #error "ZDSECMGR_JOIN_QUEUE_MAX shall be between 1 and 255 !"
+  #endif
+#endif
+
 #define ZDSECMGR_CTRL_NONE       0
 #define ZDSECMGR_CTRL_INIT       1
 #define ZDSECMGR_CTRL_TK_MASTER  2
@@ -159,6 +198,16 @@ typedef struct
   ZDSecMgrCtrl_t* ctrl;
 } ZDSecMgrDevice_t;
 
+typedef struct
+{
+  uint8  extAddr[Z_EXTADDR_LEN];
+  uint16 nwkAddr;
+  uint16 parentAddr;
+  uint8  secure;
+  uint8  devStatus;
+  uint8  retries;
+} ZDSecMgrJoin_t;
+
 /******************************************************************************
  * LOCAL VARIABLES
  */
@@ -226,6 +275,22 @@ const ZDSecMgrPreConfigData_t ZDSecMgrPreConfigData[ZDSECMGR_PRECONFIG_MAX] =
 
 ZDSecMgrEntry_t* ZDSecMgrEntries  = NULL;
 ZDSecMgrCtrl_t*  ZDSecMgrCtrlData = NULL;
+
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+// entry positions chained by address index hash and by EXT address hash
+static uint8 ZDSecMgrAmiHead[ZDSECMGR_HASH_SIZE];
+static uint8 ZDSecMgrExtHead[ZDSECMGR_HASH_SIZE];
+static uint8 ZDSecMgrAmiNext[ZDSECMGR_ENTRY_MAX];
+static uint8 ZDSecMgrExtNext[ZDSECMGR_ENTRY_MAX];
+static uint8 ZDSecMgrExtBkt[ZDSECMGR_ENTRY_MAX];  // EXT chain of the entry
+static uint8 ZDSecMgrExtKey[ZDSECMGR_ENTRY_MAX];  // EXT address hash of the entry
+#endif
+
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+// joining devices waiting for key transport, in arrival order
+static ZDSecMgrJoin_t ZDSecMgrJoinQueue[ZDSECMGR_JOIN_QUEUE_MAX];
+static uint8          ZDSecMgrJoinCnt = 0;
+#endif
 void ZDSecMgrAddrMgrUpdate( uint16 ami, uint16 nwkAddr );
 void ZDSecMgrAddrMgrCB( uint8 update, AddrMgrEntry_t* newEntry, AddrMgrEntry_t* oldEntry );
 
@@ -253,6 +318,12 @@ APSME_TCLinkKeyFrmCntr_t TCLinkKeyFrmCntr[ZDSECMGR_TC_DEVICE_MAX];
  *   ZDSecMgrEntryLookupExtGetIndex
  *   ZDSecMgrEntryFree
  *   ZDSecMgrEntryNew
+ *   ZDSecMgrEntryAMISet
+ *   ZDSecMgrEntryHashInit
+ *   ZDSecMgrEntryHashAdd
+ *   ZDSecMgrEntryHashRemove
+ *   ZDSecMgrEntryHashAMI
+ *   ZDSecMgrEntryHashExt
  *   ZDSecMgrCtrlInit
  *   ZDSecMgrCtrlRelease
  *   ZDSecMgrCtrlLookup
@@ -275,8 +346,14 @@ APSME_TCLinkKeyFrmCntr_t TCLinkKeyFrmCntr[ZDSECMGR_TC_DEVICE_MAX];
  *   ZDSecMgrDeviceValidateSKKE
  *   ZDSecMgrDeviceValidateRM
  *   ZDSecMgrDeviceValidateCM
+ *   ZDSecMgrDeviceValidatePolicy
  *   ZDSecMgrDeviceValidate
+ *   ZDSecMgrDeviceAdmit
  *   ZDSecMgrDeviceJoin
+ *   ZDSecMgrJoinQueueFind
+ *   ZDSecMgrJoinQueueAdd
+ *   ZDSecMgrJoinQueueRemove
+ *   ZDSecMgrJoinService
  *   ZDSecMgrDeviceJoinDirect
  *   ZDSecMgrDeviceJoinFwd
  *   ZDSecMgrDeviceNew
@@ -314,6 +391,14 @@ ZStatus_t ZDSecMgrEntryLookupExt( uint8* extAddr, ZDSecMgrEntry_t** entry );
 ZStatus_t ZDSecMgrEntryLookupExtGetIndex( uint8* extAddr, ZDSecMgrEntry_t** entry, uint16* entryIndex );
 void ZDSecMgrEntryFree( ZDSecMgrEntry_t* entry );
 ZStatus_t ZDSecMgrEntryNew( ZDSecMgrEntry_t** entry );
+void ZDSecMgrEntryAMISet( ZDSecMgrEntry_t* entry, uint16 ami );
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+static void ZDSecMgrEntryHashInit( void );
+static void ZDSecMgrEntryHashAdd( uint8 index );
+static void ZDSecMgrEntryHashRemove( uint8 index );
+static ZDSecMgrEntry_t* ZDSecMgrEntryHashAMI( uint16 ami );
+static ZDSecMgrEntry_t* ZDSecMgrEntryHashExt( uint8* extAddr );
+#endif
 ZStatus_t ZDSecMgrAuthenticationSet( uint8* extAddr, ZDSecMgr_Authentication_Option option );
 void ZDSecMgrApsLinkKeyInit(void);
 #if defined NV_RESTORE
@@ -371,8 +456,16 @@ void ZDSecMgrDeviceRemove( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceValidateSKKE( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceValidateRM( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceValidateCM( ZDSecMgrDevice_t* device );
+ZStatus_t ZDSecMgrDeviceValidatePolicy( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceValidate( ZDSecMgrDevice_t* device );
+ZStatus_t ZDSecMgrDeviceAdmit( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceJoin( ZDSecMgrDevice_t* device );
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+static uint8 ZDSecMgrJoinQueueFind( uint8* extAddr );
+static ZStatus_t ZDSecMgrJoinQueueAdd( ZDSecMgrDevice_t* device );
+static void ZDSecMgrJoinQueueRemove( uint8 index );
+static void ZDSecMgrJoinService( void );
+#endif
 ZStatus_t ZDSecMgrDeviceJoinDirect( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceJoinFwd( ZDSecMgrDevice_t* device );
 ZStatus_t ZDSecMgrDeviceNew( ZDSecMgrDevice_t* device );
@@ -514,6 +607,16 @@ ZStatus_t ZDSecMgrExtAddrLookup( uint8* extAddr, uint16* ami )
   ZStatus_t      status;
   AddrMgrEntry_t entry;
 
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  ZDSecMgrEntry_t* secEntry;
+
+  // devices with a security entry don't need the address manager search
+  if ( ( secEntry = ZDSecMgrEntryHashExt( extAddr ) ) != NULL )
+  {
+    *ami = secEntry->ami;
+    return ZSuccess;
+  }
+#endif
 
   // lookup entry
   entry.user = ADDRMGR_USER_SECURITY;
@@ -667,6 +770,11 @@ void ZDSecMgrEntryInit(uint8 state)
 #else
   (void)state;
 #endif
+
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  // index whatever the table holds now
+  ZDSecMgrEntryHashInit();
+#endif
 }
 
 /******************************************************************************
@@ -681,7 +789,9 @@ void ZDSecMgrEntryInit(uint8 state)
  */
 ZStatus_t ZDSecMgrEntryLookup( uint16 nwkAddr, ZDSecMgrEntry_t** entry )
 {
+#if ( ZDSECMGR_ENTRY_HASH != TRUE )
   uint16         index;
+#endif
   AddrMgrEntry_t addrMgrEntry;
 
   // initialize results
@@ -695,6 +805,9 @@ ZStatus_t ZDSecMgrEntryLookup( uint16 nwkAddr, ZDSecMgrEntry_t** entry )
 
     if ( AddrMgrEntryLookupNwk( &addrMgrEntry ) == TRUE )
     {
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+      return ZDSecMgrEntryLookupAMI( addrMgrEntry.index, entry );
+#else
       for ( index = 0; index < ZDSECMGR_ENTRY_MAX ; index++ )
       {
         if ( addrMgrEntry.index == ZDSecMgrEntries[index].ami )
@@ -706,6 +819,7 @@ ZStatus_t ZDSecMgrEntryLookup( uint16 nwkAddr, ZDSecMgrEntry_t** entry )
           return ZSuccess;
         }
       }
+#endif
     }
   }
 
@@ -732,6 +846,16 @@ ZStatus_t ZDSecMgrEntryLookupAMI( uint16 ami, ZDSecMgrEntry_t** entry )
   // verify data is available
   if ( ZDSecMgrEntries != NULL )
   {
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+    // only assigned entries are hashed; INVALID_NODE_ADDR still finds a free one
+    if ( ami != INVALID_NODE_ADDR )
+    {
+      *entry = ZDSecMgrEntryHashAMI( ami );
+
+      return ( *entry != NULL ) ? ZSuccess : ZNwkUnknownDevice;
+    }
+#endif
+
     for ( index = 0; index < ZDSECMGR_ENTRY_MAX ; index++ )
     {
       if ( ZDSecMgrEntries[index].ami == ami )
@@ -767,6 +891,14 @@ ZStatus_t ZDSecMgrEntryLookupExt( uint8* extAddr, ZDSecMgrEntry_t** entry )
   *entry = NULL;
   status = ZNwkUnknownDevice;
 
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  // the EXT address chain holds every entry whose address was known when added
+  if ( ( *entry = ZDSecMgrEntryHashExt( extAddr ) ) != NULL )
+  {
+    return ZSuccess;
+  }
+#endif
+
   // lookup address index
   if ( ZDSecMgrExtAddrLookup( extAddr, &ami ) == ZSuccess )
   {
@@ -788,6 +920,18 @@ ZStatus_t ZDSecMgrEntryLookupExt( uint8* extAddr, ZDSecMgrEntry_t** entry )
  */
 ZStatus_t ZDSecMgrEntryLookupExtGetIndex( uint8* extAddr, ZDSecMgrEntry_t** entry, uint16* entryIndex )
 {
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  ZDSecMgrEntry_t* found;
+
+  if ( ZDSecMgrEntryLookupExt( extAddr, &found ) == ZSuccess )
+  {
+    // return successful results
+    *entry = found;
+    *entryIndex = (uint16)( found - ZDSecMgrEntries );
+
+    return ZSuccess;
+  }
+#else
   uint16 ami;
   uint16 index;
 
@@ -811,6 +955,7 @@ ZStatus_t ZDSecMgrEntryLookupExtGetIndex( uint8* extAddr, ZDSecMgrEntry_t** entr
       }
     }
   }
+#endif
 
   return ZNwkUnknownDevice;
 }
@@ -845,7 +990,7 @@ void ZDSecMgrEntryFree( ZDSecMgrEntry_t* entry )
   }
 
   // marking the entry as INVALID_NODE_ADDR
-  entry->ami = INVALID_NODE_ADDR;
+  ZDSecMgrEntryAMISet( entry, INVALID_NODE_ADDR );
 }
 
 /******************************************************************************
@@ -887,6 +1032,240 @@ ZStatus_t ZDSecMgrEntryNew( ZDSecMgrEntry_t** entry )
   return ZNwkUnknownDevice;
 }
 
+/******************************************************************************
+ * @fn          ZDSecMgrEntryAMISet
+ *
+ * @brief       Assign an address index to an entry, or INVALID_NODE_ADDR to
+ *              release it, keeping the entry hash up to date.
+ *
+ * @param       entry - [in] valid entry
+ * @param       ami   - [in] Address Manager index
+ *
+ * @return      none
+ */
+void ZDSecMgrEntryAMISet( ZDSecMgrEntry_t* entry, uint16 ami )
+{
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  uint8 index = (uint8)( entry - ZDSecMgrEntries );
+
+  if ( entry->ami != INVALID_NODE_ADDR )
+  {
+    ZDSecMgrEntryHashRemove( index );
+  }
+
+  entry->ami = ami;
+
+  if ( ami != INVALID_NODE_ADDR )
+  {
+    ZDSecMgrEntryHashAdd( index );
+  }
+#else
+  entry->ami = ami;
+#endif
+}
+
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+/******************************************************************************
+ * @fn          ZDSecMgrExtHash
+ *
+ * @brief       Hash of an EXT address. The low bits pick the bucket, the
+ *              whole byte screens the entries of the bucket.
+ *
+ * @param       extAddr - [in] EXT address
+ *
+ * @return      hash
+ */
+static uint8 ZDSecMgrExtHash( uint8* extAddr )
+{
+  uint8 hash = 0;
+  uint8 x;
+
+  for ( x = 0; x < Z_EXTADDR_LEN; x++ )
+  {
+    hash ^= extAddr[x];
+  }
+
+  return hash;
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrHashUnlink
+ *
+ * @brief       Remove an entry position from a hash chain.
+ *
+ * @param       head  - [in] chain head
+ * @param       next  - [in] chain links
+ * @param       index - [in] entry position
+ *
+ * @return      none
+ */
+static void ZDSecMgrHashUnlink( uint8* head, uint8* next, uint8 index )
+{
+  while ( *head != ZDSECMGR_HASH_NONE )
+  {
+    if ( *head == index )
+    {
+      *head = next[index];
+      return;
+    }
+
+    head = &next[*head];
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrEntryHashInit
+ *
+ * @brief       Rebuild the entry hash from the entry table.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+static void ZDSecMgrEntryHashInit( void )
+{
+  uint8 index;
+
+  osal_memset( ZDSecMgrAmiHead, ZDSECMGR_HASH_NONE, ZDSECMGR_HASH_SIZE );
+  osal_memset( ZDSecMgrExtHead, ZDSECMGR_HASH_NONE, ZDSECMGR_HASH_SIZE );
+
+  if ( ZDSecMgrEntries != NULL )
+  {
+    for ( index = 0; index < ZDSECMGR_ENTRY_MAX; index++ )
+    {
+      if ( ZDSecMgrEntries[index].ami != INVALID_NODE_ADDR )
+      {
+        ZDSecMgrEntryHashAdd( index );
+      }
+    }
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrEntryHashAdd
+ *
+ * @brief       Hash an entry by its address index and, when the Address
+ *              Manager knows it, by its EXT address.
+ *
+ * @param       index - [in] entry position
+ *
+ * @return      none
+ */
+static void ZDSecMgrEntryHashAdd( uint8 index )
+{
+  AddrMgrEntry_t addrEntry;
+  uint8          bkt;
+
+  bkt = ZDSECMGR_AMI_HASH( ZDSecMgrEntries[index].ami );
+  ZDSecMgrAmiNext[index] = ZDSecMgrAmiHead[bkt];
+  ZDSecMgrAmiHead[bkt] = index;
+
+  ZDSecMgrExtBkt[index] = ZDSECMGR_HASH_NONE;
+
+  addrEntry.user  = ADDRMGR_USER_SECURITY;
+  addrEntry.index = ZDSecMgrEntries[index].ami;
+
+  if ( AddrMgrEntryGet( &addrEntry ) == TRUE )
+  {
+    ZDSecMgrExtKey[index] = ZDSecMgrExtHash( addrEntry.extAddr );
+    bkt = ZDSecMgrExtKey[index] & ( ZDSECMGR_HASH_SIZE - 1 );
+    ZDSecMgrExtNext[index] = ZDSecMgrExtHead[bkt];
+    ZDSecMgrExtHead[bkt] = index;
+    ZDSecMgrExtBkt[index] = bkt;
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrEntryHashRemove
+ *
+ * @brief       Take an entry out of the hash chains.
+ *
+ * @param       index - [in] entry position
+ *
+ * @return      none
+ */
+static void ZDSecMgrEntryHashRemove( uint8 index )
+{
+  ZDSecMgrHashUnlink( &ZDSecMgrAmiHead[ZDSECMGR_AMI_HASH( ZDSecMgrEntries[index].ami )],
+                      ZDSecMgrAmiNext, index );
+
+  if ( ZDSecMgrExtBkt[index] != ZDSECMGR_HASH_NONE )
+  {
+    ZDSecMgrHashUnlink( &ZDSecMgrExtHead[ZDSecMgrExtBkt[index]], ZDSecMgrExtNext, index );
+    ZDSecMgrExtBkt[index] = ZDSECMGR_HASH_NONE;
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrEntryHashAMI
+ *
+ * @brief       Lookup entry by address index in the entry hash.
+ *
+ * @param       ami - [in] Address Manager index
+ *
+ * @return      entry, NULL if none
+ */
+static ZDSecMgrEntry_t* ZDSecMgrEntryHashAMI( uint16 ami )
+{
+  uint8 index = ZDSecMgrAmiHead[ZDSECMGR_AMI_HASH( ami )];
+
+  while ( index != ZDSECMGR_HASH_NONE )
+  {
+    if ( ZDSecMgrEntries[index].ami == ami )
+    {
+      return &ZDSecMgrEntries[index];
+    }
+
+    index = ZDSecMgrAmiNext[index];
+  }
+
+  return NULL;
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrEntryHashExt
+ *
+ * @brief       Lookup entry by EXT address in the entry hash. Candidates are
+ *              checked against the Address Manager, so a stale chain only
+ *              costs a miss. Only candidates with the same hash byte are
+ *              read from the Address Manager.
+ *
+ * @param       extAddr - [in] EXT address
+ *
+ * @return      entry, NULL if none
+ */
+static ZDSecMgrEntry_t* ZDSecMgrEntryHashExt( uint8* extAddr )
+{
+  AddrMgrEntry_t addrEntry;
+  uint8          index;
+  uint8          key;
+
+  if ( ZDSecMgrEntries == NULL )
+  {
+    return NULL;
+  }
+
+  addrEntry.user = ADDRMGR_USER_SECURITY;
+  key = ZDSecMgrExtHash( extAddr );
+  index = ZDSecMgrExtHead[key & ( ZDSECMGR_HASH_SIZE - 1 )];
+
+  while ( index != ZDSECMGR_HASH_NONE )
+  {
+    addrEntry.index = ZDSecMgrEntries[index].ami;
+
+    if ( ( ZDSecMgrExtKey[index] == key                              ) &&
+         ( AddrMgrEntryGet( &addrEntry ) == TRUE                     ) &&
+         ( AddrMgrExtAddrEqual( addrEntry.extAddr, extAddr ) == TRUE ) )   {
+      return &ZDSecMgrEntries[index];
+    }
+
+    index = ZDSecMgrExtNext[index];
+  }
+
+  return NULL;
+}
+#endif // ( ZDSECMGR_ENTRY_HASH == TRUE )
+
 /******************************************************************************
  * @fn          ZDSecMgrCtrlInit
  *
@@ -1543,7 +1922,7 @@ ZStatus_t ZDSecMgrDeviceEntryAdd( ZDSecMgrDevice_t* device, uint16 ami )
       // reset entry lkd
 
       // finish setting up entry
-      entry->ami = ami;
+      ZDSecMgrEntryAMISet( entry, ami );
 
       // update NWK address
       ZDSecMgrAddrMgrUpdate( ami, device->nwkAddr );
@@ -1920,6 +2299,45 @@ ZStatus_t ZDSecMgrDeviceValidateCM( ZDSecMgrDevice_t* device )
   return status;
 }
 
+/******************************************************************************
+ * @fn          ZDSecMgrDeviceValidatePolicy
+ *
+ * @brief       Decide whether device is allowed by the security mode, once
+ *              joining is known to be permitted.
+ *
+ * @param       device - [in] ZDSecMgrDevice_t, device info
+ *
+ * @return      ZStatus_t
+ */
+ZStatus_t ZDSecMgrDeviceValidatePolicy( ZDSecMgrDevice_t* device )
+{
+  ZStatus_t status;
+
+
+  // device may be joining with a secure flag but it is ultimately the Trust
+  // Center that decides -- check if expected pre configured device --
+  // override settings
+  if ( zgPreConfigKeys == TRUE )
+  {
+    device->secure = TRUE;
+  }
+  else
+  {
+    device->secure = FALSE;
+  }
+
+  if ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_PRO_HIGH )
+  {
+    status = ZDSecMgrDeviceValidateCM( device );
+  }
+  else // ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_RESIDENTIAL )
+  {
+    status = ZDSecMgrDeviceValidateRM( device );
+  }
+
+  return status;
+}
+
 /******************************************************************************
  * @fn          ZDSecMgrDeviceValidate
  *
@@ -1936,26 +2354,7 @@ ZStatus_t ZDSecMgrDeviceValidate( ZDSecMgrDevice_t* device )
 
   if ( ZDSecMgrPermitJoiningEnabled == TRUE )
   {
-    // device may be joining with a secure flag but it is ultimately the Trust
-    // Center that decides -- check if expected pre configured device --
-    // override settings
-    if ( zgPreConfigKeys == TRUE )
-    {
-      device->secure = TRUE;
-    }
-    else
-    {
-      device->secure = FALSE;
-    }
-
-    if ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_PRO_HIGH )
-    {
-      status = ZDSecMgrDeviceValidateCM( device );
-    }
-    else // ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_RESIDENTIAL )
-    {
-      status = ZDSecMgrDeviceValidateRM( device );
-    }
+    status = ZDSecMgrDeviceValidatePolicy( device );
   }
   else
   {
@@ -1966,15 +2365,15 @@ ZStatus_t ZDSecMgrDeviceValidate( ZDSecMgrDevice_t* device )
 }
 
 /******************************************************************************
- * @fn          ZDSecMgrDeviceJoin
+ * @fn          ZDSecMgrDeviceAdmit
  *
- * @brief       Try to join this device.
+ * @brief       Validate this device and start its key transport now.
  *
  * @param       device - [in] ZDSecMgrDevice_t, device info
  *
  * @return      ZStatus_t
  */
-ZStatus_t ZDSecMgrDeviceJoin( ZDSecMgrDevice_t* device )
+ZStatus_t ZDSecMgrDeviceAdmit( ZDSecMgrDevice_t* device )
 {
   ZStatus_t status;
   uint16    ami;
@@ -2005,6 +2404,243 @@ ZStatus_t ZDSecMgrDeviceJoin( ZDSecMgrDevice_t* device )
   return status;
 }
 
+/******************************************************************************
+ * @fn          ZDSecMgrDeviceJoin
+ *
+ * @brief       Try to join this device. The Trust Center queues the device
+ *              and serves it from the ZDO_NEW_DEVICE event/timer. Joining
+ *              is checked here, a queued device is admitted even if the
+ *              permit joining window closes before it is served.
+ *
+ * @param       device - [in] ZDSecMgrDevice_t, device info
+ *
+ * @return      ZStatus_t - ZBufferFull if the join queue is full
+ */
+ZStatus_t ZDSecMgrDeviceJoin( ZDSecMgrDevice_t* device )
+{
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+  if ( ( ZG_BUILD_COORDINATOR_TYPE ) && ( ZG_DEVICE_COORDINATOR_TYPE ) )
+  {
+    // refused devices are removed right away
+    if ( ZDSecMgrPermitJoiningEnabled == TRUE )
+    {
+      return ZDSecMgrJoinQueueAdd( device );
+    }
+  }
+#endif
+
+  return ZDSecMgrDeviceAdmit( device );
+}
+
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+/******************************************************************************
+ * @fn          ZDSecMgrJoinQueueFind
+ *
+ * @brief       Find a device in the join queue.
+ *
+ * @param       extAddr - [in] EXT address
+ *
+ * @return      uint8 - queue position, ZDSecMgrJoinCnt if not queued
+ */
+static uint8 ZDSecMgrJoinQueueFind( uint8* extAddr )
+{
+  uint8 index;
+
+  for ( index = 0; index < ZDSecMgrJoinCnt; index++ )
+  {
+    if ( osal_memcmp( ZDSecMgrJoinQueue[index].extAddr,
+                      extAddr, Z_EXTADDR_LEN ) == TRUE )
+    {
+      break;
+    }
+  }
+
+  return index;
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrJoinQueueAdd
+ *
+ * @brief       Queue a joining device for key transport. A device already
+ *              queued has its request refreshed instead.
+ *
+ * @param       device - [in] ZDSecMgrDevice_t, device info
+ *
+ * @return      ZStatus_t - ZBufferFull if the queue is full
+ */
+static ZStatus_t ZDSecMgrJoinQueueAdd( ZDSecMgrDevice_t* device )
+{
+  ZDSecMgrJoin_t* join;
+  uint8           index;
+
+  // look for an earlier request from this device
+  index = ZDSecMgrJoinQueueFind( device->extAddr );
+
+  if ( index == ZDSecMgrJoinCnt )
+  {
+    if ( ZDSecMgrJoinCnt >= ZDSECMGR_JOIN_QUEUE_MAX )
+    {
+      return ZBufferFull;
+    }
+
+    osal_memcpy( ZDSecMgrJoinQueue[index].extAddr, device->extAddr,
+                 Z_EXTADDR_LEN );
+    ZDSecMgrJoinCnt++;
+
+    // start pacing when the queue fills from empty
+    if ( ZDSecMgrJoinCnt == 1 )
+    {
+      osal_start_timerEx( ZDAppTaskID, ZDO_NEW_DEVICE, ZDSECMGR_JOIN_PACE );
+    }
+  }
+
+  join = &ZDSecMgrJoinQueue[index];
+
+  join->nwkAddr    = device->nwkAddr;
+  join->parentAddr = device->parentAddr;
+  join->secure     = device->secure;
+  join->devStatus  = device->devStatus;
+  join->retries    = 0;
+
+  return ZSuccess;
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrJoinQueueRemove
+ *
+ * @brief       Remove a device from the join queue, keeping arrival order.
+ *
+ * @param       index - [in] queue position
+ *
+ * @return      none
+ */
+static void ZDSecMgrJoinQueueRemove( uint8 index )
+{
+  ZDSecMgrJoinCnt--;
+
+  for ( ; index < ZDSecMgrJoinCnt; index++ )
+  {
+    ZDSecMgrJoinQueue[index] = ZDSecMgrJoinQueue[index + 1];
+  }
+}
+
+/******************************************************************************
+ * @fn          ZDSecMgrJoinService
+ *
+ * @brief       Start key transport to one queued device. Rejoining devices
+ *              go first, they hold data buffered while they were offline.
+ *              A device whose NWK key could not be sent stays queued for
+ *              the next pace interval, and is removed when it runs out of
+ *              retries. A direct child is set authenticated once its key
+ *              transport has started.
+ *
+ * @param       none
+ *
+ * @return      none
+ */
+static void ZDSecMgrJoinService( void )
+{
+  ZDSecMgrDevice_t device;
+  ZDSecMgrJoin_t*  join;
+  ZStatus_t        status;
+  uint16           ami;
+  uint8            index;
+
+  if ( ZDSecMgrJoinCnt == 0 )
+  {
+    return;
+  }
+
+  if ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_PRO_HIGH )
+  {
+    // hold the queue until a device control slot is free
+    if ( ZDSecMgrCtrlData == NULL )
+    {
+      return;
+    }
+
+    for ( index = 0; index < ZDSECMGR_CTRL_MAX; index++ )
+    {
+      if ( ZDSecMgrCtrlData[index].state == ZDSECMGR_CTRL_NONE )
+      {
+        break;
+      }
+    }
+
+    if ( index == ZDSECMGR_CTRL_MAX )
+    {
+      return;
+    }
+  }
+
+  // oldest rejoining device, else the oldest device
+  for ( index = 0; index < ZDSecMgrJoinCnt; index++ )
+  {
+    if ( ZDSecMgrJoinQueue[index].devStatus & DEV_REJOIN_STATUS )
+    {
+      break;
+    }
+  }
+
+  if ( index == ZDSecMgrJoinCnt )
+  {
+    index = 0;
+  }
+
+  join = &ZDSecMgrJoinQueue[index];
+
+  device.nwkAddr    = join->nwkAddr;
+  device.extAddr    = join->extAddr;
+  device.parentAddr = join->parentAddr;
+  device.secure     = join->secure;
+  device.devStatus  = join->devStatus;
+  device.ctrl       = NULL;
+
+  // joining was permitted when the device was queued
+  status = ZDSecMgrDeviceValidatePolicy( &device );
+
+  if ( status == ZSuccess )
+  {
+    if ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_PRO_HIGH )
+    {
+      ZDSecMgrDeviceCtrlSetup( &device );
+    }
+    else // ( ZG_CHECK_SECURITY_MODE == ZG_SECURITY_RESIDENTIAL )
+    {
+      // Add the device to the address manager
+      ZDSecMgrAddrStore( device.nwkAddr, device.extAddr, &ami );
+
+      //send the nwk key data to the joining device
+      status = ZDSecMgrSendNwkKey( &device );
+
+      if ( status != ZSuccess )
+      {
+        if ( ++join->retries < ZDSECMGR_JOIN_RETRY_MAX )
+        {
+          return;
+        }
+
+        // out of retries, remove the device
+        ZDSecMgrDeviceRemove( &device );
+      }
+    }
+
+    if ( ( status == ZSuccess ) && ( device.parentAddr == NLME_GetShortAddr() ) )
+    {
+      // set association status to authenticated
+      ZDSecMgrAssocDeviceAuth( AssocGetWithShort( device.nwkAddr ) );
+    }
+  }
+  else
+  {
+    // not allowed, remove the device
+    ZDSecMgrDeviceRemove( &device );
+  }
+
+  ZDSecMgrJoinQueueRemove( index );
+}
+#endif // ( ZDSECMGR_JOIN_SCHED == TRUE )
+
 /******************************************************************************
  * @fn          ZDSecMgrDeviceJoinDirect
  *
@@ -2022,6 +2658,14 @@ ZStatus_t ZDSecMgrDeviceJoinDirect( ZDSecMgrDevice_t* device )
 
   if ( status == ZSuccess )
   {
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+    // a queued device is set authenticated when it is served
+    if ( ZDSecMgrJoinQueueFind( device->extAddr ) < ZDSecMgrJoinCnt )
+    {
+      return status;
+    }
+#endif
+
     // set association status to authenticated
     ZDSecMgrAssocDeviceAuth( AssocGetWithShort( device->nwkAddr ) );
   }
@@ -2224,8 +2868,22 @@ void ZDSecMgrAddrMgrCB( uint8           update,
                         AddrMgrEntry_t* newEntry,
                         AddrMgrEntry_t* oldEntry )
 {
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+  ZDSecMgrEntry_t* entry;
+  uint8            index;
+
+  // an entry whose EXT address changed moves to its new EXT chain
+  if ( ( update == ADDRMGR_ENTRY_EXTADDR_SET ) && ( ZDSecMgrEntries != NULL ) &&
+       ( ( entry = ZDSecMgrEntryHashAMI( newEntry->index ) ) != NULL ) )
+  {
+    index = (uint8)( entry - ZDSecMgrEntries );
+    ZDSecMgrEntryHashRemove( index );
+    ZDSecMgrEntryHashAdd( index );
+  }
+#else
   (void)update;
   (void)newEntry;
+#endif
   (void)oldEntry;
 }
 #endif // ( ADDRMGR_CALLBACK_ENABLED == 1 )
@@ -2387,11 +3045,11 @@ void ZDSecMgrPermitJoiningTimeout( void )
  * @fn          ZDSecMgrNewDeviceEvent
  *
  * @brief       Process a the new device event, if found reset new device
- *              event/timer.
+ *              event/timer. Also serves the join queue.
  *
  * @param       none
  *
- * @return      uint8 - found(TRUE:FALSE)
+ * @return      uint8 - found or queued(TRUE:FALSE)
  */
 uint8 ZDSecMgrNewDeviceEvent( void )
 {
@@ -2441,7 +3099,17 @@ uint8 ZDSecMgrNewDeviceEvent( void )
     {
       AssocRemove( addrEntry.extAddr );
     }
+    // ZBufferFull - keep security init status, retry on the next event
+  }
+
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+  ZDSecMgrJoinService();
+
+  if ( ZDSecMgrJoinCnt != 0 )
+  {
+    found = TRUE;
   }
+#endif
 
   return found;
 }
@@ -2802,7 +3470,7 @@ void ZDSecMgrTransportKeyInd( ZDO_TransportKeyInd_t* ind )
             if ( ZDSecMgrEntryNew( &entryZD ) == ZSuccess )
             {
               // finish setting up entry
-              entryZD->ami = ami;
+              ZDSecMgrEntryAMISet( entryZD, ami );
             }
           }
 
@@ -2850,7 +3518,7 @@ void ZDSecMgrTransportKeyInd( ZDO_TransportKeyInd_t* ind )
         if ( ZDSecMgrEntryNew( &entry ) == ZSuccess )
         {
           // finish setting up entry
-          entry->ami = ami;
+          ZDSecMgrEntryAMISet( entry, ami );
         }
       }
 
@@ -2879,6 +3547,17 @@ void ZDSecMgrUpdateDeviceInd( ZDO_UpdateDeviceInd_t* ind )
   device.nwkAddr    = ind->devAddr;
   device.extAddr    = ind->devExtAddr;
   device.parentAddr = ind->srcAddr;
+  device.secure     = FALSE;
+
+  if ( ( ind->status == APSME_UD_STANDARD_UNSECURED_JOIN ) ||
+       ( ind->status == APSME_UD_HIGH_UNSECURED_JOIN     )    )
+  {
+    device.devStatus = 0;
+  }
+  else
+  {
+    device.devStatus = DEV_REJOIN_STATUS;
+  }
 
   //if ( ( ind->status == APSME_UD_SECURED_JOIN   ) ||
   //     ( ind->status == APSME_UD_UNSECURED_JOIN )   )
@@ -2892,8 +3571,11 @@ void ZDSecMgrUpdateDeviceInd( ZDO_UpdateDeviceInd_t* ind )
   //    device.secure = FALSE;
   //  }
 
-    // try to join this device
-    ZDSecMgrDeviceJoin( &device );
+    // try to join this device, straight away if the join queue is full
+    if ( ZDSecMgrDeviceJoin( &device ) == ZBufferFull )
+    {
+      ZDSecMgrDeviceAdmit( &device );
+    }
   //}
 }
 
@@ -3568,7 +4250,7 @@ ZStatus_t ZDSecMgrAddLinkKey( uint16 shortAddr, uint8 *extAddr, uint8 *key)
   {
     if ( ZDSecMgrEntryNew( &entry ) == ZSuccess )
     {
-      entry->ami = ami;
+      ZDSecMgrEntryAMISet( entry, ami );
     }
     else
     {
@@ -3642,8 +4324,8 @@ static void ZDSecMgrWriteNV( void )
     {
       if ( ZDSecMgrEntries[i].ami != INVALID_NODE_ADDR )
       {
-        // Save off the record
-        osal_nv_write( ZCD_NV_APS_LINK_KEY_TABLE,
+        // Save off the record, coalesced with the others into a single NV write
+        osal_nv_write_back( ZCD_NV_APS_LINK_KEY_TABLE,
                 (uint16)((sizeof(nvDeviceListHdr_t)) + (hdr.numRecs * sizeof(ZDSecMgrEntry_t))),
                         sizeof(ZDSecMgrEntry_t), &ZDSecMgrEntries[i] );
         hdr.numRecs++;
@@ -3652,7 +4334,7 @@ static void ZDSecMgrWriteNV( void )
   }
 
   // Save off the header
-  osal_nv_write( ZCD_NV_APS_LINK_KEY_TABLE, 0, sizeof( nvDeviceListHdr_t ), &hdr );
+  osal_nv_write_back( ZCD_NV_APS_LINK_KEY_TABLE, 0, sizeof( nvDeviceListHdr_t ), &hdr );
 }
 #endif // NV_RESTORE
 
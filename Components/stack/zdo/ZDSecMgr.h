@@ -51,6 +51,26 @@ extern "C"
 #include "ZComDef.h"
 #include "ZDApp.h"
 
+/******************************************************************************
+ * CONSTANTS
+ */
+// queue joining devices on the Trust Center and pace their key transport
+#if !defined ( ZDSECMGR_JOIN_SCHED )
+  #define ZDSECMGR_JOIN_SCHED TRUE
+#endif
+
+// interval between key transports to queued devices (mSec)
+#if !defined ( ZDSECMGR_JOIN_PACE )
+  #define ZDSECMGR_JOIN_PACE 50
+#endif
+
+// ZDO_NEW_DEVICE event/timer restart interval (mSec)
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+  #define ZDSECMGR_NEW_DEVICE_DELAY ZDSECMGR_JOIN_PACE
+#else
+  #define ZDSECMGR_NEW_DEVICE_DELAY 1000
+#endif
+
 /******************************************************************************
  * TYPEDEFS
  */
@@ -116,11 +136,11 @@ extern void ZDSecMgrPermitJoiningTimeout( void );
  * @fn          ZDSecMgrNewDeviceEvent
  *
  * @brief       Process a the new device event, if found reset new device
- *              event/timer.
+ *              event/timer. Also serves the join queue.
  *
  * @param       none
  *
- * @return      uint8 - found(TRUE:FALSE)
+ * @return      uint8 - found or queued(TRUE:FALSE)
  */
 extern uint8 ZDSecMgrNewDeviceEvent( void );
 
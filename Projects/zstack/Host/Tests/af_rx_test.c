@@ -0,0 +1,356 @@
+/**************************************************************************************************
+  Filename:       af_rx_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Counts the allocations and payload copies afIncomingData() makes
+                  to deliver a frame to one or several endpoints, with and
+                  without afSetRxShared().
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "AF.h"
+#include "aps_groups.h"
+#include "aps_frag.h"
+#include "rtg.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_PROFILE_ID   0x0104
+#define OTHER_PROFILE_ID  0x0109
+#define TEST_GROUP_ID     0x0001
+
+#define TEST_EPS          4
+#define PAYLOAD_LEN       80
+
+/*********************************************************************
+ * MACROS
+ */
+// Heap blocks in use, the free ones are only merged on the next search
+#define HEAP_BLOCKS_USED()  ( osal_heap_block_cnt() - osal_heap_block_free() )
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 epTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { epTask_ProcessEvent, epTask_ProcessEvent,
+                                         epTask_ProcessEvent, epTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+APSF_SendFragmented_t *apsfSendFragmented;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 epTaskId[TEST_EPS];
+static SimpleDescriptionFormat_t epSimpleDesc[TEST_EPS];
+static endPointDesc_t epDescs[TEST_EPS];
+
+// Endpoints in TEST_GROUP_ID, in the order of the group table
+static const uint8 groupEps[] = { 2, 3 };
+
+static uint8 payload[PAYLOAD_LEN];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void deliver( uint8 dstEP, uint8 group, uint32 *blocks, uint32 *copies );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test, one task per endpoint.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      epTask_ProcessEvent
+ *
+ * @brief   The messages are collected by deliver(), not by the task.
+ */
+static uint16 epTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( events & SYS_EVENT_MSG );
+}
+
+/*********************************************************************
+ * Stubs of the network layers below AF.
+ */
+uint8 aps_FindGroupForEndpoint( uint16 groupID, uint8 lastEP )
+{
+  uint8 i;
+
+  if ( groupID != TEST_GROUP_ID )
+  {
+    return ( APS_GROUPS_EP_NOT_FOUND );
+  }
+
+  if ( lastEP == APS_GROUPS_FIND_FIRST )
+  {
+    return ( groupEps[0] );
+  }
+
+  for ( i = 0; i < (sizeof( groupEps ) - 1); i++ )
+  {
+    if ( groupEps[i] == lastEP )
+    {
+      return ( groupEps[i + 1] );
+    }
+  }
+
+  return ( APS_GROUPS_EP_NOT_FOUND );
+}
+
+ZStatus_t APSDE_DataReq( APSDE_DataReq_t *req )
+{
+  (void)req;
+  return ( ZSuccess );
+}
+
+uint8 APSDE_DataReqMTU( APSDE_DataReqMTU_t *fields )
+{
+  (void)fields;
+  return ( 80 );
+}
+
+uint16 NLME_GetShortAddr( void )
+{
+  return ( 0x0000 );
+}
+
+addr_filter_t NLME_IsAddressBroadcast( uint16 shortAddress )
+{
+  return ( (shortAddress >= 0xFFFC) ? ADDR_BCAST_FOR_ME : ADDR_NOT_BCAST );
+}
+
+RTG_Status_t RTG_CheckRtStatus( uint16 DstAddress, byte RtStatus, uint8 options )
+{
+  (void)DstAddress;
+  (void)RtStatus;
+  (void)options;
+  return ( RTG_SUCCESS );
+}
+
+RTG_Status_t RTG_AddSrcRtgEntry_Guaranteed( uint16 srcAddr, uint8 relayCnt,
+                                            uint16 *pRelayList )
+{
+  (void)srcAddr;
+  (void)relayCnt;
+  (void)pRelayList;
+  return ( RTG_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      deliver
+ *
+ * @brief   Pass one frame to afIncomingData(), check the message every
+ *          endpoint task got and release them.
+ *
+ * @param   dstEP - destination endpoint, AF_BROADCAST_ENDPOINT for all
+ * @param   group - TRUE to address the frame to TEST_GROUP_ID instead
+ * @param   blocks - returns the heap blocks the delivery allocated
+ * @param   copies - returns the number of copies of the payload
+ */
+static void deliver( uint8 dstEP, uint8 group, uint32 *blocks, uint32 *copies )
+{
+  aps_FrameFormat_t aff;
+  zAddrType_t srcAddr;
+  NLDE_Signal_t sig;
+  uint8 *data[TEST_EPS];
+  uint16 used;
+  uint16 cnt;
+  uint8 i, j;
+
+  osal_memset( &aff, 0, sizeof( aff ) );
+  aff.FrmCtrl = group ? APS_FC_DM_GROUP : 0;
+  aff.DstEndPoint = dstEP;
+  aff.SrcEndPoint = 1;
+  aff.GroupID = TEST_GROUP_ID;
+  aff.ClusterID = 0x0006;
+  aff.ProfileID = TEST_PROFILE_ID;
+  aff.asdu = payload;
+  aff.asduLength = PAYLOAD_LEN;
+  osal_memset( &srcAddr, 0, sizeof( srcAddr ) );
+  srcAddr.addrMode = afAddr16Bit;
+  srcAddr.addr.shortAddr = 0x1234;
+  osal_memset( &sig, 0, sizeof( sig ) );
+
+  cnt = HEAP_BLOCKS_USED();
+  used = osal_heap_mem_used();
+  afIncomingData( &aff, &srcAddr, 0xABCD, &sig, 0, FALSE, 0 );
+  *blocks = HEAP_BLOCKS_USED() - cnt;
+  *copies = 0;
+
+  for ( i = 0; i < TEST_EPS; i++ )
+  {
+    afIncomingMSGPacket_t *pkt;
+
+    data[i] = NULL;
+    pkt = (afIncomingMSGPacket_t *)osal_msg_receive( epTaskId[i] );
+    if ( pkt == NULL )
+    {
+      continue;
+    }
+
+    HOST_CHECK( osal_msg_receive( epTaskId[i] ) == NULL );
+    HOST_CHECK_EQ( pkt->endPoint, epDescs[i].endPoint );
+    HOST_CHECK_EQ( pkt->cmd.DataLength, PAYLOAD_LEN );
+    HOST_CHECK( osal_memcmp( pkt->cmd.Data, payload, PAYLOAD_LEN ) );
+
+    // Every distinct buffer is one copy of the payload
+    data[i] = pkt->cmd.Data;
+    for ( j = 0; j < i; j++ )
+    {
+      if ( data[j] == data[i] )
+      {
+        break;
+      }
+    }
+    if ( j == i )
+    {
+      (*copies)++;
+    }
+
+    afIncomingMSGFree( (uint8 *)pkt );
+  }
+
+  // Nothing is left behind once every task released its message
+  HOST_CHECK_EQ( HEAP_BLOCKS_USED(), cnt );
+  HOST_CHECK_EQ( osal_heap_mem_used(), used );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 blocks;
+  uint32 copies;
+  uint32 privBytes;
+  uint8 i;
+
+  osal_init_system();
+
+  for ( i = 0; i < PAYLOAD_LEN; i++ )
+  {
+    payload[i] = (uint8)(i * 7 + 3);
+  }
+
+  for ( i = 0; i < TEST_EPS; i++ )
+  {
+    epTaskId[i] = i;
+    epSimpleDesc[i].EndPoint = i + 1;
+    epSimpleDesc[i].AppProfId = TEST_PROFILE_ID;
+    epDescs[i].endPoint = i + 1;
+    epDescs[i].task_id = &epTaskId[i];
+    epDescs[i].simpleDesc = &epSimpleDesc[i];
+    epDescs[i].latencyReq = noLatencyReqs;
+    HOST_CHECK_EQ( afRegister( &epDescs[i] ), afStatus_SUCCESS );
+  }
+
+  // Private copies: one message each, the payload copied into every one
+  deliver( 1, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, 1 );
+  HOST_CHECK_EQ( copies, 1 );
+  deliver( AF_BROADCAST_ENDPOINT, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, TEST_EPS );
+  HOST_CHECK_EQ( copies, TEST_EPS );
+  privBytes = copies * PAYLOAD_LEN;
+
+  for ( i = 0; i < TEST_EPS; i++ )
+  {
+    HOST_CHECK_EQ( afSetRxShared( epDescs[i].endPoint, TRUE ), TRUE );
+  }
+
+  // A frame for one endpoint only keeps its single allocation
+  deliver( 1, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, 1 );
+  HOST_CHECK_EQ( copies, 1 );
+
+  // Broadcast to every endpoint: the messages plus one shared payload
+  deliver( AF_BROADCAST_ENDPOINT, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, TEST_EPS + 1 );
+  HOST_CHECK_EQ( copies, 1 );
+  printf( "%d-byte broadcast to %d endpoints: %lu bytes copied private, %lu shared\n",
+          PAYLOAD_LEN, TEST_EPS, (unsigned long)privBytes,
+          (unsigned long)(copies * PAYLOAD_LEN) );
+
+  // Group frame to two of them
+  deliver( 0, TRUE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, sizeof( groupEps ) + 1 );
+  HOST_CHECK_EQ( copies, 1 );
+
+  // Broadcast that only one endpoint's profile accepts: no shared buffer
+  for ( i = 1; i < TEST_EPS; i++ )
+  {
+    epSimpleDesc[i].AppProfId = OTHER_PROFILE_ID;
+  }
+  deliver( AF_BROADCAST_ENDPOINT, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, 1 );
+  HOST_CHECK_EQ( copies, 1 );
+
+  // Two sharing endpoints and two private ones
+  for ( i = 0; i < TEST_EPS; i++ )
+  {
+    epSimpleDesc[i].AppProfId = TEST_PROFILE_ID;
+  }
+  HOST_CHECK_EQ( afSetRxShared( epDescs[1].endPoint, FALSE ), TRUE );
+  HOST_CHECK_EQ( afSetRxShared( epDescs[3].endPoint, FALSE ), TRUE );
+  deliver( AF_BROADCAST_ENDPOINT, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, TEST_EPS + 1 );
+  HOST_CHECK_EQ( copies, 3 );
+
+  // Only one sharing endpoint left among the receivers
+  HOST_CHECK_EQ( afSetRxShared( epDescs[2].endPoint, FALSE ), TRUE );
+  deliver( AF_BROADCAST_ENDPOINT, FALSE, &blocks, &copies );
+  HOST_CHECK_EQ( blocks, TEST_EPS );
+  HOST_CHECK_EQ( copies, TEST_EPS );
+
+  return ( HOST_TEST_RESULT() );
+}
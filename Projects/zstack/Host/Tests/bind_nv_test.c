@@ -0,0 +1,473 @@
+/**************************************************************************************************
+  Filename:       bind_nv_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Saves the binding table to NV over the simulated flash: counts the flash
+                  bytes written per bind and unbind, checks that a removal of a cluster that
+                  is not bound writes nothing, and loses power at every flash word of a
+                  save to check the restored table is the old one or the new one.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "nwk.h"
+#include "nwk_globals.h"
+#include "AddrMgr.h"
+#include "BindingTable.h"
+#include "hal_host.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_SRC_EPS      4         // source endpoints 1 to 4
+#define TEST_CLUSTERS     16        // cluster IDs bound, 0x0100 up
+#define FIRST_CLUSTER     0x0100
+#define BIND_EMPTY        0xFF      // srcEP of an unused record
+#define ADDR_ENTRIES      ( 2 * NWK_MAX_BINDING_ENTRIES + 2 )
+#define CHANGES           2000
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+nwkIB_t _NIB;
+
+// Binding table storage, as in nwk_globals.c
+CONST uint16 gNWK_MAX_BINDING_ENTRIES = NWK_MAX_BINDING_ENTRIES;
+CONST uint8 gMAX_BINDING_CLUSTER_IDS = MAX_BINDING_CLUSTER_IDS;
+CONST uint16 gBIND_REC_SIZE = sizeof( BindingEntry_t );
+BindingEntry_t BindingTable[NWK_MAX_BINDING_ENTRIES];
+#if ( BIND_INDEX == TRUE )
+CONST uint16 gBIND_INDEX_SIZE = NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS;
+bindIndexRec_t BindingIndex[NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS];
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Address manager stub: one entry per address, in order of arrival
+static uint16 addrNwk[ADDR_ENTRIES];
+static uint8 addrExt[ADDR_ENTRIES][Z_EXTADDR_LEN];
+static uint16 addrCnt;
+
+static uint8 localExt[Z_EXTADDR_LEN] = { 1, 0, 0, 0, 0, 0, 0, 0 };
+
+static BindingEntry_t oldTable[NWK_MAX_BINDING_ENTRIES];
+static BindingEntry_t newTable[NWK_MAX_BINDING_ENTRIES];
+
+static uint32 randSeed = 1;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testRand( void );
+static void bindDevice( uint16 shortAddr );
+static uint8 randomChange( void );
+static uint8 sameTable( BindingEntry_t *pTable );
+static void powerUp( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   The test calls the binding table directly.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * Stubs of the address manager and the network layer. The address
+ * manager keeps its entries over a reset.
+ */
+void AddrMgrExtAddrSet( uint8 *dstExtAddr, uint8 *srcExtAddr )
+{
+  if ( srcExtAddr != NULL )
+  {
+    osal_memcpy( dstExtAddr, srcExtAddr, Z_EXTADDR_LEN );
+  }
+  else
+  {
+    osal_memset( dstExtAddr, 0, Z_EXTADDR_LEN );
+  }
+}
+
+uint8 AddrMgrEntryLookupNwk( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < addrCnt; i++ )
+  {
+    if ( addrNwk[i] == entry->nwkAddr )
+    {
+      entry->index = i;
+      osal_memcpy( entry->extAddr, addrExt[i], Z_EXTADDR_LEN );
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryLookupExt( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < addrCnt; i++ )
+  {
+    if ( osal_memcmp( addrExt[i], entry->extAddr, Z_EXTADDR_LEN ) )
+    {
+      entry->index = i;
+      entry->nwkAddr = addrNwk[i];
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryGet( AddrMgrEntry_t *entry )
+{
+  if ( entry->index >= addrCnt )
+  {
+    return ( FALSE );
+  }
+
+  entry->nwkAddr = addrNwk[entry->index];
+  osal_memcpy( entry->extAddr, addrExt[entry->index], Z_EXTADDR_LEN );
+  return ( TRUE );
+}
+
+uint8 AddrMgrEntryUpdate( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < addrCnt; i++ )
+  {
+    if ( addrNwk[i] == entry->nwkAddr )
+    {
+      break;
+    }
+  }
+
+  if ( i >= ADDR_ENTRIES )
+  {
+    return ( FALSE );
+  }
+  else if ( i == addrCnt )
+  {
+    addrCnt++;
+  }
+
+  addrNwk[i] = entry->nwkAddr;
+  osal_memcpy( addrExt[i], entry->extAddr, Z_EXTADDR_LEN );
+  entry->index = i;
+  return ( TRUE );
+}
+
+uint8 AddrMgrRegister( uint8 reg, AddrMgrUserCB_t cb )
+{
+  (void)reg;
+  (void)cb;
+  return ( TRUE );
+}
+
+byte *NLME_GetExtAddr( void )
+{
+  return ( localExt );
+}
+
+uint16 NLME_GetCoordShortAddr( void )
+{
+  return ( INVALID_NODE_ADDR );
+}
+
+void NLME_GetCoordExtAddr( byte *buf )
+{
+  osal_memset( buf, 0, Z_EXTADDR_LEN );
+}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Repeatable pseudo random numbers.
+ */
+static uint16 testRand( void )
+{
+  randSeed = randSeed * 1103515245UL + 12345;
+  return ( (uint16)( randSeed >> 16 ) );
+}
+
+/*********************************************************************
+ * @fn      bindDevice
+ *
+ * @brief   Bind a device to one or two random clusters.
+ */
+static void bindDevice( uint16 shortAddr )
+{
+  uint16 clusterIds[2];
+  zAddrType_t dstAddr;
+
+  clusterIds[0] = FIRST_CLUSTER + ( testRand() % TEST_CLUSTERS );
+  clusterIds[1] = clusterIds[0] + 1;
+
+  dstAddr.addrMode = Addr16Bit;
+  dstAddr.addr.shortAddr = shortAddr;
+  (void)bindAddEntry( 1 + ( testRand() % TEST_SRC_EPS ), &dstAddr, 1,
+                      1 + ( testRand() & 1 ), clusterIds );
+}
+
+/*********************************************************************
+ * @fn      randomChange
+ *
+ * @brief   Bind a random device, or unbind a random record.
+ *
+ * @return  TRUE for a bind, FALSE for an unbind
+ */
+static uint8 randomChange( void )
+{
+  BindingEntry_t *pBind;
+  uint16 used, max;
+
+  bindCapacity( &max, &used );
+
+  if ( ( used < max / 2 ) || ( ( used < max ) && ( testRand() & 1 ) ) )
+  {
+    bindDevice( 0x1000 + ( testRand() % NWK_MAX_BINDING_ENTRIES ) );
+    return ( TRUE );
+  }
+
+  do
+  {
+    pBind = &BindingTable[testRand() % NWK_MAX_BINDING_ENTRIES];
+  } while ( pBind->srcEP == BIND_EMPTY );
+
+  bindRemoveEntry( pBind );
+  return ( FALSE );
+}
+
+/*********************************************************************
+ * @fn      sameTable
+ *
+ * @brief   Compare the records in use, and their cluster IDs in use,
+ *          with a copy of the table.
+ */
+static uint8 sameTable( BindingEntry_t *pTable )
+{
+  BindingEntry_t *pBind;
+  uint16 x;
+
+  for ( x = 0; x < NWK_MAX_BINDING_ENTRIES; x++ )
+  {
+    pBind = &BindingTable[x];
+    if ( pBind->srcEP != pTable[x].srcEP )
+    {
+      return ( FALSE );
+    }
+
+    if ( ( pBind->srcEP != BIND_EMPTY ) &&
+         ( ( pBind->dstGroupMode != pTable[x].dstGroupMode ) ||
+           ( pBind->dstIdx != pTable[x].dstIdx ) ||
+           ( pBind->dstEP != pTable[x].dstEP ) ||
+           ( pBind->numClusterIds != pTable[x].numClusterIds ) ||
+           !osal_memcmp( pBind->clusterIdList, pTable[x].clusterIdList,
+                         pBind->numClusterIds * sizeof( uint16 ) ) ) )
+    {
+      return ( FALSE );
+    }
+  }
+
+  return ( TRUE );
+}
+
+/*********************************************************************
+ * @fn      powerUp
+ *
+ * @brief   Reset: scan the NV pages and restore the binding table.
+ */
+static void powerUp( void )
+{
+  osal_nv_init( NULL );
+  InitBindingTable();
+  if ( BindInitNV() == ZSUCCESS )
+  {
+    (void)BindRestoreFromNV();
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 bytes;
+  uint32 bindBytes = 0, unbindBytes = 0;
+  uint32 binds = 0, unbinds = 0;
+  uint32 words;
+  uint32 n;
+  uint16 clusterID;
+  uint8 lost;
+  uint8 isBind;
+
+  osal_init_system();
+  _NIB.nwkDevAddress = 0x0000;
+
+  // Bytes written to flash by the save after each change
+  HalHostFlashReset();
+  powerUp();
+  for ( n = 0; n < CHANGES; n++ )
+  {
+    isBind = randomChange();
+
+    bytes = halHostFlashStat.writeBytes;
+    BindWriteNV();
+    bytes = halHostFlashStat.writeBytes - bytes;
+
+    if ( isBind )
+    {
+      binds++;
+      bindBytes += bytes;
+    }
+    else
+    {
+      unbinds++;
+      unbindBytes += bytes;
+    }
+  }
+
+  printf( "%d records of %d clusters, whole table item %u bytes: "
+          "%.1f flash bytes per bind, %.1f per unbind\n",
+          NWK_MAX_BINDING_ENTRIES, MAX_BINDING_CLUSTER_IDS,
+          (unsigned)( sizeof( nvBindingHdr_t ) + NWK_MAX_BINDING_ENTRIES * sizeof( BindingEntry_t ) ),
+          (double)bindBytes / binds, (double)unbindBytes / unbinds );
+
+  // The saved table comes back after a reset
+  osal_memcpy( newTable, BindingTable, sizeof( BindingTable ) );
+  powerUp();
+  HOST_CHECK( sameTable( newTable ) );
+
+  // Removing a cluster that isn't bound writes nothing
+  while ( BindingTable[0].srcEP == BIND_EMPTY )
+  {
+    bindDevice( 0x3000 );
+  }
+  BindWriteNV();
+  clusterID = FIRST_CLUSTER + TEST_CLUSTERS + 1;
+  HOST_CHECK( !bindIsClusterIDinList( &BindingTable[0], clusterID ) );
+  bindRemoveClusterIdFromList( &BindingTable[0], clusterID );
+  bytes = halHostFlashStat.writeBytes;
+  BindWriteNV();
+  HOST_CHECK_EQ( halHostFlashStat.writeBytes, bytes );
+
+  // Power lost at every flash word of saves that grow, shrink and
+  // empty a block: the table comes back whole, old or new
+  for ( n = 0; n < 3; n++ )
+  {
+    for ( words = 1, lost = TRUE; lost; words++ )
+    {
+      HalHostFlashReset();
+      randSeed = 7;
+      powerUp();
+      while ( BindingTable[1].srcEP == BIND_EMPTY )
+      {
+        randomChange();
+      }
+      BindWriteNV();
+      osal_memcpy( oldTable, BindingTable, sizeof( BindingTable ) );
+
+      if ( n == 0 )
+      {
+        bindAddClusterIdToList( &BindingTable[1], FIRST_CLUSTER + TEST_CLUSTERS );
+      }
+      else if ( n == 1 )
+      {
+        bindRemoveClusterIdFromList( &BindingTable[1], BindingTable[1].clusterIdList[0] );
+      }
+      else
+      {
+        bindRemoveEntry( &BindingTable[0] );
+        bindRemoveEntry( &BindingTable[1] );
+        bindRemoveEntry( &BindingTable[2] );
+        bindRemoveEntry( &BindingTable[3] );
+      }
+      osal_memcpy( newTable, BindingTable, sizeof( BindingTable ) );
+
+      HalHostFlashPowerFail( words );
+      BindWriteNV();
+      lost = HalHostFlashPowerOn();
+
+      powerUp();
+      if ( !sameTable( oldTable ) && !sameTable( newTable ) )
+      {
+        printf( "change %lu: table lost with power lost after %lu flash words\n",
+                (unsigned long)n, (unsigned long)words );
+        hostTestFailures++;
+      }
+      HOST_CHECK( lost || sameTable( newTable ) );
+    }
+
+    printf( "change %lu: power lost at each of %lu flash words\n",
+            (unsigned long)n, (unsigned long)( words - 2 ) );
+  }
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,420 @@
+/**************************************************************************************************
+  Filename:       bind_table_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Fills the binding table, checks bindFind() and bindNumReflections() against
+                  a scan of BindingTable[] as records and cluster IDs come and go, and
+                  measures the lookups of an indirect send to every bound device.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "nwk.h"
+#include "nwk_globals.h"
+#include "AddrMgr.h"
+#include "BindingTable.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_SRC_EPS      4         // source endpoints 1 to 4
+#define TEST_CLUSTERS     16        // cluster IDs bound, 0x0100 up
+#define FIRST_CLUSTER     0x0100
+#define BIND_EMPTY        0xFF      // srcEP of an unused record
+#define ADDR_ENTRIES      ( NWK_MAX_BINDING_ENTRIES + 2 )
+#define SENDS             200000
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+nwkIB_t _NIB;
+
+// Binding table storage, as in nwk_globals.c
+CONST uint16 gNWK_MAX_BINDING_ENTRIES = NWK_MAX_BINDING_ENTRIES;
+CONST uint8 gMAX_BINDING_CLUSTER_IDS = MAX_BINDING_CLUSTER_IDS;
+CONST uint16 gBIND_REC_SIZE = sizeof( BindingEntry_t );
+BindingEntry_t BindingTable[NWK_MAX_BINDING_ENTRIES];
+#if ( BIND_INDEX == TRUE )
+CONST uint16 gBIND_INDEX_SIZE = NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS;
+bindIndexRec_t BindingIndex[NWK_MAX_BINDING_ENTRIES * MAX_BINDING_CLUSTER_IDS];
+#endif
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Address manager stub: one entry per address, in order of arrival
+static uint16 addrNwk[ADDR_ENTRIES];
+static uint8 addrExt[ADDR_ENTRIES][Z_EXTADDR_LEN];
+static uint16 addrCnt;
+
+static uint8 localExt[Z_EXTADDR_LEN] = { 1, 0, 0, 0, 0, 0, 0, 0 };
+
+static uint32 randSeed = 1;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testRand( void );
+static BindingEntry_t *refFind( uint8 ep, uint16 clusterID, uint8 skipping );
+static void checkLookups( void );
+static void fillTable( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   The test calls the binding table directly.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * Stubs of the address manager and the network layer.
+ */
+void AddrMgrExtAddrSet( uint8 *dstExtAddr, uint8 *srcExtAddr )
+{
+  if ( srcExtAddr != NULL )
+  {
+    osal_memcpy( dstExtAddr, srcExtAddr, Z_EXTADDR_LEN );
+  }
+  else
+  {
+    osal_memset( dstExtAddr, 0, Z_EXTADDR_LEN );
+  }
+}
+
+uint8 AddrMgrEntryLookupNwk( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < addrCnt; i++ )
+  {
+    if ( addrNwk[i] == entry->nwkAddr )
+    {
+      entry->index = i;
+      osal_memcpy( entry->extAddr, addrExt[i], Z_EXTADDR_LEN );
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryLookupExt( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < addrCnt; i++ )
+  {
+    if ( osal_memcmp( addrExt[i], entry->extAddr, Z_EXTADDR_LEN ) )
+    {
+      entry->index = i;
+      entry->nwkAddr = addrNwk[i];
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryGet( AddrMgrEntry_t *entry )
+{
+  if ( entry->index >= addrCnt )
+  {
+    return ( FALSE );
+  }
+
+  entry->nwkAddr = addrNwk[entry->index];
+  osal_memcpy( entry->extAddr, addrExt[entry->index], Z_EXTADDR_LEN );
+  return ( TRUE );
+}
+
+uint8 AddrMgrEntryUpdate( AddrMgrEntry_t *entry )
+{
+  if ( addrCnt >= ADDR_ENTRIES )
+  {
+    return ( FALSE );
+  }
+
+  addrNwk[addrCnt] = entry->nwkAddr;
+  osal_memcpy( addrExt[addrCnt], entry->extAddr, Z_EXTADDR_LEN );
+  entry->index = addrCnt++;
+  return ( TRUE );
+}
+
+uint8 AddrMgrRegister( uint8 reg, AddrMgrUserCB_t cb )
+{
+  (void)reg;
+  (void)cb;
+  return ( TRUE );
+}
+
+byte *NLME_GetExtAddr( void )
+{
+  return ( localExt );
+}
+
+uint16 NLME_GetCoordShortAddr( void )
+{
+  return ( INVALID_NODE_ADDR );
+}
+
+void NLME_GetCoordExtAddr( byte *buf )
+{
+  osal_memset( buf, 0, Z_EXTADDR_LEN );
+}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Repeatable pseudo random numbers.
+ */
+static uint16 testRand( void )
+{
+  randSeed = randSeed * 1103515245UL + 12345;
+  return ( (uint16)( randSeed >> 16 ) );
+}
+
+/*********************************************************************
+ * @fn      refFind
+ *
+ * @brief   The binding record bindFind() should return, by scanning
+ *          every record and its cluster list.
+ */
+static BindingEntry_t *refFind( uint8 ep, uint16 clusterID, uint8 skipping )
+{
+  uint16 x;
+  uint8 k;
+
+  for ( x = 0; x < NWK_MAX_BINDING_ENTRIES; x++ )
+  {
+    if ( BindingTable[x].srcEP != ep )
+    {
+      continue;
+    }
+
+    for ( k = 0; k < BindingTable[x].numClusterIds; k++ )
+    {
+      if ( BindingTable[x].clusterIdList[k] == clusterID )
+      {
+        if ( skipping == 0 )
+        {
+          return ( &BindingTable[x] );
+        }
+        skipping--;
+        break;
+      }
+    }
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      checkLookups
+ *
+ * @brief   Compare every lookup with the scan, including endpoints and
+ *          clusters that are not bound.
+ */
+static void checkLookups( void )
+{
+  uint16 clusterID;
+  uint16 n;
+  uint8 ep;
+  uint8 k;
+
+  for ( ep = 0; ep <= TEST_SRC_EPS + 1; ep++ )
+  {
+    for ( clusterID = FIRST_CLUSTER - 1; clusterID <= FIRST_CLUSTER + TEST_CLUSTERS; clusterID++ )
+    {
+      n = bindNumReflections( ep, clusterID );
+      for ( k = 0; k <= n; k++ )
+      {
+        HOST_CHECK( bindFind( ep, clusterID, k ) == refFind( ep, clusterID, k ) );
+      }
+      HOST_CHECK( bindFind( ep, clusterID, (uint8)n ) == NULL );
+      HOST_CHECK( ( n == 0 ) || ( refFind( ep, clusterID, (uint8)( n - 1 ) ) != NULL ) );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      fillTable
+ *
+ * @brief   Bind each record to its own device, from a random source
+ *          endpoint, with a random set of clusters.
+ */
+static void fillTable( void )
+{
+  uint16 clusterIds[MAX_BINDING_CLUSTER_IDS];
+  zAddrType_t dstAddr;
+  uint16 x;
+  uint8 k;
+
+  for ( x = 0; x < NWK_MAX_BINDING_ENTRIES; x++ )
+  {
+    for ( k = 0; k < MAX_BINDING_CLUSTER_IDS; k++ )
+    {
+      clusterIds[k] = FIRST_CLUSTER + ( ( x + 3 * k ) % TEST_CLUSTERS );
+    }
+
+    dstAddr.addrMode = Addr16Bit;
+    dstAddr.addr.shortAddr = 0x1000 + x;
+    HOST_CHECK( bindAddEntry( 1 + ( testRand() % TEST_SRC_EPS ), &dstAddr, 1,
+                              1 + ( testRand() % MAX_BINDING_CLUSTER_IDS ), clusterIds ) != NULL );
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  BindingEntry_t *pBind;
+  zAddrType_t dstAddr;
+  double t0, us;
+  uint32 n, found = 0;
+  uint16 maxEntries, usedEntries;
+  uint16 cnt, x;
+  uint16 clusterID;
+  uint8 ep, k;
+
+  osal_init_system();
+  _NIB.nwkDevAddress = 0x0000;
+
+  InitBindingTable();
+  fillTable();
+  bindCapacity( &maxEntries, &usedEntries );
+  HOST_CHECK_EQ( usedEntries, NWK_MAX_BINDING_ENTRIES );
+  checkLookups();
+
+  // Take clusters out of records, in and out of the list
+  for ( n = 0; n < 200; n++ )
+  {
+    pBind = &BindingTable[testRand() % NWK_MAX_BINDING_ENTRIES];
+    clusterID = FIRST_CLUSTER + ( testRand() % TEST_CLUSTERS );
+    if ( pBind->srcEP == BIND_EMPTY )
+    {
+      continue;
+    }
+
+    if ( testRand() & 1 )
+    {
+      bindRemoveClusterIdFromList( pBind, clusterID );
+    }
+    else
+    {
+      bindAddClusterIdToList( pBind, clusterID );
+    }
+
+    if ( pBind->numClusterIds == 0 )
+    {
+      bindRemoveEntry( pBind );
+    }
+  }
+  checkLookups();
+
+  // Remove some records and bind new devices in their place
+  for ( x = 0; x < NWK_MAX_BINDING_ENTRIES; x += 3 )
+  {
+    bindRemoveEntry( &BindingTable[x] );
+  }
+  checkLookups();
+
+  for ( x = 0; x < NWK_MAX_BINDING_ENTRIES / 4; x++ )
+  {
+    clusterID = FIRST_CLUSTER + ( x % TEST_CLUSTERS );
+    dstAddr.addrMode = Addr16Bit;
+    dstAddr.addr.shortAddr = 0x2000 + x;
+    bindAddEntry( 1 + ( x % TEST_SRC_EPS ), &dstAddr, 2, 1, &clusterID );
+  }
+  checkLookups();
+
+  // Every bound device of a cluster, the way APS walks an indirect send
+  InitBindingTable();
+  fillTable();
+
+  t0 = HOST_TEST_SECONDS();
+  for ( n = 0; n < SENDS; n++ )
+  {
+    ep = 1 + ( n % TEST_SRC_EPS );
+    clusterID = FIRST_CLUSTER + ( ( n / TEST_SRC_EPS ) % TEST_CLUSTERS );
+
+    cnt = bindNumReflections( ep, clusterID );
+    for ( k = 0; k < cnt; k++ )
+    {
+      if ( bindFind( ep, clusterID, k ) != NULL )
+      {
+        found++;
+      }
+    }
+  }
+  us = ( HOST_TEST_SECONDS() - t0 ) * 1e6 / SENDS;
+
+  HOST_CHECK( found != 0 );
+  printf( "%d records of %d clusters, index %s: %.3f us per send, %.2f bound devices per send\n",
+          NWK_MAX_BINDING_ENTRIES, MAX_BINDING_CLUSTER_IDS,
+          ( BIND_INDEX == TRUE ) ? "on" : "off", us, (double)found / SENDS );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,470 @@
+/**************************************************************************************************
+  Filename:       genericapp_loop_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Counts the OSAL passes GenericApp_ProcessEvent() takes per
+                  measurement loop, with the AD7793 and the rest of the board stubbed.
+                  With POWER_SAVING, also the charge a measurement takes.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Clock.h"
+#include "OSAL_PwrMgr.h"
+#include "AF.h"
+#include "ZDApp.h"
+#include "ZDObject.h"
+#include "ZDProfile.h"
+#include "OnBoard.h"
+#include "GenericApp.h"
+#include "hal_led.h"
+#include "hal_key.h"
+#include "hal_oled.h"
+#include "hal_external_flash.h"
+#include "hal_battery_monitor.h"
+#include "hal_AD7793.h"
+#include "measTempr.h"
+#include "hal_energy.h"
+#include "hal_sleep.h"
+#include "hal_host.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define ADC_RDY_EVT       0x0001
+
+// AD7793 conversion time, below the 33 ms fallback timeout at 33.2 Hz
+#define CONV_MSEC         30
+
+#define TEST_LOOPS        20
+#define CONVERSIONS       3       // PT, reference and thermocouple
+
+#if defined( POWER_SAVING )
+// Typical supply currents in uA, CC2530 with the radio off and AD7793
+// with the in-amp on
+#define CPU_ACTIVE_UA     6700UL  // 32 MHz crystal
+#define CPU_PM2_UA        1UL
+#define AD7793_UA         400UL
+#endif
+
+// The virtual clock stands still while code runs. A wake-up from PM2
+// (32 MHz crystal start-up and the DOUT/RDY ISR) and the SPI read of a
+// result with the re-arm of the next conversion cost active time.
+#define WAKE_USEC         400
+#define READ_USEC         300
+
+#define TICKS_PER_SEC     32768UL
+#define USEC_TO_TICKS(us) (((us) * TICKS_PER_SEC + 500000UL) / 1000000UL)
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+static uint16 adcTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent, adcTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+#define APP_TASK_ID       0
+#define ADC_TASK_ID       1
+
+static uint32 appPasses;
+static uint16 loops;
+
+// DOUT/RDY interrupt armed by HalAD7793RdyIntEnable()
+static uint8 rdyTask = TASK_NO_TASK;
+static uint16 rdyEvent;
+
+// The sleep timer follows the OSAL clock
+static uint32 syncClock;
+static uint32 syncRem;
+
+#if defined( POWER_SAVING )
+// Energy of the last runLoops()
+static uint32 loopUC;
+static uint32 loopActiveUs;
+static uint32 loopPm2Us;
+static uint16 loopWakeUps;
+static uint16 wakeUps;
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint32 runLoops( void );
+static void sleepTimerSync( void );
+#if defined( POWER_SAVING )
+static void energyRead( void );
+#endif
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   GenericApp, then the AD7793 DOUT/RDY interrupt.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  GenericApp_Init( APP_TASK_ID );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   GenericApp_ProcessEvent(), counting the OSAL passes it takes.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  appPasses++;
+
+  return ( GenericApp_ProcessEvent( task_id, events ) );
+}
+
+/*********************************************************************
+ * @fn      adcTask_ProcessEvent
+ *
+ * @brief   The end of a conversion: DOUT/RDY goes low and, when armed,
+ *          its interrupt posts the sample event.
+ */
+static uint16 adcTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( (events & ADC_RDY_EVT) && (rdyTask != TASK_NO_TASK) )
+  {
+    osal_set_event( rdyTask, rdyEvent );
+    rdyTask = TASK_NO_TASK;
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * AD7793 stub, every conversion takes CONV_MSEC.
+ */
+static void adcConfig( AD7793Rate_t OutUpdateRate )
+{
+  (void)OutUpdateRate;
+  sleepTimerSync();
+  HAL_ENERGY_START( HAL_ENERGY_AD7793 );
+  osal_start_timerEx( ADC_TASK_ID, ADC_RDY_EVT, CONV_MSEC );
+}
+
+static float adcFetch( float volt )
+{
+  sleepTimerSync();
+  HalHostSleepTimerAdvance( USEC_TO_TICKS( READ_USEC ) );
+  HAL_ENERGY_STOP( HAL_ENERGY_AD7793 );
+  return ( volt );
+}
+
+void AD7793_AIN1_config_one( AD7793Rate_t OutUpdateRate ) { adcConfig( OutUpdateRate ); }
+void AD7793_AIN2_config_one( AD7793Rate_t OutUpdateRate ) { adcConfig( OutUpdateRate ); }
+void AD7793_AIN3_config_one( AD7793Rate_t OutUpdateRate ) { adcConfig( OutUpdateRate ); }
+float AD7793_AIN1_fetch_one( void ) { return ( adcFetch( 0.1f ) ); }
+float AD7793_AIN2_fetch_one( void ) { return ( adcFetch( 0.2f ) ); }
+float AD7793_AIN3_fetch_one( void ) { return ( adcFetch( 0.3f ) ); }
+
+bool AD7793_IsReadyToFetch( void )
+{
+  return ( osal_get_timeoutEx( ADC_TASK_ID, ADC_RDY_EVT ) == 0 );
+}
+
+void HalAD7793RdyIntEnable( uint8 task_id, uint16 event )
+{
+  rdyTask = task_id;
+  rdyEvent = event;
+}
+
+void HalAD7793RdyIntDisable( void )
+{
+  rdyTask = TASK_NO_TASK;
+}
+
+/*********************************************************************
+ * Measurement stub, the loop is complete after TEST_LOOPS samples.
+ */
+bool measWorkEndTemperature( measResult_t *pMeasRlt )
+{
+  (void)pMeasRlt;
+  return ( TRUE );
+}
+
+bool CheckMeasComplete( measResult_t *pMeasRlt, uint16 curr_result_idx,
+                        real32 *pfOuputDegree, real32 *pfColdEndDegree )
+{
+  (void)pMeasRlt;
+  loops++;
+  *pfOuputDegree = 36.5f;
+  *pfColdEndDegree = 25.0f;
+  return ( (curr_result_idx + 1) >= TEST_LOOPS );
+}
+
+/*********************************************************************
+ * Board and stack stubs.
+ */
+void HalOledShowChar( uint8 x, uint8 y, uint8 chr, uint8 size, uint8 mode ) {}
+void HalOledShowNum( uint8 x, uint8 y, uint32 num, uint8 len, uint8 size ) {}
+void HalOledShowString( uint8 x, uint8 y, uint8 size, const uint8 *p ) {}
+void HalOledOnOff( uint8 mode ) {}
+void HalOledShowDegreeSymbol( uint8 x, uint8 y ) {}
+uint8 HalShowBattVol( uint8 fThreshold ) { return ( 0 ); }
+uint8 HalLedSet( uint8 led, uint8 mode ) { return ( 0 ); }
+uint8 HalExtFlashDataRead( ExtFlashStruct_t *ExtFlashStruct ) { return ( FALSE ); }
+void HalExtFlashLoseNetwork( void ) {}
+uint8 RegisterForKeys( uint8 task_id ) { return ( TRUE ); }
+uint8 ZDOInitDevice( uint16 startDelay ) { return ( ZDO_INITDEV_NEW_NETWORK_STATE ); }
+uint8 ZDApp_StartJoiningCycle( void ) { return ( TRUE ); }
+uint8 ZDApp_StopJoiningCycle( void ) { return ( TRUE ); }
+ZStatus_t ZDO_RegisterForZDOMsg( uint8 taskID, uint16 clusterID ) { return ( ZSuccess ); }
+ZDO_ActiveEndpointRsp_t *ZDO_ParseEPListRsp( zdoIncomingMsg_t *inMsg ) { return ( NULL ); }
+byte *NLME_GetExtAddr( void ) { return ( NULL ); }
+ZStatus_t NLME_LeaveReq( NLME_LeaveReq_t *req ) { return ( ZSuccess ); }
+afStatus_t afRegister( endPointDesc_t *epDesc ) { return ( afStatus_SUCCESS ); }
+uint8 afSetRxShared( uint8 ep, uint8 action ) { return ( TRUE ); }
+void afIncomingMSGFree( uint8 *msg ) { osal_msg_deallocate( msg ); }
+
+afStatus_t AF_DataRequest( afAddrType_t *dstAddr, endPointDesc_t *srcEP,
+                           uint16 cID, uint16 len, uint8 *buf, uint8 *transID,
+                           uint8 options, uint8 radius )
+{
+  return ( afStatus_SUCCESS );
+}
+
+#if defined( POWER_SAVING )
+/*********************************************************************
+ * Sleep stub, PM2 until the next OSAL timer. The DOUT/RDY wake-up is
+ * a timer of the ADC task here.
+ */
+void halSleep( uint16 osal_timer )
+{
+  if ( osal_timer == 0 )
+  {
+    return;  // only an interrupt would wake it up
+  }
+
+  sleepTimerSync();
+  HAL_ENERGY_CPU( HAL_ENERGY_CPU_PM2 );
+
+  osal_virtual_clock_advance( osal_timer );
+
+  sleepTimerSync();
+  HAL_ENERGY_CPU( HAL_ENERGY_CPU_ACTIVE );
+  HalHostSleepTimerAdvance( USEC_TO_TICKS( WAKE_USEC ) );
+  wakeUps++;
+}
+
+// The virtual clock has updated the timers already
+uint32 TimerElapsed( void ) { return ( 0 ); }
+#endif // POWER_SAVING
+
+/*********************************************************************
+ * @fn      sleepTimerSync
+ *
+ * @brief   Move the sleep timer on by the OSAL clock time since the
+ *          last call, carrying the fractions of a tick over.
+ */
+static void sleepTimerSync( void )
+{
+  uint32 now = osal_GetSystemClock();
+
+  syncRem += (now - syncClock) * TICKS_PER_SEC;
+  syncClock = now;
+
+  HalHostSleepTimerAdvance( syncRem / 1000 );
+  syncRem %= 1000;
+}
+
+#if defined( POWER_SAVING )
+/*********************************************************************
+ * @fn      energyRead
+ *
+ * @brief   Read the energy counters into the loopXxx results, the
+ *          charge in uC.
+ */
+static void energyRead( void )
+{
+  uint8 buf[HAL_ENERGY_REPORT_LEN];
+  uint32 us[HAL_ENERGY_STATE_NUM];
+  uint8 *p = buf;
+  uint8 idx;
+
+  sleepTimerSync();
+  HalEnergySerialize( buf );
+
+  for ( idx = 0; idx < HAL_ENERGY_STATE_NUM; idx++ )
+  {
+    us[idx] = osal_build_uint32( p, 4 ) * 1000000UL + osal_build_uint32( p + 4, 4 );
+    p += HAL_ENERGY_COUNTER_LEN;
+  }
+
+  loopActiveUs = us[HAL_ENERGY_CPU_ACTIVE];
+  loopPm2Us = us[HAL_ENERGY_CPU_PM2];
+  loopUC = (uint32)(((uint64_t)us[HAL_ENERGY_CPU_ACTIVE] * CPU_ACTIVE_UA +
+                     (uint64_t)us[HAL_ENERGY_CPU_PM2] * CPU_PM2_UA +
+                     (uint64_t)us[HAL_ENERGY_AD7793] * AD7793_UA) / 1000000UL);
+}
+#endif // POWER_SAVING
+
+/*********************************************************************
+ * @fn      runLoops
+ *
+ * @brief   Press the work key and run TEST_LOOPS measurement loops.
+ *
+ * @return  OSAL passes of GenericApp
+ */
+static uint32 runLoops( void )
+{
+  keyChange_t *key;
+  uint32 passes;
+
+  HOST_CHECK_EQ( TemprSystemStatus, TEMPR_OFFLINE_IDLE );
+  loops = 0;
+
+#if defined( POWER_SAVING )
+  sleepTimerSync();
+  HalEnergyReset();
+  wakeUps = 0;
+#endif
+
+  // Press the work key: the measurement loop starts offline
+  key = (keyChange_t *)osal_msg_allocate( sizeof( keyChange_t ) );
+  key->hdr.event = KEY_CHANGE;
+  key->state = 0;
+  key->keys = HAL_KEY_SW_7;
+  HOST_CHECK_EQ( osal_msg_send( APP_TASK_ID, (uint8 *)key ), SUCCESS );
+
+  // Up to the start of the first conversion, a sleep would run into it
+  osal_run_virtual( 0 );
+  HOST_CHECK_EQ( TemprSystemStatus, TEMPR_OFFLINE_MEASURE );
+  passes = appPasses;
+
+#if defined( POWER_SAVING )
+  // Stop at the end of the last loop, the idle time after it is not
+  // part of the measurement
+  while ( loops < TEST_LOOPS )
+  {
+    osal_run_virtual( 1 );
+  }
+  energyRead();
+  loopWakeUps = wakeUps;
+#endif
+
+  osal_run_virtual( 60000 );
+  passes = appPasses - passes;
+
+  HOST_CHECK_EQ( loops, TEST_LOOPS );
+  HOST_CHECK_EQ( osal_next_timeout(), 0 );
+
+  return ( passes );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 passes;
+#if defined( POWER_SAVING )
+  uint32 spinUC, spinActiveUs;
+  uint32 sleepUC, sleepActiveUs, sleepPm2Us;
+#endif
+
+  osal_init_system();
+
+#if defined( POWER_SAVING )
+  // Spin through the conversions first, as a mains powered device does
+  HalEnergyInit();
+  osal_pwrmgr_device( PWRMGR_ALWAYS_ON );
+  (void)runLoops();
+  spinUC = loopUC;
+  spinActiveUs = loopActiveUs;
+  HOST_CHECK_EQ( loopWakeUps, 0 );
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+
+  // Back to idle as the stable result does with GO_TO_STABLE
+  TemprSystemStatus = TEMPR_OFFLINE_IDLE;
+#endif
+
+  passes = runLoops();
+  printf( "%d measurement loops, event budget %d: %lu OSAL passes, %.2f per loop\n",
+          TEST_LOOPS, GENERICAPP_EVENT_BUDGET, (unsigned long)passes,
+          (double)passes / TEST_LOOPS );
+
+#if GENERICAPP_EVENT_BUDGET >= 3
+  // One pass per conversion: the last one runs GENERICAPP_DO_MEAS_TEMPR
+  // and starts the next loop in the same call
+  HOST_CHECK_EQ( passes, (uint32)TEST_LOOPS * CONVERSIONS );
+#else
+  // One event per pass, as before the dispatch table: the loop end and
+  // the restart of the coroutine each take a pass of their own
+  HOST_CHECK_EQ( passes, (uint32)TEST_LOOPS * (CONVERSIONS + 2) - 1 );
+#endif
+
+#if defined( POWER_SAVING )
+  sleepUC = loopUC;
+  sleepActiveUs = loopActiveUs;
+  sleepPm2Us = loopPm2Us;
+  printf( "per measurement, spinning: %lu us active, %lu uC\n",
+          (unsigned long)(spinActiveUs / TEST_LOOPS),
+          (unsigned long)(spinUC / TEST_LOOPS) );
+  printf( "per measurement, PM2: %lu us active, %lu ms PM2 in %u wake-ups, %lu uC\n",
+          (unsigned long)(sleepActiveUs / TEST_LOOPS),
+          (unsigned long)(sleepPm2Us / 1000 / TEST_LOOPS),
+          loopWakeUps / TEST_LOOPS, (unsigned long)(sleepUC / TEST_LOOPS) );
+  printf( "measurements per mAh: %lu spinning, %lu with PM2\n",
+          (unsigned long)(3600000UL * TEST_LOOPS / spinUC),
+          (unsigned long)(3600000UL * TEST_LOOPS / sleepUC) );
+
+  // Every conversion is slept through, woken up once by DOUT/RDY, and
+  // the wake-ups and reads are all that keeps the CPU active
+  HOST_CHECK_EQ( loopWakeUps, (uint16)(TEST_LOOPS * CONVERSIONS) );
+  HOST_CHECK( sleepActiveUs < (uint32)TEST_LOOPS * CONVERSIONS * (WAKE_USEC + READ_USEC + 100) );
+  HOST_CHECK( sleepUC * 10 < spinUC );
+#endif
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,173 @@
+/**************************************************************************************************
+  Filename:       hal_energy_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Checks the energy accounting against the simulated sleep timer:
+                  CPU states, overlapping peripherals, the 24-bit wrap and rounding.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "hal_energy.h"
+#include "hal_host.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TICKS_PER_SEC     32768UL
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint32 report[HAL_ENERGY_STATE_NUM][2];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void energyRead( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   No task is needed.
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      energyRead
+ *
+ * @brief   Serialize the counters and decode them into report[][].
+ */
+static void energyRead( void )
+{
+  uint8 buf[HAL_ENERGY_REPORT_LEN];
+  uint8 *p = buf;
+  uint8 idx;
+
+  HalEnergySerialize( buf );
+
+  for ( idx = 0; idx < HAL_ENERGY_STATE_NUM; idx++ )
+  {
+    report[idx][0] = osal_build_uint32( p, 4 );
+    report[idx][1] = osal_build_uint32( p + 4, 4 );
+    p += HAL_ENERGY_COUNTER_LEN;
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  halEnergyCounter_t counter = { 0, 0 };
+  uint32 n;
+
+  osal_init_system();
+
+  // Start just before the 24-bit wrap, every interval below crosses it
+  HalHostSleepTimerAdvance( 0x00FFFFFFUL - TICKS_PER_SEC / 2 );
+  HalEnergyInit();
+
+  // 1.5 s active, then 10 s in PM2 with a 2 s AD7793 conversion and a
+  // nested start that must not restart the interval
+  HalHostSleepTimerAdvance( TICKS_PER_SEC + TICKS_PER_SEC / 2 );
+  HalEnergyCpuState( HAL_ENERGY_CPU_PM2 );
+  HalEnergyStart( HAL_ENERGY_AD7793 );
+  HalHostSleepTimerAdvance( TICKS_PER_SEC );
+  HalEnergyStart( HAL_ENERGY_AD7793 );
+  HalHostSleepTimerAdvance( TICKS_PER_SEC );
+  HalEnergyStop( HAL_ENERGY_AD7793 );
+  HalHostSleepTimerAdvance( 8 * TICKS_PER_SEC );
+
+  // Stopping an idle activity accounts nothing
+  HalEnergyStop( HAL_ENERGY_OLED );
+
+  energyRead();
+  HOST_CHECK_EQ( report[HAL_ENERGY_CPU_ACTIVE][0], 1 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_CPU_ACTIVE][1], 500000 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_CPU_PM2][0], 10 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_CPU_PM2][1], 0 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_AD7793][0], 2 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_AD7793][1], 0 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_OLED][0], 0 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_OLED][1], 0 );
+
+  // An open interval is accounted up to the read and goes on
+  HalEnergyStart( HAL_ENERGY_RADIO_RX );
+  HalHostSleepTimerAdvance( TICKS_PER_SEC / 4 );
+  energyRead();
+  HOST_CHECK_EQ( report[HAL_ENERGY_RADIO_RX][1], 250000 );
+  HalHostSleepTimerAdvance( TICKS_PER_SEC / 4 );
+  energyRead();
+  HOST_CHECK_EQ( report[HAL_ENERGY_RADIO_RX][1], 500000 );
+
+  // Reset clears the counters but keeps the open intervals running
+  HalEnergyReset();
+  HalHostSleepTimerAdvance( TICKS_PER_SEC );
+  energyRead();
+  HOST_CHECK_EQ( report[HAL_ENERGY_CPU_ACTIVE][0], 0 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_CPU_PM2][0], 1 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_RADIO_RX][0], 1 );
+  HOST_CHECK_EQ( report[HAL_ENERGY_AD7793][0], 0 );
+
+  // An hour of one-tick intervals adds up exactly, the remainder is kept in ticks
+  for ( n = 0; n < 3600UL * TICKS_PER_SEC; n++ )
+  {
+    HalEnergyAccumulate( &counter, 1 );
+  }
+  HOST_CHECK_EQ( counter.sec, 3600UL );
+  HOST_CHECK_EQ( counter.ticks, 0 );
+
+  HalEnergyAccumulate( &counter, TICKS_PER_SEC - 1 );
+  HalEnergyAccumulate( &counter, 2 );
+  HOST_CHECK_EQ( counter.sec, 3600UL + 1 );
+  HOST_CHECK_EQ( counter.ticks, 1 );
+
+  return ( HOST_TEST_RESULT() );
+}
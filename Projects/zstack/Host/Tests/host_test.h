@@ -0,0 +1,113 @@
+/**************************************************************************************************
+  Filename:       host_test.h
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Checks and reporting shared by the host tests.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hal_defs.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Count a failure and go on, so one run reports every broken check
+#define HOST_CHECK( expr )  st( \
+  if ( !(expr) ) \
+  { \
+    printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr ); \
+    hostTestFailures++; \
+  } \
+)
+
+// Check an equality, printing both values as unsigned long
+#define HOST_CHECK_EQ( a, b )  st( \
+  unsigned long _a = (unsigned long)(a); \
+  unsigned long _b = (unsigned long)(b); \
+  if ( _a != _b ) \
+  { \
+    printf( "%s:%d: check failed: %s == %s (%lu != %lu)\n", \
+            __FILE__, __LINE__, #a, #b, _a, _b ); \
+    hostTestFailures++; \
+  } \
+)
+
+// Exit status of the test program
+#define HOST_TEST_RESULT()  ( hostTestReport() )
+
+// Processor time in seconds, to report the real time a benchmark took
+#define HOST_TEST_SECONDS()  ( (double)clock() / CLOCKS_PER_SEC )
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static int hostTestFailures = 0;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      hostTestReport
+ *
+ * @brief   Print the verdict of the test program.
+ *
+ * @param   none
+ *
+ * @return  exit status, zero if all checks passed
+ */
+static int hostTestReport( void )
+{
+  if ( hostTestFailures )
+  {
+    printf( "FAILED: %d check(s)\n", hostTestFailures );
+    return ( EXIT_FAILURE );
+  }
+
+  printf( "PASSED\n" );
+  return ( EXIT_SUCCESS );
+}
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,240 @@
+/**************************************************************************************************
+  Filename:       osal_dispatch_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Checks the dispatch order of the ready-task bit map and times
+                  osal_run_system against a linear scan of tasksEvents[].
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_TASKS        16      // the bit map holds 16 tasks
+
+#define RUN_EVT           0x0001
+#define KEEP_EVT          0x0002
+
+#define BENCH_RUNS        2000000UL
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 order[64];
+static uint8 orderCnt;
+
+static uint32 benchLeft;
+static uint8 postTo = TASK_NO_TASK;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events );
+static uint8 linearFirstReady( void );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[TEST_TASKS] = {
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent
+};
+const uint8 tasksCnt = TEST_TASKS;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      testTask_ProcessEvent
+ *
+ * @brief   Logs the dispatch order. KEEP_EVT is handed back once,
+ *          during the benchmark the task posts RUN_EVT to itself.
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  if ( benchLeft )
+  {
+    if ( --benchLeft )
+    {
+      osal_set_event( task_id, RUN_EVT );
+    }
+    return ( 0 );
+  }
+
+  if ( orderCnt < sizeof( order ) )
+  {
+    order[orderCnt++] = task_id;
+  }
+
+  if ( postTo != TASK_NO_TASK )
+  {
+    osal_set_event( postTo, RUN_EVT );
+    postTo = TASK_NO_TASK;
+  }
+
+  if ( events & KEEP_EVT )
+  {
+    return ( (events & ~KEEP_EVT) | RUN_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      linearFirstReady
+ *
+ * @brief   The scan osal_run_system did before the bit map.
+ */
+static uint8 linearFirstReady( void )
+{
+  uint8 idx = 0;
+
+  do
+  {
+    if ( tasksEvents[idx] )
+    {
+      break;
+    }
+  } while ( ++idx < tasksCnt );
+
+  return ( idx );
+}
+
+/*********************************************************************
+ * @fn      runAll
+ *
+ * @brief   Run until no task is ready.
+ */
+static void runAll( void )
+{
+  uint8 n;
+
+  for ( n = 0; n < 64; n++ )
+  {
+    osal_run_system();
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  volatile uint8 sink = 0;
+  uint32 n;
+  double start;
+  double bitMap;
+  double linear;
+
+  osal_init_system();
+
+  // Lowest index first, whatever order the events were set in
+  osal_set_event( 15, RUN_EVT );
+  osal_set_event( 3, RUN_EVT );
+  osal_set_event( 9, RUN_EVT );
+  osal_set_event( 0, RUN_EVT );
+  osal_set_event( 8, RUN_EVT );
+  runAll();
+  HOST_CHECK_EQ( orderCnt, 5 );
+  HOST_CHECK_EQ( order[0], 0 );
+  HOST_CHECK_EQ( order[1], 3 );
+  HOST_CHECK_EQ( order[2], 8 );
+  HOST_CHECK_EQ( order[3], 9 );
+  HOST_CHECK_EQ( order[4], 15 );
+
+  // A higher priority task posted by a handler runs next
+  orderCnt = 0;
+  osal_set_event( 12, RUN_EVT );
+  osal_set_event( 14, RUN_EVT );
+  postTo = 1;
+  runAll();
+  HOST_CHECK_EQ( orderCnt, 3 );
+  HOST_CHECK_EQ( order[0], 12 );
+  HOST_CHECK_EQ( order[1], 1 );
+  HOST_CHECK_EQ( order[2], 14 );
+
+  // Unprocessed events keep the task ready, clearing the last one does not
+  orderCnt = 0;
+  osal_set_event( 7, KEEP_EVT );
+  osal_set_event( 5, RUN_EVT );
+  osal_clear_event( 5, RUN_EVT );
+  runAll();
+  HOST_CHECK_EQ( orderCnt, 2 );
+  HOST_CHECK_EQ( order[0], 7 );
+  HOST_CHECK_EQ( order[1], 7 );
+
+  // Worst case of the scan: only the last task is ready
+  start = HOST_TEST_SECONDS();
+  benchLeft = BENCH_RUNS;
+  osal_set_event( TEST_TASKS - 1, RUN_EVT );
+  while ( benchLeft )
+  {
+    osal_run_system();
+  }
+  bitMap = HOST_TEST_SECONDS() - start;
+  HOST_CHECK_EQ( tasksEvents[TEST_TASKS - 1], 0 );
+
+  tasksEvents[TEST_TASKS - 1] = RUN_EVT;
+  start = HOST_TEST_SECONDS();
+  for ( n = 0; n < BENCH_RUNS; n++ )
+  {
+    sink += linearFirstReady();
+  }
+  linear = HOST_TEST_SECONDS() - start;
+  tasksEvents[TEST_TASKS - 1] = 0;
+
+  printf( "%lu dispatches of task %d: %.1f ns each, linear scan alone %.1f ns\n",
+          BENCH_RUNS, TEST_TASKS - 1, bitMap * 1e9 / BENCH_RUNS, linear * 1e9 / BENCH_RUNS );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,238 @@
+/**************************************************************************************************
+  Filename:       osal_mem_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Replays a pseudo random allocation trace through the OSAL heap and
+                  its fixed-size block pools, checking that no two blocks overlap.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TRACE_STEPS       1000000UL
+#define TRACE_SLOTS       48        // live blocks at most
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint8 *ptr;
+  uint16 size;
+  uint8  fill;
+} traceSlot_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static traceSlot_t slot[TRACE_SLOTS];
+static uint32 traceSeed = 1;
+
+static uint32 allocs;
+static uint32 misses;
+static uint32 corrupt;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 traceRand( void );
+static uint16 traceSize( void );
+static void slotFree( traceSlot_t *pSlot );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   No task is needed.
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      traceRand
+ *
+ * @brief   Small LCG, so the trace is the same on every host.
+ */
+static uint16 traceRand( void )
+{
+  traceSeed = traceSeed * 1103515245UL + 12345UL;
+  return ( (uint16)(traceSeed >> 16) );
+}
+
+/*********************************************************************
+ * @fn      traceSize
+ *
+ * @brief   Request sizes as profiled on the device: mostly timers and
+ *          small OSAL messages, then ZDO and short AF messages, now and
+ *          then a large frame.
+ */
+static uint16 traceSize( void )
+{
+  uint16 r = traceRand() % 100;
+
+  if ( r < 55 )
+  {
+    return ( 6 + traceRand() % 11 );      // 6..16
+  }
+  else if ( r < 85 )
+  {
+    return ( 17 + traceRand() % 48 );     // 17..64
+  }
+  return ( 65 + traceRand() % 160 );      // 65..224
+}
+
+/*********************************************************************
+ * @fn      slotFree
+ *
+ * @brief   Check the fill pattern of a block and free it.
+ */
+static void slotFree( traceSlot_t *pSlot )
+{
+  uint16 n;
+
+  for ( n = 0; n < pSlot->size; n++ )
+  {
+    if ( pSlot->ptr[n] != (uint8)(pSlot->fill + n) )
+    {
+      corrupt++;
+      break;
+    }
+  }
+
+  osal_mem_free( pSlot->ptr );
+  pSlot->ptr = NULL;
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  traceSlot_t *pSlot;
+  uint16 heapUsed;
+  uint32 step;
+  uint16 n;
+  double start;
+  double real;
+#if OSALMEM_POOLS
+  osalMemPoolStat_t stat;
+  uint8 pool;
+#endif
+
+  osal_init_system();
+  heapUsed = osal_heap_mem_used();
+
+  start = HOST_TEST_SECONDS();
+  for ( step = 0; step < TRACE_STEPS; step++ )
+  {
+    pSlot = &slot[traceRand() % TRACE_SLOTS];
+
+    if ( pSlot->ptr )
+    {
+      slotFree( pSlot );
+      continue;
+    }
+
+    pSlot->size = traceSize();
+    pSlot->ptr = osal_mem_alloc( pSlot->size );
+    if ( pSlot->ptr == NULL )
+    {
+      misses++;
+      continue;
+    }
+
+    allocs++;
+    pSlot->fill = (uint8)step;
+    for ( n = 0; n < pSlot->size; n++ )
+    {
+      pSlot->ptr[n] = (uint8)(pSlot->fill + n);
+    }
+  }
+  real = HOST_TEST_SECONDS() - start;
+
+  for ( n = 0; n < TRACE_SLOTS; n++ )
+  {
+    if ( slot[n].ptr )
+    {
+      slotFree( &slot[n] );
+    }
+  }
+
+  printf( "%lu allocations, %lu out of memory, %.1f ns per step\n",
+          (unsigned long)allocs, (unsigned long)misses, real * 1e9 / TRACE_STEPS );
+
+  HOST_CHECK_EQ( corrupt, 0 );
+  HOST_CHECK( allocs > TRACE_STEPS / 3 );
+
+  // Everything came back, the heap is not fragmented for a large block
+  HOST_CHECK_EQ( osal_heap_mem_used(), heapUsed );
+  pSlot = &slot[0];
+  pSlot->ptr = osal_mem_alloc( 1024 );
+  HOST_CHECK( pSlot->ptr != NULL );
+  osal_mem_free( pSlot->ptr );
+
+#if OSALMEM_POOLS
+  for ( pool = 0; pool < OSALMEM_POOL_NUM; pool++ )
+  {
+    HOST_CHECK_EQ( osal_mem_pool_stat( pool, &stat ), SUCCESS );
+    printf( "pool %d: %d x %d bytes, high-water %d, %u fell back to the heap\n",
+            pool, stat.blkCnt, stat.blkSz, stat.max, stat.miss );
+
+    HOST_CHECK_EQ( stat.used, 0 );
+    HOST_CHECK_EQ( stat.max, stat.blkCnt );   // the trace fills every pool
+    HOST_CHECK( stat.miss > 0 );              // and overflows it to the heap
+  }
+  HOST_CHECK_EQ( osal_mem_pool_stat( OSALMEM_POOL_NUM, &stat ), INVALIDPARAMETER );
+#endif
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,346 @@
+/**************************************************************************************************
+  Filename:       osal_msgq_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Burst load of the per-task message queues against the single
+                  global list they replaced, with the depth caps and urgent messages.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_TASKS        8
+
+#define TEST_MSG          0xA0
+#define URGENT_MSG        0xA1
+
+#define BURST_MSGS        512
+#define BURST_ROUNDS      200
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  osal_event_hdr_t hdr;
+  uint16 seq;
+} testMsg_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[TEST_TASKS] = {
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent
+};
+const uint8 tasksCnt = TEST_TASKS;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+// The single list every message used to go on
+static uint8 *globalQ;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint8 *newMsg( uint8 event, uint16 seq );
+static void globalSend( uint8 task_id, uint8 *msg );
+static uint8 *globalReceive( uint8 task_id );
+static double burst( uint8 global );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      testTask_ProcessEvent
+ *
+ * @brief   The messages are received by the test itself.
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( events & SYS_EVENT_MSG );
+}
+
+/*********************************************************************
+ * @fn      newMsg
+ *
+ * @brief   Allocate a numbered test message.
+ */
+static uint8 *newMsg( uint8 event, uint16 seq )
+{
+  testMsg_t *msg = (testMsg_t *)osal_msg_allocate( sizeof( testMsg_t ) );
+
+  if ( msg != NULL )
+  {
+    msg->hdr.event = event;
+    msg->seq = seq;
+  }
+
+  return ( (uint8 *)msg );
+}
+
+/*********************************************************************
+ * @fn      globalSend
+ *
+ * @brief   osal_msg_send() as it was: append to the single list.
+ */
+static void globalSend( uint8 task_id, uint8 *msg )
+{
+  uint8 *list = globalQ;
+
+  OSAL_MSG_ID( msg ) = task_id;
+
+  if ( list == NULL )
+  {
+    globalQ = msg;
+    return;
+  }
+
+  while ( OSAL_MSG_NEXT( list ) != NULL )
+  {
+    list = (uint8 *)OSAL_MSG_NEXT( list );
+  }
+  OSAL_MSG_NEXT( list ) = (osal_msg_hdr_t *)msg;
+}
+
+/*********************************************************************
+ * @fn      globalReceive
+ *
+ * @brief   osal_msg_receive() as it was: take the task's first message
+ *          out of the single list.
+ */
+static uint8 *globalReceive( uint8 task_id )
+{
+  uint8 *list = globalQ;
+  uint8 *prev = NULL;
+
+  while ( list != NULL )
+  {
+    if ( OSAL_MSG_ID( list ) == task_id )
+    {
+      if ( prev == NULL )
+      {
+        globalQ = (uint8 *)OSAL_MSG_NEXT( list );
+      }
+      else
+      {
+        OSAL_MSG_NEXT( prev ) = OSAL_MSG_NEXT( list );
+      }
+      OSAL_MSG_NEXT( list ) = NULL;
+      OSAL_MSG_ID( list ) = TASK_NO_TASK;
+      break;
+    }
+
+    prev = list;
+    list = (uint8 *)OSAL_MSG_NEXT( list );
+  }
+
+  return ( list );
+}
+
+/*********************************************************************
+ * @fn      burst
+ *
+ * @brief   Send BURST_MSGS messages round robin to the tasks, then let
+ *          the tasks drain them from the last one, the slow task whose
+ *          messages sit behind everybody else's. Every message must come
+ *          out once and in order.
+ *
+ * @param   global - TRUE for the single list, FALSE for OSAL
+ *
+ * @return  processor seconds of the sends and receives
+ */
+static double burst( uint8 global )
+{
+  uint8 *msgs[BURST_MSGS];
+  uint16 next[TEST_TASKS];
+  uint16 round;
+  uint16 n;
+  uint8 task;
+  double start;
+  double total = 0;
+
+  for ( round = 0; round < BURST_ROUNDS; round++ )
+  {
+    for ( n = 0; n < BURST_MSGS; n++ )
+    {
+      msgs[n] = newMsg( TEST_MSG, n );
+    }
+
+    start = HOST_TEST_SECONDS();
+    for ( n = 0; n < BURST_MSGS; n++ )
+    {
+      if ( global )
+      {
+        globalSend( n % TEST_TASKS, msgs[n] );
+      }
+      else
+      {
+        osal_msg_send( n % TEST_TASKS, msgs[n] );
+      }
+    }
+
+    n = 0;
+    task = TEST_TASKS;
+    while ( task-- )
+    {
+      testMsg_t *msg;
+
+      next[task] = task;
+      while ( (msg = (testMsg_t *)(global ? globalReceive( task )
+                                          : osal_msg_receive( task ))) != NULL )
+      {
+        msgs[n++] = (uint8 *)msg;
+        if ( msg->seq != next[task] )
+        {
+          next[task] = 0xFFFF;
+        }
+        next[task] += TEST_TASKS;
+      }
+    }
+    total += HOST_TEST_SECONDS() - start;
+
+    HOST_CHECK_EQ( n, BURST_MSGS );
+    for ( task = 0; task < TEST_TASKS; task++ )
+    {
+      HOST_CHECK_EQ( next[task], task + BURST_MSGS );
+    }
+    while ( n-- )
+    {
+      osal_msg_deallocate( msgs[n] );
+    }
+  }
+
+  return ( total );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  osal_msg_qstat_t stat;
+  testMsg_t *msg;
+  uint16 used;
+  uint16 n;
+  double perTask;
+  double global;
+
+  osal_init_system();
+  used = osal_heap_mem_used();
+
+  // Burst load: O(1) per message against a walk of the shared list
+  perTask = burst( FALSE );
+  global = burst( TRUE );
+  printf( "%d-message bursts over %d tasks: %.1f ns per message per-task queues,"
+          " %.1f ns single list\n", BURST_MSGS, TEST_TASKS,
+          perTask * 1e9 / ((double)BURST_ROUNDS * BURST_MSGS),
+          global * 1e9 / ((double)BURST_ROUNDS * BURST_MSGS) );
+  HOST_CHECK( perTask * 4 < global );
+  HOST_CHECK_EQ( osal_msg_q_stats( 0, &stat ), SUCCESS );
+  HOST_CHECK_EQ( stat.count, 0 );
+  HOST_CHECK_EQ( stat.peak, BURST_MSGS / TEST_TASKS );
+  HOST_CHECK_EQ( tasksEvents[0] & SYS_EVENT_MSG, 0 );
+
+  // Depth cap: the overflow is dropped, counted and reported to the sender
+  HOST_CHECK_EQ( osal_msg_set_depth( 1, 4 ), SUCCESS );
+  for ( n = 0; n < 10; n++ )
+  {
+    HOST_CHECK_EQ( osal_msg_send( 1, newMsg( TEST_MSG, n ) ),
+                   (n < 4) ? SUCCESS : MSG_BUFFER_NOT_AVAIL );
+  }
+  HOST_CHECK_EQ( osal_msg_q_stats( 1, &stat ), SUCCESS );
+  HOST_CHECK_EQ( stat.count, 4 );
+  HOST_CHECK_EQ( stat.peak, BURST_MSGS / TEST_TASKS );  // Still the burst's
+  HOST_CHECK_EQ( stat.drops, 6 );
+  HOST_CHECK_EQ( stat.max, 4 );
+  HOST_CHECK( tasksEvents[1] & SYS_EVENT_MSG );
+
+  // Urgent message: past the cap and ahead of the queue
+  HOST_CHECK_EQ( osal_msg_send_urgent( 1, newMsg( URGENT_MSG, 100 ) ), SUCCESS );
+  HOST_CHECK_EQ( osal_msg_q_stats( 1, &stat ), SUCCESS );
+  HOST_CHECK_EQ( stat.count, 5 );
+  HOST_CHECK_EQ( stat.drops, 6 );
+
+  // Only the task's own queue is searched
+  HOST_CHECK_EQ( osal_msg_send( 2, newMsg( URGENT_MSG, 200 ) ), SUCCESS );
+  HOST_CHECK( osal_msg_find( 0, URGENT_MSG ) == NULL );
+  msg = (testMsg_t *)osal_msg_find( 2, URGENT_MSG );
+  HOST_CHECK( (msg != NULL) && (msg->seq == 200) );
+  msg = (testMsg_t *)osal_msg_find( 1, URGENT_MSG );
+  HOST_CHECK( (msg != NULL) && (msg->seq == 100) );
+
+  for ( n = 0; n < 5; n++ )
+  {
+    msg = (testMsg_t *)osal_msg_receive( 1 );
+    HOST_CHECK( msg != NULL );
+    if ( msg != NULL )
+    {
+      HOST_CHECK_EQ( msg->seq, (n == 0) ? 100 : (n - 1) );
+      osal_msg_deallocate( (uint8 *)msg );
+    }
+  }
+  HOST_CHECK( osal_msg_receive( 1 ) == NULL );
+  HOST_CHECK_EQ( tasksEvents[1] & SYS_EVENT_MSG, 0 );
+  osal_msg_deallocate( osal_msg_receive( 2 ) );
+
+  // A dropped or misaddressed message is freed, not leaked
+  HOST_CHECK_EQ( osal_msg_send( TEST_TASKS, newMsg( TEST_MSG, 0 ) ), INVALID_TASK );
+  HOST_CHECK_EQ( osal_heap_mem_used(), used );
+
+  return ( HOST_TEST_RESULT() );
+}
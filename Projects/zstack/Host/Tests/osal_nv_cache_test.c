@@ -0,0 +1,207 @@
+/**************************************************************************************************
+  Filename:       osal_nv_cache_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Counts the simulated flash reads of NV item lookups, with and without
+                  the RAM index of item locations, and checks the data read back.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "hal_host.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_ITEM_ID      0x0401
+#define TEST_ITEMS        40
+#define TEST_HOT_ITEMS    6       // the working set, fits the index
+#define TEST_HOT_STRIDE   7       // spread over the pages
+#define TEST_LOOKUPS      1200
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 image[TEST_ITEMS][64];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 itemLen( uint8 item );
+static uint32 checkItems( uint8 cnt );
+static uint32 lookups( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   No task is needed.
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      itemLen
+ *
+ * @brief   Items of 8 to 64 bytes.
+ */
+static uint16 itemLen( uint8 item )
+{
+  return ( 8 + ((item * 24) % 57) );
+}
+
+/*********************************************************************
+ * @fn      checkItems
+ *
+ * @brief   Read the first cnt items back and compare them with the image.
+ *
+ * @return  number of items that differ
+ */
+static uint32 checkItems( uint8 cnt )
+{
+  uint8 buf[64];
+  uint32 bad = 0;
+  uint8 item;
+
+  for ( item = 0; item < cnt; item++ )
+  {
+    if ( (osal_nv_read( TEST_ITEM_ID + item, 0, itemLen( item ), buf ) != SUCCESS) ||
+         !osal_memcmp( buf, image[item], itemLen( item ) ) )
+    {
+      bad++;
+    }
+  }
+
+  return ( bad );
+}
+
+/*********************************************************************
+ * @fn      lookups
+ *
+ * @brief   Read a few bytes of the working set items in turn, as the
+ *          stack does for its frequently used items.
+ *
+ * @return  number of flash reads
+ */
+static uint32 lookups( void )
+{
+  uint8 buf[4];
+  uint16 n;
+
+  // Clear the statistics only, not the simulated flash
+  osal_memset( &halHostFlashStat, 0, sizeof( halHostFlashStat ) );
+  for ( n = 0; n < TEST_LOOKUPS; n++ )
+  {
+    (void)osal_nv_read( TEST_ITEM_ID + (n % TEST_HOT_ITEMS) * TEST_HOT_STRIDE, 0,
+                        sizeof( buf ), buf );
+  }
+
+  return ( halHostFlashStat.reads );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 reads;
+  uint16 n;
+  uint8 item;
+
+  osal_init_system();
+  osal_nv_init( NULL );
+
+  for ( item = 0; item < TEST_ITEMS; item++ )
+  {
+    for ( n = 0; n < itemLen( item ); n++ )
+    {
+      image[item][n] = (uint8)(item * 7 + n);
+    }
+    HOST_CHECK_EQ( osal_nv_item_init( TEST_ITEM_ID + item, itemLen( item ), image[item] ),
+                   NV_ITEM_UNINIT );
+  }
+  HOST_CHECK_EQ( checkItems( TEST_ITEMS ), 0 );
+
+  reads = lookups();
+  printf( "index of %d: %lu flash reads for %d lookups of %d items among %d\n",
+          OSAL_NV_CACHE_SIZE, (unsigned long)reads, TEST_LOOKUPS, TEST_HOT_ITEMS, TEST_ITEMS );
+#if OSAL_NV_CACHE_SIZE
+  // A hit reads the data alone, no page header chain
+  HOST_CHECK( reads <= TEST_LOOKUPS * 2 );
+#else
+  // Every lookup walks the headers of the items before it
+  HOST_CHECK( reads > TEST_LOOKUPS * 2 );
+#endif
+
+  // Rewrites move the items, compaction moves them again: the index follows
+  halHostFlashStat.erases = 0;
+  for ( n = 0; n < 400; n++ )
+  {
+    item = (uint8)(n % TEST_ITEMS);
+    image[item][0]++;
+    HOST_CHECK_EQ( osal_nv_write( TEST_ITEM_ID + item, 0, itemLen( item ), image[item] ),
+                   SUCCESS );
+    if ( (n % 50) == 0 )
+    {
+      HOST_CHECK_EQ( checkItems( TEST_ITEMS ), 0 );
+    }
+  }
+  HOST_CHECK_EQ( checkItems( TEST_ITEMS ), 0 );
+  HOST_CHECK( halHostFlashStat.erases > 0 );
+
+  // After a restart the index is refilled from the pages
+  osal_nv_init( NULL );
+  HOST_CHECK_EQ( checkItems( TEST_ITEMS ), 0 );
+
+  // A deleted item is gone from the index too
+  HOST_CHECK_EQ( osal_nv_delete( TEST_ITEM_ID, itemLen( 0 ) ), SUCCESS );
+  HOST_CHECK_EQ( osal_nv_item_len( TEST_ITEM_ID ), 0 );
+  HOST_CHECK_EQ( osal_nv_read( TEST_ITEM_ID, 0, 1, image[0] ), NV_OPER_FAILED );
+
+  return ( HOST_TEST_RESULT() );
+}
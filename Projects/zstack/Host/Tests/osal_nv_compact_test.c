@@ -0,0 +1,338 @@
+/**************************************************************************************************
+  Filename:       osal_nv_compact_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Drives the NV page compaction in the background on the simulated
+                  flash: per-call cost without faults, then resets at random words.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "hal_host.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define NV_EVT            0x0001
+
+#define TEST_ITEM_ID      0x0401
+#define TEST_ITEMS        12
+#define TEST_ITEM_MAX     100
+
+#define LOAD_WRITES       3000    // writes of the fault free run
+#define FAULT_TRIALS      400
+#define FAULT_AGE_MAX     400     // writes before power is lost, at most
+#define FAULT_WORDS_MAX   600     // flash words written before, at most
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 nvTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { nvTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 image[TEST_ITEMS][TEST_ITEM_MAX];     // committed values
+static uint8 pending[TEST_ITEM_MAX];               // value being written
+static uint32 testSeed = 1;
+
+static uint32 steps;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testRand( void );
+static uint16 itemLen( uint8 item );
+static void nvStart( void );
+static void runIdle( void );
+static uint8 checkItem( uint8 item, uint8 *alt );
+static uint8 writeRandom( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      nvTask_ProcessEvent
+ *
+ * @brief   Steps the compaction in the background, as GenericApp does.
+ */
+static uint16 nvTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  if ( events & NV_EVT )
+  {
+    steps++;
+    osal_nv_process();
+    return ( events ^ NV_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Small LCG, so the runs are the same on every host.
+ */
+static uint16 testRand( void )
+{
+  testSeed = testSeed * 1103515245UL + 12345UL;
+  return ( (uint16)(testSeed >> 16) );
+}
+
+/*********************************************************************
+ * @fn      itemLen
+ *
+ * @brief   Items of 16 to 100 bytes.
+ */
+static uint16 itemLen( uint8 item )
+{
+  return ( 16 + ((item * 37) % (TEST_ITEM_MAX - 15)) );
+}
+
+/*********************************************************************
+ * @fn      nvStart
+ *
+ * @brief   Power up: scan the pages and create any missing item.
+ */
+static void nvStart( void )
+{
+  uint8 item;
+
+  osal_nv_init( NULL );
+  osal_nv_register( 0, NV_EVT );
+
+  for ( item = 0; item < TEST_ITEMS; item++ )
+  {
+    (void)osal_nv_item_init( TEST_ITEM_ID + item, itemLen( item ), image[item] );
+  }
+}
+
+/*********************************************************************
+ * @fn      runIdle
+ *
+ * @brief   Let the NV task step until it has nothing left to do.
+ */
+static void runIdle( void )
+{
+  uint16 n;
+
+  for ( n = 0; (n < 1000) && tasksEvents[0]; n++ )
+  {
+    osal_run_system();
+  }
+}
+
+/*********************************************************************
+ * @fn      checkItem
+ *
+ * @brief   The item must hold its committed value or, if given, alt.
+ *
+ * @return  TRUE if it does
+ */
+static uint8 checkItem( uint8 item, uint8 *alt )
+{
+  uint8 buf[TEST_ITEM_MAX];
+
+  if ( osal_nv_item_len( TEST_ITEM_ID + item ) != itemLen( item ) )
+  {
+    return ( FALSE );
+  }
+
+  (void)osal_nv_read( TEST_ITEM_ID + item, 0, itemLen( item ), buf );
+
+  return ( osal_memcmp( buf, image[item], itemLen( item ) ) ||
+           ((alt != NULL) && osal_memcmp( buf, alt, itemLen( item ) )) );
+}
+
+/*********************************************************************
+ * @fn      writeRandom
+ *
+ * @brief   Write a new random value to a random item.
+ *
+ * @return  the item written, its new value is in pending[]
+ */
+static uint8 writeRandom( void )
+{
+  uint8 item = (uint8)(testRand() % TEST_ITEMS);
+  uint16 n;
+
+  for ( n = 0; n < itemLen( item ); n++ )
+  {
+    pending[n] = (uint8)testRand();
+  }
+  (void)osal_nv_write( TEST_ITEM_ID + item, 0, itemLen( item ), pending );
+
+  return ( item );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  halHostFlashStat_t before;
+  uint32 maxErases = 0;
+  uint32 maxBytes = 0;
+  uint32 compactions = 0;
+  uint32 lost = 0;
+  uint32 lostInStep = 0;
+  uint32 trial;
+  uint32 n;
+  uint16 age;
+  uint8 item;
+  uint8 bad;
+
+  osal_init_system();
+
+  // Fault free: no API call erases a page, the steps do the compaction
+  HalHostFlashReset();
+  nvStart();
+  for ( n = 0; n < LOAD_WRITES; n++ )
+  {
+    before = halHostFlashStat;
+    item = writeRandom();
+    osal_memcpy( image[item], pending, itemLen( item ) );
+
+    if ( halHostFlashStat.erases - before.erases > maxErases )
+    {
+      maxErases = halHostFlashStat.erases - before.erases;
+    }
+    if ( halHostFlashStat.writeBytes - before.writeBytes > maxBytes )
+    {
+      maxBytes = halHostFlashStat.writeBytes - before.writeBytes;
+    }
+
+    before = halHostFlashStat;
+    runIdle();
+    compactions += halHostFlashStat.erases - before.erases;
+  }
+
+  printf( "%d writes: %lu compactions in %lu steps, an API call wrote %lu bytes "
+          "and erased %lu pages at most\n", LOAD_WRITES, (unsigned long)compactions,
+          (unsigned long)steps, (unsigned long)maxBytes, (unsigned long)maxErases );
+
+  HOST_CHECK( compactions > 10 );
+  HOST_CHECK_EQ( maxErases, 0 );
+  // The new copy plus the header and zeroing of the old one
+  HOST_CHECK( maxBytes <= TEST_ITEM_MAX + 32 );
+  for ( item = 0; item < TEST_ITEMS; item++ )
+  {
+    HOST_CHECK( checkItem( item, NULL ) );
+  }
+
+  // Resets at random flash words, in item writes and compaction steps alike
+  for ( trial = 0; trial < FAULT_TRIALS; trial++ )
+  {
+    HalHostFlashReset();
+    for ( item = 0; item < TEST_ITEMS; item++ )
+    {
+      osal_memset( image[item], (uint8)trial, TEST_ITEM_MAX );
+    }
+    nvStart();
+
+    // Age the pages so that power is often lost in a compaction
+    for ( age = testRand() % FAULT_AGE_MAX; age; age-- )
+    {
+      item = writeRandom();
+      osal_memcpy( image[item], pending, itemLen( item ) );
+      runIdle();
+    }
+
+    HalHostFlashPowerFail( 1 + testRand() % FAULT_WORDS_MAX );
+    bad = TEST_ITEMS;
+    while ( !HalHostFlashPowerLost() )
+    {
+      item = writeRandom();
+      if ( HalHostFlashPowerLost() )
+      {
+        bad = item;   // lost within this write
+        break;
+      }
+      osal_memcpy( image[item], pending, itemLen( item ) );
+
+      runIdle();
+    }
+    lost++;
+    lostInStep += ( bad == TEST_ITEMS ) ? 1 : 0;
+
+    // Reset, every item holds its old value, or the new one if it was being written
+    HOST_CHECK( HalHostFlashPowerOn() );
+    nvStart();
+    for ( item = 0; item < TEST_ITEMS; item++ )
+    {
+      if ( !checkItem( item, (item == bad) ? pending : NULL ) )
+      {
+        printf( "trial %lu: item %d lost\n", (unsigned long)trial, item );
+        hostTestFailures++;
+      }
+    }
+
+    // And NV keeps working
+    for ( n = 0; n < 50; n++ )
+    {
+      item = writeRandom();
+      osal_memcpy( image[item], pending, itemLen( item ) );
+      runIdle();
+    }
+    for ( item = 0; item < TEST_ITEMS; item++ )
+    {
+      HOST_CHECK( checkItem( item, NULL ) );
+    }
+  }
+
+  printf( "%lu resets at random flash words recovered, %lu of them in a compaction step\n",
+          (unsigned long)lost, (unsigned long)lostInStep );
+  HOST_CHECK( lostInStep > 0 );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,227 @@
+/**************************************************************************************************
+  Filename:       osal_nv_wb_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Counts the flash writes of a table saved record by record, written
+                  through and coalesced by osal_nv_write_back(), and checks the flushes.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "OnBoard.h"
+#include "hal_host.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define NV_EVT            0x0001
+
+#define TABLE_ID          0x0401
+#define OTHER_ID          0x0402
+#define TABLE_RECORDS     6
+#define RECORD_LEN        14
+#define TABLE_LEN         (2 + TABLE_RECORDS * RECORD_LEN)
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 nvTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { nvTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 table[TABLE_LEN];
+static uint8 resets;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void saveTable( uint8 (*write)( uint16, uint16, uint16, void * ) );
+static uint8 tableInFlash( void );
+static void testReset( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      nvTask_ProcessEvent
+ *
+ * @brief   The NV service event, as GenericApp handles it.
+ */
+static uint16 nvTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  if ( events & NV_EVT )
+  {
+    osal_nv_process();
+    return ( events ^ NV_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      saveTable
+ *
+ * @brief   Save a changed table the way BindWriteNV() does: every
+ *          record, then the header.
+ */
+static void saveTable( uint8 (*write)( uint16, uint16, uint16, void * ) )
+{
+  uint8 rec;
+
+  for ( rec = 0; rec < TABLE_RECORDS; rec++ )
+  {
+    table[2 + rec * RECORD_LEN] ^= 0xFF;
+    HOST_CHECK_EQ( write( TABLE_ID, 2 + rec * RECORD_LEN, RECORD_LEN,
+                          &table[2 + rec * RECORD_LEN] ), SUCCESS );
+  }
+
+  table[0]++;
+  HOST_CHECK_EQ( write( TABLE_ID, 0, 2, table ), SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      tableInFlash
+ *
+ * @brief   Check the table on flash: once nothing is held in RAM, the
+ *          read comes from flash.
+ */
+static uint8 tableInFlash( void )
+{
+  uint8 buf[TABLE_LEN];
+
+  // Nothing may be held, else the read would not come from flash
+  if ( osal_nv_flush() != SUCCESS )
+  {
+    return ( FALSE );
+  }
+
+  return ( (osal_nv_read( TABLE_ID, 0, TABLE_LEN, buf ) == SUCCESS) &&
+           osal_memcmp( buf, table, TABLE_LEN ) );
+}
+
+/*********************************************************************
+ * @fn      testReset
+ *
+ * @brief   HAL_SYSTEM_RESET() of the test, the device carries on.
+ */
+static void testReset( void )
+{
+  resets++;
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 throughWrites;
+  uint32 backWrites;
+  uint32 writes;
+  uint8 buf[TABLE_LEN];
+
+  osal_init_system();
+  HalHostResetRegister( testReset );
+  osal_nv_init( NULL );
+  osal_nv_register( 0, NV_EVT );
+  HOST_CHECK_EQ( osal_nv_item_init( TABLE_ID, TABLE_LEN, table ), NV_ITEM_UNINIT );
+  HOST_CHECK_EQ( osal_nv_item_init( OTHER_ID, 4, table ), NV_ITEM_UNINIT );
+
+  // Written through, every record copies the whole item
+  writes = halHostFlashStat.writes;
+  saveTable( osal_nv_write );
+  throughWrites = halHostFlashStat.writes - writes;
+  HOST_CHECK( tableInFlash() );
+
+  // Coalesced, one copy once the delay has expired
+  writes = halHostFlashStat.writes;
+  saveTable( osal_nv_write_back );
+  HOST_CHECK_EQ( halHostFlashStat.writes, writes );
+  HOST_CHECK_EQ( osal_nv_read( TABLE_ID, 0, TABLE_LEN, buf ), SUCCESS );
+  HOST_CHECK( osal_memcmp( buf, table, TABLE_LEN ) );
+  osal_run_virtual( 200 );
+  backWrites = halHostFlashStat.writes - writes;
+  HOST_CHECK( backWrites > 0 );
+  HOST_CHECK( tableInFlash() );
+
+  printf( "%d-record table save: %lu flash write calls written through, %lu coalesced\n",
+          TABLE_RECORDS, (unsigned long)throughWrites, (unsigned long)backWrites );
+  HOST_CHECK( backWrites * 5 < throughWrites );
+
+  // A held item is not read past its end
+  HOST_CHECK_EQ( osal_nv_write_back( TABLE_ID, 0, 1, table ), SUCCESS );
+  HOST_CHECK_EQ( osal_nv_read( TABLE_ID, TABLE_LEN - 1, 2, buf ), NV_OPER_FAILED );
+
+  // A write past the end of a held item writes the held data first and
+  // fails; the held data can not come back later over newer data
+  table[0]++;
+  HOST_CHECK_EQ( osal_nv_write_back( TABLE_ID, 0, 1, table ), SUCCESS );
+  HOST_CHECK_EQ( osal_nv_write( TABLE_ID, TABLE_LEN - 1, 2, buf ), NV_OPER_FAILED );
+  writes = halHostFlashStat.writes;
+  osal_run_virtual( 200 );
+  HOST_CHECK_EQ( halHostFlashStat.writes, writes );
+  HOST_CHECK( tableInFlash() );
+
+  // A software reset writes the held data out first
+  table[0]++;
+  HOST_CHECK_EQ( osal_nv_write_back( TABLE_ID, 0, 1, table ), SUCCESS );
+  writes = halHostFlashStat.writes;
+  SystemReset();
+  HOST_CHECK_EQ( resets, 1 );
+  HOST_CHECK( halHostFlashStat.writes > writes );
+  writes = halHostFlashStat.writes;
+  HOST_CHECK( tableInFlash() );
+  HOST_CHECK_EQ( halHostFlashStat.writes, writes );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,328 @@
+/**************************************************************************************************
+  Filename:       osal_pt_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Runs interleaved OSAL_Pt.h coroutines in two tasks on the virtual
+                  clock and checks the order and time of every step.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Pt.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define APP_TASK          0
+#define DRV_TASK          1
+
+// Events of the application task
+#define BLINK_EVT         0x0001
+#define PROD_EVT          0x0002
+#define PING_EVT          0x0004
+#define PONG_EVT          0x0008
+
+// Events of the driver task
+#define CONS_EVT          0x0001
+#define EXIT_EVT          0x0002
+
+#define ITEMS             3
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+static uint16 drvTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent, drvTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static osalPt_t blinkPt, prodPt, pingPt, pongPt;
+static osalPt_t consPt, exitPt;
+
+// Coroutine state kept across waits
+static uint8 blinkCnt;
+static uint8 produced;
+static uint8 consumed;
+static uint8 pingCnt, pongCnt;
+
+// What the coroutines did, "<step>@<ms> " each
+static char trace[256];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void traceStep( const char *step, uint8 n );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      traceStep
+ *
+ * @brief   Append a step and the OSAL time to the trace.
+ */
+static void traceStep( const char *step, uint8 n )
+{
+  sprintf( trace + strlen( trace ), "%s%u@%lu ", step, n,
+           (unsigned long)osal_GetSystemClock() );
+}
+
+/*********************************************************************
+ * @fn      blink
+ *
+ * @brief   Timed steps: waits of 10, 20, 30, 40 and 50 ms.
+ */
+static uint8 blink( void )
+{
+  OSAL_PT_BEGIN( &blinkPt );
+
+  for ( blinkCnt = 0; blinkCnt < 5; blinkCnt++ )
+  {
+    traceStep( "B", blinkCnt );
+    OSAL_PT_WAIT_MS( &blinkPt, 10 * (blinkCnt + 1) );
+  }
+  traceStep( "b", blinkCnt );
+
+  OSAL_PT_END( &blinkPt );
+}
+
+/*********************************************************************
+ * @fn      producer
+ *
+ * @brief   Every 25 ms an item is done, the driver task is told as a
+ *          DMA done interrupt would.
+ */
+static uint8 producer( void )
+{
+  OSAL_PT_BEGIN( &prodPt );
+
+  while ( produced < ITEMS )
+  {
+    OSAL_PT_WAIT_MS( &prodPt, 25 );
+    produced++;
+    osal_set_event( DRV_TASK, CONS_EVT );
+  }
+
+  OSAL_PT_END( &prodPt );
+}
+
+/*********************************************************************
+ * @fn      consumer
+ *
+ * @brief   Waits for each item, then yields before the next one.
+ */
+static uint8 consumer( void )
+{
+  OSAL_PT_BEGIN( &consPt );
+
+  while ( consumed < ITEMS )
+  {
+    OSAL_PT_WAIT_UNTIL( &consPt, produced > consumed );
+    consumed++;
+    traceStep( "C", consumed );
+    OSAL_PT_YIELD( &consPt );
+  }
+
+  OSAL_PT_END( &consPt );
+}
+
+/*********************************************************************
+ * @fn      ping / pong
+ *
+ * @brief   Two coroutines of one task yielding to each other.
+ */
+static uint8 ping( void )
+{
+  OSAL_PT_BEGIN( &pingPt );
+
+  for ( pingCnt = 0; pingCnt < 3; pingCnt++ )
+  {
+    traceStep( "P", pingCnt );
+    OSAL_PT_YIELD( &pingPt );
+  }
+
+  OSAL_PT_END( &pingPt );
+}
+
+static uint8 pong( void )
+{
+  OSAL_PT_BEGIN( &pongPt );
+
+  for ( pongCnt = 0; pongCnt < 3; pongCnt++ )
+  {
+    traceStep( "Q", pongCnt );
+    OSAL_PT_YIELD( &pongPt );
+  }
+
+  OSAL_PT_END( &pongPt );
+}
+
+/*********************************************************************
+ * @fn      early
+ *
+ * @brief   Leaves before its end once it has waited 5 ms.
+ */
+static uint8 early( void )
+{
+  OSAL_PT_BEGIN( &exitPt );
+
+  OSAL_PT_WAIT_MS( &exitPt, 5 );
+  traceStep( "X", 0 );
+  OSAL_PT_EXIT( &exitPt );
+  traceStep( "never", 0 );
+
+  OSAL_PT_END( &exitPt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   Resumes each coroutine on its event.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & BLINK_EVT )
+  {
+    (void)blink();
+  }
+  if ( events & PROD_EVT )
+  {
+    (void)producer();
+  }
+  if ( events & PING_EVT )
+  {
+    (void)ping();
+  }
+  if ( events & PONG_EVT )
+  {
+    (void)pong();
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      drvTask_ProcessEvent
+ *
+ * @brief   Resumes each coroutine on its event.
+ */
+static uint16 drvTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & CONS_EVT )
+  {
+    (void)consumer();
+  }
+  if ( events & EXIT_EVT )
+  {
+    (void)early();
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  osal_init_system();
+
+  OSAL_PT_INIT( &blinkPt, APP_TASK, BLINK_EVT );
+  OSAL_PT_INIT( &prodPt, APP_TASK, PROD_EVT );
+  OSAL_PT_INIT( &pingPt, APP_TASK, PING_EVT );
+  OSAL_PT_INIT( &pongPt, APP_TASK, PONG_EVT );
+  OSAL_PT_INIT( &consPt, DRV_TASK, CONS_EVT );
+  OSAL_PT_INIT( &exitPt, DRV_TASK, EXIT_EVT );
+
+  // Timed, event and condition waits of three coroutines in two tasks
+  osal_set_event( APP_TASK, BLINK_EVT );
+  osal_set_event( APP_TASK, PROD_EVT );
+  osal_set_event( DRV_TASK, CONS_EVT );
+  osal_set_event( DRV_TASK, EXIT_EVT );
+  osal_run_virtual( 1000 );
+  HOST_CHECK_EQ( strcmp( trace, "B0@0 X0@5 B1@10 C1@25 B2@30 C2@50 B3@60 C3@75 B4@100 b5@150 " ), 0 );
+  printf( "%s\n", trace );
+
+  // Ended coroutines stay ended, whatever event comes late
+  HOST_CHECK_EQ( blink(), OSAL_PT_ENDED );
+  HOST_CHECK_EQ( consumer(), OSAL_PT_ENDED );
+  HOST_CHECK_EQ( early(), OSAL_PT_ENDED );
+  trace[0] = '\0';
+  osal_set_event( APP_TASK, BLINK_EVT | PROD_EVT );
+  osal_set_event( DRV_TASK, CONS_EVT | EXIT_EVT );
+  osal_run_virtual( 1000 );
+  HOST_CHECK_EQ( strcmp( trace, "" ), 0 );
+  HOST_CHECK_EQ( osal_next_timeout(), 0 );
+
+  // Two coroutines of one task take turns on each pass
+  osal_set_event( APP_TASK, PING_EVT | PONG_EVT );
+  osal_run_virtual( 10 );
+  HOST_CHECK_EQ( strcmp( trace, "P0@2000 Q0@2000 P1@2000 Q1@2000 P2@2000 Q2@2000 " ), 0 );
+  printf( "%s\n", trace );
+
+  // A restarted coroutine runs again from the top
+  trace[0] = '\0';
+  OSAL_PT_RESTART( &exitPt );
+  osal_set_event( DRV_TASK, EXIT_EVT );
+  osal_run_virtual( 10 );
+  HOST_CHECK_EQ( strcmp( trace, "X0@2015 " ), 0 );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,217 @@
+/**************************************************************************************************
+  Filename:       osal_stats_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Checks the per-task dispatch statistics and log2 histograms of
+                  osal_run_system(), timed by osal_time_us() on the virtual MAC timer.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Clock.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define RUN_EVT           0x0001
+#define KEEP_EVT          0x0002
+
+#define LAST_BUCKET       (OSAL_TASK_STATS_BUCKETS - 1)
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { testTask_ProcessEvent, testTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+// How long the next handler call takes, in microseconds
+static uint32 runUs;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void runOnce( uint8 task_id, uint32 wait, uint32 run );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      testTask_ProcessEvent
+ *
+ * @brief   Takes runUs, and hands KEEP_EVT back once.
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  osal_virtual_clock_us( runUs );
+
+  if ( events & KEEP_EVT )
+  {
+    return ( (events & ~KEEP_EVT) | RUN_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      runOnce
+ *
+ * @brief   Make a task ready, let it wait, then dispatch it once.
+ *
+ * @param   task_id - task to run
+ * @param   wait - microseconds from ready to dispatch
+ * @param   run - microseconds the event handler takes
+ */
+static void runOnce( uint8 task_id, uint32 wait, uint32 run )
+{
+  osal_set_event( task_id, RUN_EVT );
+  osal_virtual_clock_us( wait );
+  runUs = run;
+  osal_run_system();
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  // Run times at the edges of the buckets, and the bucket of each
+  static const uint32 runs[] = { 0, 1, 2, 3, 4, 255, 256, 319, 320, 16383, 16384, 0x10000 };
+  static const uint8 buckets[] = { 0, 1, 2, 2, 3, 8, 9, 9, 9, 14, LAST_BUCKET, LAST_BUCKET };
+  osal_task_stats_t stats;
+  uint32 total = 0;
+  uint32 n;
+  uint8 i;
+
+  osal_init_system();
+
+  for ( i = 0; i < sizeof( runs ) / sizeof( runs[0] ); i++ )
+  {
+    runOnce( 0, runs[i], runs[i] );
+    total += runs[i];
+  }
+
+  HOST_CHECK_EQ( osal_task_stats( 0, &stats, FALSE ), SUCCESS );
+  HOST_CHECK_EQ( stats.dispatches, sizeof( runs ) / sizeof( runs[0] ) );
+  HOST_CHECK_EQ( stats.runTotal, total );
+  HOST_CHECK_EQ( stats.runMax, 0xFFFF );      // Saturated, 0x10000 us
+  HOST_CHECK_EQ( stats.latencyMax, 0xFFFF );
+  for ( i = 0; i < OSAL_TASK_STATS_BUCKETS; i++ )
+  {
+    uint16 expect = 0;
+    uint8 j;
+
+    for ( j = 0; j < sizeof( buckets ); j++ )
+    {
+      expect += (buckets[j] == i);
+    }
+    HOST_CHECK_EQ( stats.runHist[i], expect );
+    HOST_CHECK_EQ( stats.latencyHist[i], expect );
+  }
+
+  // The last bucket starts at 2^(OSAL_TASK_STATS_BUCKETS - 2) us:
+  // 16.4 ms with the default 16 buckets
+  HOST_CHECK_EQ( 1UL << (OSAL_TASK_STATS_BUCKETS - 2), 16384 );
+
+  // The other task is untouched, reset clears after reading
+  HOST_CHECK_EQ( osal_task_stats( 1, &stats, FALSE ), SUCCESS );
+  HOST_CHECK_EQ( stats.dispatches, 0 );
+  HOST_CHECK_EQ( osal_task_stats( 0, &stats, TRUE ), SUCCESS );
+  HOST_CHECK_EQ( stats.dispatches, sizeof( runs ) / sizeof( runs[0] ) );
+  HOST_CHECK_EQ( osal_task_stats( 0, &stats, FALSE ), SUCCESS );
+  HOST_CHECK_EQ( stats.dispatches, 0 );
+  HOST_CHECK_EQ( stats.runTotal, 0 );
+  HOST_CHECK_EQ( stats.runHist[LAST_BUCKET], 0 );
+  HOST_CHECK_EQ( osal_task_stats( 2, &stats, FALSE ), INVALID_TASK );
+
+  // Handed back events are ready again when the handler returns
+  osal_set_event( 0, KEEP_EVT );
+  osal_virtual_clock_us( 5 );
+  runUs = 40;
+  osal_run_system();
+  osal_virtual_clock_us( 3 );
+  runUs = 0;
+  osal_run_system();
+  HOST_CHECK_EQ( osal_task_stats( 0, &stats, TRUE ), SUCCESS );
+  HOST_CHECK_EQ( stats.dispatches, 2 );
+  HOST_CHECK_EQ( stats.runMax, 40 );
+  HOST_CHECK_EQ( stats.latencyMax, 5 );
+  HOST_CHECK_EQ( stats.latencyHist[2], 1 );   // 3 us
+  HOST_CHECK_EQ( stats.latencyHist[3], 1 );   // 5 us
+
+  // Setting more events on a ready task keeps the first ready time
+  osal_set_event( 0, RUN_EVT );
+  osal_virtual_clock_us( 10 );
+  osal_set_event( 0, KEEP_EVT );
+  osal_virtual_clock_us( 10 );
+  runUs = 0;
+  osal_run_system();
+  osal_run_system();
+  HOST_CHECK_EQ( osal_task_stats( 0, &stats, TRUE ), SUCCESS );
+  HOST_CHECK_EQ( stats.latencyMax, 20 );
+
+  // Histogram counters saturate instead of wrapping
+  for ( n = 0; n < 0x10010UL; n++ )
+  {
+    runOnce( 1, 0, 1 );
+  }
+  HOST_CHECK_EQ( osal_task_stats( 1, &stats, FALSE ), SUCCESS );
+  HOST_CHECK_EQ( stats.dispatches, 0x10010UL );
+  HOST_CHECK_EQ( stats.runTotal, 0x10010UL );
+  HOST_CHECK_EQ( stats.runHist[1], 0xFFFF );
+  HOST_CHECK_EQ( stats.latencyHist[0], 0xFFFF );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,215 @@
+/**************************************************************************************************
+  Filename:       osal_time_us_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Checks osal_time_us() against a 64-bit reference over three wraps
+                  of the 320us tick count, awake and across sleep.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Clock.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+// The 32-bit count of 320us ticks wraps every 2^32 * 320 us, 15.9 days
+#define TICKS_WRAP_US     (4294967296ULL * 320)
+
+// Longest PM2 sleep, osalTimeUpdate() takes at most 65535 ms at a time
+#define SLEEP_MAX_US      60000000UL
+
+// Longest awake step, the 1 ms OSAL tick with some slack
+#define AWAKE_MAX_US      2000UL
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+extern uint32 macMcuPrecisionCount( void );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[] = { NULL };
+const uint8 tasksCnt = 0;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+// Microseconds since start up, the reference for osal_time_us()
+static unsigned long long refUs;
+static unsigned long long lastUs;
+static uint32 seed = 1;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint32 testRand( uint32 range );
+static void advance( uint32 us );
+static uint8 checkTime( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   No tasks, the test drives the clock itself.
+ */
+void osalInitTasks( void )
+{
+}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Deterministic random number below range.
+ */
+static uint32 testRand( uint32 range )
+{
+  seed = seed * 1103515245UL + 12345UL;
+
+  return ( ((seed >> 8) ^ (seed << 13)) % range );
+}
+
+/*********************************************************************
+ * @fn      advance
+ *
+ * @brief   Let the MAC timer run for us, or restore it after a sleep of
+ *          us, then run the OSAL loop once.
+ */
+static void advance( uint32 us )
+{
+  osal_virtual_clock_us( us );
+  refUs += us;
+  osal_run_system();
+}
+
+/*********************************************************************
+ * @fn      checkTime
+ *
+ * @brief   Compare osal_time_us() with the reference, and the OSAL
+ *          milliseconds with the ticks elapsed.
+ *
+ * @return  TRUE if both match
+ */
+static uint8 checkTime( void )
+{
+  osalTimeUs_t t;
+  unsigned long long us;
+  uint32 lo;
+  uint8 ok;
+
+  lo = osal_time_us( &t );
+  us = ((unsigned long long)t.hi << 32) | t.lo;
+  ok = (us == refUs) && (lo == t.lo) && (us >= lastUs);
+  lastUs = us;
+
+  if ( osal_GetSystemClock() != (uint32)(((refUs / 320) * 320) / 1000) )
+  {
+    ok = FALSE;
+  }
+
+  if ( !ok )
+  {
+    printf( "at %llu us: osal_time_us() %llu, OSAL clock %lu ms\n",
+            refUs, us, (unsigned long)osal_GetSystemClock() );
+  }
+
+  return ( ok );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 reads = 0;
+  uint32 steps = 0;
+  uint32 sleeps = 0;
+  uint8 wrap;
+
+  osal_init_system();
+  HOST_CHECK( checkTime() );
+
+  // First wrap without a single read: osalTimeUpdate() alone counts it
+  while ( refUs < TICKS_WRAP_US + SLEEP_MAX_US )
+  {
+    advance( SLEEP_MAX_US - testRand( 1000 ) );
+  }
+  HOST_CHECK( checkTime() );
+  HOST_CHECK( refUs / 320 > 0xFFFFFFFFULL );
+
+  // Two more wraps, reads after short awake steps between sleeps of up
+  // to a minute, one of them across the wrap
+  for ( wrap = 2; wrap <= 3; wrap++ )
+  {
+    while ( refUs < (wrap * TICKS_WRAP_US) - SLEEP_MAX_US )
+    {
+      if ( testRand( 8 ) == 0 )
+      {
+        // Awake for one OSAL pass, then the clock is read
+        advance( testRand( AWAKE_MAX_US ) );
+        if ( !checkTime() )
+        {
+          HOST_CHECK( FALSE );
+          break;
+        }
+        reads++;
+      }
+      else
+      {
+        advance( testRand( SLEEP_MAX_US ) + 1 );
+        sleeps++;
+      }
+      steps++;
+    }
+
+    // Asleep from before the wrap to after it
+    HOST_CHECK( macMcuPrecisionCount() > 0xFFFFFFFFUL - (SLEEP_MAX_US / 320) );
+    advance( SLEEP_MAX_US );
+    HOST_CHECK( macMcuPrecisionCount() < (SLEEP_MAX_US / 320) );
+    HOST_CHECK( checkTime() );
+  }
+
+  printf( "%.1f days, %lu steps: %lu reads while awake, %lu sleeps, 3 tick wraps\n",
+          (double)refUs / 86400e6, (unsigned long)steps, (unsigned long)reads,
+          (unsigned long)sleeps );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,264 @@
+/**************************************************************************************************
+  Filename:       osal_timers_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Runs 240 OSAL timers, one-shot, reload, stopped and restarted,
+                  for an hour of virtual time and checks every expiration.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Timers.h"
+#include "OnBoard.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_TASKS        16
+#define TEST_EVENTS       15      // SYS_EVENT_MSG is not used as a timer
+#define TEST_TIMERS       (TEST_TASKS * TEST_EVENTS)
+
+#define RUN_MSEC          (3600UL * 1000UL)
+#define CHECK_MSEC        1000UL  // compare the list with the model this often
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint32 due[TEST_TASKS][TEST_EVENTS];     // 0 while stopped
+static uint16 period[TEST_TASKS][TEST_EVENTS];
+static uint8  reload[TEST_TASKS][TEST_EVENTS];
+
+static uint32 fired;
+static uint32 lateOrEarly;
+static uint32 stray;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events );
+static void checkModel( void );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[TEST_TASKS] = {
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent,
+  testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent, testTask_ProcessEvent
+};
+const uint8 tasksCnt = TEST_TASKS;
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Arm every timer with a pseudo random period, every third one
+ *          reloading, the others re-armed by the task.
+ */
+void osalInitTasks( void )
+{
+  uint8 t, e;
+
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  for ( t = 0; t < TEST_TASKS; t++ )
+  {
+    for ( e = 0; e < TEST_EVENTS; e++ )
+    {
+      period[t][e] = 1 + (uint16)(Onboard_rand() % 5000);
+      reload[t][e] = (((t * TEST_EVENTS) + e) % 3) == 0;
+      due[t][e] = period[t][e];
+
+      if ( reload[t][e] )
+      {
+        osal_start_reload_timer( t, BV( e ), period[t][e] );
+      }
+      else
+      {
+        osal_start_timerEx( t, BV( e ), period[t][e] );
+      }
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      testTask_ProcessEvent
+ *
+ * @brief   Check each expiration against the model and re-arm.
+ */
+static uint16 testTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  uint32 now = osal_GetSystemClock();
+  uint8 e;
+
+  for ( e = 0; e < TEST_EVENTS; e++ )
+  {
+    if ( !(events & BV( e )) )
+    {
+      continue;
+    }
+
+    fired++;
+
+    if ( due[task_id][e] == 0 )
+    {
+      stray++;
+      continue;
+    }
+
+    if ( due[task_id][e] != now )
+    {
+      lateOrEarly++;
+    }
+
+    due[task_id][e] = now + period[task_id][e];
+    if ( !reload[task_id][e] )
+    {
+      osal_start_timerEx( task_id, BV( e ), period[task_id][e] );
+    }
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      checkModel
+ *
+ * @brief   Every running timer reports its remaining time, the next
+ *          timeout is the earliest of them.
+ */
+static void checkModel( void )
+{
+  uint32 now = osal_GetSystemClock();
+  uint32 next = 0xFFFFFFFFUL;
+  uint8 active = 0;
+  uint8 t, e;
+
+  for ( t = 0; t < TEST_TASKS; t++ )
+  {
+    for ( e = 0; e < TEST_EVENTS; e++ )
+    {
+      if ( due[t][e] )
+      {
+        HOST_CHECK_EQ( osal_get_timeoutEx( t, BV( e ) ), due[t][e] - now );
+        next = ( due[t][e] - now < next ) ? due[t][e] - now : next;
+        active++;
+      }
+      else
+      {
+        HOST_CHECK_EQ( osal_get_timeoutEx( t, BV( e ) ), 0 );
+      }
+    }
+  }
+
+  HOST_CHECK_EQ( osal_timer_num_active(), active );
+  HOST_CHECK_EQ( osal_next_timeout(), ( active ? next : 0 ) );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 elapsed;
+  uint32 expected;
+  double start;
+  double real;
+  uint8 t, e;
+
+  osal_init_system();
+  HOST_CHECK_EQ( osal_timer_num_active(), TEST_TIMERS );
+  checkModel();
+
+  real = 0;
+  for ( elapsed = 0; elapsed < RUN_MSEC; elapsed += CHECK_MSEC )
+  {
+    start = HOST_TEST_SECONDS();
+    osal_run_virtual( CHECK_MSEC );
+    real += HOST_TEST_SECONDS() - start;
+    checkModel();
+
+    // Half way, stop every fifth timer and restart every seventh with a
+    // new period, which moves it within the list
+    if ( elapsed == RUN_MSEC / 2 )
+    {
+      for ( t = 0; t < TEST_TASKS; t++ )
+      {
+        for ( e = 0; e < TEST_EVENTS; e++ )
+        {
+          if ( ((t * TEST_EVENTS) + e) % 5 == 0 )
+          {
+            osal_stop_timerEx( t, BV( e ) );
+            due[t][e] = 0;
+          }
+          else if ( ((t * TEST_EVENTS) + e) % 7 == 0 )
+          {
+            period[t][e] = 1 + (uint16)(Onboard_rand() % 5000);
+            reload[t][e] = FALSE;
+            osal_start_timerEx( t, BV( e ), period[t][e] );
+            due[t][e] = osal_GetSystemClock() + period[t][e];
+          }
+        }
+      }
+      checkModel();
+    }
+  }
+
+  // Each timer fired once per period while it ran
+  expected = 0;
+  for ( t = 0; t < TEST_TASKS; t++ )
+  {
+    for ( e = 0; e < TEST_EVENTS; e++ )
+    {
+      expected += ( due[t][e] ) ? 1 : 0;
+    }
+  }
+
+  printf( "%d timers, %lu expirations in an hour of virtual time, %.3f s real, %.2f us each\n",
+          TEST_TIMERS, (unsigned long)fired, real, real * 1e6 / fired );
+
+  HOST_CHECK_EQ( lateOrEarly, 0 );
+  HOST_CHECK_EQ( stray, 0 );
+  HOST_CHECK( fired > expected * 720 );   // the mean period is 2.5 s
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,235 @@
+/**************************************************************************************************
+  Filename:       osal_virtual_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Runs OSAL tasks in virtual time on the host: timers, messages
+                  and the clock over an hour of simulated time.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Clock.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TICK_EVT          0x0001
+#define FAST_EVT          0x0002
+
+#define TICK_PERIOD       1000   // reload timer, ms
+#define FAST_PERIOD       250    // re-armed by the task, ms
+
+#define RUN_MSEC          (3600UL * 1000UL)
+
+#define PING_MSG          0xE0
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 tickTaskID;
+static uint8 sinkTaskID;
+
+static uint32 ticks;
+static uint32 fastRuns;
+static uint32 pings;
+static uint32 lateRuns;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 tickTask_ProcessEvent( uint8 task_id, uint16 events );
+static uint16 sinkTask_ProcessEvent( uint8 task_id, uint16 events );
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+const pTaskEventHandlerFn tasksArr[] = {
+  tickTask_ProcessEvent,
+  sinkTask_ProcessEvent
+};
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  tickTaskID = 0;
+  sinkTaskID = 1;
+
+  osal_start_reload_timer( tickTaskID, TICK_EVT, TICK_PERIOD );
+  osal_start_timerEx( sinkTaskID, FAST_EVT, FAST_PERIOD );
+}
+
+/*********************************************************************
+ * @fn      tickTask_ProcessEvent
+ *
+ * @brief   Counts the reload timer and pings the other task.
+ */
+static uint16 tickTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  osal_event_hdr_t *msg;
+
+  if ( events & TICK_EVT )
+  {
+    ticks++;
+
+    // The clock must read exactly the expiry time, the run is not late
+    if ( osal_GetSystemClock() != ticks * TICK_PERIOD )
+    {
+      lateRuns++;
+    }
+
+    msg = (osal_event_hdr_t *)osal_msg_allocate( sizeof( osal_event_hdr_t ) );
+    if ( msg )
+    {
+      msg->event = PING_MSG;
+      osal_msg_send( sinkTaskID, (uint8 *)msg );
+    }
+
+    return ( events ^ TICK_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      sinkTask_ProcessEvent
+ *
+ * @brief   Consumes the pings and re-arms its own timer.
+ */
+static uint16 sinkTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  uint8 *msg;
+
+  if ( events & SYS_EVENT_MSG )
+  {
+    while ( (msg = osal_msg_receive( task_id )) != NULL )
+    {
+      if ( ((osal_event_hdr_t *)msg)->event == PING_MSG )
+      {
+        pings++;
+      }
+      osal_msg_deallocate( msg );
+    }
+
+    return ( events ^ SYS_EVENT_MSG );
+  }
+
+  if ( events & FAST_EVT )
+  {
+    fastRuns++;
+    osal_start_timerEx( task_id, FAST_EVT, FAST_PERIOD );
+
+    return ( events ^ FAST_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint16 heapUsed;
+  uint32 now;
+  uint32 n;
+  double start;
+  double real;
+
+  osal_init_system();
+
+  // The timers armed at init live in the heap, re-armed ones in a pool,
+  // so take the heap use for the leak check once they have cycled.
+  start = HOST_TEST_SECONDS();
+  osal_run_virtual( TICK_PERIOD );
+  heapUsed = osal_heap_mem_used();
+  osal_run_virtual( RUN_MSEC - TICK_PERIOD );
+  real = HOST_TEST_SECONDS() - start;
+
+  printf( "virtual %lu s in %.3f s real, %lu ticks, %lu fast runs, %lu pings\n",
+          (unsigned long)(osal_GetSystemClock() / 1000), real,
+          (unsigned long)ticks, (unsigned long)fastRuns, (unsigned long)pings );
+
+  HOST_CHECK_EQ( osal_GetSystemClock(), RUN_MSEC );
+  HOST_CHECK_EQ( osal_getClock(), RUN_MSEC / 1000 );
+  HOST_CHECK_EQ( ticks, RUN_MSEC / TICK_PERIOD );
+  HOST_CHECK_EQ( fastRuns, RUN_MSEC / FAST_PERIOD );
+  HOST_CHECK_EQ( pings, ticks );
+  HOST_CHECK_EQ( lateRuns, 0 );
+
+  // Every message was freed
+  HOST_CHECK_EQ( osal_heap_mem_used(), heapUsed );
+
+  // An hour of two busy timers must take well under a second
+  HOST_CHECK( real < 1.0 );
+
+  // With no timer left the run still ends on time
+  osal_stop_timerEx( tickTaskID, TICK_EVT );
+  osal_stop_timerEx( sinkTaskID, FAST_EVT );
+  osal_run_virtual( 100000UL );
+  HOST_CHECK_EQ( osal_GetSystemClock(), RUN_MSEC + 100000UL );
+
+  // Steps that are not whole 320us ticks move the clock exactly too
+  now = osal_GetSystemClock();
+  for ( n = 1; n <= 1000; n++ )
+  {
+    osal_virtual_clock_advance( (uint16)(n % 17) );
+    now += n % 17;
+    if ( osal_GetSystemClock() != now )
+    {
+      lateRuns++;
+    }
+  }
+  HOST_CHECK_EQ( lateRuns, 0 );
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,391 @@
+/**************************************************************************************************
+  Filename:       zcl_attr_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Passes read attribute and discover attribute commands for a large
+                  attribute set through zclProcessMessageMSG(), checks the responses and
+                  times the lookups.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "AF.h"
+#include "aps_groups.h"
+#include "aps_frag.h"
+#include "rtg.h"
+#include "zcl.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_ENDPOINT     8
+#define TEST_PROFILE_ID   0x0109
+
+// Four Smart Energy clusters of 60 attributes each, the IDs in sets of
+// 16 as the SE attribute sets are
+#define TEST_CLUSTERS     4
+#define ATTRS_PER_CLUSTER 60
+#define TEST_ATTRS        ( TEST_CLUSTERS * ATTRS_PER_CLUSTER )
+#define ATTR_ID( k )      ( (uint16)( ( ( (k) / 16 ) << 8 ) | ( (k) % 16 ) ) )
+
+#define READ_ATTRS        12
+#define DISC_ATTRS        20
+#define ROUNDS            2000
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+APSF_SendFragmented_t *apsfSendFragmented;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+extern void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static const uint16 clusterIds[TEST_CLUSTERS] = { 0x0700, 0x0702, 0x0703, 0x0704 };
+
+static uint8 appTaskId = 0;
+static SimpleDescriptionFormat_t appSimpleDesc;
+static endPointDesc_t appEpDesc;
+
+static zclAttrRec_t attrs[TEST_ATTRS];
+static uint16 attrValues[TEST_ATTRS];
+
+// Last frame sent
+static uint8 rspBuf[128];
+static uint16 rspLen;
+static uint16 rspCnt;
+
+static uint8 transSeq;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void sendCmd( uint16 clusterId, uint8 cmd, uint8 *pData, uint8 len );
+static void readAttrs( uint8 c, uint8 k, uint8 check );
+static uint8 discoverAttrs( uint8 c, uint8 check );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   The commands are passed to ZCL directly, not by the task.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( events & SYS_EVENT_MSG );
+}
+
+/*********************************************************************
+ * Stubs of the network layers below AF.
+ */
+uint8 aps_FindGroupForEndpoint( uint16 groupID, uint8 lastEP )
+{
+  (void)groupID;
+  (void)lastEP;
+  return ( APS_GROUPS_EP_NOT_FOUND );
+}
+
+ZStatus_t APSDE_DataReq( APSDE_DataReq_t *req )
+{
+  HOST_CHECK( req->asduLen <= sizeof( rspBuf ) );
+  osal_memcpy( rspBuf, req->asdu, req->asduLen );
+  rspLen = req->asduLen;
+  rspCnt++;
+  return ( ZSuccess );
+}
+
+uint8 APSDE_DataReqMTU( APSDE_DataReqMTU_t *fields )
+{
+  (void)fields;
+  return ( 80 );
+}
+
+uint16 NLME_GetShortAddr( void )
+{
+  return ( 0x0000 );
+}
+
+addr_filter_t NLME_IsAddressBroadcast( uint16 shortAddress )
+{
+  return ( (shortAddress >= 0xFFFC) ? ADDR_BCAST_FOR_ME : ADDR_NOT_BCAST );
+}
+
+RTG_Status_t RTG_CheckRtStatus( uint16 DstAddress, byte RtStatus, uint8 options )
+{
+  (void)DstAddress;
+  (void)RtStatus;
+  (void)options;
+  return ( RTG_SUCCESS );
+}
+
+RTG_Status_t RTG_AddSrcRtgEntry_Guaranteed( uint16 srcAddr, uint8 relayCnt,
+                                            uint16 *pRelayList )
+{
+  (void)srcAddr;
+  (void)relayCnt;
+  (void)pRelayList;
+  return ( RTG_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      sendCmd
+ *
+ * @brief   Pass a profile wide command to zclProcessMessageMSG(), the
+ *          response is left in rspBuf.
+ *
+ * @param   clusterId - cluster ID
+ * @param   cmd - command ID
+ * @param   pData - command payload
+ * @param   len - payload length
+ */
+static void sendCmd( uint16 clusterId, uint8 cmd, uint8 *pData, uint8 len )
+{
+  afIncomingMSGPacket_t pkt;
+  uint8 frame[3 + 2 * READ_ATTRS];
+
+  frame[0] = ZCL_FRAME_TYPE_PROFILE_CMD;
+  frame[1] = ++transSeq;
+  frame[2] = cmd;
+  osal_memcpy( &frame[3], pData, len );
+
+  osal_memset( &pkt, 0, sizeof( pkt ) );
+  pkt.clusterId = clusterId;
+  pkt.srcAddr.addrMode = afAddr16Bit;
+  pkt.srcAddr.addr.shortAddr = 0x1234;
+  pkt.srcAddr.endPoint = 1;
+  pkt.endPoint = TEST_ENDPOINT;
+  pkt.cmd.DataLength = 3 + len;
+  pkt.cmd.Data = frame;
+
+  rspLen = 0;
+  zclProcessMessageMSG( &pkt );
+}
+
+/*********************************************************************
+ * @fn      readAttrs
+ *
+ * @brief   Read READ_ATTRS attributes of a cluster, the last one of
+ *          them unsupported.
+ *
+ * @param   c - cluster
+ * @param   k - first attribute of the cluster
+ * @param   check - TRUE to check the response
+ */
+static void readAttrs( uint8 c, uint8 k, uint8 check )
+{
+  uint8 req[2 * READ_ATTRS];
+  uint8 *p;
+  uint8 i;
+
+  for ( i = 0; i < READ_ATTRS; i++ )
+  {
+    uint16 id = ( i < READ_ATTRS - 1 ) ? ATTR_ID( k + i ) : 0x0F0F;
+
+    req[2 * i] = LO_UINT16( id );
+    req[2 * i + 1] = HI_UINT16( id );
+  }
+
+  sendCmd( clusterIds[c], ZCL_CMD_READ, req, sizeof( req ) );
+  if ( !check )
+  {
+    return;
+  }
+
+  HOST_CHECK_EQ( rspBuf[2], ZCL_CMD_READ_RSP );
+  HOST_CHECK_EQ( rspBuf[1], transSeq );
+  p = &rspBuf[3];
+  for ( i = 0; i < READ_ATTRS - 1; i++ )
+  {
+    HOST_CHECK_EQ( BUILD_UINT16( p[0], p[1] ), ATTR_ID( k + i ) );
+    HOST_CHECK_EQ( p[2], ZCL_STATUS_SUCCESS );
+    HOST_CHECK_EQ( p[3], ZCL_DATATYPE_UINT16 );
+    HOST_CHECK_EQ( BUILD_UINT16( p[4], p[5] ),
+                   attrValues[c * ATTRS_PER_CLUSTER + k + i] );
+    p += 6;
+  }
+  HOST_CHECK_EQ( BUILD_UINT16( p[0], p[1] ), 0x0F0F );
+  HOST_CHECK_EQ( p[2], ZCL_STATUS_UNSUPPORTED_ATTRIBUTE );
+  HOST_CHECK_EQ( p + 3 - rspBuf, rspLen );
+}
+
+/*********************************************************************
+ * @fn      discoverAttrs
+ *
+ * @brief   Discover every attribute of a cluster, DISC_ATTRS at a time.
+ *
+ * @param   c - cluster
+ * @param   check - TRUE to check the responses
+ *
+ * @return  number of discover commands
+ */
+static uint8 discoverAttrs( uint8 c, uint8 check )
+{
+  uint8 req[3];
+  uint16 start = 0;
+  uint8 k = 0;
+  uint8 cmds = 0;
+  uint8 i, n;
+
+  do
+  {
+    req[0] = LO_UINT16( start );
+    req[1] = HI_UINT16( start );
+    req[2] = DISC_ATTRS;
+    sendCmd( clusterIds[c], ZCL_CMD_DISCOVER, req, sizeof( req ) );
+    cmds++;
+
+    n = ( rspLen - 4 ) / 3;
+    if ( check )
+    {
+      HOST_CHECK_EQ( rspBuf[2], ZCL_CMD_DISCOVER_RSP );
+      HOST_CHECK_EQ( rspBuf[3], ( k + n == ATTRS_PER_CLUSTER ) );
+      HOST_CHECK_EQ( n, ( ATTRS_PER_CLUSTER - k < DISC_ATTRS ) ? ATTRS_PER_CLUSTER - k : DISC_ATTRS );
+      for ( i = 0; i < n; i++ )
+      {
+        HOST_CHECK_EQ( BUILD_UINT16( rspBuf[4 + 3 * i], rspBuf[5 + 3 * i] ), ATTR_ID( k + i ) );
+        HOST_CHECK_EQ( rspBuf[6 + 3 * i], ZCL_DATATYPE_UINT16 );
+      }
+    }
+    k += n;
+    start = ATTR_ID( k - 1 ) + 1;
+  } while ( ( rspBuf[3] == FALSE ) && ( n != 0 ) );
+
+  return ( cmds );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  double t0, readUs, discUs;
+  uint16 r;
+  uint8 c, k;
+
+  osal_init_system();
+
+  appSimpleDesc.EndPoint = TEST_ENDPOINT;
+  appSimpleDesc.AppProfId = TEST_PROFILE_ID;
+  appEpDesc.endPoint = TEST_ENDPOINT;
+  appEpDesc.task_id = &appTaskId;
+  appEpDesc.simpleDesc = &appSimpleDesc;
+  appEpDesc.latencyReq = noLatencyReqs;
+  HOST_CHECK_EQ( afRegister( &appEpDesc ), afStatus_SUCCESS );
+
+  for ( c = 0; c < TEST_CLUSTERS; c++ )
+  {
+    for ( k = 0; k < ATTRS_PER_CLUSTER; k++ )
+    {
+      zclAttrRec_t *pAttr = &attrs[c * ATTRS_PER_CLUSTER + k];
+
+      attrValues[c * ATTRS_PER_CLUSTER + k] = (uint16)( c * 1000 + k * 3 + 1 );
+      pAttr->clusterID = clusterIds[c];
+      pAttr->attr.attrId = ATTR_ID( k );
+      pAttr->attr.dataType = ZCL_DATATYPE_UINT16;
+      pAttr->attr.accessControl = ACCESS_CONTROL_READ;
+      pAttr->attr.dataPtr = &attrValues[c * ATTRS_PER_CLUSTER + k];
+    }
+  }
+  HOST_CHECK_EQ( zcl_registerAttrList( TEST_ENDPOINT, TEST_ATTRS, attrs ), ZSuccess );
+
+  // Every attribute read and discovered once with the responses checked
+  for ( c = 0; c < TEST_CLUSTERS; c++ )
+  {
+    for ( k = 0; k + READ_ATTRS - 1 <= ATTRS_PER_CLUSTER; k += READ_ATTRS - 1 )
+    {
+      readAttrs( c, k, TRUE );
+    }
+    HOST_CHECK_EQ( discoverAttrs( c, TRUE ),
+                   ( ATTRS_PER_CLUSTER + DISC_ATTRS - 1 ) / DISC_ATTRS );
+  }
+
+  // Discovery from an ID between two sets starts at the next set
+  {
+    uint8 req[3] = { 0x10, 0x00, 2 };
+
+    sendCmd( clusterIds[1], ZCL_CMD_DISCOVER, req, sizeof( req ) );
+    HOST_CHECK_EQ( rspLen, 4 + 2 * 3 );
+    HOST_CHECK_EQ( BUILD_UINT16( rspBuf[4], rspBuf[5] ), 0x0100 );
+    HOST_CHECK_EQ( BUILD_UINT16( rspBuf[7], rspBuf[8] ), 0x0101 );
+    HOST_CHECK_EQ( rspBuf[3], FALSE );
+  }
+
+  // Timing: reads spread over the table, full discovery of the last cluster
+  t0 = HOST_TEST_SECONDS();
+  for ( r = 0; r < ROUNDS; r++ )
+  {
+    readAttrs( r % TEST_CLUSTERS, (uint8)( r % ( ATTRS_PER_CLUSTER - READ_ATTRS + 2 ) ), FALSE );
+  }
+  readUs = ( HOST_TEST_SECONDS() - t0 ) * 1e6 / ROUNDS;
+
+  t0 = HOST_TEST_SECONDS();
+  for ( r = 0; r < ROUNDS; r++ )
+  {
+    (void)discoverAttrs( TEST_CLUSTERS - 1, FALSE );
+  }
+  discUs = ( HOST_TEST_SECONDS() - t0 ) * 1e6 / ROUNDS;
+
+  printf( "%d attributes: read of %d attributes %.2f us, discovery of %d attributes %.2f us\n",
+          TEST_ATTRS, READ_ATTRS, readUs, ATTRS_PER_CLUSTER, discUs );
+
+  return ( HOST_TEST_RESULT() );
+}
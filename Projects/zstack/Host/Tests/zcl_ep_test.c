@@ -0,0 +1,280 @@
+/**************************************************************************************************
+  Filename:       zcl_ep_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Passes read attribute commands to many registered endpoints through
+                  zclProcessMessageMSG(), checks every response and measures the frame
+                  throughput.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "AF.h"
+#include "aps_groups.h"
+#include "aps_frag.h"
+#include "rtg.h"
+#include "zcl.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_PROFILE_ID   0x0104
+#define TEST_CLUSTER_ID   0x0402
+#define FIRST_ENDPOINT    10
+
+#define TEST_EPS          16
+#define EP_ATTRS          4
+#define FRAMES            40000
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+APSF_SendFragmented_t *apsfSendFragmented;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+extern void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 appTaskId = 0;
+static SimpleDescriptionFormat_t epSimpleDesc[TEST_EPS];
+static endPointDesc_t epDescs[TEST_EPS];
+
+static zclAttrRec_t epAttrs[TEST_EPS][EP_ATTRS];
+static zclOptionRec_t epOptions[TEST_EPS][1];
+static int16 epValues[TEST_EPS][EP_ATTRS];
+
+// Last frame sent
+static uint8 rspBuf[80];
+static uint16 rspLen;
+static uint8 rspEP;
+
+static uint8 transSeq;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void readAttrs( uint8 endPoint );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   The commands are passed to ZCL directly, not by the task.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( events & SYS_EVENT_MSG );
+}
+
+/*********************************************************************
+ * Stubs of the network layers below AF.
+ */
+uint8 aps_FindGroupForEndpoint( uint16 groupID, uint8 lastEP )
+{
+  (void)groupID;
+  (void)lastEP;
+  return ( APS_GROUPS_EP_NOT_FOUND );
+}
+
+ZStatus_t APSDE_DataReq( APSDE_DataReq_t *req )
+{
+  HOST_CHECK( req->asduLen <= sizeof( rspBuf ) );
+  osal_memcpy( rspBuf, req->asdu, req->asduLen );
+  rspLen = req->asduLen;
+  rspEP = req->srcEP;
+  return ( ZSuccess );
+}
+
+uint8 APSDE_DataReqMTU( APSDE_DataReqMTU_t *fields )
+{
+  (void)fields;
+  return ( 80 );
+}
+
+uint16 NLME_GetShortAddr( void )
+{
+  return ( 0x0000 );
+}
+
+addr_filter_t NLME_IsAddressBroadcast( uint16 shortAddress )
+{
+  return ( (shortAddress >= 0xFFFC) ? ADDR_BCAST_FOR_ME : ADDR_NOT_BCAST );
+}
+
+RTG_Status_t RTG_CheckRtStatus( uint16 DstAddress, byte RtStatus, uint8 options )
+{
+  (void)DstAddress;
+  (void)RtStatus;
+  (void)options;
+  return ( RTG_SUCCESS );
+}
+
+RTG_Status_t RTG_AddSrcRtgEntry_Guaranteed( uint16 srcAddr, uint8 relayCnt,
+                                            uint16 *pRelayList )
+{
+  (void)srcAddr;
+  (void)relayCnt;
+  (void)pRelayList;
+  return ( RTG_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      readAttrs
+ *
+ * @brief   Pass a read of the last two attributes of the cluster to
+ *          zclProcessMessageMSG(), the response is left in rspBuf.
+ *
+ * @param   endPoint - destination endpoint
+ */
+static void readAttrs( uint8 endPoint )
+{
+  afIncomingMSGPacket_t pkt;
+  uint8 frame[7];
+
+  frame[0] = ZCL_FRAME_TYPE_PROFILE_CMD;
+  frame[1] = ++transSeq;
+  frame[2] = ZCL_CMD_READ;
+  frame[3] = LO_UINT16( EP_ATTRS - 2 );
+  frame[4] = HI_UINT16( EP_ATTRS - 2 );
+  frame[5] = LO_UINT16( EP_ATTRS - 1 );
+  frame[6] = HI_UINT16( EP_ATTRS - 1 );
+
+  osal_memset( &pkt, 0, sizeof( pkt ) );
+  pkt.clusterId = TEST_CLUSTER_ID;
+  pkt.srcAddr.addrMode = afAddr16Bit;
+  pkt.srcAddr.addr.shortAddr = 0x1234;
+  pkt.srcAddr.endPoint = 1;
+  pkt.endPoint = endPoint;
+  pkt.cmd.DataLength = sizeof( frame );
+  pkt.cmd.Data = frame;
+
+  rspLen = 0;
+  zclProcessMessageMSG( &pkt );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  double t0, us;
+  uint32 n;
+  uint8 i, k;
+
+  osal_init_system();
+
+  for ( i = 0; i < TEST_EPS; i++ )
+  {
+    epSimpleDesc[i].EndPoint = FIRST_ENDPOINT + i;
+    epSimpleDesc[i].AppProfId = TEST_PROFILE_ID;
+    epDescs[i].endPoint = FIRST_ENDPOINT + i;
+    epDescs[i].task_id = &appTaskId;
+    epDescs[i].simpleDesc = &epSimpleDesc[i];
+    epDescs[i].latencyReq = noLatencyReqs;
+    HOST_CHECK_EQ( afRegister( &epDescs[i] ), afStatus_SUCCESS );
+
+    for ( k = 0; k < EP_ATTRS; k++ )
+    {
+      epValues[i][k] = (int16)( i * 100 + k );
+      epAttrs[i][k].clusterID = TEST_CLUSTER_ID;
+      epAttrs[i][k].attr.attrId = k;
+      epAttrs[i][k].attr.dataType = ZCL_DATATYPE_INT16;
+      epAttrs[i][k].attr.accessControl = ACCESS_CONTROL_READ;
+      epAttrs[i][k].attr.dataPtr = &epValues[i][k];
+    }
+    HOST_CHECK_EQ( zcl_registerAttrList( FIRST_ENDPOINT + i, EP_ATTRS, epAttrs[i] ), ZSuccess );
+
+    epOptions[i][0].clusterID = TEST_CLUSTER_ID;
+    epOptions[i][0].option = AF_ACK_REQUEST;
+    HOST_CHECK_EQ( zcl_registerClusterOptionList( FIRST_ENDPOINT + i, 1, epOptions[i] ), ZSuccess );
+  }
+
+  // Each endpoint answers with its own attributes
+  for ( i = 0; i < TEST_EPS; i++ )
+  {
+    readAttrs( FIRST_ENDPOINT + i );
+    HOST_CHECK_EQ( rspEP, FIRST_ENDPOINT + i );
+    HOST_CHECK_EQ( rspLen, 3 + 2 * 6 );
+    HOST_CHECK_EQ( rspBuf[2], ZCL_CMD_READ_RSP );
+    HOST_CHECK_EQ( rspBuf[5], ZCL_STATUS_SUCCESS );
+    HOST_CHECK_EQ( (int16)BUILD_UINT16( rspBuf[7], rspBuf[8] ), epValues[i][EP_ATTRS - 2] );
+    HOST_CHECK_EQ( (int16)BUILD_UINT16( rspBuf[13], rspBuf[14] ), epValues[i][EP_ATTRS - 1] );
+  }
+
+  // Nothing answers for an endpoint that is not registered
+  readAttrs( FIRST_ENDPOINT + TEST_EPS );
+  HOST_CHECK_EQ( rspLen, 0 );
+
+  // Frames round robin from the last registered endpoint down
+  t0 = HOST_TEST_SECONDS();
+  for ( n = 0; n < FRAMES; n++ )
+  {
+    readAttrs( FIRST_ENDPOINT + TEST_EPS - 1 - ( n % TEST_EPS ) );
+  }
+  us = ( HOST_TEST_SECONDS() - t0 ) * 1e6 / FRAMES;
+  HOST_CHECK_EQ( rspEP, FIRST_ENDPOINT );
+
+  printf( "%d endpoints, %d slots: %.3f us per read frame, %.0f frames/s\n",
+          TEST_EPS, AF_MAX_EP_SLOTS, us, 1e6 / us );
+
+  return ( HOST_TEST_RESULT() );
+}
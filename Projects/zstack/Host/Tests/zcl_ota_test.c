@@ -0,0 +1,851 @@
+/**************************************************************************************************
+  Filename:       zcl_ota_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Downloads an OTA image through the OTA client from a model of the server
+                  and the network, measures the download time and the frames sent, and
+                  checks that Image Block Responses longer than asked for are dropped
+                  and that the in-tree server streams a page to one client at a time.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "AF.h"
+#include "aps_groups.h"
+#include "aps_frag.h"
+#include "rtg.h"
+#include "ZDObject.h"
+#include "zcl.h"
+#include "zcl_ota.h"
+#include "hal_ota.h"
+#include "MT_OTA.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define SRV_NWK_ADDR      0x0000
+#define SRV_ENDPOINT      1
+#define SRV_RSP_EVT       0x0001
+#define SRV_FILE_VERSION  2
+#define PEER_NWK_ADDR     0x3412    // a client with the same low bytes as PEER_EXT_ADDR
+#define PAGE_BLOCKS       4
+
+#define IMAGE_SIZE        ( 128UL * 1024 )
+#define IMAGE_HDR_LEN     56
+#define IMAGE_ELEM_LEN    6         // tag and length of the upgrade image element
+
+// Server and network model
+#define SRV_BUSY_MSEC     4         // the server and the radio take 4 ms plus
+#define SRV_BYTES_PER_MS  8         // 1 ms per 8 bytes for each frame
+#define RSP_MIN_MSEC      10        // then a response takes 10 to 40 ms
+#define RSP_VAR_MSEC      31        // to get to the client
+#define RSP_MAX           64        // responses on their way
+#define LOSS_PCT          5
+#define RUN_MAX_MSEC      3600000UL
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint32 offset;
+  uint8  len;
+  uint32 dueMSec;
+} srvRsp_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 srvTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { zclOTA_event_loop, srvTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+APSF_SendFragmented_t *apsfSendFragmented;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+extern void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );
+
+/*********************************************************************
+ * EXTERNAL VARIABLES
+ */
+extern zclOTA_QueryImageRspParams_t queryResponse;  // image the server offers
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 otaTaskId = 0;
+static uint8 srvTaskId = 1;
+
+// The image served and the flash it is downloaded to
+static uint8 image[IMAGE_SIZE];
+static uint8 flash[IMAGE_SIZE];
+static uint32 imageSize;
+
+// Server model
+static uint8 srvMtu;             // longest block the server sends
+static uint8 srvPage;            // the server streams Image Page Requests
+static uint8 srvMute;            // the server ignores requests
+static uint8 lossPct;
+static uint32 srvFreeMSec;       // the server is busy until then
+static srvRsp_t srvRsps[RSP_MAX];
+static uint8 srvRspCnt;
+
+// OTA Console reads of the in-tree server
+static uint32 srvReads;
+static afAddrType_t srvReadAddr;
+static uint32 waitRsps;          // Wait For Data sent by the in-tree server
+
+// What the client sent
+static uint32 reqFrames;         // Image Block and Image Page Requests
+static uint32 rspFrames;         // Image Block Responses, lost ones included
+static uint8 endStatus;          // of the Upgrade End Request
+static uint32 endMSec;
+static uint8 defaultRspStatus;
+
+static afAddrType_t srvAddr;
+static uint8 transSeq;
+static uint32 randSeed = 1;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testRand( void );
+static void srvArm( void );
+static void srvSend( uint32 offset, uint8 len, uint32 sentMSec );
+static void srvRequest( uint8 *pData, uint16 len );
+static void otaDeliver( afAddrType_t *pSrcAddr, uint8 toClient, uint8 cmd, uint8 *pData, uint16 len );
+static void sendImagePageReq( afAddrType_t *pSrcAddr );
+static void sendQueryNextImageRsp( void );
+static void sendImageBlockRsp( uint32 offset, uint8 dataSize, uint16 len );
+static void makeImage( uint32 size );
+static void startDownload( uint32 size );
+static uint32 runDownload( uint32 size, uint8 mtu, uint8 loss );
+static void checkBlockLen( void );
+static void checkPagePeer( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test: the OTA client and the server model.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+
+  zclOTA_Init( otaTaskId );
+}
+
+/*********************************************************************
+ * @fn      srvTask_ProcessEvent
+ *
+ * @brief   Pass the responses that are due to the client.
+ */
+static uint16 srvTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  srvRsp_t rsp;
+  uint32 now;
+  uint8 x, first;
+
+  (void)task_id;
+
+  if ( events & SRV_RSP_EVT )
+  {
+    now = osal_GetSystemClock();
+
+    while ( srvRspCnt != 0 )
+    {
+      for ( x = 1, first = 0; x < srvRspCnt; x++ )
+      {
+        if ( srvRsps[x].dueMSec < srvRsps[first].dueMSec )
+        {
+          first = x;
+        }
+      }
+
+      if ( srvRsps[first].dueMSec > now )
+      {
+        break;
+      }
+
+      rsp = srvRsps[first];
+      srvRsps[first] = srvRsps[--srvRspCnt];
+      sendImageBlockRsp( rsp.offset, rsp.len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + rsp.len );
+    }
+
+    srvArm();
+
+    return ( events ^ SRV_RSP_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * Stubs of the network layers below AF.
+ */
+uint8 aps_FindGroupForEndpoint( uint16 groupID, uint8 lastEP )
+{
+  (void)groupID;
+  (void)lastEP;
+  return ( APS_GROUPS_EP_NOT_FOUND );
+}
+
+ZStatus_t APSDE_DataReq( APSDE_DataReq_t *req )
+{
+  srvRequest( req->asdu, req->asduLen );
+  return ( ZSuccess );
+}
+
+uint8 APSDE_DataReqMTU( APSDE_DataReqMTU_t *fields )
+{
+  (void)fields;
+  return ( 80 );
+}
+
+uint16 NLME_GetShortAddr( void )
+{
+  return ( 0x0001 );
+}
+
+addr_filter_t NLME_IsAddressBroadcast( uint16 shortAddress )
+{
+  return ( (shortAddress >= 0xFFFC) ? ADDR_BCAST_FOR_ME : ADDR_NOT_BCAST );
+}
+
+RTG_Status_t RTG_CheckRtStatus( uint16 DstAddress, byte RtStatus, uint8 options )
+{
+  (void)DstAddress;
+  (void)RtStatus;
+  (void)options;
+  return ( RTG_SUCCESS );
+}
+
+RTG_Status_t RTG_AddSrcRtgEntry_Guaranteed( uint16 srcAddr, uint8 relayCnt,
+                                            uint16 *pRelayList )
+{
+  (void)srcAddr;
+  (void)relayCnt;
+  (void)pRelayList;
+  return ( RTG_SUCCESS );
+}
+
+/*********************************************************************
+ * Stubs of ZDO.
+ */
+ZStatus_t ZDO_RegisterForZDOMsg( uint8 taskID, uint16 clusterID )
+{
+  (void)taskID;
+  (void)clusterID;
+  return ( ZSuccess );
+}
+
+afStatus_t ZDP_IEEEAddrReq( uint16 shortAddr, byte ReqType, byte StartIndex, byte SecurityEnable )
+{
+  (void)shortAddr;
+  (void)ReqType;
+  (void)StartIndex;
+  (void)SecurityEnable;
+  return ( afStatus_SUCCESS );
+}
+
+ZDO_NwkIEEEAddrResp_t *ZDO_ParseAddrRsp( zdoIncomingMsg_t *inMsg )
+{
+  (void)inMsg;
+  return ( NULL );
+}
+
+/*********************************************************************
+ * Stubs of the OTA flash. A write that starts a page erases it first.
+ */
+void HalOTAWrite( uint32 oset, uint8 *pBuf, uint16 len, image_t type )
+{
+  (void)type;
+
+  if ( ( oset % HAL_FLASH_PAGE_SIZE ) == 0 )
+  {
+    osal_memset( &flash[oset], 0xFF, ( IMAGE_SIZE - oset < HAL_FLASH_PAGE_SIZE ) ?
+                                     IMAGE_SIZE - oset : HAL_FLASH_PAGE_SIZE );
+  }
+
+  osal_memcpy( &flash[oset], pBuf, len );
+}
+
+uint8 HalOTAChkDL( uint8 dlImagePreambleOffset )
+{
+  (void)dlImagePreambleOffset;
+  return ( osal_memcmp( flash, image, imageSize ) ? SUCCESS : FAILURE );
+}
+
+void HalOTAInvRC( void )
+{
+}
+
+/*********************************************************************
+ * Stubs of the OTA Console. Reads are counted, not answered.
+ */
+void MT_OtaRegister( uint8 taskId )
+{
+  (void)taskId;
+}
+
+uint8 MT_OtaFileReadReq( afAddrType_t *pAddr, zclOTA_FileID_t *pFileId,
+                         uint8 len, uint32 offset )
+{
+  (void)pFileId;
+  (void)len;
+  (void)offset;
+
+  srvReads++;
+  srvReadAddr = *pAddr;
+  return ( ZSuccess );
+}
+
+uint8 MT_OtaGetImage( afAddrType_t *pAddr, zclOTA_FileID_t *pFileId,
+                      uint16 hwVer, uint8 *ieee, uint8 options )
+{
+  (void)pAddr;
+  (void)pFileId;
+  (void)hwVer;
+  (void)ieee;
+  (void)options;
+  return ( ZSuccess );
+}
+
+uint8 MT_OtaSendStatus( uint16 shortAddr, uint8 type, uint8 status, uint8 optional )
+{
+  (void)shortAddr;
+  (void)type;
+  (void)status;
+  (void)optional;
+  return ( ZSuccess );
+}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Repeatable pseudo random numbers.
+ */
+static uint16 testRand( void )
+{
+  randSeed = randSeed * 1103515245UL + 12345;
+  return ( (uint16)( randSeed >> 16 ) );
+}
+
+/*********************************************************************
+ * @fn      srvArm
+ *
+ * @brief   Run the server task when the first response is due.
+ */
+static void srvArm( void )
+{
+  uint32 now = osal_GetSystemClock();
+  uint32 due;
+  uint8 x;
+
+  if ( srvRspCnt == 0 )
+  {
+    osal_stop_timerEx( srvTaskId, SRV_RSP_EVT );
+    return;
+  }
+
+  for ( x = 1, due = srvRsps[0].dueMSec; x < srvRspCnt; x++ )
+  {
+    if ( srvRsps[x].dueMSec < due )
+    {
+      due = srvRsps[x].dueMSec;
+    }
+  }
+
+  if ( due > now )
+  {
+    osal_start_timerEx( srvTaskId, SRV_RSP_EVT, (uint16)( due - now ) );
+  }
+  else
+  {
+    osal_set_event( srvTaskId, SRV_RSP_EVT );
+  }
+}
+
+/*********************************************************************
+ * @fn      srvSend
+ *
+ * @brief   Send an Image Block Response over the lossy network.
+ *
+ * @param   offset - file offset of the block
+ * @param   len - length of the block
+ * @param   sentMSec - when the server is done sending it
+ */
+static void srvSend( uint32 offset, uint8 len, uint32 sentMSec )
+{
+  rspFrames++;
+
+  if ( ( testRand() % 100 ) < lossPct )
+  {
+    return;
+  }
+
+  HOST_CHECK( srvRspCnt < RSP_MAX );
+  if ( srvRspCnt < RSP_MAX )
+  {
+    srvRsps[srvRspCnt].offset = offset;
+    srvRsps[srvRspCnt].len = len;
+    srvRsps[srvRspCnt].dueMSec = sentMSec + RSP_MIN_MSEC + ( testRand() % RSP_VAR_MSEC );
+    srvRspCnt++;
+  }
+
+  srvArm();
+}
+
+/*********************************************************************
+ * @fn      srvRequest
+ *
+ * @brief   Serve a ZCL frame of the client. The server and the radio
+ *          handle one frame at a time.
+ *
+ * @param   pData - ZCL frame
+ * @param   len - length of the frame
+ */
+static void srvRequest( uint8 *pData, uint16 len )
+{
+  uint32 now = osal_GetSystemClock();
+  uint32 t = ( srvFreeMSec > now ) ? srvFreeMSec : now;
+  uint32 offset, end;
+  uint16 spacing, busy;
+  uint8 maxLen, blockLen;
+
+  if ( ( pData[0] & ZCL_FRAME_CONTROL_TYPE ) != ZCL_FRAME_TYPE_SPECIFIC_CMD )
+  {
+    if ( pData[2] == ZCL_CMD_DEFAULT_RSP )
+    {
+      defaultRspStatus = pData[4];
+    }
+    return;
+  }
+
+  pData += 3;
+  len -= 3;
+
+  switch ( pData[-1] )
+  {
+    case COMMAND_IMAGE_BLOCK_REQ:
+      reqFrames++;
+      if ( srvMute )
+      {
+        break;
+      }
+
+      offset = osal_build_uint32( &pData[9], 4 );
+      blockLen = ( pData[13] < srvMtu ) ? pData[13] : srvMtu;
+
+      t += SRV_BUSY_MSEC + blockLen / SRV_BYTES_PER_MS;
+      srvFreeMSec = t;
+      srvSend( offset, blockLen, t );
+      break;
+
+    case COMMAND_IMAGE_PAGE_REQ:
+      reqFrames++;
+      if ( srvMute || !srvPage )
+      {
+        break;
+      }
+
+      offset = osal_build_uint32( &pData[9], 4 );
+      maxLen = ( pData[13] < srvMtu ) ? pData[13] : srvMtu;
+      end = offset + BUILD_UINT16( pData[14], pData[15] );
+      spacing = BUILD_UINT16( pData[16], pData[17] );
+
+      for ( ; offset < end; offset += blockLen )
+      {
+        blockLen = ( end - offset < maxLen ) ? end - offset : maxLen;
+        busy = SRV_BUSY_MSEC + blockLen / SRV_BYTES_PER_MS;
+        t += ( spacing > busy ) ? spacing : busy;
+        srvSend( offset, blockLen, t );
+      }
+      srvFreeMSec = t;
+      break;
+
+    case COMMAND_IMAGE_BLOCK_RSP:
+      if ( pData[0] == ZOtaWaitForData )
+      {
+        waitRsps++;
+      }
+      break;
+
+    case COMMAND_UPGRADE_END_REQ:
+      endStatus = pData[0];
+      endMSec = now;
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*********************************************************************
+ * @fn      otaDeliver
+ *
+ * @brief   Pass an OTA command to zclProcessMessageMSG().
+ *
+ * @param   pSrcAddr - sender
+ * @param   toClient - a command of the server to the client
+ * @param   cmd - command ID
+ * @param   pData - command payload
+ * @param   len - length of the payload
+ */
+static void otaDeliver( afAddrType_t *pSrcAddr, uint8 toClient, uint8 cmd, uint8 *pData, uint16 len )
+{
+  afIncomingMSGPacket_t pkt;
+  uint8 frame[3 + PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + 0xFF];
+
+  frame[0] = ZCL_FRAME_TYPE_SPECIFIC_CMD | ( toClient ? ZCL_FRAME_CONTROL_DIRECTION : 0 );
+  frame[1] = ++transSeq;
+  frame[2] = cmd;
+  osal_memcpy( &frame[3], pData, len );
+
+  osal_memset( &pkt, 0, sizeof( pkt ) );
+  pkt.clusterId = ZCL_CLUSTER_ID_OTA;
+  pkt.srcAddr = *pSrcAddr;
+  pkt.endPoint = ZCL_OTA_ENDPOINT;
+  pkt.SecurityUse = FALSE;  // the cluster option drops security when SECURE=0
+  pkt.cmd.DataLength = 3 + len;
+  pkt.cmd.Data = frame;
+
+  zclProcessMessageMSG( &pkt );
+}
+
+/*********************************************************************
+ * @fn      sendQueryNextImageRsp
+ *
+ * @brief   Offer the image to the client, which starts the download.
+ */
+static void sendQueryNextImageRsp( void )
+{
+  uint8 buf[PAYLOAD_MAX_LEN_QUERY_NEXT_IMAGE_RSP];
+  uint8 *pBuf = buf;
+
+  *pBuf++ = ZCL_STATUS_SUCCESS;
+  *pBuf++ = LO_UINT16( OTA_MANUFACTURER_ID );
+  *pBuf++ = HI_UINT16( OTA_MANUFACTURER_ID );
+  *pBuf++ = LO_UINT16( OTA_TYPE_ID );
+  *pBuf++ = HI_UINT16( OTA_TYPE_ID );
+  pBuf = osal_buffer_uint32( pBuf, SRV_FILE_VERSION );
+  pBuf = osal_buffer_uint32( pBuf, imageSize );
+
+  otaDeliver( &srvAddr, TRUE, COMMAND_QUERY_NEXT_IMAGE_RSP, buf, (uint16)( pBuf - buf ) );
+}
+
+/*********************************************************************
+ * @fn      sendImagePageReq
+ *
+ * @brief   Ask the in-tree server for the first page of the image.
+ *
+ * @param   pSrcAddr - client
+ */
+static void sendImagePageReq( afAddrType_t *pSrcAddr )
+{
+  uint8 buf[PAYLOAD_MAX_LEN_IMAGE_PAGE_REQ];
+  uint8 *pBuf = buf;
+
+  *pBuf++ = 0;
+  *pBuf++ = LO_UINT16( OTA_MANUFACTURER_ID );
+  *pBuf++ = HI_UINT16( OTA_MANUFACTURER_ID );
+  *pBuf++ = LO_UINT16( OTA_TYPE_ID );
+  *pBuf++ = HI_UINT16( OTA_TYPE_ID );
+  pBuf = osal_buffer_uint32( pBuf, SRV_FILE_VERSION );
+  pBuf = osal_buffer_uint32( pBuf, 0 );
+  *pBuf++ = OTA_BLOCK_DATA_SIZE;
+  *pBuf++ = LO_UINT16( PAGE_BLOCKS * OTA_BLOCK_DATA_SIZE );
+  *pBuf++ = HI_UINT16( PAGE_BLOCKS * OTA_BLOCK_DATA_SIZE );
+  *pBuf++ = LO_UINT16( OTA_PAGE_SPACING );
+  *pBuf++ = HI_UINT16( OTA_PAGE_SPACING );
+
+  otaDeliver( pSrcAddr, FALSE, COMMAND_IMAGE_PAGE_REQ, buf, (uint16)( pBuf - buf ) );
+}
+
+/*********************************************************************
+ * @fn      sendImageBlockRsp
+ *
+ * @brief   Pass an Image Block Response to the client.
+ *
+ * @param   offset - file offset of the block
+ * @param   dataSize - length of the block in the response
+ * @param   len - length of the response, cut short if less than the
+ *                block needs
+ */
+static void sendImageBlockRsp( uint32 offset, uint8 dataSize, uint16 len )
+{
+  uint8 buf[PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + 0xFF];
+  uint8 *pBuf = buf;
+
+  *pBuf++ = ZCL_STATUS_SUCCESS;
+  *pBuf++ = LO_UINT16( OTA_MANUFACTURER_ID );
+  *pBuf++ = HI_UINT16( OTA_MANUFACTURER_ID );
+  *pBuf++ = LO_UINT16( OTA_TYPE_ID );
+  *pBuf++ = HI_UINT16( OTA_TYPE_ID );
+  pBuf = osal_buffer_uint32( pBuf, SRV_FILE_VERSION );
+  pBuf = osal_buffer_uint32( pBuf, offset );
+  *pBuf++ = dataSize;
+  osal_memcpy( pBuf, &image[offset], dataSize );
+
+  otaDeliver( &srvAddr, TRUE, COMMAND_IMAGE_BLOCK_RSP, buf, len );
+}
+
+/*********************************************************************
+ * @fn      makeImage
+ *
+ * @brief   An OTA file of random data: the header and one upgrade
+ *          image element.
+ *
+ * @param   size - file size
+ */
+static void makeImage( uint32 size )
+{
+  uint32 i;
+
+  imageSize = size;
+  for ( i = 0; i < size; i++ )
+  {
+    image[i] = (uint8)testRand();
+  }
+
+  image[0] = 0x1E;
+  image[1] = 0xF1;
+  image[2] = 0xEE;
+  image[3] = 0x0B;
+  image[4] = 0x00;
+  image[5] = 0x01;
+  image[6] = LO_UINT16( IMAGE_HDR_LEN );
+  image[7] = HI_UINT16( IMAGE_HDR_LEN );
+  image[18] = LO_UINT16( OTA_HDR_STACK_VERSION );
+  image[19] = HI_UINT16( OTA_HDR_STACK_VERSION );
+  osal_buffer_uint32( &image[52], size );
+  image[IMAGE_HDR_LEN] = LO_UINT16( OTA_UPGRADE_IMAGE_TAG_ID );
+  image[IMAGE_HDR_LEN + 1] = HI_UINT16( OTA_UPGRADE_IMAGE_TAG_ID );
+  osal_buffer_uint32( &image[IMAGE_HDR_LEN + 2], size - IMAGE_HDR_LEN - IMAGE_ELEM_LEN );
+}
+
+/*********************************************************************
+ * @fn      startDownload
+ *
+ * @brief   Start the download of a new image from a clean state.
+ *
+ * @param   size - file size
+ */
+static void startDownload( uint32 size )
+{
+  osal_stop_timerEx( otaTaskId, ZCL_OTA_IMAGE_BLOCK_WAIT_EVT );
+  osal_stop_timerEx( otaTaskId, ZCL_OTA_UPGRADE_WAIT_EVT );
+  osal_stop_timerEx( otaTaskId, ZCL_OTA_BLOCK_RSP_TO_EVT );
+  osal_stop_timerEx( otaTaskId, ZCL_OTA_IMAGE_QUERY_TO_EVT );
+  zclOTA_ImageUpgradeStatus = OTA_STATUS_NORMAL;
+
+  srvRspCnt = 0;
+  srvArm();
+  srvFreeMSec = 0;
+  reqFrames = 0;
+  rspFrames = 0;
+  endStatus = 0xFF;
+
+  osal_memset( flash, 0xFF, sizeof( flash ) );
+  makeImage( size );
+
+  sendQueryNextImageRsp();
+  HOST_CHECK_EQ( zclOTA_ImageUpgradeStatus, OTA_STATUS_IN_PROGRESS );
+}
+
+/*********************************************************************
+ * @fn      runDownload
+ *
+ * @brief   Download an image from the server model.
+ *
+ * @param   size - file size
+ * @param   mtu - longest block the server sends
+ * @param   loss - percentage of the responses lost
+ *
+ * @return  download time, in ms
+ */
+static uint32 runDownload( uint32 size, uint8 mtu, uint8 loss )
+{
+  uint32 start;
+
+  srvMtu = mtu;
+  lossPct = loss;
+  srvMute = FALSE;
+
+  start = osal_GetSystemClock();
+  startDownload( size );
+
+  while ( ( endStatus == 0xFF ) && ( osal_GetSystemClock() - start < RUN_MAX_MSEC ) )
+  {
+    osal_run_virtual( 1000 );
+  }
+
+  HOST_CHECK_EQ( endStatus, ZSuccess );
+  HOST_CHECK( osal_memcmp( flash, image, size ) );
+
+  return ( endMSec - start );
+}
+
+/*********************************************************************
+ * @fn      checkBlockLen
+ *
+ * @brief   Image Block Responses longer than the block asked for, or
+ *          than the frame they came in, are dropped.
+ */
+static void checkBlockLen( void )
+{
+  uint8 len = OTA_BLOCK_DATA_SIZE;
+
+  srvMute = TRUE;
+  startDownload( 3 * len );
+
+  // The data runs past the end of the frame
+  defaultRspStatus = ZCL_STATUS_SUCCESS;
+  sendImageBlockRsp( 0, len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + len / 2 );
+  HOST_CHECK_EQ( defaultRspStatus, ZCL_STATUS_MALFORMED_COMMAND );
+  HOST_CHECK_EQ( zclOTA_FileOffset, 0 );
+
+  // A head block of two blocks would misalign the blocks held after it
+  startDownload( 3 * len );
+  sendImageBlockRsp( 0, 2 * len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + 2 * len );
+  HOST_CHECK_EQ( zclOTA_FileOffset, 0 );
+
+  // A held block up to the end of the image, but longer than a block
+  startDownload( 3 * len );
+  sendImageBlockRsp( len, 2 * len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + 2 * len );
+  sendImageBlockRsp( 0, len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + len );
+  HOST_CHECK_EQ( zclOTA_FileOffset, len );
+
+  // The image is still downloaded block by block
+  sendImageBlockRsp( len, len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + len );
+  sendImageBlockRsp( 2 * len, len, PAYLOAD_MAX_LEN_IMAGE_BLOCK_RSP + len );
+  HOST_CHECK_EQ( zclOTA_FileOffset, 3 * len );
+  HOST_CHECK_EQ( endStatus, ZSuccess );
+  HOST_CHECK( osal_memcmp( flash, image, 3 * len ) );
+}
+
+/*********************************************************************
+ * @fn      checkPagePeer
+ *
+ * @brief   While the in-tree server streams a page to a client with a
+ *          64-bit address, other clients get Wait For Data, also the ones
+ *          whose address shares the bytes of a short address with it.
+ */
+static void checkPagePeer( void )
+{
+  static const uint8 extAddr[Z_EXTADDR_LEN] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+  afAddrType_t client, peer;
+
+  queryResponse.fileId.version = SRV_FILE_VERSION;
+
+  client.addrMode = afAddr64Bit;
+  osal_memcpy( client.addr.extAddr, extAddr, Z_EXTADDR_LEN );
+  client.endPoint = ZCL_OTA_ENDPOINT;
+
+  srvReads = 0;
+  waitRsps = 0;
+  sendImagePageReq( &client );
+  HOST_CHECK_EQ( waitRsps, 0 );
+
+  // A short address equal to the first bytes of the 64-bit one
+  peer.addrMode = afAddr16Bit;
+  peer.addr.shortAddr = PEER_NWK_ADDR;
+  peer.endPoint = ZCL_OTA_ENDPOINT;
+  HOST_CHECK_EQ( peer.addr.shortAddr, client.addr.shortAddr );
+  sendImagePageReq( &peer );
+  HOST_CHECK_EQ( waitRsps, 1 );
+
+  // A 64-bit address that differs in its last byte
+  peer = client;
+  peer.addr.extAddr[Z_EXTADDR_LEN - 1] ^= 0xFF;
+  sendImagePageReq( &peer );
+  HOST_CHECK_EQ( waitRsps, 2 );
+
+  // The client itself starts its page again
+  sendImagePageReq( &client );
+  HOST_CHECK_EQ( waitRsps, 2 );
+
+  osal_run_virtual( ( PAGE_BLOCKS + 1 ) * OTA_PAGE_SPACING );
+  HOST_CHECK_EQ( srvReads, PAGE_BLOCKS );
+  HOST_CHECK_EQ( srvReadAddr.addrMode, afAddr64Bit );
+  HOST_CHECK( osal_memcmp( srvReadAddr.addr.extAddr, extAddr, Z_EXTADDR_LEN ) );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  static const uint8 loss[] = { 0, LOSS_PCT, 0 };
+  uint32 t;
+  uint8 mtu;
+  uint8 x;
+
+  osal_init_system();
+
+  zclOTA_ManufacturerId = OTA_MANUFACTURER_ID;
+  zclOTA_ImageType = OTA_TYPE_ID;
+  srvAddr.addrMode = afAddr16Bit;
+  srvAddr.addr.shortAddr = SRV_NWK_ADDR;
+  srvAddr.endPoint = SRV_ENDPOINT;
+  srvPage = TRUE;
+
+  checkBlockLen();
+  checkPagePeer();
+
+  // A server that sends the blocks asked for, then one that sends half
+  for ( x = 0; x < sizeof( loss ); x++ )
+  {
+    mtu = ( x < 2 ) ? OTA_BLOCK_DATA_SIZE : OTA_BLOCK_DATA_SIZE / 2;
+    t = runDownload( IMAGE_SIZE, mtu, loss[x] );
+
+    printf( "window %u, %u B blocks, page requests %s, %2u B server, %u%% loss: "
+            "%.1f s, %lu requests, %lu responses\n",
+            OTA_BLOCK_WINDOW, OTA_BLOCK_DATA_SIZE, ( OTA_PAGE_REQ == TRUE ) ? "on" : "off",
+            mtu, loss[x], t / 1000.0, (unsigned long)reqFrames, (unsigned long)rspFrames );
+  }
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,422 @@
+/**************************************************************************************************
+  Filename:       zcl_read_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Passes Read Attributes commands to zclProcessMessageMSG() and checks the
+                  responses are cut into MTU sized frames, that a record longer than the
+                  MTU goes alone to APS fragmentation, and how many heap blocks are held
+                  while a response frame is sent.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "AF.h"
+#include "aps_groups.h"
+#include "aps_frag.h"
+#include "rtg.h"
+#include "zcl.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_PROFILE_ID   0x0104
+#define TEST_CLUSTER_ID   ZCL_CLUSTER_ID_SE_SIMPLE_METERING
+#define TEST_ENDPOINT     8
+
+#define NUM_ATTRS         30        // uint32 attributes 0 to 29
+#define ATTR_STRING       0x0100    // longer than the MTU
+#define ATTR_WRITE_ONLY   0x0200
+#define ATTR_UNKNOWN      0x0300
+#define STRING_LEN        120
+
+#define MAX_FRAMES        8
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint8 fragmented;   // sent through apsfSendFragmented
+  uint16 len;
+  uint8 data[3 + 1 + 2 + 1 + 1 + STRING_LEN];
+  uint16 heapBlocks;  // blocks held by the read, as the frame is sent
+  uint16 heapBytes;   // bytes held by the read, as the frame is sent
+} frame_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+APSF_SendFragmented_t *apsfSendFragmented;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+extern void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 appTaskId = 0;
+static SimpleDescriptionFormat_t epSimpleDesc;
+static endPointDesc_t epDesc;
+
+static zclAttrRec_t testAttrs[NUM_ATTRS + 2];
+static uint32 attrValues[NUM_ATTRS];
+static uint8 stringValue[1 + STRING_LEN];
+static uint32 writeOnlyValue;
+
+static frame_t frames[MAX_FRAMES];
+static uint8 numFrames;
+static uint16 baseBlocks;
+static uint16 baseBytes;
+
+static uint8 transSeq;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 heapBlocksUsed( void );
+static void captureFrame( APSDE_DataReq_t *req, uint8 fragmented );
+static ZStatus_t sendFragmented( APSDE_DataReq_t *req );
+static void readAttrs( uint8 numAttr, uint16 *attrIDs );
+static uint8 *checkValueRec( uint8 *pBuf, uint16 attrID );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   The commands are passed to ZCL directly, not by the task.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( events & SYS_EVENT_MSG );
+}
+
+/*********************************************************************
+ * Stubs of the network layers below AF.
+ */
+uint8 aps_FindGroupForEndpoint( uint16 groupID, uint8 lastEP )
+{
+  (void)groupID;
+  (void)lastEP;
+  return ( APS_GROUPS_EP_NOT_FOUND );
+}
+
+ZStatus_t APSDE_DataReq( APSDE_DataReq_t *req )
+{
+  captureFrame( req, FALSE );
+  return ( ZSuccess );
+}
+
+uint8 APSDE_DataReqMTU( APSDE_DataReqMTU_t *fields )
+{
+  (void)fields;
+  return ( 80 );
+}
+
+uint16 NLME_GetShortAddr( void )
+{
+  return ( 0x0000 );
+}
+
+addr_filter_t NLME_IsAddressBroadcast( uint16 shortAddress )
+{
+  return ( (shortAddress >= 0xFFFC) ? ADDR_BCAST_FOR_ME : ADDR_NOT_BCAST );
+}
+
+RTG_Status_t RTG_CheckRtStatus( uint16 DstAddress, byte RtStatus, uint8 options )
+{
+  (void)DstAddress;
+  (void)RtStatus;
+  (void)options;
+  return ( RTG_SUCCESS );
+}
+
+RTG_Status_t RTG_AddSrcRtgEntry_Guaranteed( uint16 srcAddr, uint8 relayCnt,
+                                            uint16 *pRelayList )
+{
+  (void)srcAddr;
+  (void)relayCnt;
+  (void)pRelayList;
+  return ( RTG_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      sendFragmented
+ *
+ * @brief   Stub of APS fragmentation, for frames longer than the MTU.
+ */
+static ZStatus_t sendFragmented( APSDE_DataReq_t *req )
+{
+  captureFrame( req, TRUE );
+  return ( ZSuccess );
+}
+
+/*********************************************************************
+ * @fn      heapBlocksUsed
+ *
+ * @brief   Number of heap blocks in use.
+ */
+static uint16 heapBlocksUsed( void )
+{
+  return ( osal_heap_block_cnt() - osal_heap_block_free() );
+}
+
+/*********************************************************************
+ * @fn      captureFrame
+ *
+ * @brief   Keep a sent frame and the heap held by the read.
+ */
+static void captureFrame( APSDE_DataReq_t *req, uint8 fragmented )
+{
+  frame_t *pFrame;
+
+  HOST_CHECK( numFrames < MAX_FRAMES );
+  HOST_CHECK( req->asduLen <= sizeof( frames[0].data ) );
+  if ( ( numFrames >= MAX_FRAMES ) || ( req->asduLen > sizeof( frames[0].data ) ) )
+  {
+    return;
+  }
+
+  pFrame = &frames[numFrames++];
+  pFrame->fragmented = fragmented;
+  pFrame->len = req->asduLen;
+  osal_memcpy( pFrame->data, req->asdu, req->asduLen );
+  pFrame->heapBlocks = heapBlocksUsed() - baseBlocks;
+  pFrame->heapBytes = osal_heap_mem_used() - baseBytes;
+}
+
+/*********************************************************************
+ * @fn      readAttrs
+ *
+ * @brief   Pass a read of some attributes to zclProcessMessageMSG(),
+ *          the responses are left in frames[].
+ *
+ * @param   numAttr - number of attributes
+ * @param   attrIDs - attribute IDs
+ */
+static void readAttrs( uint8 numAttr, uint16 *attrIDs )
+{
+  afIncomingMSGPacket_t pkt;
+  uint8 frame[3 + 2 * NUM_ATTRS];
+  uint8 i;
+
+  frame[0] = ZCL_FRAME_TYPE_PROFILE_CMD;
+  frame[1] = ++transSeq;
+  frame[2] = ZCL_CMD_READ;
+  for ( i = 0; i < numAttr; i++ )
+  {
+    frame[3 + 2 * i] = LO_UINT16( attrIDs[i] );
+    frame[4 + 2 * i] = HI_UINT16( attrIDs[i] );
+  }
+
+  osal_memset( &pkt, 0, sizeof( pkt ) );
+  pkt.clusterId = TEST_CLUSTER_ID;
+  pkt.srcAddr.addrMode = afAddr16Bit;
+  pkt.srcAddr.addr.shortAddr = 0x1234;
+  pkt.srcAddr.endPoint = 1;
+  pkt.endPoint = TEST_ENDPOINT;
+  pkt.cmd.DataLength = 3 + 2 * numAttr;
+  pkt.cmd.Data = frame;
+
+  numFrames = 0;
+  baseBlocks = heapBlocksUsed();
+  baseBytes = osal_heap_mem_used();
+
+  zclProcessMessageMSG( &pkt );
+
+  // Nothing is left allocated
+  HOST_CHECK_EQ( heapBlocksUsed(), baseBlocks );
+  HOST_CHECK_EQ( osal_heap_mem_used(), baseBytes );
+}
+
+/*********************************************************************
+ * @fn      checkValueRec
+ *
+ * @brief   Check the read response record of a uint32 attribute.
+ *
+ * @return  next record
+ */
+static uint8 *checkValueRec( uint8 *pBuf, uint16 attrID )
+{
+  HOST_CHECK_EQ( BUILD_UINT16( pBuf[0], pBuf[1] ), attrID );
+  HOST_CHECK_EQ( pBuf[2], ZCL_STATUS_SUCCESS );
+  HOST_CHECK_EQ( pBuf[3], ZCL_DATATYPE_UINT32 );
+  HOST_CHECK_EQ( BUILD_UINT32( pBuf[4], pBuf[5], pBuf[6], pBuf[7] ), attrValues[attrID] );
+
+  return ( pBuf + 8 );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  afDataReqMTU_t mtu;
+  uint16 attrIDs[NUM_ATTRS];
+  uint16 mtuLen;
+  uint16 perFrame;
+  uint16 attrID;
+  uint8 *pBuf;
+  uint8 i, k;
+
+  osal_init_system();
+  apsfSendFragmented = sendFragmented;
+
+  epSimpleDesc.EndPoint = TEST_ENDPOINT;
+  epSimpleDesc.AppProfId = TEST_PROFILE_ID;
+  epDesc.endPoint = TEST_ENDPOINT;
+  epDesc.task_id = &appTaskId;
+  epDesc.simpleDesc = &epSimpleDesc;
+  epDesc.latencyReq = noLatencyReqs;
+  HOST_CHECK_EQ( afRegister( &epDesc ), afStatus_SUCCESS );
+
+  for ( i = 0; i < NUM_ATTRS; i++ )
+  {
+    attrValues[i] = 0x01000000UL * i + i;
+    testAttrs[i].clusterID = TEST_CLUSTER_ID;
+    testAttrs[i].attr.attrId = i;
+    testAttrs[i].attr.dataType = ZCL_DATATYPE_UINT32;
+    testAttrs[i].attr.accessControl = ACCESS_CONTROL_READ;
+    testAttrs[i].attr.dataPtr = &attrValues[i];
+  }
+
+  stringValue[0] = STRING_LEN;
+  for ( i = 0; i < STRING_LEN; i++ )
+  {
+    stringValue[1 + i] = 'a' + ( i % 26 );
+  }
+  testAttrs[NUM_ATTRS].clusterID = TEST_CLUSTER_ID;
+  testAttrs[NUM_ATTRS].attr.attrId = ATTR_STRING;
+  testAttrs[NUM_ATTRS].attr.dataType = ZCL_DATATYPE_CHAR_STR;
+  testAttrs[NUM_ATTRS].attr.accessControl = ACCESS_CONTROL_READ;
+  testAttrs[NUM_ATTRS].attr.dataPtr = stringValue;
+
+  testAttrs[NUM_ATTRS + 1].clusterID = TEST_CLUSTER_ID;
+  testAttrs[NUM_ATTRS + 1].attr.attrId = ATTR_WRITE_ONLY;
+  testAttrs[NUM_ATTRS + 1].attr.dataType = ZCL_DATATYPE_UINT32;
+  testAttrs[NUM_ATTRS + 1].attr.accessControl = ACCESS_CONTROL_WRITE;
+  testAttrs[NUM_ATTRS + 1].attr.dataPtr = &writeOnlyValue;
+
+  HOST_CHECK_EQ( zcl_registerAttrList( TEST_ENDPOINT, NUM_ATTRS + 2, testAttrs ), ZSuccess );
+
+  mtu.kvp = FALSE;
+  mtu.aps.secure = FALSE;
+  mtuLen = afDataReqMTU( &mtu );
+  perFrame = ( mtuLen - 3 ) / 8;
+
+  // All the value attributes: MTU sized frames, records in order
+  for ( i = 0; i < NUM_ATTRS; i++ )
+  {
+    attrIDs[i] = i;
+  }
+  readAttrs( NUM_ATTRS, attrIDs );
+
+  HOST_CHECK_EQ( numFrames, ( NUM_ATTRS + perFrame - 1 ) / perFrame );
+  for ( i = 0, attrID = 0; i < numFrames; i++ )
+  {
+    printf( "frame %u: %u bytes, %u blocks and %u bytes of heap held\n",
+            i, frames[i].len, frames[i].heapBlocks, frames[i].heapBytes );
+
+    HOST_CHECK( !frames[i].fragmented );
+    HOST_CHECK( frames[i].len <= mtuLen );
+    HOST_CHECK_EQ( frames[i].data[1], transSeq );
+    HOST_CHECK_EQ( frames[i].data[2], ZCL_CMD_READ_RSP );
+    HOST_CHECK_EQ( ( frames[i].len - 3 ) % 8, 0 );
+
+    // The parsed command and the one frame buffer
+    HOST_CHECK_EQ( frames[i].heapBlocks, 2 );
+
+    for ( pBuf = frames[i].data + 3; pBuf < frames[i].data + frames[i].len; attrID++ )
+    {
+      pBuf = checkValueRec( pBuf, attrID );
+    }
+  }
+  HOST_CHECK_EQ( attrID, NUM_ATTRS );
+
+  // The long string goes alone to fragmentation, the rest share a frame
+  attrIDs[0] = ATTR_STRING;
+  attrIDs[1] = 5;
+  attrIDs[2] = ATTR_WRITE_ONLY;
+  attrIDs[3] = ATTR_UNKNOWN;
+  readAttrs( 4, attrIDs );
+
+  HOST_CHECK_EQ( numFrames, 2 );
+  HOST_CHECK( frames[0].fragmented );
+  HOST_CHECK_EQ( frames[0].len, 3 + 2 + 1 + 1 + 1 + STRING_LEN );
+  HOST_CHECK_EQ( BUILD_UINT16( frames[0].data[3], frames[0].data[4] ), ATTR_STRING );
+  HOST_CHECK_EQ( frames[0].data[5], ZCL_STATUS_SUCCESS );
+  HOST_CHECK_EQ( frames[0].data[6], ZCL_DATATYPE_CHAR_STR );
+  HOST_CHECK_EQ( frames[0].data[7], STRING_LEN );
+  HOST_CHECK( osal_memcmp( &frames[0].data[8], &stringValue[1], STRING_LEN ) );
+
+  HOST_CHECK( !frames[1].fragmented );
+  HOST_CHECK_EQ( frames[1].len, 3 + 8 + 3 + 3 );
+  pBuf = checkValueRec( frames[1].data + 3, 5 );
+  HOST_CHECK_EQ( BUILD_UINT16( pBuf[0], pBuf[1] ), ATTR_WRITE_ONLY );
+  HOST_CHECK_EQ( pBuf[2], ZCL_STATUS_WRITE_ONLY );
+  HOST_CHECK_EQ( BUILD_UINT16( pBuf[3], pBuf[4] ), ATTR_UNKNOWN );
+  HOST_CHECK_EQ( pBuf[5], ZCL_STATUS_UNSUPPORTED_ATTRIBUTE );
+
+  for ( k = 0; k < numFrames; k++ )
+  {
+    HOST_CHECK_EQ( frames[k].heapBlocks, 2 );
+  }
+
+  return ( HOST_TEST_RESULT() );
+}
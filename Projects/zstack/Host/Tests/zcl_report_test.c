@@ -0,0 +1,457 @@
+/**************************************************************************************************
+  Filename:       zcl_report_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Drives the ZCL reporting engine with scripted attribute changes on the
+                  virtual clock and checks every Report Attributes frame it sends: the
+                  minimum and maximum intervals, the reportable change and the sharing of
+                  frames by attributes that fall due together.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "comdef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Clock.h"
+#include "AF.h"
+#include "aps_groups.h"
+#include "aps_frag.h"
+#include "rtg.h"
+#include "zcl.h"
+#include "zcl_ms.h"
+#include "zcl_report.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#define TEST_PROFILE_ID   0x0104
+#define TEST_ENDPOINT     8
+#define TEST_REPORT_EVT   0x0001
+
+#define TEMP_CLUSTER      ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT
+#define HUM_CLUSTER       ZCL_CLUSTER_ID_MS_RELATIVE_HUMIDITY
+#define ATTR_MEASURED     0x0000
+#define ATTR_TOLERANCE    0x0003
+
+#define MAX_FRAMES        32
+#define MAX_FRAME_ATTRS   3
+
+// Script actions
+#define SET_TEMP          1
+#define SET_TOL           2
+#define SET_HUM           3
+#define STOP_TOL          4   // Configure Reporting frame from the air
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint32 time;
+  uint8 action;
+  uint16 value;
+} scriptStep_t;
+
+typedef struct
+{
+  uint32 time;
+  uint16 clusterID;
+  uint8 cmd;
+  uint8 numAttr;
+  uint16 attrID[MAX_FRAME_ATTRS];
+  uint16 value[MAX_FRAME_ATTRS];
+} frame_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+APSF_SendFragmented_t *apsfSendFragmented;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+extern void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 appTaskId = 0;
+static SimpleDescriptionFormat_t epSimpleDesc;
+static endPointDesc_t epDesc;
+
+static int16 tempValue = 2000;     // 20.00 C
+static uint16 tolValue = 10;
+static uint16 humValue = 5000;     // 50.00 %
+
+static CONST zclAttrRec_t testAttrs[] =
+{
+  { TEMP_CLUSTER, { ATTR_MEASURED, ZCL_DATATYPE_INT16, ACCESS_CONTROL_READ, (void *)&tempValue } },
+  { TEMP_CLUSTER, { ATTR_TOLERANCE, ZCL_DATATYPE_UINT16, ACCESS_CONTROL_READ, (void *)&tolValue } },
+  { HUM_CLUSTER,  { ATTR_MEASURED, ZCL_DATATYPE_UINT16, ACCESS_CONTROL_READ, (void *)&humValue } },
+};
+
+// Scripted changes, the engine is configured at 0
+static CONST scriptStep_t script[] =
+{
+  {   3000, SET_TEMP, 2030 },   // below the reportable change
+  {   4000, SET_TEMP, 2060 },   // held to the end of the minimum interval
+  {   6000, SET_HUM,  5150 },
+  {   7000, SET_HUM,  5200 },   // below the reportable change
+  {  12000, SET_TOL,  11 },
+  {  15000, SET_TEMP, 2200 },   // held to the end of the minimum interval
+  {  15000, SET_TOL,  12 },     // sent right away
+  {  40000, SET_TEMP, 2400 },   // both due at once: one frame
+  {  40000, SET_TOL,  13 },
+  { 110000, STOP_TOL, 0 },
+};
+
+// Frames expected from the script, up to the end of the run
+static CONST frame_t expected[] =
+{
+  {      0, TEMP_CLUSTER, ZCL_CMD_REPORT, 2, { ATTR_MEASURED, ATTR_TOLERANCE }, { 2000, 10 } },
+  {      0, HUM_CLUSTER,  ZCL_CMD_REPORT, 1, { ATTR_MEASURED }, { 5000 } },
+  {   6000, HUM_CLUSTER,  ZCL_CMD_REPORT, 1, { ATTR_MEASURED }, { 5150 } },
+  {  10000, TEMP_CLUSTER, ZCL_CMD_REPORT, 1, { ATTR_MEASURED }, { 2060 } },
+  {  12000, TEMP_CLUSTER, ZCL_CMD_REPORT, 1, { ATTR_TOLERANCE }, { 11 } },
+  {  15000, TEMP_CLUSTER, ZCL_CMD_REPORT, 1, { ATTR_TOLERANCE }, { 12 } },
+  {  20000, TEMP_CLUSTER, ZCL_CMD_REPORT, 1, { ATTR_MEASURED }, { 2200 } },
+  {  40000, TEMP_CLUSTER, ZCL_CMD_REPORT, 2, { ATTR_MEASURED, ATTR_TOLERANCE }, { 2400, 13 } },
+  {  70000, TEMP_CLUSTER, ZCL_CMD_REPORT, 1, { ATTR_TOLERANCE }, { 13 } },
+  { 100000, TEMP_CLUSTER, ZCL_CMD_REPORT, 2, { ATTR_MEASURED, ATTR_TOLERANCE }, { 2400, 13 } },
+  { 110000, TEMP_CLUSTER, ZCL_CMD_CONFIG_REPORT_RSP, 0, { 0 }, { 0 } },
+  { 160000, TEMP_CLUSTER, ZCL_CMD_REPORT, 1, { ATTR_MEASURED }, { 2400 } },
+};
+
+#define SCRIPT_STEPS      ( sizeof( script ) / sizeof( script[0] ) )
+#define EXPECTED_FRAMES   ( sizeof( expected ) / sizeof( expected[0] ) )
+#define RUN_END           170000
+
+static frame_t frames[MAX_FRAMES];
+static uint8 numFrames;
+static uint8 transSeq;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void configure( uint16 clusterID, uint16 attrID, uint8 dataType,
+                       uint16 minInt, uint16 maxInt, uint16 change );
+static void stopTolerance( void );
+static void runStep( CONST scriptStep_t *pStep );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   Runs the shared timer of the reporting engine.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & TEST_REPORT_EVT )
+  {
+    zclReport_ProcessEvent();
+    return ( events ^ TEST_REPORT_EVT );
+  }
+
+  return ( events & SYS_EVENT_MSG );
+}
+
+/*********************************************************************
+ * Stubs of the network layers below AF.
+ */
+uint8 aps_FindGroupForEndpoint( uint16 groupID, uint8 lastEP )
+{
+  (void)groupID;
+  (void)lastEP;
+  return ( APS_GROUPS_EP_NOT_FOUND );
+}
+
+ZStatus_t APSDE_DataReq( APSDE_DataReq_t *req )
+{
+  frame_t *pFrame;
+  uint8 *pBuf;
+  uint8 i;
+
+  HOST_CHECK( numFrames < MAX_FRAMES );
+  HOST_CHECK_EQ( req->dstAddr.addrMode, afAddr16Bit );
+  HOST_CHECK_EQ( req->dstAddr.addr.shortAddr, 0x0000 );
+  HOST_CHECK_EQ( req->srcEP, TEST_ENDPOINT );
+  if ( numFrames >= MAX_FRAMES )
+  {
+    return ( ZSuccess );
+  }
+
+  pFrame = &frames[numFrames++];
+  osal_memset( pFrame, 0, sizeof( frame_t ) );
+  pFrame->time = osal_GetSystemClock();
+  pFrame->clusterID = req->clusterID;
+  pFrame->cmd = req->asdu[2];
+
+  if ( pFrame->cmd == ZCL_CMD_REPORT )
+  {
+    // Attribute ID, data type and a 16 bit value per attribute
+    HOST_CHECK_EQ( ( req->asduLen - 3 ) % 5, 0 );
+    pBuf = req->asdu + 3;
+    for ( i = 0; ( pBuf < req->asdu + req->asduLen ) && ( i < MAX_FRAME_ATTRS ); i++ )
+    {
+      pFrame->attrID[i] = BUILD_UINT16( pBuf[0], pBuf[1] );
+      pFrame->value[i] = BUILD_UINT16( pBuf[3], pBuf[4] );
+      pBuf += 5;
+    }
+    pFrame->numAttr = i;
+  }
+  else
+  {
+    // All records configured: a lone SUCCESS status
+    HOST_CHECK_EQ( req->asduLen, 4 );
+    HOST_CHECK_EQ( req->asdu[3], ZCL_STATUS_SUCCESS );
+  }
+
+  return ( ZSuccess );
+}
+
+uint8 APSDE_DataReqMTU( APSDE_DataReqMTU_t *fields )
+{
+  (void)fields;
+  return ( 80 );
+}
+
+uint16 NLME_GetShortAddr( void )
+{
+  return ( 0x1234 );
+}
+
+addr_filter_t NLME_IsAddressBroadcast( uint16 shortAddress )
+{
+  return ( (shortAddress >= 0xFFFC) ? ADDR_BCAST_FOR_ME : ADDR_NOT_BCAST );
+}
+
+RTG_Status_t RTG_CheckRtStatus( uint16 DstAddress, byte RtStatus, uint8 options )
+{
+  (void)DstAddress;
+  (void)RtStatus;
+  (void)options;
+  return ( RTG_SUCCESS );
+}
+
+RTG_Status_t RTG_AddSrcRtgEntry_Guaranteed( uint16 srcAddr, uint8 relayCnt,
+                                            uint16 *pRelayList )
+{
+  (void)srcAddr;
+  (void)relayCnt;
+  (void)pRelayList;
+  return ( RTG_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      configure
+ *
+ * @brief   Configure the reports of an attribute through the API.
+ */
+static void configure( uint16 clusterID, uint16 attrID, uint8 dataType,
+                       uint16 minInt, uint16 maxInt, uint16 change )
+{
+  zclCfgReportRec_t cfg;
+
+  cfg.direction = ZCL_SEND_ATTR_REPORTS;
+  cfg.attrID = attrID;
+  cfg.dataType = dataType;
+  cfg.minReportInt = minInt;
+  cfg.maxReportInt = maxInt;
+  cfg.timeoutPeriod = 0;
+  cfg.reportableChange = (uint8 *)&change;
+
+  HOST_CHECK_EQ( zclReport_Configure( TEST_ENDPOINT, clusterID, &cfg ), ZCL_STATUS_SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      stopTolerance
+ *
+ * @brief   Pass a Configure Reporting command that stops the reports
+ *          of the tolerance to zclProcessMessageMSG().
+ */
+static void stopTolerance( void )
+{
+  afIncomingMSGPacket_t pkt;
+  uint8 frame[13];
+
+  frame[0] = ZCL_FRAME_TYPE_PROFILE_CMD;
+  frame[1] = ++transSeq;
+  frame[2] = ZCL_CMD_CONFIG_REPORT;
+  frame[3] = ZCL_SEND_ATTR_REPORTS;
+  frame[4] = LO_UINT16( ATTR_TOLERANCE );
+  frame[5] = HI_UINT16( ATTR_TOLERANCE );
+  frame[6] = ZCL_DATATYPE_UINT16;
+  frame[7] = 0;                           // Minimum interval
+  frame[8] = 0;
+  frame[9] = LO_UINT16( ZCL_REPORT_STOP ); // Maximum interval
+  frame[10] = HI_UINT16( ZCL_REPORT_STOP );
+  frame[11] = 0;                          // Reportable change
+  frame[12] = 0;
+
+  osal_memset( &pkt, 0, sizeof( pkt ) );
+  pkt.clusterId = TEMP_CLUSTER;
+  pkt.srcAddr.addrMode = afAddr16Bit;
+  pkt.srcAddr.addr.shortAddr = 0x0000;
+  pkt.srcAddr.endPoint = 1;
+  pkt.endPoint = TEST_ENDPOINT;
+  pkt.cmd.DataLength = sizeof( frame );
+  pkt.cmd.Data = frame;
+
+  zclProcessMessageMSG( &pkt );
+}
+
+/*********************************************************************
+ * @fn      runStep
+ *
+ * @brief   Apply one step of the script.
+ */
+static void runStep( CONST scriptStep_t *pStep )
+{
+  switch ( pStep->action )
+  {
+    case SET_TEMP:
+      tempValue = (int16)pStep->value;
+      zclReport_AttrChanged( TEST_ENDPOINT, TEMP_CLUSTER, ATTR_MEASURED );
+      break;
+
+    case SET_TOL:
+      tolValue = pStep->value;
+      zclReport_AttrChanged( TEST_ENDPOINT, TEMP_CLUSTER, ATTR_TOLERANCE );
+      break;
+
+    case SET_HUM:
+      humValue = pStep->value;
+      zclReport_AttrChanged( TEST_ENDPOINT, HUM_CLUSTER, ATTR_MEASURED );
+      break;
+
+    case STOP_TOL:
+      stopTolerance();
+      break;
+  }
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  afAddrType_t dstAddr;
+  uint8 i, k, n;
+
+  osal_init_system();
+
+  epSimpleDesc.EndPoint = TEST_ENDPOINT;
+  epSimpleDesc.AppProfId = TEST_PROFILE_ID;
+  epDesc.endPoint = TEST_ENDPOINT;
+  epDesc.task_id = &appTaskId;
+  epDesc.simpleDesc = &epSimpleDesc;
+  epDesc.latencyReq = noLatencyReqs;
+  HOST_CHECK_EQ( afRegister( &epDesc ), afStatus_SUCCESS );
+  HOST_CHECK_EQ( zcl_registerAttrList( TEST_ENDPOINT, sizeof( testAttrs ) / sizeof( testAttrs[0] ),
+                                       testAttrs ), ZSuccess );
+
+  zclReport_Init( appTaskId, TEST_REPORT_EVT );
+
+  osal_memset( &dstAddr, 0, sizeof( dstAddr ) );
+  dstAddr.addrMode = afAddr16Bit;
+  dstAddr.addr.shortAddr = 0x0000;
+  dstAddr.endPoint = 1;
+  zclReport_SetDstAddr( &dstAddr );
+
+  // Temperature: 0.50 C, 10 s to 60 s. Tolerance: any change, 0 s to
+  // 30 s. Humidity: 1.00 %, 5 s, on change only.
+  configure( TEMP_CLUSTER, ATTR_MEASURED, ZCL_DATATYPE_INT16, 10, 60, 50 );
+  configure( TEMP_CLUSTER, ATTR_TOLERANCE, ZCL_DATATYPE_UINT16, 0, 30, 0 );
+  configure( HUM_CLUSTER, ATTR_MEASURED, ZCL_DATATYPE_UINT16, 5, ZCL_REPORT_NO_PERIODIC, 100 );
+
+  for ( i = 0; i < SCRIPT_STEPS; i++ )
+  {
+    // Steps at the same time are applied before the tasks run
+    if ( script[i].time != osal_GetSystemClock() )
+    {
+      osal_run_virtual( script[i].time - osal_GetSystemClock() );
+    }
+    runStep( &script[i] );
+  }
+  osal_run_virtual( RUN_END - osal_GetSystemClock() );
+
+  for ( i = 0; i < numFrames; i++ )
+  {
+    printf( "%6lu 0x%04X 0x%02X", (unsigned long)frames[i].time, frames[i].clusterID, frames[i].cmd );
+    for ( k = 0; k < frames[i].numAttr; k++ )
+    {
+      printf( " %u=%u", frames[i].attrID[k], frames[i].value[k] );
+    }
+    printf( "\n" );
+  }
+
+  HOST_CHECK_EQ( numFrames, EXPECTED_FRAMES );
+  n = ( numFrames < EXPECTED_FRAMES ) ? numFrames : EXPECTED_FRAMES;
+  for ( i = 0; i < n; i++ )
+  {
+    HOST_CHECK_EQ( frames[i].time, expected[i].time );
+    HOST_CHECK_EQ( frames[i].clusterID, expected[i].clusterID );
+    HOST_CHECK_EQ( frames[i].cmd, expected[i].cmd );
+    HOST_CHECK_EQ( frames[i].numAttr, expected[i].numAttr );
+    for ( k = 0; k < frames[i].numAttr; k++ )
+    {
+      HOST_CHECK_EQ( frames[i].attrID[k], expected[i].attrID[k] );
+      HOST_CHECK_EQ( frames[i].value[k], expected[i].value[k] );
+    }
+  }
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -0,0 +1,694 @@
+/**************************************************************************************************
+  Filename:       zdsecmgr_entry_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Runs a join storm through the Trust Center's security entries, checks the
+                  entry and address lookups against a scan of the address manager and the
+                  entry table as devices come and go, and measures the EXT address lookup.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "ZGlobals.h"
+#include "ssp.h"
+#include "nwk_globals.h"
+#include "nwk.h"
+#include "NLMEDE.h"
+#include "AddrMgr.h"
+#include "AssocList.h"
+#include "APSMEDE.h"
+#include "ZDApp.h"
+#include "ZDSecMgr.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#if !defined ( ZDSECMGR_ENTRY_HASH )
+  #define ZDSECMGR_ENTRY_HASH TRUE
+#endif
+
+#if !defined ( ZDSECMGR_HASH_SIZE )
+  #define ZDSECMGR_HASH_SIZE 8
+#endif
+
+#define TEST_DEVICES      600       // devices known to the Trust Center
+#define ADDR_ENTRIES      640       // address manager slots
+#define ENTRIES           ZDSECMGR_DEVICE_MAX
+#define CHURN_LOOKUPS     50000     // checked lookups, with devices coming and going
+#define LOOKUPS           300000    // timed lookups
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Security entry, as in ZDSecMgr.c
+typedef struct
+{
+  uint16 ami;
+  uint16 keyNvId;
+  ZDSecMgr_Authentication_Option authenticateOption;
+} ZDSecMgrEntry_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { appTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+nwkIB_t _NIB;
+devStates_t devState = DEV_ZB_COORD;
+uint8 ZDAppTaskID = 0;
+uint8 zgSecurePermitJoin = TRUE;
+uint8 zgPreConfigKeys = FALSE;
+uint8 zgUseDefaultTCLK = TRUE;
+CONST byte defaultTCLinkKey[SEC_KEY_LEN] = { 0 };
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+// Private functions of ZDSecMgr.c
+extern void ZDSecMgrEntryInit( uint8 state );
+extern ZStatus_t ZDSecMgrAddrStore( uint16 nwkAddr, uint8* extAddr, uint16* ami );
+extern ZStatus_t ZDSecMgrExtAddrLookup( uint8* extAddr, uint16* ami );
+extern ZStatus_t ZDSecMgrEntryLookup( uint16 nwkAddr, ZDSecMgrEntry_t** entry );
+extern ZStatus_t ZDSecMgrEntryLookupAMI( uint16 ami, ZDSecMgrEntry_t** entry );
+extern ZStatus_t ZDSecMgrEntryLookupExt( uint8* extAddr, ZDSecMgrEntry_t** entry );
+extern ZStatus_t ZDSecMgrEntryLookupExtGetIndex( uint8* extAddr, ZDSecMgrEntry_t** entry,
+                                                 uint16* entryIndex );
+extern void ZDSecMgrEntryFree( ZDSecMgrEntry_t* entry );
+extern ZStatus_t ZDSecMgrEntryNew( ZDSecMgrEntry_t** entry );
+extern void ZDSecMgrEntryAMISet( ZDSecMgrEntry_t* entry, uint16 ami );
+
+extern ZDSecMgrEntry_t* ZDSecMgrEntries;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Address manager stub: slots are taken first free, like the real one
+static uint8 addrUsed[ADDR_ENTRIES];
+static uint16 addrNwk[ADDR_ENTRIES];
+static uint8 addrExt[ADDR_ENTRIES][Z_EXTADDR_LEN];
+static uint32 addrScanSteps;
+
+// The devices, their addresses and their address manager slot
+static uint8 devExt[TEST_DEVICES][Z_EXTADDR_LEN];
+static uint16 devNwk[TEST_DEVICES];
+static uint16 devAmi[TEST_DEVICES];
+static uint16 nextNwk = 0x0100;
+
+static uint16 benchDev[TEST_DEVICES];
+
+static uint32 randSeed = 1;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testRand( void );
+static void devJoin( uint16 dev );
+static void devLeave( uint16 dev );
+static ZDSecMgrEntry_t *refLookupExt( uint8 *extAddr );
+static ZDSecMgrEntry_t *refLookupAMI( uint16 ami );
+static void checkDevice( uint16 dev );
+static uint16 entryCount( void );
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      appTask_ProcessEvent
+ *
+ * @brief   The test calls the Security Manager directly.
+ */
+static uint16 appTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * Stubs of the address manager. The searches count the slots they
+ * look at.
+ */
+void AddrMgrExtAddrSet( uint8 *dstExtAddr, uint8 *srcExtAddr )
+{
+  if ( srcExtAddr != NULL )
+  {
+    osal_memcpy( dstExtAddr, srcExtAddr, Z_EXTADDR_LEN );
+  }
+  else
+  {
+    osal_memset( dstExtAddr, 0, Z_EXTADDR_LEN );
+  }
+}
+
+uint8 AddrMgrExtAddrEqual( uint8 *extAddr1, uint8 *extAddr2 )
+{
+  return ( osal_memcmp( extAddr1, extAddr2, Z_EXTADDR_LEN ) );
+}
+
+uint8 AddrMgrExtAddrValid( uint8 *extAddr )
+{
+  uint8 x;
+
+  for ( x = 0; x < Z_EXTADDR_LEN; x++ )
+  {
+    if ( extAddr[x] != 0 )
+    {
+      return ( TRUE );
+    }
+  }
+
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryLookupNwk( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    addrScanSteps++;
+    if ( addrUsed[i] && ( addrNwk[i] == entry->nwkAddr ) )
+    {
+      entry->index = i;
+      osal_memcpy( entry->extAddr, addrExt[i], Z_EXTADDR_LEN );
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryLookupExt( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    addrScanSteps++;
+    if ( addrUsed[i] && osal_memcmp( addrExt[i], entry->extAddr, Z_EXTADDR_LEN ) )
+    {
+      entry->index = i;
+      entry->nwkAddr = addrNwk[i];
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrExtAddrLookup( uint16 nwkAddr, uint8 *extAddr )
+{
+  AddrMgrEntry_t entry;
+
+  entry.nwkAddr = nwkAddr;
+  if ( AddrMgrEntryLookupNwk( &entry ) == TRUE )
+  {
+    osal_memcpy( extAddr, entry.extAddr, Z_EXTADDR_LEN );
+    return ( TRUE );
+  }
+
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryGet( AddrMgrEntry_t *entry )
+{
+  if ( ( entry->index >= ADDR_ENTRIES ) || !addrUsed[entry->index] )
+  {
+    return ( FALSE );
+  }
+
+  entry->nwkAddr = addrNwk[entry->index];
+  osal_memcpy( entry->extAddr, addrExt[entry->index], Z_EXTADDR_LEN );
+  return ( TRUE );
+}
+
+uint8 AddrMgrEntryUpdate( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+  uint16 slot = INVALID_NODE_ADDR;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    if ( addrUsed[i] && osal_memcmp( addrExt[i], entry->extAddr, Z_EXTADDR_LEN ) )
+    {
+      slot = i;
+      break;
+    }
+    if ( !addrUsed[i] && ( slot == INVALID_NODE_ADDR ) )
+    {
+      slot = i;
+    }
+  }
+
+  if ( slot == INVALID_NODE_ADDR )
+  {
+    entry->index = INVALID_NODE_ADDR;
+    return ( FALSE );
+  }
+
+  addrUsed[slot] = TRUE;
+  addrNwk[slot] = entry->nwkAddr;
+  osal_memcpy( addrExt[slot], entry->extAddr, Z_EXTADDR_LEN );
+  entry->index = slot;
+  return ( TRUE );
+}
+
+uint8 AddrMgrEntryRelease( AddrMgrEntry_t *entry )
+{
+  if ( entry->index >= ADDR_ENTRIES )
+  {
+    return ( FALSE );
+  }
+
+  addrUsed[entry->index] = FALSE;
+  return ( TRUE );
+}
+
+/*********************************************************************
+ * Stubs of the rest of the stack, not reached by the entry code.
+ */
+uint8 osal_nv_item_init( uint16 id, uint16 len, void *buf )
+{
+  (void)id; (void)len; (void)buf;
+  return ( SUCCESS );
+}
+
+uint8 osal_nv_read( uint16 id, uint16 offset, uint16 len, void *buf )
+{
+  (void)id; (void)offset;
+  osal_memset( buf, 0, len );
+  return ( SUCCESS );
+}
+
+uint8 osal_nv_write( uint16 id, uint16 offset, uint16 len, void *buf )
+{
+  (void)id; (void)offset; (void)len; (void)buf;
+  return ( SUCCESS );
+}
+
+ZStatus_t APSME_AuthenticateReq( APSME_AuthenticateReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_EstablishKeyReq( APSME_EstablishKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_EstablishKeyRsp( APSME_EstablishKeyRsp_t *rsp ) { (void)rsp; return ( ZSuccess ); }
+ZStatus_t APSME_RemoveDeviceReq( APSME_RemoveDeviceReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_RequestKeyReq( APSME_RequestKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_SwitchKeyReq( APSME_SwitchKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_TransportKeyReq( APSME_TransportKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_UpdateDeviceReq( APSME_UpdateDeviceReq_t *req ) { (void)req; return ( ZSuccess ); }
+void APSME_SecurityRM_CD( void ) {}
+
+uint8 APSME_LookupExtAddr( uint16 nwkAddr, uint8 *extAddr )
+{
+  return ( AddrMgrExtAddrLookup( nwkAddr, extAddr ) );
+}
+
+uint8 APSME_LookupNwkAddr( uint8 *extAddr, uint16 *nwkAddr )
+{
+  AddrMgrEntry_t entry;
+
+  AddrMgrExtAddrSet( entry.extAddr, extAddr );
+  if ( AddrMgrEntryLookupExt( &entry ) == TRUE )
+  {
+    *nwkAddr = entry.nwkAddr;
+    return ( TRUE );
+  }
+
+  return ( FALSE );
+}
+
+associated_devices_t *AssocGetWithShort( uint16 shortAddr ) { (void)shortAddr; return ( NULL ); }
+associated_devices_t *AssocGetWithExt( byte *extAddr ) { (void)extAddr; return ( NULL ); }
+associated_devices_t *AssocMatchDeviceStatus( uint8 status ) { (void)status; return ( NULL ); }
+byte AssocRemove( byte *extAddr ) { (void)extAddr; return ( FALSE ); }
+
+uint16 NLME_GetShortAddr( void ) { return ( 0x0000 ); }
+ZStatus_t NLME_LeaveReq( NLME_LeaveReq_t *req ) { (void)req; return ( ZSuccess ); }
+
+ZStatus_t NLME_ReadNwkKeyInfo( uint16 index, uint16 len, void *keyinfo, uint16 NvId )
+{
+  (void)index; (void)NvId;
+  osal_memset( keyinfo, 0, len );
+  return ( ZSuccess );
+}
+
+void SSP_Init( void ) {}
+void SSP_GetTrueRand( uint8 len, uint8 *rand ) { osal_memset( rand, 0x5A, len ); }
+void SSP_SwitchNwkKey( uint8 seqNum ) { (void)seqNum; }
+void SSP_UpdateNwkKey( uint8 *key, uint8 keySeqNum ) { (void)key; (void)keySeqNum; }
+
+void ZDApp_NVUpdate( void ) {}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Repeatable pseudo random numbers.
+ */
+static uint16 testRand( void )
+{
+  randSeed = randSeed * 1103515245UL + 12345;
+  return ( (uint16)( randSeed >> 16 ) );
+}
+
+/*********************************************************************
+ * @fn      devJoin
+ *
+ * @brief   The device joins with a new NWK address and the Trust Center
+ *          stores it in the address manager.
+ */
+static void devJoin( uint16 dev )
+{
+  devNwk[dev] = nextNwk++;
+  HOST_CHECK( ZDSecMgrAddrStore( devNwk[dev], devExt[dev], &devAmi[dev] ) == ZSuccess );
+}
+
+/*********************************************************************
+ * @fn      devLeave
+ *
+ * @brief   The device leaves, its address manager slot is released and
+ *          may go to the next device that joins.
+ */
+static void devLeave( uint16 dev )
+{
+  AddrMgrEntry_t entry;
+
+  entry.user = ADDRMGR_USER_SECURITY;
+  entry.index = devAmi[dev];
+  AddrMgrEntryRelease( &entry );
+  devAmi[dev] = INVALID_NODE_ADDR;
+}
+
+/*********************************************************************
+ * @fn      refLookupAMI
+ *
+ * @brief   The assigned entry of an address index, by scanning the
+ *          entry table.
+ */
+static ZDSecMgrEntry_t *refLookupAMI( uint16 ami )
+{
+  uint16 x;
+
+  for ( x = 0; x < ENTRIES; x++ )
+  {
+    if ( ZDSecMgrEntries[x].ami == ami )
+    {
+      return ( &ZDSecMgrEntries[x] );
+    }
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      refLookupExt
+ *
+ * @brief   The entry of an EXT address, by scanning the address manager
+ *          and then the entry table.
+ */
+static ZDSecMgrEntry_t *refLookupExt( uint8 *extAddr )
+{
+  uint16 i;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    if ( addrUsed[i] && osal_memcmp( addrExt[i], extAddr, Z_EXTADDR_LEN ) )
+    {
+      return ( refLookupAMI( i ) );
+    }
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      checkDevice
+ *
+ * @brief   Compare every lookup of a device with the scans.
+ */
+static void checkDevice( uint16 dev )
+{
+  ZDSecMgrEntry_t *ref = refLookupExt( devExt[dev] );
+  ZDSecMgrEntry_t *entry;
+  uint16 index;
+  uint16 ami;
+
+  HOST_CHECK( ( ZDSecMgrEntryLookupExt( devExt[dev], &entry ) == ZSuccess ) == ( ref != NULL ) );
+  HOST_CHECK( entry == ref );
+
+  if ( ref != NULL )
+  {
+    HOST_CHECK( ZDSecMgrEntryLookupExtGetIndex( devExt[dev], &entry, &index ) == ZSuccess );
+    HOST_CHECK( ( entry == ref ) && ( index == (uint16)( ref - ZDSecMgrEntries ) ) );
+  }
+  else
+  {
+    HOST_CHECK( ZDSecMgrEntryLookupExtGetIndex( devExt[dev], &entry, &index ) != ZSuccess );
+  }
+
+  if ( devAmi[dev] != INVALID_NODE_ADDR )
+  {
+    HOST_CHECK( ZDSecMgrExtAddrLookup( devExt[dev], &ami ) == ZSuccess );
+    HOST_CHECK_EQ( ami, devAmi[dev] );
+
+    ZDSecMgrEntryLookupAMI( devAmi[dev], &entry );
+    HOST_CHECK( entry == refLookupAMI( devAmi[dev] ) );
+
+    ZDSecMgrEntryLookup( devNwk[dev], &entry );
+    HOST_CHECK( entry == ref );
+  }
+  else
+  {
+    HOST_CHECK( ZDSecMgrExtAddrLookup( devExt[dev], &ami ) != ZSuccess );
+  }
+}
+
+/*********************************************************************
+ * @fn      entryCount
+ *
+ * @brief   Number of assigned entries.
+ */
+static uint16 entryCount( void )
+{
+  uint16 x;
+  uint16 cnt = 0;
+
+  for ( x = 0; x < ENTRIES; x++ )
+  {
+    if ( ZDSecMgrEntries[x].ami != INVALID_NODE_ADDR )
+    {
+      cnt++;
+    }
+  }
+
+  return ( cnt );
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  ZDSecMgrEntry_t *entry;
+  double t0, us;
+  uint32 n, hits;
+  uint16 dev, other, cnt;
+  uint8 k;
+
+  osal_init_system();
+  _NIB.nwkDevAddress = 0x0000;
+
+  ZDSecMgrEntryInit( ZDO_INITDEV_NEW_NETWORK_STATE );
+  HOST_CHECK( ZDSecMgrEntries != NULL );
+
+  // Join storm: every device joins, one in three gets a link key entry
+  for ( dev = 0; dev < TEST_DEVICES; dev++ )
+  {
+    for ( k = 0; k < Z_EXTADDR_LEN; k++ )
+    {
+      devExt[dev][k] = (uint8)testRand();
+    }
+    devExt[dev][0] = LO_UINT16( dev );
+    devExt[dev][1] = HI_UINT16( dev );
+
+    devJoin( dev );
+
+    if ( ( dev % 3 ) == 0 )
+    {
+      HOST_CHECK( ZDSecMgrEntryNew( &entry ) == ZSuccess );
+      ZDSecMgrEntryAMISet( entry, devAmi[dev] );
+    }
+
+    checkDevice( testRand() % ( dev + 1 ) );
+  }
+  HOST_CHECK_EQ( entryCount(), ENTRIES );
+
+  for ( dev = 0; dev < TEST_DEVICES; dev++ )
+  {
+    checkDevice( dev );
+  }
+
+  // Devices leave and rejoin, their entries are freed and go to other
+  // devices
+  for ( n = 0; n < CHURN_LOOKUPS; n++ )
+  {
+    if ( ( n % 8 ) == 0 )
+    {
+      dev = testRand() % TEST_DEVICES;
+      entry = refLookupExt( devExt[dev] );
+
+      if ( entry != NULL )
+      {
+        ZDSecMgrEntryFree( entry );
+        devLeave( dev );
+        devJoin( dev );
+
+        do
+        {
+          other = testRand() % TEST_DEVICES;
+        } while ( ( devAmi[other] == INVALID_NODE_ADDR ) ||
+                  ( refLookupExt( devExt[other] ) != NULL ) );
+
+        HOST_CHECK( ZDSecMgrEntryNew( &entry ) == ZSuccess );
+        ZDSecMgrEntryAMISet( entry, devAmi[other] );
+      }
+      else if ( devAmi[dev] != INVALID_NODE_ADDR )
+      {
+        devLeave( dev );
+      }
+      else
+      {
+        devJoin( dev );
+      }
+    }
+
+    // the NV restore path rebuilds the hash from the table
+    if ( n == CHURN_LOOKUPS / 2 )
+    {
+      ZDSecMgrEntryInit( ZDO_INITDEV_NEW_NETWORK_STATE );
+    }
+
+    checkDevice( testRand() % TEST_DEVICES );
+  }
+
+  for ( dev = 0; dev < TEST_DEVICES; dev++ )
+  {
+    checkDevice( dev );
+  }
+
+  // The address manager gives the slot of a device that still holds an
+  // entry to another device: the entry follows the slot, as it did
+  // without the hash
+  for ( dev = 0; refLookupExt( devExt[dev] ) == NULL; dev++ );
+  for ( other = 0; ( devAmi[other] == INVALID_NODE_ADDR ) ||
+                   ( refLookupExt( devExt[other] ) != NULL ); other++ );
+  devLeave( other );
+  devAmi[other] = devAmi[dev];
+  devAmi[dev] = INVALID_NODE_ADDR;
+  osal_memcpy( addrExt[devAmi[other]], devExt[other], Z_EXTADDR_LEN );
+  addrNwk[devAmi[other]] = devNwk[other];
+  checkDevice( dev );
+  checkDevice( other );
+  HOST_CHECK( refLookupExt( devExt[other] ) != NULL );
+  devJoin( dev );
+  checkDevice( dev );
+
+  // rebuilt from the address manager, the hash holds the new owner
+  ZDSecMgrEntryInit( ZDO_INITDEV_NEW_NETWORK_STATE );
+  for ( dev = 0; dev < TEST_DEVICES; dev++ )
+  {
+    checkDevice( dev );
+  }
+
+  // EXT address lookups of the devices holding an entry, as on their
+  // secured frames, then of the devices without one
+  for ( k = 0; k < 2; k++ )
+  {
+    cnt = 0;
+    for ( dev = 0; dev < TEST_DEVICES; dev++ )
+    {
+      if ( ( refLookupExt( devExt[dev] ) != NULL ) == ( k == 0 ) )
+      {
+        benchDev[cnt++] = dev;
+      }
+    }
+
+    hits = 0;
+    addrScanSteps = 0;
+    t0 = HOST_TEST_SECONDS();
+    for ( n = 0; n < LOOKUPS; n++ )
+    {
+      if ( ZDSecMgrEntryLookupExt( devExt[benchDev[testRand() % cnt]], &entry ) == ZSuccess )
+      {
+        hits++;
+      }
+    }
+    us = ( HOST_TEST_SECONDS() - t0 ) * 1e6 / LOOKUPS;
+
+    HOST_CHECK_EQ( hits, ( k == 0 ) ? LOOKUPS : 0 );
+#if ( ZDSECMGR_ENTRY_HASH == TRUE )
+    // a device with an entry never costs an address manager search
+    HOST_CHECK( ( k != 0 ) || ( addrScanSteps == 0 ) );
+#endif
+
+    printf( "%d devices, %d entries, hash %s (%d buckets), %u devices %s an entry: "
+            "%.3f us, %.1f address manager steps per lookup\n",
+            TEST_DEVICES, ENTRIES, ( ZDSECMGR_ENTRY_HASH == TRUE ) ? "on" : "off",
+            ZDSECMGR_HASH_SIZE, cnt, ( k == 0 ) ? "with" : "without",
+            us, (double)addrScanSteps / LOOKUPS );
+  }
+
+  return ( HOST_TEST_RESULT() );
+}
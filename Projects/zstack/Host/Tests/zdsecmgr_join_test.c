@@ -0,0 +1,896 @@
+/**************************************************************************************************
+  Filename:       zdsecmgr_join_test.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Runs join storms of 50 to 200 devices through the Trust Center over a model
+                  of the network that carries a few key frames at a time, measures the time
+                  to full network, and checks when joining devices are authenticated, removed
+                  and admitted.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "ZComDef.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "OSAL_Nv.h"
+#include "ZGlobals.h"
+#include "ssp.h"
+#include "nwk_globals.h"
+#include "nwk.h"
+#include "NLMEDE.h"
+#include "AddrMgr.h"
+#include "AssocList.h"
+#include "APSMEDE.h"
+#include "ZDApp.h"
+#include "ZDSecMgr.h"
+#include "host_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+#if !defined ( ZDSECMGR_JOIN_RETRY_MAX )
+  #define ZDSECMGR_JOIN_RETRY_MAX 3
+#endif
+
+#define TC_NWK_ADDR       0x0000
+#define MAX_DEVICES       200
+#define ADDR_ENTRIES      ( MAX_DEVICES + 8 )
+#define ROUTERS           8         // parents of the devices that are not TC children
+#define RUNS              20        // join storms of each size
+
+// Network model
+#define STORM_MSEC        1000      // devices power up within this time
+#define DIRECT_PCT        30        // devices joining the Trust Center itself
+#define REJOIN_PCT        50        // devices that were in the network before
+#define FRAMES_MAX        4         // key frames the network carries at a time
+#define FRAME_MIN_MSEC    30        // key frame delivery time, 30 to 80 ms
+#define FRAME_VAR_MSEC    51
+#define FRAME_LOSS_PCT    10
+#define KEY_WAIT_MSEC     3000      // a device gives up on the key after this
+#define BACKOFF_MSEC      2000      // and joins again after 2, 4, then 6 s
+#define BACKOFF_MAX_MSEC  6000
+#define TICK_MSEC         5
+#define RUN_MAX_MSEC      600000UL
+#define IDLE_MSEC         10000     // the Trust Center is done with a storm
+
+// Simulated device states
+#define DEV_OFF           0
+#define DEV_WAIT_KEY      1
+#define DEV_HAS_KEY       2
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint8  extAddr[Z_EXTADDR_LEN];
+  uint16 nwkAddr;
+  uint16 parentAddr;
+  uint8  rejoin;
+  uint8  state;
+  uint8  joins;
+  uint8  keySent;            // a key transport to the device was accepted
+  uint32 nextMSec;           // next join, or end of the key wait
+  associated_devices_t assoc;
+  uint8  assocUsed;
+} simDev_t;
+
+typedef struct
+{
+  uint16 dev;
+  uint8  lost;
+  uint32 doneMSec;
+} simFrame_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+static uint16 zdoTask_ProcessEvent( uint8 task_id, uint16 events );
+
+const pTaskEventHandlerFn tasksArr[] = { zdoTask_ProcessEvent };
+const uint8 tasksCnt = sizeof( tasksArr ) / sizeof( tasksArr[0] );
+uint16 *tasksEvents;
+
+nwkIB_t _NIB;
+devStates_t devState = DEV_ZB_COORD;
+uint8 ZDAppTaskID = 0;
+uint8 zgSecurePermitJoin = TRUE;
+uint8 zgPreConfigKeys = FALSE;
+uint8 zgUseDefaultTCLK = TRUE;
+CONST byte defaultTCLinkKey[SEC_KEY_LEN] = { 0 };
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Address manager stub
+static uint8 addrUsed[ADDR_ENTRIES];
+static uint16 addrNwk[ADDR_ENTRIES];
+static uint8 addrExt[ADDR_ENTRIES][Z_EXTADDR_LEN];
+
+// The devices and the key frames on their way
+static simDev_t simDevs[MAX_DEVICES];
+static uint16 simDevCnt;
+static simFrame_t simFrames[FRAMES_MAX];
+static uint8 simFrameCnt;
+static uint32 simMSec;
+
+// Counters of the Trust Center actions
+static uint16 failDev = 0xFFFF;  // key transports to this device fail
+static uint8 lossPct = FRAME_LOSS_PCT;
+static uint32 keyReqs;
+static uint32 keyFails;
+static uint32 removals;
+static uint32 authEarly;         // authenticated before a key was sent
+
+static uint32 randSeed = 1;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static uint16 testRand( void );
+static simDev_t *simFind( uint8 *extAddr );
+static void simReset( uint16 devices );
+static void simJoin( simDev_t *dev );
+static void simLeave( simDev_t *dev );
+static void simTick( void );
+static uint32 simStorm( uint16 devices );
+static void checkPermitWindow( void );
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+static void checkRetries( void );
+#endif
+
+/*********************************************************************
+ * @fn      osalInitTasks
+ *
+ * @brief   Task table of the test.
+ */
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, sizeof( uint16 ) * tasksCnt );
+}
+
+/*********************************************************************
+ * @fn      zdoTask_ProcessEvent
+ *
+ * @brief   The new device event of ZDApp_ProcessSecEvent().
+ */
+static uint16 zdoTask_ProcessEvent( uint8 task_id, uint16 events )
+{
+  (void)task_id;
+
+  if ( events & ZDO_NEW_DEVICE )
+  {
+    if ( ZDSecMgrNewDeviceEvent() == TRUE )
+    {
+      osal_start_timerEx( ZDAppTaskID, ZDO_NEW_DEVICE, ZDSECMGR_NEW_DEVICE_DELAY );
+    }
+
+    return ( events ^ ZDO_NEW_DEVICE );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * Stubs of the address manager.
+ */
+void AddrMgrExtAddrSet( uint8 *dstExtAddr, uint8 *srcExtAddr )
+{
+  if ( srcExtAddr != NULL )
+  {
+    osal_memcpy( dstExtAddr, srcExtAddr, Z_EXTADDR_LEN );
+  }
+  else
+  {
+    osal_memset( dstExtAddr, 0, Z_EXTADDR_LEN );
+  }
+}
+
+uint8 AddrMgrExtAddrEqual( uint8 *extAddr1, uint8 *extAddr2 )
+{
+  return ( osal_memcmp( extAddr1, extAddr2, Z_EXTADDR_LEN ) );
+}
+
+uint8 AddrMgrExtAddrValid( uint8 *extAddr )
+{
+  uint8 x;
+
+  for ( x = 0; x < Z_EXTADDR_LEN; x++ )
+  {
+    if ( extAddr[x] != 0 )
+    {
+      return ( TRUE );
+    }
+  }
+
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryLookupNwk( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    if ( addrUsed[i] && ( addrNwk[i] == entry->nwkAddr ) )
+    {
+      entry->index = i;
+      osal_memcpy( entry->extAddr, addrExt[i], Z_EXTADDR_LEN );
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryLookupExt( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    if ( addrUsed[i] && osal_memcmp( addrExt[i], entry->extAddr, Z_EXTADDR_LEN ) )
+    {
+      entry->index = i;
+      entry->nwkAddr = addrNwk[i];
+      return ( TRUE );
+    }
+  }
+
+  entry->index = INVALID_NODE_ADDR;
+  return ( FALSE );
+}
+
+uint8 AddrMgrExtAddrLookup( uint16 nwkAddr, uint8 *extAddr )
+{
+  AddrMgrEntry_t entry;
+
+  entry.nwkAddr = nwkAddr;
+  if ( AddrMgrEntryLookupNwk( &entry ) == TRUE )
+  {
+    osal_memcpy( extAddr, entry.extAddr, Z_EXTADDR_LEN );
+    return ( TRUE );
+  }
+
+  return ( FALSE );
+}
+
+uint8 AddrMgrEntryGet( AddrMgrEntry_t *entry )
+{
+  if ( ( entry->index >= ADDR_ENTRIES ) || !addrUsed[entry->index] )
+  {
+    return ( FALSE );
+  }
+
+  entry->nwkAddr = addrNwk[entry->index];
+  osal_memcpy( entry->extAddr, addrExt[entry->index], Z_EXTADDR_LEN );
+  return ( TRUE );
+}
+
+uint8 AddrMgrEntryUpdate( AddrMgrEntry_t *entry )
+{
+  uint16 i;
+  uint16 slot = INVALID_NODE_ADDR;
+
+  for ( i = 0; i < ADDR_ENTRIES; i++ )
+  {
+    if ( addrUsed[i] && osal_memcmp( addrExt[i], entry->extAddr, Z_EXTADDR_LEN ) )
+    {
+      slot = i;
+      break;
+    }
+    if ( !addrUsed[i] && ( slot == INVALID_NODE_ADDR ) )
+    {
+      slot = i;
+    }
+  }
+
+  if ( slot == INVALID_NODE_ADDR )
+  {
+    entry->index = INVALID_NODE_ADDR;
+    return ( FALSE );
+  }
+
+  addrUsed[slot] = TRUE;
+  addrNwk[slot] = entry->nwkAddr;
+  osal_memcpy( addrExt[slot], entry->extAddr, Z_EXTADDR_LEN );
+  entry->index = slot;
+  return ( TRUE );
+}
+
+uint8 AddrMgrEntryRelease( AddrMgrEntry_t *entry )
+{
+  if ( entry->index >= ADDR_ENTRIES )
+  {
+    return ( FALSE );
+  }
+
+  addrUsed[entry->index] = FALSE;
+  return ( TRUE );
+}
+
+/*********************************************************************
+ * Stubs of the association table, one entry per simulated device that
+ * joined the Trust Center itself.
+ */
+associated_devices_t *AssocGetWithShort( uint16 shortAddr )
+{
+  uint16 x;
+
+  for ( x = 0; x < simDevCnt; x++ )
+  {
+    if ( simDevs[x].assocUsed && ( simDevs[x].assoc.shortAddr == shortAddr ) )
+    {
+      return ( &simDevs[x].assoc );
+    }
+  }
+
+  return ( NULL );
+}
+
+associated_devices_t *AssocGetWithExt( byte *extAddr )
+{
+  simDev_t *dev = simFind( extAddr );
+
+  if ( ( dev != NULL ) && dev->assocUsed )
+  {
+    return ( &dev->assoc );
+  }
+
+  return ( NULL );
+}
+
+associated_devices_t *AssocMatchDeviceStatus( uint8 status )
+{
+  uint16 x;
+
+  for ( x = 0; x < simDevCnt; x++ )
+  {
+    if ( simDevs[x].assocUsed && ( simDevs[x].assoc.devStatus & status ) )
+    {
+      return ( &simDevs[x].assoc );
+    }
+  }
+
+  return ( NULL );
+}
+
+byte AssocRemove( byte *extAddr )
+{
+  simDev_t *dev = simFind( extAddr );
+
+  if ( ( dev != NULL ) && dev->assocUsed )
+  {
+    dev->assocUsed = FALSE;
+    return ( TRUE );
+  }
+
+  return ( FALSE );
+}
+
+/*********************************************************************
+ * Stubs of the frames the Trust Center sends. A key frame takes one of
+ * the FRAMES_MAX network buffers until it is delivered or lost.
+ */
+ZStatus_t APSME_TransportKeyReq( APSME_TransportKeyReq_t *req )
+{
+  simDev_t *dev = simFind( req->extAddr );
+
+  keyReqs++;
+
+  if ( ( dev == NULL ) || ( ( dev - simDevs ) == failDev ) || ( simFrameCnt >= FRAMES_MAX ) )
+  {
+    keyFails++;
+    return ( ZMemError );
+  }
+
+  dev->keySent = TRUE;
+
+  simFrames[simFrameCnt].dev = (uint16)( dev - simDevs );
+  simFrames[simFrameCnt].lost = ( ( testRand() % 100 ) < lossPct );
+  simFrames[simFrameCnt].doneMSec = simMSec + FRAME_MIN_MSEC + ( testRand() % FRAME_VAR_MSEC );
+  simFrameCnt++;
+
+  return ( ZSuccess );
+}
+
+ZStatus_t NLME_LeaveReq( NLME_LeaveReq_t *req )
+{
+  simDev_t *dev = simFind( req->extAddr );
+
+  removals++;
+
+  if ( dev != NULL )
+  {
+    simLeave( dev );
+  }
+
+  return ( ZSuccess );
+}
+
+ZStatus_t APSME_RemoveDeviceReq( APSME_RemoveDeviceReq_t *req )
+{
+  simDev_t *dev = simFind( req->childExtAddr );
+
+  removals++;
+
+  if ( dev != NULL )
+  {
+    simLeave( dev );
+  }
+
+  return ( ZSuccess );
+}
+
+/*********************************************************************
+ * Stubs of the rest of the stack, not reached by the join code.
+ */
+uint8 osal_nv_item_init( uint16 id, uint16 len, void *buf )
+{
+  (void)id; (void)len; (void)buf;
+  return ( SUCCESS );
+}
+
+uint8 osal_nv_read( uint16 id, uint16 offset, uint16 len, void *buf )
+{
+  (void)id; (void)offset;
+  osal_memset( buf, 0, len );
+  return ( SUCCESS );
+}
+
+uint8 osal_nv_write( uint16 id, uint16 offset, uint16 len, void *buf )
+{
+  (void)id; (void)offset; (void)len; (void)buf;
+  return ( SUCCESS );
+}
+
+ZStatus_t APSME_AuthenticateReq( APSME_AuthenticateReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_EstablishKeyReq( APSME_EstablishKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_EstablishKeyRsp( APSME_EstablishKeyRsp_t *rsp ) { (void)rsp; return ( ZSuccess ); }
+ZStatus_t APSME_RequestKeyReq( APSME_RequestKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_SwitchKeyReq( APSME_SwitchKeyReq_t *req ) { (void)req; return ( ZSuccess ); }
+ZStatus_t APSME_UpdateDeviceReq( APSME_UpdateDeviceReq_t *req ) { (void)req; return ( ZSuccess ); }
+void APSME_SecurityRM_CD( void ) {}
+
+uint8 APSME_LookupExtAddr( uint16 nwkAddr, uint8 *extAddr )
+{
+  return ( AddrMgrExtAddrLookup( nwkAddr, extAddr ) );
+}
+
+uint8 APSME_LookupNwkAddr( uint8 *extAddr, uint16 *nwkAddr )
+{
+  AddrMgrEntry_t entry;
+
+  AddrMgrExtAddrSet( entry.extAddr, extAddr );
+  if ( AddrMgrEntryLookupExt( &entry ) == TRUE )
+  {
+    *nwkAddr = entry.nwkAddr;
+    return ( TRUE );
+  }
+
+  return ( FALSE );
+}
+
+uint16 NLME_GetShortAddr( void ) { return ( TC_NWK_ADDR ); }
+
+ZStatus_t NLME_ReadNwkKeyInfo( uint16 index, uint16 len, void *keyinfo, uint16 NvId )
+{
+  (void)index; (void)NvId;
+  osal_memset( keyinfo, 0, len );
+  return ( ZSuccess );
+}
+
+void SSP_Init( void ) {}
+void SSP_GetTrueRand( uint8 len, uint8 *rand ) { osal_memset( rand, 0x5A, len ); }
+void SSP_SwitchNwkKey( uint8 seqNum ) { (void)seqNum; }
+void SSP_UpdateNwkKey( uint8 *key, uint8 keySeqNum ) { (void)key; (void)keySeqNum; }
+
+void ZDApp_NVUpdate( void ) {}
+
+/*********************************************************************
+ * @fn      testRand
+ *
+ * @brief   Repeatable pseudo random numbers.
+ */
+static uint16 testRand( void )
+{
+  randSeed = randSeed * 1103515245UL + 12345;
+  return ( (uint16)( randSeed >> 16 ) );
+}
+
+/*********************************************************************
+ * @fn      simFind
+ *
+ * @brief   The simulated device with an EXT address.
+ */
+static simDev_t *simFind( uint8 *extAddr )
+{
+  uint16 x = BUILD_UINT16( extAddr[0], extAddr[1] );
+
+  if ( ( x < simDevCnt ) && osal_memcmp( simDevs[x].extAddr, extAddr, Z_EXTADDR_LEN ) )
+  {
+    return ( &simDevs[x] );
+  }
+
+  return ( NULL );
+}
+
+/*********************************************************************
+ * @fn      simReset
+ *
+ * @brief   Power up the devices within STORM_MSEC, with the Trust
+ *          Center idle.
+ */
+static void simReset( uint16 devices )
+{
+  simDev_t *dev;
+  uint16 x;
+
+  osal_stop_timerEx( ZDAppTaskID, ZDO_NEW_DEVICE );
+  osal_clear_event( ZDAppTaskID, ZDO_NEW_DEVICE );
+  osal_memset( addrUsed, FALSE, sizeof( addrUsed ) );
+  osal_memset( simDevs, 0, sizeof( simDevs ) );
+  simDevCnt = devices;
+  simFrameCnt = 0;
+  simMSec = 0;
+
+  for ( x = 0; x < devices; x++ )
+  {
+    dev = &simDevs[x];
+    dev->extAddr[0] = LO_UINT16( x );
+    dev->extAddr[1] = HI_UINT16( x );
+    dev->extAddr[7] = 0x12;
+
+    if ( ( testRand() % 100 ) < DIRECT_PCT )
+    {
+      dev->parentAddr = TC_NWK_ADDR;
+      dev->nwkAddr = 0x0001 + x;
+    }
+    else
+    {
+      dev->parentAddr = 0x0100 + ( x % ROUTERS );
+      dev->nwkAddr = 0x1000 + x;
+    }
+
+    dev->rejoin = ( ( testRand() % 100 ) < REJOIN_PCT );
+    dev->state = DEV_OFF;
+    dev->nextMSec = testRand() % STORM_MSEC;
+  }
+}
+
+/*********************************************************************
+ * @fn      simJoin
+ *
+ * @brief   The device joins. A child of the Trust Center is associated
+ *          as ZDO_JoinIndicationCB() does, the parent of another device
+ *          sends an Update-Device.
+ */
+static void simJoin( simDev_t *dev )
+{
+  ZDO_UpdateDeviceInd_t ind;
+  AddrMgrEntry_t entry;
+
+  dev->state = DEV_WAIT_KEY;
+  dev->nextMSec = simMSec + KEY_WAIT_MSEC;
+  dev->joins++;
+
+  if ( dev->parentAddr == TC_NWK_ADDR )
+  {
+    entry.user = ADDRMGR_USER_DEFAULT;
+    entry.nwkAddr = dev->nwkAddr;
+    AddrMgrExtAddrSet( entry.extAddr, dev->extAddr );
+    AddrMgrEntryUpdate( &entry );
+
+    dev->assoc.shortAddr = dev->nwkAddr;
+    dev->assoc.addrIdx = entry.index;
+    dev->assoc.nodeRelation = CHILD_RFD;
+    dev->assoc.devStatus = DEV_SEC_INIT_STATUS | ( dev->rejoin ? DEV_REJOIN_STATUS : 0 );
+    dev->assocUsed = TRUE;
+
+    osal_start_timerEx( ZDAppTaskID, ZDO_NEW_DEVICE, 600 );
+  }
+  else
+  {
+    ind.srcAddr = dev->parentAddr;
+    osal_memcpy( ind.devExtAddr, dev->extAddr, Z_EXTADDR_LEN );
+    ind.devAddr = dev->nwkAddr;
+    ind.status = dev->rejoin ? APSME_UD_STANDARD_UNSECURED_REJOIN
+                             : APSME_UD_STANDARD_UNSECURED_JOIN;
+    ZDSecMgrUpdateDeviceInd( &ind );
+  }
+}
+
+/*********************************************************************
+ * @fn      simLeave
+ *
+ * @brief   The device leaves without the key and joins again after a
+ *          backoff that doubles up to BACKOFF_MAX_MSEC.
+ */
+static void simLeave( simDev_t *dev )
+{
+  uint32 backoff = (uint32)BACKOFF_MSEC << ( ( dev->joins > 0 ) ? dev->joins - 1 : 0 );
+
+  dev->state = DEV_OFF;
+  dev->nextMSec = simMSec + ( ( backoff > BACKOFF_MAX_MSEC ) ? BACKOFF_MAX_MSEC : backoff );
+  dev->assocUsed = FALSE;
+}
+
+/*********************************************************************
+ * @fn      simTick
+ *
+ * @brief   Deliver the key frames that are due, and let the devices
+ *          that are due join or give up on the key.
+ */
+static void simTick( void )
+{
+  simDev_t *dev;
+  uint16 x;
+  uint8 f;
+
+  for ( f = 0; f < simFrameCnt; )
+  {
+    if ( simFrames[f].doneMSec > simMSec )
+    {
+      f++;
+      continue;
+    }
+
+    dev = &simDevs[simFrames[f].dev];
+    if ( !simFrames[f].lost && ( dev->state == DEV_WAIT_KEY ) )
+    {
+      dev->state = DEV_HAS_KEY;
+    }
+
+    simFrames[f] = simFrames[--simFrameCnt];
+  }
+
+  for ( x = 0; x < simDevCnt; x++ )
+  {
+    dev = &simDevs[x];
+
+    // a child is authenticated only once its key is on the way
+    if ( dev->assocUsed && ( dev->assoc.devStatus & DEV_SEC_AUTH_STATUS ) && !dev->keySent )
+    {
+      authEarly++;
+    }
+
+    if ( dev->nextMSec > simMSec )
+    {
+      continue;
+    }
+
+    if ( dev->state == DEV_OFF )
+    {
+      simJoin( dev );
+    }
+    else if ( dev->state == DEV_WAIT_KEY )
+    {
+      simLeave( dev );
+    }
+  }
+}
+
+/*********************************************************************
+ * @fn      simStorm
+ *
+ * @brief   Run a join storm until every device holds the key.
+ *
+ * @return  time to full network, in ms
+ */
+static uint32 simStorm( uint16 devices )
+{
+  uint32 t;
+  uint16 x, done;
+
+  simReset( devices );
+
+  while ( simMSec < RUN_MAX_MSEC )
+  {
+    simTick();
+
+    for ( x = 0, done = 0; x < simDevCnt; x++ )
+    {
+      if ( simDevs[x].state == DEV_HAS_KEY )
+      {
+        done++;
+      }
+    }
+
+    if ( done == simDevCnt )
+    {
+      break;
+    }
+
+    osal_run_virtual( TICK_MSEC );
+    simMSec += TICK_MSEC;
+  }
+
+  HOST_CHECK( simMSec < RUN_MAX_MSEC );
+
+  t = simMSec;
+
+  // let the Trust Center go idle before the next storm
+  while ( simMSec < t + IDLE_MSEC )
+  {
+    osal_run_virtual( TICK_MSEC );
+    simMSec += TICK_MSEC;
+  }
+
+  return ( t );
+}
+
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+/*********************************************************************
+ * @fn      checkRetries
+ *
+ * @brief   A queued child whose key cannot be sent is removed, without
+ *          being authenticated, when it runs out of retries.
+ */
+static void checkRetries( void )
+{
+  simDev_t *dev;
+
+  simReset( 1 );
+  dev = &simDevs[0];
+  dev->parentAddr = TC_NWK_ADDR;
+  dev->nwkAddr = 0x0001;
+  failDev = 0;
+  removals = 0;
+  keyReqs = 0;
+
+  simJoin( dev );
+  osal_run_virtual( 600 + ZDSECMGR_JOIN_RETRY_MAX * ZDSECMGR_NEW_DEVICE_DELAY );
+
+  HOST_CHECK_EQ( keyReqs, ZDSECMGR_JOIN_RETRY_MAX );
+  HOST_CHECK_EQ( removals, 1 );
+  HOST_CHECK( dev->state == DEV_OFF );
+  HOST_CHECK( !( dev->assoc.devStatus & DEV_SEC_AUTH_STATUS ) );
+
+  // and is not tried again
+  osal_run_virtual( 10 * ZDSECMGR_NEW_DEVICE_DELAY );
+  HOST_CHECK_EQ( keyReqs, ZDSECMGR_JOIN_RETRY_MAX );
+
+  failDev = 0xFFFF;
+}
+#endif
+
+/*********************************************************************
+ * @fn      checkPermitWindow
+ *
+ * @brief   Devices whose Update-Device came while joining was permitted
+ *          get the key even if the window closes before the Trust Center
+ *          serves them, and devices that join after it closes are
+ *          removed.
+ */
+static void checkPermitWindow( void )
+{
+  uint16 x;
+
+  simReset( 2 * FRAMES_MAX );
+  for ( x = 0; x < simDevCnt; x++ )
+  {
+    simDevs[x].parentAddr = 0x0100;
+    simDevs[x].nwkAddr = 0x1000 + x;
+  }
+  removals = 0;
+  lossPct = 0;
+  ZDSecMgrPermitJoining( 60 );
+
+  for ( x = 0; x < FRAMES_MAX; x++ )
+  {
+    simJoin( &simDevs[x] );
+  }
+  ZDSecMgrPermitJoiningTimeout();
+
+  for ( ; x < simDevCnt; x++ )
+  {
+    simJoin( &simDevs[x] );
+  }
+  HOST_CHECK_EQ( removals, FRAMES_MAX );
+
+  while ( simMSec < 1000 )
+  {
+    osal_run_virtual( TICK_MSEC );
+    simMSec += TICK_MSEC;
+    simTick();
+  }
+
+  for ( x = 0; x < simDevCnt; x++ )
+  {
+    HOST_CHECK( simDevs[x].state == ( ( x < FRAMES_MAX ) ? DEV_HAS_KEY : DEV_OFF ) );
+  }
+  HOST_CHECK_EQ( removals, FRAMES_MAX );
+
+  ZDSecMgrPermitJoining( 0xFF );
+  lossPct = FRAME_LOSS_PCT;
+}
+
+/*********************************************************************
+ * @fn      main
+ */
+int main( void )
+{
+  uint32 t, sum, worst, joins;
+  uint16 devices;
+  uint16 x;
+  uint8 run;
+
+  osal_init_system();
+  _NIB.nwkDevAddress = TC_NWK_ADDR;
+
+  ZDSecMgrInit( ZDO_INITDEV_NEW_NETWORK_STATE );
+
+  for ( devices = 50; devices <= MAX_DEVICES; devices += 50 )
+  {
+    sum = 0;
+    worst = 0;
+    joins = 0;
+    keyReqs = 0;
+    keyFails = 0;
+    removals = 0;
+
+    for ( run = 0; run < RUNS; run++ )
+    {
+      t = simStorm( devices );
+      sum += t;
+      worst = ( t > worst ) ? t : worst;
+
+      for ( x = 0; x < devices; x++ )
+      {
+        joins += simDevs[x].joins;
+      }
+    }
+
+    printf( "%3u devices, join queue %s: time to full network %.1f s (worst %.1f s), "
+            "%.2f joins per device, %lu of %lu key transports refused, %lu removals\n",
+            devices, ( ZDSECMGR_JOIN_SCHED == TRUE ) ? "on" : "off",
+            sum / 1000.0 / RUNS, worst / 1000.0, (double)joins / devices / RUNS,
+            (unsigned long)keyFails, (unsigned long)keyReqs, (unsigned long)removals );
+  }
+
+  HOST_CHECK_EQ( authEarly, 0 );
+
+  checkPermitWindow();
+#if ( ZDSECMGR_JOIN_SCHED == TRUE )
+  checkRetries();
+#endif
+
+  return ( HOST_TEST_RESULT() );
+}
@@ -45,10 +45,18 @@
  * INCLUDES
  */
 #include "OSAL.h"
+#include "OSAL_PwrMgr.h"
+#include "OSAL_Nv.h"
+#include "OSAL_Pt.h"
 #include "AF.h"
 #include "ZDApp.h"
 #include "ZDObject.h"
 #include "ZDProfile.h"
+#if defined ( ZCL_REPORT_ENGINE )
+  #include "zcl.h"
+  #include "zcl_ms.h"
+  #include "zcl_report.h"
+#endif
 
 #include "GenericApp.h"
 #include "DebugTrace.h"
@@ -67,6 +75,7 @@
 #include "hal_battery_monitor.h"
 #include "hal_rtc_ds1302.h"
 #include "hal_AD7793.h"
+#include "hal_energy.h"
 #include "measTempr.h"
 
 #include "string.h"
@@ -74,19 +83,39 @@
  * MACROS
  */
 
+// Expand GENERICAPP_EVENT_LIST into dispatch table entries / an event mask
+#define GENERICAPP_EVENT_ENTRY( name, bit, handler )  { name, handler },
+#define GENERICAPP_EVENT_OR( name, bit, handler )     | (bit)
+
 /*********************************************************************
  * CONSTANTS
  */
 #define MEAS_TEMPR_LOOP_COUNT_MAX     80
 
+// Every event handled by GenericApp_ProcessEvent()
+#define GENERICAPP_EVENT_MASK  \
+  ( SYS_EVENT_MSG GENERICAPP_EVENT_LIST( GENERICAPP_EVENT_OR ) )
+
+#define GENERICAPP_EVENT_CNT  \
+  ( sizeof( GenericApp_EventTable ) / sizeof( GenericApp_EventTable[0] ) )
+
 /*********************************************************************
  * TYPEDEFS
  */
-typedef enum
+// AD7793 channel of the measurement loop
+typedef struct
 {
-  AD7793_IDLE,
-  AD7793_SAMPLE
-} AD7793State_t;
+  void (*config)(AD7793Rate_t OutUpdateRate);
+  float (*fetch)(void);
+  uint8 offset;       // Offset of the result in measResult_t
+} GenericAppMeasChannel_t;
+
+// Application event and its handler
+typedef struct
+{
+  uint16 event;
+  void (*pfnHandler)( void );
+} GenericAppEvent_t;
 
 
 /*********************************************************************
@@ -98,14 +127,19 @@ const cId_t GenericApp_InClusterList[GENERICAPP_IN_CLUSTERS] =
 {
   GENERICAPP_CLUSTERID,
   GENERICAPP_CLUSTERID_START,
-  GENERICAPP_CLUSTERID_SYNC
+  GENERICAPP_CLUSTERID_SYNC,
+  GENERICAPP_CLUSTERID_ENERGY
+#if defined ( ZCL_REPORT_ENGINE )
+  , ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT
+#endif
 };
 
 const cId_t GenericApp_OutClusterList[GENERICAPP_OUT_CLUSTERS] =
 {
   GENERICAPP_CLUSTERID,
   GENERICAPP_CLUSTERID_TEMPR_SYNC_OVER,
-  GENERICAPP_CLUSTERID_TEMPR_RESULT
+  GENERICAPP_CLUSTERID_TEMPR_RESULT,
+  GENERICAPP_CLUSTERID_ENERGY
 };
 
 const SimpleDescriptionFormat_t GenericApp_SimpleDesc =
@@ -136,6 +170,10 @@ TemprSystemStatus_t TemprSystemStatus;
 /*********************************************************************
  * EXTERNAL FUNCTIONS
  */
+#if defined ( ZCL_REPORT_ENGINE )
+// ZCL frames of the endpoint are passed on by GenericApp_MessageMSGCB()
+extern void zclProcessMessageMSG( afIncomingMSGPacket_t *pkt );
+#endif
 
 /*********************************************************************
  * LOCAL VARIABLES
@@ -151,15 +189,56 @@ byte GenericApp_TransID;  // This is the unique message ID (counter)
 afAddrType_t GenericApp_DstAddr;
 
 /* For measure */
-AD7793State_t  appAD7793State;         // ADC״̬
 static uint16  ad7793RegSetDelay_ms;   // ȡʱʱ
 AD7793Rate_t   ad7793UpdateRate;       // ѡĲƵ
 measResult_t   measRltArray[MEAS_TEMPR_LOOP_COUNT_MAX]; // 洢ͼмֵ
 ResultStore_t  OneRltStore;            // 洢һεĲ
 
+// Measurement loop coroutine, the channel it converts and its wait timeout
+static osalPt_t measPt;
+static uint8 measChannel;
+static uint16 measTimeout;
+
+// Channels converted in each measurement loop, in order
+static const GenericAppMeasChannel_t GenericApp_MeasChannels[] =
+{
+  { AD7793_AIN2_config_one, AD7793_AIN2_fetch_one, osal_offsetof(measResult_t, fPtVolt) },
+  { AD7793_AIN3_config_one, AD7793_AIN3_fetch_one, osal_offsetof(measResult_t, fRefVolt) },
+  { AD7793_AIN1_config_one, AD7793_AIN1_fetch_one, osal_offsetof(measResult_t, fThermoVolt) }
+};
+
+#define GENERICAPP_MEAS_CHANNELS \
+  ( sizeof( GenericApp_MeasChannels ) / sizeof( GenericApp_MeasChannels[0] ) )
+
 static uint16 retryNumOfMeasTempr;  // ¼µĴ
 static SensorCalCoef_t   s_factoryCalCoef;
 
+#if defined ( ZCL_REPORT_ENGINE )
+// Temperature Measurement server attributes, in 0.01 C. The measured
+// value is unknown until the first stable online result.
+static int16 GenericApp_MeasuredValue = (int16)0x8000;
+static int16 GenericApp_MinMeasuredValue = 0;       // results below 0 C are dropped
+static int16 GenericApp_MaxMeasuredValue = 9995;    // and from 100 C on
+
+// The measured value is reported from the first stable online result on
+static bool GenericApp_ReportStarted = FALSE;
+
+static CONST zclAttrRec_t GenericApp_Attrs[] =
+{
+  { ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT,
+    { ATTRID_MS_TEMPERATURE_MEASURED_VALUE, ZCL_DATATYPE_INT16, ACCESS_CONTROL_READ,
+      (void *)&GenericApp_MeasuredValue } },
+  { ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT,
+    { ATTRID_MS_TEMPERATURE_MIN_MEASURED_VALUE, ZCL_DATATYPE_INT16, ACCESS_CONTROL_READ,
+      (void *)&GenericApp_MinMeasuredValue } },
+  { ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT,
+    { ATTRID_MS_TEMPERATURE_MAX_MEASURED_VALUE, ZCL_DATATYPE_INT16, ACCESS_CONTROL_READ,
+      (void *)&GenericApp_MaxMeasuredValue } }
+};
+
+#define GENERICAPP_ATTRS  ( sizeof( GenericApp_Attrs ) / sizeof( GenericApp_Attrs[0] ) )
+#endif
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -169,20 +248,40 @@ void GenericApp_MessageMSGCB( afIncomingMSGPacket_t *pckt );
 
 
 void GenericApp_DoMeasTempr(void);
-void GenericApp_PtVoltSample(void);
-void GenericApp_RefVoltSample(void);
-void GenericApp_ThermoVoltSample(void);
+uint8 GenericApp_MeasSample(void);
+void GenericApp_MeasSampleEvt(void);
+void GenericApp_WaitConversion(uint16 event, uint16 timeout);
+void GenericApp_ConversionDone(uint16 event);
+void GenericApp_MeasAbort(void);
 
 void GenericApp_MeasTemprInit(void);
 void GenericApp_InitMeasResultArray(void);
 void MeasTemprComplete(real32 fOutputDegree, real32 fColdEndDegree, bool isStableRlt);
 real32 CalWorkEndTemp(real32 fWorkEndDegree, real32 fColdEndDegree);
+#if defined ( ZCL_REPORT_ENGINE )
+void GenericApp_ReportInit( void );
+void GenericApp_ReportStart( void );
+void GenericApp_ZclReportEvt( void );
+#endif
 
 void GenericApp_HandleNetworkStatus( devStates_t GenericApp_NwkStateTemp);
 void GenericApp_LeaveNetwork( void );
 void GenericApp_SyncData(void);
+void GenericApp_SendEnergyReport(afIncomingMSGPacket_t *pkt);
 void HalOledDispStaDurMeas(real32 data,TemprSystemStatus_t deviceStatus);
 void HalOledDispTempr(real32 data);
+
+void GenericApp_ProcessMsgs( void );
+void GenericApp_DoMeasTemprEvt( void );
+void GenericApp_TemprSyncEvt( void );
+void GenericApp_NvServiceEvt( void );
+
+// Event handlers in dispatch priority order
+static const GenericAppEvent_t GenericApp_EventTable[] =
+{
+  { SYS_EVENT_MSG, GenericApp_ProcessMsgs },
+  GENERICAPP_EVENT_LIST( GENERICAPP_EVENT_ENTRY )
+};
 /*********************************************************************
  * NETWORK LAYER CALLBACKS
  */
@@ -229,8 +328,24 @@ void GenericApp_Init( byte task_id )
   // Register the endpoint description with the AF
   afRegister( &GenericApp_epDesc );
 
+  // Payloads are parsed in place, share group/broadcast data with other endpoints
+  afSetRxShared( GenericApp_epDesc.endPoint, TRUE );
+
   // Register for all key events - This app will handle all key events
   RegisterForKeys( GenericApp_TaskID );
+
+  // Cap the application message queue, state changes still get through
+  osal_msg_set_depth( GenericApp_TaskID, GENERICAPP_MSG_Q_DEPTH );
+
+#if OSAL_NV_BG_COMPACT || OSAL_NV_WRITE_BACK
+  // Compact NV pages and flush coalesced NV writes between the application events
+  osal_nv_register( GenericApp_TaskID, GENERICAPP_NV_SERVICE );
+#endif
+
+#if defined ( ZCL_REPORT_ENGINE )
+  // Temperature results are reported through the ZCL
+  GenericApp_ReportInit();
+#endif
   
   // Init system status 
   TemprSystemStatus = TEMPR_OFFLINE_IDLE;
@@ -262,14 +377,60 @@ void GenericApp_Init( byte task_id )
  * @brief   Generic Application Task event processor.  This function
  *          is called to process all events for the task.  Events
  *          include timers, messages and any other user defined events.
+ *          Pending events are handled in GenericApp_EventTable order,
+ *          including those set by the handlers themselves, until none
+ *          is left or GENERICAPP_EVENT_BUDGET handlers have run.
  *
  * @param   task_id  - The OSAL assigned task ID.
  * @param   events - events to process.  This is a bit map and can
  *                   contain more than one event.
  *
- * @return  none
+ * @return  events left for the next call
  */
 UINT16 GenericApp_ProcessEvent( byte task_id, UINT16 events )
+{
+  uint8 budget = GENERICAPP_EVENT_BUDGET;
+  uint8 idx;
+  (void)task_id;  // Intentionally unreferenced parameter
+
+  while ( budget != 0 )
+  {
+    // Find the highest priority pending event
+    for ( idx = 0; idx < GENERICAPP_EVENT_CNT; idx++ )
+    {
+      if ( events & GenericApp_EventTable[idx].event )
+      {
+        break;
+      }
+    }
+
+    if ( idx == GENERICAPP_EVENT_CNT )
+    {
+      break;
+    }
+
+    events ^= GenericApp_EventTable[idx].event;
+    GenericApp_EventTable[idx].pfnHandler();
+    budget--;
+
+    // Events the handler set for this task are handled in this call too
+    events |= osal_take_events( GenericApp_TaskID, GENERICAPP_EVENT_MASK );
+  }
+
+  // Discard unknown events
+  return ( events & GENERICAPP_EVENT_MASK );
+}
+
+/*********************************************************************
+ * @fn      GenericApp_ProcessMsgs
+ *
+ * @brief   Handle SYS_EVENT_MSG, process all the queued OSAL messages.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_ProcessMsgs( void )
 {
   afIncomingMSGPacket_t *MSGpkt;
   afDataConfirm_t *afDataConfirm;
@@ -278,126 +439,184 @@ UINT16 GenericApp_ProcessEvent( byte task_id, UINT16 events )
   byte sentEP;
   ZStatus_t sentStatus;
   byte sentTransID;       // This should match the value sent
-  (void)task_id;  // Intentionally unreferenced parameter
 
-  if ( events & SYS_EVENT_MSG )
+  MSGpkt = (afIncomingMSGPacket_t *)osal_msg_receive( GenericApp_TaskID );
+  while ( MSGpkt )
   {
-    MSGpkt = (afIncomingMSGPacket_t *)osal_msg_receive( GenericApp_TaskID );
-    while ( MSGpkt )
+    switch ( MSGpkt->hdr.event )
     {
-      switch ( MSGpkt->hdr.event )
-      {
-        case ZDO_CB_MSG:
-          GenericApp_ProcessZDOMsgs( (zdoIncomingMsg_t *)MSGpkt );
-          break;
-
-        case KEY_CHANGE:
-          GenericApp_HandleKeys( ((keyChange_t *)MSGpkt)->state, ((keyChange_t *)MSGpkt)->keys );
-          break;
-
-        case AF_DATA_CONFIRM_CMD:
-          // This message is received as a confirmation of a data packet sent.
-          // The status is of ZStatus_t type [defined in ZComDef.h]
-          // The message fields are defined in AF.h
-          afDataConfirm = (afDataConfirm_t *)MSGpkt;
-          sentEP = afDataConfirm->endpoint;
-          sentStatus = afDataConfirm->hdr.status;
-          sentTransID = afDataConfirm->transID;
-          (void)sentEP;
-          (void)sentTransID;
-
-          // Action taken when confirmation is received.
-          if ( sentStatus != ZSuccess )
-          {
-            // The data wasn't delivered -- Do something
-          }
-          break;
-
-        case AF_INCOMING_MSG_CMD:
-          GenericApp_MessageMSGCB( MSGpkt );
-          break;
-
-        case ZDO_STATE_CHANGE:
-          GenericApp_NwkState = (devStates_t)(MSGpkt->hdr.status);
-          
-          GenericApp_HandleNetworkStatus(GenericApp_NwkState);
-          break;
+      case ZDO_CB_MSG:
+        GenericApp_ProcessZDOMsgs( (zdoIncomingMsg_t *)MSGpkt );
+        break;
+
+      case KEY_CHANGE:
+        GenericApp_HandleKeys( ((keyChange_t *)MSGpkt)->state, ((keyChange_t *)MSGpkt)->keys );
+        break;
+
+      case AF_DATA_CONFIRM_CMD:
+        // This message is received as a confirmation of a data packet sent.
+        // The status is of ZStatus_t type [defined in ZComDef.h]
+        // The message fields are defined in AF.h
+        afDataConfirm = (afDataConfirm_t *)MSGpkt;
+        sentEP = afDataConfirm->endpoint;
+        sentStatus = afDataConfirm->hdr.status;
+        sentTransID = afDataConfirm->transID;
+        (void)sentEP;
+        (void)sentTransID;
+
+        // Action taken when confirmation is received.
+        if ( sentStatus != ZSuccess )
+        {
+          // The data wasn't delivered -- Do something
+        }
+        break;
 
-        default:
-          break;
-      }
+      case AF_INCOMING_MSG_CMD:
+        GenericApp_MessageMSGCB( MSGpkt );
+        break;
 
-      // Release the memory
-      osal_msg_deallocate( (uint8 *)MSGpkt );
+      case ZDO_STATE_CHANGE:
+        GenericApp_NwkState = (devStates_t)(MSGpkt->hdr.status);
+        
+        GenericApp_HandleNetworkStatus(GenericApp_NwkState);
+        break;
 
-      // Next
-      MSGpkt = (afIncomingMSGPacket_t *)osal_msg_receive( GenericApp_TaskID );
+      default:
+        break;
     }
 
-    // return unprocessed events
-    return (events ^ SYS_EVENT_MSG);
+    // Release the memory, and the shared payload of an AF message
+    afIncomingMSGFree( (uint8 *)MSGpkt );
+
+    // Next
+    MSGpkt = (afIncomingMSGPacket_t *)osal_msg_receive( GenericApp_TaskID );
   }
+}
 
-  // handle GENERICAPP_PT_VOLT_SAMPLE
-  if(events & GENERICAPP_PT_VOLT_SAMPLE)
-  {
-    GenericApp_PtVoltSample();
-    
-    return (events ^ GENERICAPP_PT_VOLT_SAMPLE);
-  }  
-  
-  // handle GENERICAPP_REF_VOLT_SAMPLE
-  if(events & GENERICAPP_REF_VOLT_SAMPLE)
-  {
-    GenericApp_RefVoltSample();
-    
-    return (events ^ GENERICAPP_REF_VOLT_SAMPLE);
+/*********************************************************************
+ * @fn      GenericApp_DoMeasTemprEvt
+ *
+ * @brief   Handle GENERICAPP_DO_MEAS_TEMPR.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_DoMeasTemprEvt( void )
+{
+  if(TemprSystemStatus == TEMPR_FIND_NETWORK) // ߲ͻȻ
+  { 
+    // stop measure
+    GenericApp_MeasAbort();
+    osal_pwrmgr_task_state(GenericApp_TaskID, PWRMGR_CONSERVE);
+    HalOledShowString(TEMPR_RESULT_X,TEMPR_RESULT_Y,
+                      TEMPR_RESULT_SIZE,TEMPR_RESULT_DEFAULT);
+    HalOledShowString(DEVICE_INFO_X,DEVICE_INFO_Y,
+                      DEVICE_INFO_SIZE,DEVICE_INFO_FIND_NWK);
+    HalShowBattVol(BATTERY_NO_MEASURE_SHOW);
   }
+  else // start temperature measurement.
+    GenericApp_DoMeasTempr();
+}
 
-  // handle GENERICAPP_THERMO_VOLT_SAMPLE
-  if(events & GENERICAPP_THERMO_VOLT_SAMPLE)
-  {
-    GenericApp_ThermoVoltSample();
-    
-    return (events ^ GENERICAPP_THERMO_VOLT_SAMPLE);
-  }  
-  
-  
-  // handle meas tempr event
-  if (events & GENERICAPP_DO_MEAS_TEMPR)
-  {
-    if(TemprSystemStatus == TEMPR_FIND_NETWORK) // ߲ͻȻ
-    { 
-      // stop measure
-      HalOledShowString(TEMPR_RESULT_X,TEMPR_RESULT_Y,
-                        TEMPR_RESULT_SIZE,TEMPR_RESULT_DEFAULT);
-      HalOledShowString(DEVICE_INFO_X,DEVICE_INFO_Y,
-                        DEVICE_INFO_SIZE,DEVICE_INFO_FIND_NWK);
-      HalShowBattVol(BATTERY_NO_MEASURE_SHOW);
-            
-      
-    }
-    else // start temperature measurement.
-      GenericApp_DoMeasTempr();
-    
-    return (events ^ GENERICAPP_DO_MEAS_TEMPR);
-  }  
-  
-  // SYNC DATA
-  if (events &  GENERICAPP_TEMPR_SYNC)
+/*********************************************************************
+ * @fn      GenericApp_TemprSyncEvt
+ *
+ * @brief   Handle GENERICAPP_TEMPR_SYNC.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_TemprSyncEvt( void )
+{
+  if(TemprSystemStatus == TEMPR_SYNC_DATA) // ֻͬ״̬ͬ
+    GenericApp_SyncData();
+  else // Ѱ״̬
+    HalExtFlashLoseNetwork();
+}
+
+/*********************************************************************
+ * @fn      GenericApp_NvServiceEvt
+ *
+ * @brief   Handle GENERICAPP_NV_SERVICE, NV work in the background.
+ *          The event is set again while more is pending.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_NvServiceEvt( void )
+{
+#if OSAL_NV_BG_COMPACT || OSAL_NV_WRITE_BACK
+  osal_nv_process();
+#endif
+}
+
+#if defined ( ZCL_REPORT_ENGINE )
+/*********************************************************************
+ * @fn      GenericApp_ZclReportEvt
+ *
+ * @brief   Handle GENERICAPP_ZCL_REPORT, the timer of the reporting
+ *          engine.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_ZclReportEvt( void )
+{
+  zclReport_ProcessEvent();
+}
+
+/*********************************************************************
+ * @fn      GenericApp_ReportInit
+ *
+ * @brief   Register the Temperature Measurement attributes. Nothing is
+ *          reported before GenericApp_ReportStart().
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_ReportInit( void )
+{
+  zcl_registerAttrList( GENERICAPP_ENDPOINT, GENERICAPP_ATTRS, GenericApp_Attrs );
+
+  zclReport_Init( GenericApp_TaskID, GENERICAPP_ZCL_REPORT );
+  zclReport_SetDstAddr( &GenericApp_DstAddr );
+}
+
+/*********************************************************************
+ * @fn      GenericApp_ReportStart
+ *
+ * @brief   Report the measured value to the coordinator. Called on the
+ *          first stable online result, which is reported right away, so
+ *          the unknown value is never sent.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_ReportStart( void )
+{
+  zclCfgReportRec_t cfg;
+  int16 change = GENERICAPP_REPORT_CHANGE;
+
+  cfg.direction = ZCL_SEND_ATTR_REPORTS;
+  cfg.attrID = ATTRID_MS_TEMPERATURE_MEASURED_VALUE;
+  cfg.dataType = ZCL_DATATYPE_INT16;
+  cfg.minReportInt = GENERICAPP_REPORT_MIN_INT;
+  cfg.maxReportInt = GENERICAPP_REPORT_MAX_INT;
+  cfg.timeoutPeriod = 0;
+  cfg.reportableChange = (uint8 *)&change;
+  if ( zclReport_Configure( GENERICAPP_ENDPOINT, ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT,
+                            &cfg ) == ZCL_STATUS_SUCCESS )
   {
-    // start temperature measurement.
-    if(TemprSystemStatus == TEMPR_SYNC_DATA) // ֻͬ״̬ͬ
-      GenericApp_SyncData();
-    else // Ѱ״̬
-      HalExtFlashLoseNetwork();
-    
-    return (events ^  GENERICAPP_TEMPR_SYNC);
-  } 
- 
-  // Discard unknown events
-  return 0;
+    GenericApp_ReportStarted = TRUE;
+  }
 }
+#endif
 
 /*********************************************************************
  * Event Generation Functions
@@ -528,8 +747,8 @@ void GenericApp_HandleKeys( byte shift, byte keys )
         GenericApp_MeasTemprInit();
         // ԭ
         HalOledShowString(10,16,32,"     ");
-        // to start from PT volt sampling
-        osal_set_event(GenericApp_TaskID, GENERICAPP_PT_VOLT_SAMPLE);
+        // start the measurement loop
+        osal_set_event(GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
       }
       break;
       
@@ -540,8 +759,8 @@ void GenericApp_HandleKeys( byte shift, byte keys )
         GenericApp_MeasTemprInit();
         // ԭ
         HalOledShowString(10,16,32,"     ");
-        // to start from PT volt sampling
-        osal_set_event(GenericApp_TaskID, GENERICAPP_PT_VOLT_SAMPLE);
+        // start the measurement loop
+        osal_set_event(GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
       }
       break;
       default:// Online , Offline measure , closing , SYNC
@@ -589,8 +808,8 @@ void GenericApp_MessageMSGCB( afIncomingMSGPacket_t *pkt )
         GenericApp_MeasTemprInit();
         // ԭ
         HalOledShowString(10,16,32,"     ");
-        // to start from PT volt sampling
-        osal_set_event(GenericApp_TaskID, GENERICAPP_PT_VOLT_SAMPLE);    
+        // start the measurement loop
+        osal_set_event(GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);    
       }
       break;
       
@@ -601,6 +820,17 @@ void GenericApp_MessageMSGCB( afIncomingMSGPacket_t *pkt )
         osal_set_event(GenericApp_TaskID, GENERICAPP_TEMPR_SYNC);
       }
       break;
+
+    case GENERICAPP_CLUSTERID_ENERGY:
+      GenericApp_SendEnergyReport(pkt);
+      break;
+
+#if defined ( ZCL_REPORT_ENGINE )
+    case ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT:
+      // Read Attributes, Configure Reporting, ...
+      zclProcessMessageMSG( pkt );
+      break;
+#endif
   }
 }
 
@@ -630,107 +860,128 @@ void GenericApp_InitMeasResultArray(void)
 
 
 /*********************************************************************
- * @fn      GenericApp_PtVoltSample()
+ * @fn      GenericApp_MeasSample()
  *
- * @brief   none.
+ * @brief   Coroutine of one measurement loop: convert the PT, reference
+ *          and thermocouple voltages in turn, then post
+ *          GENERICAPP_DO_MEAS_TEMPR. It is resumed by
+ *          GENERICAPP_MEAS_SAMPLE, which DOUT/RDY or the fallback timer
+ *          sets while a conversion runs.
  *
  * @param   none
  *
- * @return  none
+ * @return  OSAL_PT_WAITING or OSAL_PT_ENDED
  */
-void GenericApp_PtVoltSample(void)
+uint8 GenericApp_MeasSample(void)
 {
-  real32 fVolt = 0.0f;
-  
-  if (appAD7793State == AD7793_IDLE) // ò
-  {
-    AD7793_AIN2_config_one(ad7793UpdateRate);
+  real32 fVolt;
 
-    appAD7793State = AD7793_SAMPLE;
-    osal_start_timerEx(GenericApp_TaskID, GENERICAPP_PT_VOLT_SAMPLE, ad7793RegSetDelay_ms);
-  }
-  else if ((appAD7793State == AD7793_SAMPLE) && AD7793_IsReadyToFetch())
-  {
-    fVolt = AD7793_AIN2_fetch_one(); // ȡ
-    measRltArray[retryNumOfMeasTempr].fPtVolt = fVolt;
+  OSAL_PT_BEGIN(&measPt);
 
-    appAD7793State = AD7793_IDLE;
-    osal_set_event(GenericApp_TaskID, GENERICAPP_REF_VOLT_SAMPLE);
-  }
-  else
+  for (measChannel = 0; measChannel < GENERICAPP_MEAS_CHANNELS; measChannel++)
   {
-    osal_start_timerEx(GenericApp_TaskID, GENERICAPP_PT_VOLT_SAMPLE, ad7793RegSetDelay_ms/10);
+    // no SPI traffic while DOUT/RDY is armed
+    HalAD7793RdyIntDisable();
+
+    GenericApp_MeasChannels[measChannel].config(ad7793UpdateRate); // ò
+    measTimeout = ad7793RegSetDelay_ms;
+
+    do
+    {
+      GenericApp_WaitConversion(GENERICAPP_MEAS_SAMPLE, measTimeout);
+      OSAL_PT_WAIT_EVENT(&measPt);
+
+      HalAD7793RdyIntDisable();
+      measTimeout = ad7793RegSetDelay_ms/10;
+    } while (!AD7793_IsReadyToFetch());
+
+    fVolt = GenericApp_MeasChannels[measChannel].fetch(); // ȡ
+    *(real32 *)((uint8 *)&measRltArray[retryNumOfMeasTempr] +
+                GenericApp_MeasChannels[measChannel].offset) = fVolt;
+
+    GenericApp_ConversionDone(GENERICAPP_MEAS_SAMPLE);
   }
+
+  osal_set_event(GenericApp_TaskID, GENERICAPP_DO_MEAS_TEMPR);
+
+  OSAL_PT_END(&measPt);
 }
 
 
 /*********************************************************************
- * @fn      GenericApp_RefVoltSample()
+ * @fn      GenericApp_MeasSampleEvt()
  *
- * @brief   none.
+ * @brief   Handle GENERICAPP_MEAS_SAMPLE, resume the measurement loop.
  *
  * @param   none
  *
  * @return  none
  */
-void GenericApp_RefVoltSample(void)
+void GenericApp_MeasSampleEvt(void)
 {
-  real32 fVolt = 0.0f;
-  
-  if (appAD7793State == AD7793_IDLE)
-  {
-    AD7793_AIN3_config_one(ad7793UpdateRate); // ò
-
-    appAD7793State = AD7793_SAMPLE;
-    osal_start_timerEx(GenericApp_TaskID, GENERICAPP_REF_VOLT_SAMPLE, ad7793RegSetDelay_ms);
-  }
-  else if ((appAD7793State == AD7793_SAMPLE) && AD7793_IsReadyToFetch())
-  {
-    fVolt = AD7793_AIN3_fetch_one();  // ȡ
-    measRltArray[retryNumOfMeasTempr].fRefVolt = fVolt;
+  (void)GenericApp_MeasSample();
+}
 
-    appAD7793State = AD7793_IDLE;
-    osal_set_event(GenericApp_TaskID, GENERICAPP_THERMO_VOLT_SAMPLE);
-  }
-  else
-  {
-    osal_start_timerEx(GenericApp_TaskID, GENERICAPP_REF_VOLT_SAMPLE, ad7793RegSetDelay_ms/10);
-  }
+/*********************************************************************
+ * @fn      GenericApp_WaitConversion()
+ *
+ * @brief   wait for the running AD7793 conversion without keeping the
+ *          CPU awake. The task votes to conserve power, so the idle OSAL
+ *          loop puts the MCU into PM2 until either DOUT/RDY goes low or
+ *          the fallback timer expires, whichever comes first.
+ *
+ * @param   event   - sample event to be posted on wake up.
+ * @param   timeout - fallback timeout in ms.
+ *
+ * @return  none
+ */
+void GenericApp_WaitConversion(uint16 event, uint16 timeout)
+{
+  osal_pwrmgr_task_state(GenericApp_TaskID, PWRMGR_CONSERVE);
+  HalAD7793RdyIntEnable(GenericApp_TaskID, event);
+  osal_start_timerEx(GenericApp_TaskID, event, timeout);
 }
 
 
 /*********************************************************************
- * @fn      GenericApp_ThermoVoltSample()
+ * @fn      GenericApp_ConversionDone()
  *
- * @brief   none.
+ * @brief   the AD7793 result has been fetched, to cancel the pending
+ *          fallback timer and to hold power until the next conversion
+ *          is started.
  *
- * @param   none
+ * @param   event - sample event of the finished conversion.
  *
  * @return  none
  */
-void GenericApp_ThermoVoltSample(void)
+void GenericApp_ConversionDone(uint16 event)
 {
-  real32 fVolt = 0.0f;
-  
-  if (appAD7793State == AD7793_IDLE)
-  {
-    AD7793_AIN1_config_one(ad7793UpdateRate); // ò
+  // woken up by DOUT/RDY, the fallback timer is still running.
+  osal_stop_timerEx(GenericApp_TaskID, event);
+  osal_pwrmgr_task_state(GenericApp_TaskID, PWRMGR_HOLD);
+}
 
-    appAD7793State = AD7793_SAMPLE;
-    osal_start_timerEx(GenericApp_TaskID, GENERICAPP_THERMO_VOLT_SAMPLE, ad7793RegSetDelay_ms);
-  }
-  else if ((appAD7793State == AD7793_SAMPLE) && AD7793_IsReadyToFetch())
-  {
-    fVolt = AD7793_AIN1_fetch_one(); // ȡ
-    measRltArray[retryNumOfMeasTempr].fThermoVolt = fVolt;
 
-    appAD7793State = AD7793_IDLE;
-    osal_set_event(GenericApp_TaskID, GENERICAPP_DO_MEAS_TEMPR);
-  }
-  else
-  {
-    osal_start_timerEx(GenericApp_TaskID, GENERICAPP_THERMO_VOLT_SAMPLE, ad7793RegSetDelay_ms/10);
-  }  
+/*********************************************************************
+ * @fn      GenericApp_MeasAbort()
+ *
+ * @brief   the measurement loop is given up, e.g. the network is lost
+ *          while measuring online. A conversion may have been configured
+ *          without its result being fetched, so the DOUT/RDY interrupt,
+ *          the fallback timer and the AD7793 energy interval are closed
+ *          here and the coroutine is rewound.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void GenericApp_MeasAbort(void)
+{
+  HalAD7793RdyIntDisable();
+  osal_stop_timerEx(GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
+  osal_clear_event(GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
+  HAL_ENERGY_STOP(HAL_ENERGY_AD7793);
+  OSAL_PT_INIT(&measPt, GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
 }
 
 
@@ -790,7 +1041,8 @@ void GenericApp_DoMeasTempr(void)
   
   if ((retryNumOfMeasTempr < MEAS_TEMPR_LOOP_COUNT_MAX) && (isComplete == FALSE))
   { // not complete, to start new loop of meas temperature;
-    osal_set_event(GenericApp_TaskID, GENERICAPP_PT_VOLT_SAMPLE);
+    OSAL_PT_RESTART(&measPt);
+    osal_set_event(GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
   }
   else
   { // 
@@ -819,7 +1071,7 @@ void GenericApp_DoMeasTempr(void)
 void GenericApp_MeasTemprInit(void)
 {
   retryNumOfMeasTempr = 0;
-  appAD7793State = AD7793_IDLE;
+  OSAL_PT_INIT(&measPt, GenericApp_TaskID, GENERICAPP_MEAS_SAMPLE);
   
   // 480ms, 240ms, 120ms ,60ms or 32ms
   ad7793UpdateRate     = AD7793_RATE_33dot2;
@@ -843,6 +1095,8 @@ void MeasTemprComplete(real32 fOutputDegree, real32 fColdEndDegree, bool isStabl
   real32 fOutputTmp = 0.0f;
   int32  iOutputTmp = 0;
   
+  // measurement loop is over, release the power hold.
+  osal_pwrmgr_task_state(GenericApp_TaskID, PWRMGR_CONSERVE);
 
   fOutputTmp = CalWorkEndTemp(fOutputDegree, fColdEndDegree);
     
@@ -886,12 +1140,28 @@ void MeasTemprComplete(real32 fOutputDegree, real32 fColdEndDegree, bool isStabl
         return;
       
       // 
+#if defined ( ZCL_REPORT_ENGINE )
+      // Report the measured value, a result within the reportable
+      // change of the last report is not sent
+      GenericApp_MeasuredValue = (int16)(iOutputTmp * 5);
+      if ( GenericApp_ReportStarted == FALSE )
+      {
+        GenericApp_ReportStart();
+      }
+      else
+      {
+        zclReport_AttrChanged( GENERICAPP_ENDPOINT,
+                               ZCL_CLUSTER_ID_MS_TEMPERATURE_MEASUREMENT,
+                               ATTRID_MS_TEMPERATURE_MEASURED_VALUE );
+      }
+#else
       AF_DataRequest( &GenericApp_DstAddr, &GenericApp_epDesc,
                        GENERICAPP_CLUSTERID_TEMPR_RESULT,
                        TEMPR_RESULT_BYTE_PER_PACKET,
                        (uint8 *)&ExtFlashStruct,
                        &GenericApp_TransID,
                        AF_DISCV_ROUTE, AF_DEFAULT_RADIUS );
+#endif
       
     }
     if(TemprSystemStatus == TEMPR_OFFLINE_MEASURE) // ״̬洢
@@ -1056,6 +1326,56 @@ void GenericApp_SyncData(void)
 }
 
 
+/*********************************************************************
+ * @fn      GenericApp_SendEnergyReport
+ *
+ * @brief   Answer an energy request with the energy accounting counters.
+ *          Request data byte 0 (optional): 0 = read, nonzero = read
+ *          and reset.
+ *          Response: seconds(4) + microseconds(4) per HAL_ENERGY_xxx state.
+ *
+ * @param   pkt - the request
+ *
+ * @return  none
+ */
+void GenericApp_SendEnergyReport(afIncomingMSGPacket_t *pkt)
+{
+#if (defined HAL_ENERGY) && (HAL_ENERGY == TRUE)
+  afAddrType_t dstAddr;
+  uint8 *buf;
+
+  buf = osal_mem_alloc(HAL_ENERGY_REPORT_LEN);
+  if (buf == NULL)
+  {
+    return;
+  }
+
+  HalEnergySerialize(buf);
+
+  if ((pkt->cmd.DataLength > 0) && (pkt->cmd.Data[0] != 0))
+  {
+    HalEnergyReset();
+  }
+
+  // reply to the requester
+  dstAddr.addrMode = (afAddrMode_t)Addr16Bit;
+  dstAddr.addr.shortAddr = pkt->srcAddr.addr.shortAddr;
+  dstAddr.endPoint = pkt->srcAddr.endPoint;
+
+  AF_DataRequest( &dstAddr, &GenericApp_epDesc,
+                 GENERICAPP_CLUSTERID_ENERGY,
+                 HAL_ENERGY_REPORT_LEN,
+                 buf,
+                 &GenericApp_TransID,
+                 AF_DISCV_ROUTE, AF_DEFAULT_RADIUS );
+
+  osal_mem_free(buf);
+#else
+  (void)pkt;
+#endif
+}
+
+
 /*********************************************************************
  * @fn      HalOledDispStaDurMeas
  *
@@ -63,8 +63,15 @@ extern "C"
 #define GENERICAPP_DEVICE_VERSION     0
 #define GENERICAPP_FLAGS              0
 
-#define GENERICAPP_IN_CLUSTERS        3
-#define GENERICAPP_OUT_CLUSTERS       3  
+// ZCL_REPORT_ENGINE is off in the shipped configurations: it reports live
+// results as ZCL Temperature Measurement instead of the private
+// TEMPR_RESULT frame (with its RTC timestamp) the collector expects.
+#if defined ( ZCL_REPORT_ENGINE )
+  #define GENERICAPP_IN_CLUSTERS      5   // + Temperature Measurement server
+#else
+  #define GENERICAPP_IN_CLUSTERS      4
+#endif
+#define GENERICAPP_OUT_CLUSTERS       4  
 
 
 #define GENERICAPP_CLUSTERID                  0x0001   // I/O
@@ -80,17 +87,57 @@ extern "C"
 #define GENERICAPP_CLUSTERID_TEMPR_RESULT   0x0031   // O
 //#define GENERICAPP_CLUSTERID_SPO2_RESULT   0x0032   // O
 
+#define GENERICAPP_CLUSTERID_ENERGY         0x0040   // I/O energy counters, see hal_energy.h
+
+// Default reporting of the measured temperature, a collector may change
+// it with Configure Reporting: on every change of at least one display
+// step (0.05 C), without periodic reports
+#define GENERICAPP_REPORT_MIN_INT           0        // s
+#define GENERICAPP_REPORT_MAX_INT           0        // s, ZCL_REPORT_NO_PERIODIC
+#define GENERICAPP_REPORT_CHANGE            5        // 0.01 C
+
 // Send SYNC Message Timeout
 #define GENERICAPP_SEND_SYNC_DATA_TIMEOUT   1000     // ֮ͬΪ1s
   
 // Application Events (OSAL) - These are bit weighted definitions.
 //#define GENERICAPP_SEND_MSG_EVT       0x0001
 
-#define GENERICAPP_TEMPR_SYNC         0x0010
-#define GENERICAPP_DO_MEAS_TEMPR      0x0020
-#define GENERICAPP_PT_VOLT_SAMPLE     0x0040
-#define GENERICAPP_REF_VOLT_SAMPLE    0x0080
-#define GENERICAPP_THERMO_VOLT_SAMPLE 0x0100
+// The single list of application events, in dispatch priority order
+// (SYS_EVENT_MSG always comes first): EVT( name, bit, handler ).
+// Both the event bits below and the dispatch table in GenericApp.c are
+// generated from it, so an event cannot lack a handler.
+#define GENERICAPP_EVENT_LIST( EVT ) \
+  EVT( GENERICAPP_MEAS_SAMPLE,        0x0040, GenericApp_MeasSampleEvt )    \
+  EVT( GENERICAPP_DO_MEAS_TEMPR,      0x0020, GenericApp_DoMeasTemprEvt )   \
+  EVT( GENERICAPP_TEMPR_SYNC,         0x0010, GenericApp_TemprSyncEvt )     \
+  GENERICAPP_REPORT_EVENTS( EVT )                                           \
+  EVT( GENERICAPP_NV_SERVICE,         0x0200, GenericApp_NvServiceEvt )
+
+// Shared timer of the ZCL reporting engine
+#if defined ( ZCL_REPORT_ENGINE )
+  #define GENERICAPP_REPORT_EVENTS( EVT ) \
+    EVT( GENERICAPP_ZCL_REPORT,       0x0080, GenericApp_ZclReportEvt )
+#else
+  #define GENERICAPP_REPORT_EVENTS( EVT )
+#endif
+
+#define GENERICAPP_EVENT_BIT( name, bit, handler )  name = (bit),
+
+enum
+{
+  GENERICAPP_EVENT_LIST( GENERICAPP_EVENT_BIT )
+  GENERICAPP_NO_EVENT = 0
+};
+
+// Most event handlers run by one GenericApp_ProcessEvent() call, the rest
+// are left for the next OSAL pass so higher priority tasks are not delayed
+#if !defined ( GENERICAPP_EVENT_BUDGET )
+  #define GENERICAPP_EVENT_BUDGET     4
+#endif
+
+// Most messages queued for the application task, a burst of frames beyond
+// it is dropped instead of filling the heap
+#define GENERICAPP_MSG_Q_DEPTH        8
 
 /* packet */
 #define TEMPR_RESULT_BYTE_PER_PACKET     12
@@ -0,0 +1,128 @@
+/**************************************************************************************************
+  Filename:       OnBoard.c
+  Revised:        $Date: 2016-10-19 10:00:00 +0800 (Wed, 19 Oct 2016) $
+  Revision:       $Revision: 1 $
+
+  Description:    Board services of the Linux host port, for the declarations in
+                  ZMain/TI2530DB/OnBoard.h.
+
+
+  Copyright 2016 Bupt. All rights reserved.
+
+  IMPORTANT: Your use of this Software is limited to those specific rights
+  granted under the terms of a software license agreement between the user
+  who downloaded the software, his/her employer (which must be your employer)
+  and Texas Instruments Incorporated (the "License").  You may not use this
+  Software unless you agree to abide by the terms of the License. The License
+  limits your use, and you acknowledge, that the Software may not be modified,
+  copied or distributed unless embedded on a Texas Instruments microcontroller
+  or used solely and exclusively in conjunction with a Texas Instruments radio
+  frequency transceiver, which is integrated into your product.  Other than for
+  the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+  works of, modify, distribute, perform, display or sell this Software and/or
+  its documentation for any purpose.
+
+  YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+  PROVIDED AS IS?WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, 
+  INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE, 
+  NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+  TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+  NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+  LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+  INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+  OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+  OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+  (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+  Should you have any questions regarding your right to use this Software,
+  contact kylinnevercry@gami.com. 
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdlib.h>
+
+#include "ZComDef.h"
+#include "OnBoard.h"
+
+/*********************************************************************
+ * @fn      _itoa
+ *
+ * @brief   convert a 16bit number to ASCII
+ *
+ * @param   num -
+ *          buf -
+ *          radix -
+ *
+ * @return  void
+ *
+ *********************************************************************/
+void _itoa(uint16 num, uint8 *buf, uint8 radix)
+{
+  char c,i;
+  uint8 *p, rst[5];
+
+  p = rst;
+  for ( i=0; i<5; i++,p++ )
+  {
+    c = num % radix;  // Isolate a digit
+    *p = c + (( c < 10 ) ? '0' : '7');  // Convert to Ascii
+    num /= radix;
+    if ( !num )
+      break;
+  }
+
+  for ( c=0 ; c<=i; c++ )
+    *buf++ = *p--;  // Reverse character order
+
+  *buf = '\0';
+}
+
+/*********************************************************************
+ * @fn        Onboard_rand
+ *
+ * @brief    Random number generator, seeded the same on every run so
+ *           that simulations repeat.
+ *
+ * @param   none
+ *
+ * @return  uint16 - new random number
+ *
+ *********************************************************************/
+uint16 Onboard_rand( void )
+{
+  return ( (uint16)rand() );
+}
+
+/*********************************************************************
+ * @fn        Onboard_wait
+ *
+ * @brief    Delay wait, nothing to wait for in virtual time
+ *
+ * @param   uint16 - time to wait
+ *
+ * @return  none
+ *
+ *********************************************************************/
+void Onboard_wait( uint16 timeout )
+{
+  (void)timeout;
+}
+
+/*********************************************************************
+ * @fn      OnBoard_stack_used
+ *
+ * @brief   The host stack is not checked.
+ *
+ * @param   none
+ *
+ * @return  zero
+ *********************************************************************/
+uint16 OnBoard_stack_used( void )
+{
+  return ( 0 );
+}
+
+/*********************************************************************
+*********************************************************************/
@@ -47,6 +47,7 @@
 #include "ZGlobals.h"
 #include "OnBoard.h"
 #include "OSAL.h"
+#include "OSAL_Nv.h"
 #include "MT.h"
 #include "MT_SYS.h"
 #include "DebugTrace.h"
@@ -388,6 +389,9 @@ void Onboard_wait( uint16 timeout )
  *********************************************************************/
 __near_func void Onboard_soft_reset( void )
 {
+  // Don't lose the NV writes still being coalesced in RAM.
+  (void)osal_nv_flush();
+
   HAL_DISABLE_INTERRUPTS();
   // Abort all DMA channels to insure that ongoing operations do not
   // interfere with re-configuration.
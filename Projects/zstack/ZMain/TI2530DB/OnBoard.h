@@ -54,6 +54,7 @@ extern "C"
 #include "hal_uart.h"
 #include "hal_sleep.h"
 #include "osal.h"
+#include "OSAL_Nv.h"
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -174,9 +175,10 @@ extern uint8 aExtendedAddress[8];
 #define MT_UART_IDLE_TIMEOUT 6
 
 // Restart system from absolute beginning
-// Disables interrupts, forces WatchDog reset
+// Writes the NV items still held in RAM, disables interrupts, forces WatchDog reset
 #define SystemReset()       \
 {                           \
+  (void)osal_nv_flush();    \
   HAL_DISABLE_INTERRUPTS(); \
   HAL_SYSTEM_RESET();       \
 }
@@ -204,6 +206,9 @@ extern uint8 aExtendedAddress[8];
 #define CSTACK_END ((uint8 const *)(_Pragma("segment=\"XSTACK\"") __segment_end("XSTACK"))-1)
 // Stack Initialization Value
 #define STACK_INIT_VALUE  0xCD
+#elif defined ( HAL_MCU_HOST )
+// The host port has no XSTACK segment to fill and check
+#define STACK_INIT_VALUE  0xCD
 #else
 #error Check compiler compatibility.
 #endif